@@ -0,0 +1,30 @@
+#ifndef ANALYTICS_NOTIFIER_HPP
+#define ANALYTICS_NOTIFIER_HPP
+
+#include <memory>
+#include <string>
+
+#include "constants.hpp"
+#include "env_manager.hpp"
+#include "jwt_manager.hpp"
+
+// Tells the analytics service that complaints changed, so it drops the statistics it cached
+// from them. The request is signed as an Admin with the JWT secret the services share. Best
+// effort: the cached statistics still expire on their own.
+class AnalyticsNotifier {
+   public:
+    AnalyticsNotifier(const std::string& analytics_server_url,
+                      std::shared_ptr<JwtManager> jwt_manager);
+
+    // nullptr when ANALYTICS_SERVER_URL is not set.
+    static std::shared_ptr<AnalyticsNotifier> create_from_env(
+        std::shared_ptr<JwtManager> jwt_manager, EnvManager env_manager = EnvManager());
+
+    void notify_complaints_changed();
+
+   private:
+    std::string analytics_server_url;
+    std::shared_ptr<JwtManager> jwt_manager;
+};
+
+#endif  // ANALYTICS_NOTIFIER_HPP
@@ -2,14 +2,19 @@
 #define BASE_API_HANDLER_H
 
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/stdx/optional.hpp>
 #include <memory>
 #include <string>
 #include <tuple>
 #include <vector>
 
 #include "base_api_strategy.hpp"
+#include "complaint_rollup_manager.hpp"
 #include "crow.h"
 #include "database_manager.hpp"
+#include "deferred_handler.hpp"
+#include "replicated_collection.hpp"
+#include "write_coalescer.hpp"
 
 class BaseApiHandler {
    public:
@@ -22,6 +27,17 @@ class BaseApiHandler {
                       process_response_func = BaseApiStrategy::process_response_func_get_one)
         -> crow::response;
 
+    // Same contract as find_one, but answered from the replica unless a projection is asked for
+    // or the filter is not a single equality on _id or name.
+    auto find_one(const crow::request& req,
+                  std::shared_ptr<ReplicatedCollection> replicated_collection,
+                  std::function<std::tuple<bsoncxx::document::value, mongocxx::options::find>(
+                      const crow::request&)>
+                      process_request_func = BaseApiStrategy::process_request_func_get_one,
+                  std::function<crow::json::wvalue(const bsoncxx::document::value&)>
+                      process_response_func = BaseApiStrategy::process_response_func_get_one)
+        -> crow::response;
+
     auto find(const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
               const std::string& collection_name,
               std::function<std::tuple<bsoncxx::document::value, mongocxx::options::find,
@@ -30,6 +46,32 @@ class BaseApiHandler {
               std::function<crow::json::wvalue(mongocxx::cursor&)> process_response_func)
         -> crow::response;
 
+    // Same as find, but the documents are serialized one at a time as the cursor yields them into
+    // a {"documents": [...]} body, so large results are never materialized as a wvalue tree. The
+    // body is not streamed: crow sends it in one piece once complete. The optional
+    // process_fields_func adds top-level fields once the last document has been seen.
+    auto find_serialized(
+        const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
+        const std::string& collection_name,
+        std::function<std::tuple<bsoncxx::document::value, mongocxx::options::find,
+                                 bsoncxx::document::value>(const crow::request&)>
+            process_request_func,
+        std::function<void(const bsoncxx::document::view&, std::string&)> process_document_func =
+            BaseApiStrategy::process_document_func_get,
+        std::function<crow::json::wvalue(
+            const crow::request&, const bsoncxx::stdx::optional<bsoncxx::document::value>&,
+            const size_t&)>
+            process_fields_func = nullptr) -> crow::response;
+
+    // Same contract as find_serialized with the default document shaping, but a request for the
+    // whole replicated collection is answered from the replica, as JSON from its serialized body.
+    // Filters, sorts and projections go to the database.
+    auto find_serialized(
+        const crow::request& req, std::shared_ptr<ReplicatedCollection> replicated_collection,
+        std::function<std::tuple<bsoncxx::document::value, mongocxx::options::find,
+                                 bsoncxx::document::value>(const crow::request&)>
+            process_request_func) -> crow::response;
+
     auto insert_one(const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
                     const std::string& collection_name,
                     std::function<std::tuple<bsoncxx::document::value, mongocxx::options::insert>(
@@ -39,6 +81,17 @@ class BaseApiHandler {
                         process_response_func = BaseApiStrategy::process_response_func_insert_one)
         -> crow::response;
 
+    // Same contract as insert_one, but the write is batched with concurrent inserts and the
+    // response is passed to respond once the batch has been written.
+    void insert_one(
+        const crow::request& req, std::shared_ptr<WriteCoalescer> write_coalescer,
+        const respond_func_type& respond,
+        std::function<std::tuple<bsoncxx::document::value, mongocxx::options::insert>(
+            const crow::request&)>
+            process_request_func = BaseApiStrategy::process_request_func_insert_one,
+        std::function<crow::json::wvalue(const bsoncxx::oid&)> process_response_func =
+            BaseApiStrategy::process_response_func_coalesced_insert_one);
+
     auto delete_one(
         const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
         const std::string& collection_name,
@@ -66,6 +119,25 @@ class BaseApiHandler {
         std::function<crow::json::wvalue(const mongocxx::result::update&)> process_response_func)
         -> crow::response;
 
+    // Same contracts as delete_many and update_one on complaints, but the write is made through
+    // the rollup manager so complaint_rollups move with it.
+    auto delete_many(
+        const crow::request& req, std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager,
+        std::function<std::tuple<bsoncxx::document::value, mongocxx::options::delete_options>(
+            const crow::request&)>
+            process_request_func,
+        std::function<crow::json::wvalue(const long long int&)> process_response_func =
+            BaseApiStrategy::process_response_func_tracked_delete_many) -> crow::response;
+
+    auto update_one(
+        const crow::request& req, std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager,
+        std::function<std::tuple<bsoncxx::document::value, bsoncxx::document::value,
+                                 mongocxx::options::update>(const crow::request&)>
+            process_request_func,
+        std::function<crow::json::wvalue(const ComplaintRollupManager::UpdateResult&)>
+            process_response_func = BaseApiStrategy::process_response_func_tracked_update_one)
+        -> crow::response;
+
     auto count_documents(
         const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
         const std::string& collection_name,
@@ -84,6 +156,12 @@ class BaseApiHandler {
                        create_pipeline_func,
                    std::function<crow::json::wvalue(const crow::request&, mongocxx::cursor&)>
                        process_response_func) -> crow::response;
+
+   private:
+    static auto _make_find_one_response(
+        const bsoncxx::stdx::optional<bsoncxx::document::value>& result,
+        const std::function<crow::json::wvalue(const bsoncxx::document::value&)>&
+            process_response_func) -> crow::response;
 };
 
 #endif
\ No newline at end of file
@@ -3,23 +3,29 @@
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/oid.hpp>
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
 #include <mongocxx/uri.hpp>
+#include <string>
 #include <tuple>
 #include <vector>
 
+#include "complaint_rollup_manager.hpp"
 #include "crow.h"
 
 namespace BaseApiStrategy {
 auto process_request_func_get_one(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::find>;
 auto process_response_func_get_one(const bsoncxx::document::value& doc) -> crow::json::wvalue;
+// Appends one serialized document of a find result to out.
+void process_document_func_get(const bsoncxx::document::view& doc, std::string& out);
 
 auto process_request_func_insert_one(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::insert>;
 auto process_response_func_insert_one(const mongocxx::result::insert_one& result)
     -> crow::json::wvalue;
+auto process_response_func_coalesced_insert_one(const bsoncxx::oid& oid) -> crow::json::wvalue;
 
 auto process_response_func_delete_one(const mongocxx::result::delete_result& result)
     -> crow::json::wvalue;
@@ -28,6 +34,13 @@ auto process_response_func_delete_many(const mongocxx::result::delete_result& re
 
 auto process_response_func_update_one(const mongocxx::result::update& result) -> crow::json::wvalue;
 
+// Same fields as the delete and update responses above, for writes made through
+// ComplaintRollupManager; its updates never upsert.
+auto process_response_func_tracked_delete_many(const long long int& deleted_count)
+    -> crow::json::wvalue;
+auto process_response_func_tracked_update_one(const ComplaintRollupManager::UpdateResult& result)
+    -> crow::json::wvalue;
+
 auto process_request_func_count_documents(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::count>;
 auto process_response_func_count_documents(const long long int& count) -> crow::json::wvalue;
@@ -1,65 +1,76 @@
 #ifndef BASE_API_STRATEGY_UTILS_H
 #define BASE_API_STRATEGY_UTILS_H
 
+#include <bsoncxx/builder/core.hpp>
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/stdx/string_view.hpp>
+#include <bsoncxx/types/bson_value/value.hpp>
 #include <string>
-#include <unordered_set>
+#include <vector>
 
 #include "crow.h"
+#include "response_format.hpp"
 
 namespace BaseApiStrategyUtils {
 void validate_fields(const crow::request& req, std::initializer_list<std::string> required_fields);
+// Both are encoded as negotiated from the Accept header of the request being served.
 auto make_error_response(int status_code, const std::string& message) -> crow::response;
 auto make_success_response(int status_code, crow::json::wvalue data, const std::string& message)
     -> crow::response;
+auto _get_response_format() -> ResponseFormat;
+auto _make_binary_response(int status_code, const crow::json::wvalue& data,
+                           const ResponseFormat& format) -> crow::response;
 
 auto parse_database_json_to_response_json(const crow::json::rvalue& rval_json)
     -> crow::json::wvalue;
 
 auto parse_request_json_to_database_bson(const crow::json::rvalue& rval_json)
     -> bsoncxx::document::value;
-auto parse_request_json_to_database_bson_single_primitive(const std::string& key,
-                                                          const crow::json::rvalue& rval_json)
-    -> bsoncxx::document::value;
-auto _parse_request_json_to_database_bson_single_primitive(const std::string& key,
-                                                           const crow::json::rvalue& rval_json)
-    -> bsoncxx::document::value;
-auto _parse_request_json_to_database_bson_single_primitive_clean_key(const std::string& key)
-    -> std::string;
-auto _parse_request_json_to_database_bson_single_primitive_parse_inequality(
-    const std::string& key, const bsoncxx::document::value& doc) -> bsoncxx::document::value;
-auto parse_request_json_to_database_bson_single_array(const std::string& key,
-                                                      const crow::json::rvalue& rval_json)
-    -> bsoncxx::document::value;
-auto parse_request_json_to_database_bson_single_object(const std::string& key,
-                                                       const crow::json::rvalue& rval_json)
-    -> bsoncxx::document::value;
+// Range keys ("_from_x", "_to_x") and date fields are rewritten while the single builder is
+// filled, so no intermediate documents are created.
+void _append_request_json_field(bsoncxx::builder::core& builder, const std::string& key,
+                                const crow::json::rvalue& rval_json, const bool& is_top_level);
+void _append_request_json_value(bsoncxx::builder::core& builder,
+                                const crow::json::rvalue& rval_json, const bool& is_date_field);
+auto _get_range_operator(const bsoncxx::stdx::string_view& key) -> bsoncxx::stdx::string_view;
+auto _is_date_field(const bsoncxx::stdx::string_view& key) -> bool;
 
 auto parse_oid_str_to_oid_bson(const std::string& oid_str) -> bsoncxx::document::value;
 auto parse_date_str_to_date_bson(const std::string& date_str) -> bsoncxx::types::b_date;
 
-const std::string DEFAULT_KEY = "";
+// Builds a projection from the optional "fields" (inclusion) or "exclude_fields" (exclusion)
+// string arrays in the request body. required_fields are always kept, e.g. for sort keys.
+auto parse_request_json_to_projection(const crow::json::rvalue& body,
+                                      const std::vector<std::string>& required_fields = {})
+    -> bsoncxx::stdx::optional<bsoncxx::document::value>;
+auto _parse_request_json_to_field_names(const crow::json::rvalue& field_names_json,
+                                        const std::string& key) -> std::vector<std::string>;
+
+// Keyset pagination: the sort always ends in _id so every document has a unique position, and
+// the opaque cursor stores that position (plus the sort it belongs to) for the next page. A
+// missing sort field is stored as null, which is where mongod sorts it, and sort fields that
+// hold values of different types are paged across type boundaries. Arrays cannot be paged.
+auto add_keyset_tiebreaker(const bsoncxx::document::view& sort) -> bsoncxx::document::value;
+auto create_keyset_cursor(const bsoncxx::document::view& sort,
+                          const bsoncxx::document::view& last_document) -> std::string;
+auto parse_keyset_cursor_to_filter(const std::string& cursor, const bsoncxx::document::view& sort)
+    -> bsoncxx::document::value;
+auto _get_keyset_sort_direction(const bsoncxx::document::element& direction) -> int;
+// Position of a value's type in mongod's sort order; values of different types compare by it.
+auto _get_keyset_type_rank(const bsoncxx::type& type) -> size_t;
+// Conditions on field that match the values sorted strictly after value in the direction.
+auto _make_keyset_after_conditions(const std::string& field,
+                                   const bsoncxx::types::bson_value::view& value,
+                                   const int& direction) -> std::vector<bsoncxx::document::value>;
+auto _get_keyset_field_value(const bsoncxx::document::view& document, const std::string& path)
+    -> bsoncxx::types::bson_value::value;
+
 const std::string GTE_SIGN = "_from_";
 const std::string LTE_SIGN = "_to_";
 
-const std::unordered_set<std::string> DATE_FIELDS = {"date",
-                                                     "created_utc",
-                                                     "date_created",
-                                                     "date_published",
-                                                     "date_closed",
-                                                     "date_submitted",
-                                                     GTE_SIGN + "date",
-                                                     GTE_SIGN + "created_utc",
-                                                     GTE_SIGN + "date_created",
-                                                     GTE_SIGN + "date_published",
-                                                     GTE_SIGN + "date_closed",
-                                                     GTE_SIGN + "date_submitted",
-                                                     LTE_SIGN + "date",
-                                                     LTE_SIGN + "created_utc",
-                                                     LTE_SIGN + "date_created",
-                                                     LTE_SIGN + "date_published",
-                                                     LTE_SIGN + "date_closed",
-                                                     LTE_SIGN + "date_submitted"};
+// fields whose string values are stored as dates, also when used with a range prefix
+const std::vector<bsoncxx::stdx::string_view> DATE_FIELDS = {
+    "date", "created_utc", "date_created", "date_published", "date_closed", "date_submitted"};
 }  // namespace BaseApiStrategyUtils
 
 #endif
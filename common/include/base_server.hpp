@@ -6,22 +6,41 @@
 #include <string>
 #include <vector>
 
+#include "blocking_executor.hpp"
 #include "cors.hpp"
 #include "crow.h"
+#include "deferred_handler.hpp"
 #include "jwt_manager.hpp"
+#include "metrics_manager.hpp"
+#include "request_coalescer.hpp"
+#include "response_compressor.hpp"
 
 using handler_func_type = std::function<crow::response(const crow::request&)>;
 
+// Served as a deferred handler once decorated, since admission control parks queued requests.
 struct HandlerFunc {
     std::string route;
     std::function<crow::response(const crow::request&)> func;
     crow::HTTPMethod method;
-    std::function<handler_func_type(const handler_func_type&)> concurrency_protection_decorator;
+    std::function<deferred_handler_func_type(const handler_func_type&)>
+        concurrency_protection_decorator;
     JwtAccessLevel access_level;
     std::function<handler_func_type(const handler_func_type&, const JwtAccessLevel& access_level)>
         jwt_protection_decorator;
 };
 
+struct DeferredHandlerFunc {
+    std::string route;
+    deferred_handler_func_type func;
+    crow::HTTPMethod method;
+    std::function<deferred_handler_func_type(const deferred_handler_func_type&)>
+        concurrency_protection_decorator;
+    JwtAccessLevel access_level;
+    std::function<deferred_handler_func_type(const deferred_handler_func_type&,
+                                             const JwtAccessLevel& access_level)>
+        jwt_protection_decorator;
+};
+
 class BaseServer {
    public:
     BaseServer(int port, int concurrency);
@@ -30,20 +49,54 @@ class BaseServer {
    protected:
     int port;
     int concurrency;
+    std::shared_ptr<BlockingExecutor> blocking_executor;
+    std::shared_ptr<JwtManager> jwt_manager;
+    std::shared_ptr<MetricsManager> metrics_manager;
+    std::shared_ptr<ResponseCompressor> response_compressor;
     std::vector<HandlerFunc> handler_funcs;
+    std::vector<DeferredHandlerFunc> deferred_handler_funcs;
+    // collections whose registered indexes are ensured when the server starts
+    std::vector<std::string> indexed_collections;
+    // With a request coalescer, concurrent identical requests to these routes share one execution.
+    std::shared_ptr<RequestCoalescer> request_coalescer;
+    std::vector<std::string> coalesced_routes;
 
     void _init_server();
     virtual void _define_handler_funcs() = 0;
     void _decorate_handler_funcs();
+    // Outermost decorator: creates the request's RequestContext, answers If-None-Match with a
+    // 304, compresses the response and reports the stage timings.
+    auto _request_context_decorator(const std::string& route,
+                                    const deferred_handler_func_type& func)
+        -> deferred_handler_func_type;
+    // Sits outside admission control, so a parked caller holds neither a thread nor a slot.
+    // Requests are identical when they have the same route, response format, Accept-Encoding,
+    // If-None-Match and body, and the same Authorization header on routes that need a JWT.
+    auto _request_coalescing_decorator(const std::string& route, const JwtAccessLevel& access_level,
+                                       const deferred_handler_func_type& func)
+        -> deferred_handler_func_type;
+    void _ensure_indexes();
+    // Starts func on the blocking executor; the response is completed whenever func responds.
+    auto _make_async_handler_func(const deferred_handler_func_type& func)
+        -> std::function<void(const crow::request&, crow::response&)>;
     void _register_handler_func(const std::string& route,
                                 const std::function<crow::response(const crow::request&)>& func,
                                 const crow::HTTPMethod& method,
-                                const std::function<handler_func_type(const handler_func_type&)>&
-                                    concurrency_protection_decorator,
+                                const std::function<deferred_handler_func_type(
+                                    const handler_func_type&)>& concurrency_protection_decorator,
                                 const JwtAccessLevel& access_level,
                                 const std::function<handler_func_type(
                                     const handler_func_type&, const JwtAccessLevel& access_level)>&
                                     jwt_protection_decorator);
+    void _register_handler_func(
+        const std::string& route, const deferred_handler_func_type& func,
+        const crow::HTTPMethod& method,
+        const std::function<deferred_handler_func_type(const deferred_handler_func_type&)>&
+            concurrency_protection_decorator,
+        const JwtAccessLevel& access_level,
+        const std::function<deferred_handler_func_type(
+            const deferred_handler_func_type&, const JwtAccessLevel& access_level)>&
+            jwt_protection_decorator);
 };
 
 #endif
@@ -0,0 +1,33 @@
+#ifndef BINARY_RESPONSE_BUILDER_HPP
+#define BINARY_RESPONSE_BUILDER_HPP
+
+#include <bsoncxx/builder/core.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <string>
+
+#include "crow.h"
+#include "response_format.hpp"
+
+// Builds a {"<key>": [...], <fields>} response body as BSON or MessagePack from documents as the
+// cursor yields them. BSON bodies embed the raw documents without transcoding, so dates and
+// ObjectIds keep their BSON types; MessagePack bodies match the JSON response.
+class BinaryResponseBuilder {
+   public:
+    BinaryResponseBuilder(const ResponseFormat& format, const std::string& key);
+
+    void append_document(const bsoncxx::document::view& document);
+    // Appends the remaining top-level fields and returns the body.
+    auto finish(const crow::json::wvalue& fields) -> std::string;
+
+    auto get_item_count() const -> size_t;
+
+   private:
+    ResponseFormat format;
+    std::string key;
+    bsoncxx::builder::core bson_builder;
+    // MessagePack arrays are length-prefixed, so items are kept apart until the count is known
+    std::string msgpack_items;
+    size_t item_count;
+};
+
+#endif  // BINARY_RESPONSE_BUILDER_HPP
@@ -0,0 +1,45 @@
+#ifndef BLOCKING_EXECUTOR_HPP
+#define BLOCKING_EXECUTOR_HPP
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "constants.hpp"
+#include "env_manager.hpp"
+
+// Fixed-size thread pool for work that blocks on Mongo or outbound HTTP calls, so that crow's
+// I/O threads only ever parse requests and write responses.
+class BlockingExecutor {
+   public:
+    BlockingExecutor(
+        const int& num_threads = stoi(Constants::DEFAULT_BLOCKING_EXECUTOR_THREADS),
+        const int& max_queue_length = stoi(Constants::DEFAULT_BLOCKING_EXECUTOR_MAX_QUEUE_LENGTH));
+    ~BlockingExecutor();
+
+    BlockingExecutor(const BlockingExecutor&) = delete;
+    BlockingExecutor& operator=(const BlockingExecutor&) = delete;
+
+    static std::shared_ptr<BlockingExecutor> create_from_env(EnvManager env_manager = EnvManager());
+
+    // Returns false without running the task when the queue is full or the executor is stopping.
+    auto submit(std::function<void()> task) -> bool;
+
+    auto get_num_threads() const -> int;
+
+   private:
+    int max_queue_length;
+    bool is_stopping = false;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    std::queue<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+
+    void _run_worker();
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef COLLECTION_WATCHER_HPP
+#define COLLECTION_WATCHER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "constants.hpp"
+#include "database_manager.hpp"
+
+// Calls on_change from a background thread whenever a collection changes, and once more each time
+// the change stream is (re)opened since changes in between were missed. Deployments without change
+// streams (standalone servers) are logged once and retried; with a positive poll_interval_ms,
+// on_change is also called on that interval until the stream opens. A given on_poll is called on
+// the interval instead, e.g. to check whether anything changed before reporting it.
+class CollectionWatcher {
+   public:
+    CollectionWatcher(std::shared_ptr<DatabaseManager> db_manager,
+                      const std::string& collection_name, std::function<void()> on_change,
+                      const int& poll_interval_ms = 0, std::function<void()> on_poll = nullptr);
+    ~CollectionWatcher();
+
+    CollectionWatcher(const CollectionWatcher&) = delete;
+    CollectionWatcher& operator=(const CollectionWatcher&) = delete;
+
+   private:
+    std::shared_ptr<DatabaseManager> db_manager;
+    std::string collection_name;
+    std::function<void()> on_change;
+    std::function<void()> on_poll;
+    std::chrono::milliseconds poll_interval;
+
+    std::atomic<bool> is_stopping{false};
+    std::mutex mutex;
+    std::condition_variable stopping_changed;
+    std::thread watcher;
+
+    void _run();
+    // Returns false once the watcher is stopping.
+    auto _wait(const std::chrono::milliseconds& duration) -> bool;
+};
+
+#endif  // COLLECTION_WATCHER_HPP
@@ -0,0 +1,173 @@
+#ifndef COMPLAINT_COLUMN_STORE_HPP
+#define COMPLAINT_COLUMN_STORE_HPP
+
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/stdx/optional.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "collection_watcher.hpp"
+#include "constants.hpp"
+#include "database_manager.hpp"
+#include "env_manager.hpp"
+#include "sentiment_sketch.hpp"
+
+// Read-optimized copy of the complaint fields the statistics read, one array per field, so a
+// statistics request is a scan over a few contiguous arrays instead of an aggregation. Category
+// and source are dictionary encoded. The copy is reloaded in the background after complaints
+// change, once changes pause, so a burst of writes costs one reload. Until the reload that
+// includes a change is published, get_columns() keeps returning the previous columns for at most
+// max_staleness_ms after that change, then nullptr so reads go to the database. Without change
+// streams, changes are those reported to mark_changed() and, on each poll, a moved count or
+// largest _id of complaints.
+class ComplaintColumnStore {
+   public:
+    static constexpr int64_t MISSING_DATE = std::numeric_limits<int64_t>::min();
+    static constexpr uint8_t MISSING_CATEGORY = std::numeric_limits<uint8_t>::max();
+    static constexpr uint16_t MISSING_SOURCE = std::numeric_limits<uint16_t>::max();
+    static constexpr int ANY_VALUE = -1;
+    static constexpr int32_t NO_MONTH = std::numeric_limits<int32_t>::min();
+
+    // Immutable once published.
+    struct Columns {
+        // UTC unix milliseconds, MISSING_DATE for complaints without a date
+        std::vector<int64_t> dates;
+        // months since January 1970 of the dates, for grouping by month
+        std::vector<int32_t> months;
+        // indexes into the dictionaries, MISSING_CATEGORY / MISSING_SOURCE for non-strings
+        std::vector<uint8_t> categories;
+        std::vector<uint16_t> sources;
+        // NaN for complaints without a numeric sentiment
+        std::vector<double> sentiments;
+
+        std::vector<std::string> category_dictionary;
+        std::vector<std::string> source_dictionary;
+        std::unordered_map<std::string, uint8_t> category_codes;
+        std::unordered_map<std::string, uint16_t> source_codes;
+        // range of months, empty when first_month > last_month
+        int32_t first_month = std::numeric_limits<int32_t>::max();
+        int32_t last_month = std::numeric_limits<int32_t>::min();
+
+        auto size() const -> size_t;
+        // Throws when a dictionary is full.
+        void append(const bsoncxx::document::view& complaint);
+        // category and source are nullopt for missing or non-string values
+        void append(const int64_t& date, const bsoncxx::stdx::optional<std::string>& category,
+                    const bsoncxx::stdx::optional<std::string>& source, const double& sentiment);
+    };
+
+    enum class Dimension { None, Category, Source };
+
+    // Rows match when every bound holds; unset bounds hold for every row. Rows without a date
+    // fail any from_date above MISSING_DATE.
+    struct Filter {
+        int64_t from_date = std::numeric_limits<int64_t>::min();
+        int64_t to_date = std::numeric_limits<int64_t>::max();
+        bool has_sentiment_range = false;
+        double from_sentiment = -std::numeric_limits<double>::infinity();
+        double to_sentiment = std::numeric_limits<double>::infinity();
+        // a dictionary code, or ANY_VALUE
+        int category = ANY_VALUE;
+        int source = ANY_VALUE;
+        // set when an equality names a value that no complaint has
+        bool matches_nothing = false;
+    };
+
+    struct Statistics {
+        long long int count = 0;
+        long long int sentiment_count = 0;
+        double sentiment_sum = 0;
+        SentimentSketch sentiment_sketch;
+    };
+
+    struct Group {
+        // NO_MONTH unless grouped by month
+        int32_t month;
+        // a dictionary code, MISSING_CATEGORY / MISSING_SOURCE, or ANY_VALUE when not grouped by
+        // a dimension
+        int value;
+        Statistics statistics;
+    };
+
+    ComplaintColumnStore(std::shared_ptr<DatabaseManager> db_manager,
+                         const int& poll_interval_ms =
+                             stoi(Constants::DEFAULT_COMPLAINT_COLUMN_STORE_POLL_INTERVAL_MS),
+                         const int& max_staleness_ms =
+                             stoi(Constants::DEFAULT_COMPLAINT_COLUMN_STORE_MAX_STALENESS_MS));
+    ~ComplaintColumnStore();
+
+    ComplaintColumnStore(const ComplaintColumnStore&) = delete;
+    ComplaintColumnStore& operator=(const ComplaintColumnStore&) = delete;
+
+    // nullptr when COMPLAINT_COLUMN_STORE_ENABLED is not "true".
+    static std::shared_ptr<ComplaintColumnStore> create_from_env(
+        std::shared_ptr<DatabaseManager> db_manager, EnvManager env_manager = EnvManager());
+
+    // Loads complaints now and publishes them; the background loader calls it after changes.
+    void refresh();
+
+    // nullptr before the first load and once a change has waited longer than max_staleness_ms
+    // to be loaded.
+    auto get_columns() -> std::shared_ptr<const Columns>;
+
+    // Counts a change to complaints, e.g. one a writer reported, so the columns are reloaded.
+    void mark_changed();
+
+    // Called after each reload is published, e.g. to drop results computed from older columns.
+    void set_on_refresh(std::function<void()> on_refresh);
+
+    // Statistics of the matching rows per month and/or dimension value, leaving out empty
+    // groups. Rows without a date are left out when grouping by month.
+    static auto compute_statistics(const Columns& columns, const Filter& filter,
+                                   const bool& is_by_month, const Dimension& dimension)
+        -> std::vector<Group>;
+    // Counts of the matching rows per [boundaries[i], boundaries[i + 1]) sentiment bucket, then
+    // one more count of the rows outside every bucket, like $bucket with a default.
+    static auto count_sentiment_buckets(const Columns& columns, const Filter& filter,
+                                        const std::vector<double>& boundaries)
+        -> std::vector<long long int>;
+
+    static auto _get_month(const int64_t& date) -> int32_t;
+
+   private:
+    std::shared_ptr<DatabaseManager> db_manager;
+    std::chrono::milliseconds max_staleness;
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::shared_ptr<const Columns> columns;
+    // the columns are current while every counted change is loaded
+    long long int change_count = 1;
+    long long int loaded_change_count = 0;
+    // when the oldest change the columns miss was counted, and when the latest one was
+    std::chrono::steady_clock::time_point unloaded_since;
+    std::chrono::steady_clock::time_point last_change_at;
+    std::function<void()> on_refresh;
+    // the count and largest _id of complaints when the published columns were loaded
+    std::string loaded_version;
+    bool is_stopping = false;
+    // serializes loads so an older load never replaces a newer one
+    std::mutex refresh_mutex;
+    std::thread loader;
+
+    void _run_loader();
+    // waits until changes pause or the oldest unloaded one has waited long enough
+    void _wait_for_changes_to_settle(std::unique_lock<std::mutex>& lock);
+    // marks a change when the version moved since the last load, instead of reloading every poll
+    void _poll();
+    auto _read_version() -> std::string;
+
+    // declared last so it stops calling mark_changed before the rest is destroyed
+    std::unique_ptr<CollectionWatcher> watcher;
+};
+
+#endif  // COMPLAINT_COLUMN_STORE_HPP
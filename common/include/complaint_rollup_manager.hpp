@@ -0,0 +1,92 @@
+#ifndef COMPLAINT_ROLLUP_MANAGER_HPP
+#define COMPLAINT_ROLLUP_MANAGER_HPP
+
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/stdx/optional.hpp>
+#include <bsoncxx/types.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "database_manager.hpp"
+#include "env_manager.hpp"
+
+// Keeps complaint_rollups in step with complaints: one document per (month, category, source)
+// holding the complaint count, the count, sum, sum of squares, minimum and maximum of their
+// sentiments, and their SentimentSketch bins as a sentiment_histogram of { "<bin>": count }. The
+// month is stored as the date of its first instant, so date filters on complaints select whole
+// months of rollups. The minimum and maximum cannot be taken back like the sums, so they are
+// recomputed from complaints for the rollups a sentiment leaves.
+// Writers report their complaint inserts here and make their updates and deletes through it;
+// rebuild() recomputes the collection from scratch.
+class ComplaintRollupManager {
+   public:
+    struct UpdateResult {
+        long long int matched_count;
+        long long int modified_count;
+    };
+
+    explicit ComplaintRollupManager(std::shared_ptr<DatabaseManager> db_manager);
+
+    // nullptr when COMPLAINT_ROLLUPS_ENABLED is not "true".
+    static std::shared_ptr<ComplaintRollupManager> create_from_env(
+        std::shared_ptr<DatabaseManager> db_manager, EnvManager env_manager = EnvManager());
+
+    void apply_inserts(const std::vector<bsoncxx::document::view>& complaints);
+
+    // Reads the fields rollups depend on from the complaints matching the filter, deletes them by
+    // _id with one delete_many, and takes them out of their rollups. Returns how many were
+    // deleted.
+    auto delete_many(const bsoncxx::document::view& filter) -> long long int;
+    // Updates the first complaint matching the filter with findOneAndUpdate, on the condition that
+    // the fields rollups depend on still hold what was just read, so its contribution moves from
+    // exactly that document to the one handed back. Retried when another write got in between.
+    auto update_one(const bsoncxx::document::view& filter,
+                    const bsoncxx::document::view& update_document) -> UpdateResult;
+
+    // Replaces the collection with rollups aggregated from complaints; returns their number.
+    // Writes that land while it runs may be lost, so it is meant for an idle moment.
+    auto rebuild() -> long long int;
+    // Rebuilds only when the rollups do not count as many complaints as there are, e.g. on a
+    // first deployment or after writes made while the rollups were turned off, or when some
+    // rollups predate sentiment histograms or ranges.
+    void rebuild_if_out_of_sync();
+
+    // The rollup key of a complaint, or nothing when the complaint has no date.
+    static auto _make_key(const bsoncxx::document::view& complaint)
+        -> bsoncxx::stdx::optional<bsoncxx::document::value>;
+    static auto _get_month_start(const bsoncxx::types::b_date& date) -> bsoncxx::types::b_date;
+
+   private:
+    struct Contribution {
+        bsoncxx::document::value key;
+        long long int count;
+        long long int sentiment_count;
+        double sentiment_sum;
+        double sentiment_sum_of_squares;
+        std::map<int, long long int> sentiment_histogram;
+        // of the sentiments added; the range of the rollup is recomputed when one is removed
+        double sentiment_min;
+        double sentiment_max;
+        bool has_removed_sentiment;
+    };
+
+    std::shared_ptr<DatabaseManager> db_manager;
+
+    // contributions are merged per key so a batch of complaints becomes one $inc per rollup
+    static void _add_contribution(const bsoncxx::document::view& complaint, const int& sign,
+                                  std::map<std::string, Contribution>& contributions);
+    void _apply(const std::map<std::string, Contribution>& contributions);
+    // the complaint has been written already, so a failure only leaves the rollups behind
+    void _apply_or_log(const std::map<std::string, Contribution>& contributions);
+    // sets the sentiment range of a rollup from its complaints
+    void _recompute_sentiment_range(const bsoncxx::document::view& key);
+    // matches the complaint only while the fields its contribution comes from are unchanged
+    static auto _make_unchanged_filter(const bsoncxx::document::view& complaint)
+        -> bsoncxx::document::value;
+};
+
+#endif  // COMPLAINT_ROLLUP_MANAGER_HPP
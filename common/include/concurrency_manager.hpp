@@ -1,20 +1,93 @@
 #ifndef CONCURRENCY_MANAGER_HPP
 #define CONCURRENCY_MANAGER_HPP
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
+#include "blocking_executor.hpp"
+#include "constants.hpp"
 #include "crow.h"
+#include "deferred_handler.hpp"
 
+struct AdmissionPolicy {
+    int max_concurrency;
+    int max_queue_length;
+    int max_wait_ms;
+};
+
+// Admits at most max_concurrency requests per route. Requests over the limit are parked without
+// a thread: they wait as deferred completions that a finishing request starts on the blocking
+// executor, or that a single timer thread rejects with a 503 once max_wait_ms has passed.
 class ConcurrencyManager {
    public:
+    // Without a blocking executor, a parked request runs on the thread that released its slot.
+    ConcurrencyManager(const int& retry_after_seconds = Constants::ADMISSION_RETRY_AFTER_SECONDS,
+                       std::shared_ptr<BlockingExecutor> blocking_executor = nullptr);
+    ~ConcurrencyManager();
+
+    ConcurrencyManager(const ConcurrencyManager&) = delete;
+    ConcurrencyManager& operator=(const ConcurrencyManager&) = delete;
+
+    // Each call creates an independent set of slots and wait queue for the decorated route. The
+    // handler is served as a deferred one, so a queued request does not hold a thread.
     auto concurrency_protection_decorator(
-        const std::function<crow::response(const crow::request&)>& func)
-        -> std::function<crow::response(const crow::request&)>;
+        const std::function<crow::response(const crow::request&)>& func,
+        const AdmissionPolicy& policy) -> deferred_handler_func_type;
+    // The slot is held until the deferred handler responds, not just until it returns.
+    auto concurrency_protection_decorator(const deferred_handler_func_type& func,
+                                          const AdmissionPolicy& policy)
+        -> deferred_handler_func_type;
+
+    static const AdmissionPolicy LIGHT_ADMISSION_POLICY;
+    static const AdmissionPolicy MEDIUM_ADMISSION_POLICY;
+    static const AdmissionPolicy HEAVY_ADMISSION_POLICY;
+    static const AdmissionPolicy WRITE_ADMISSION_POLICY;
+    static const AdmissionPolicy JOB_ADMISSION_POLICY;
 
    private:
-    std::mutex mutex;
+    enum class Admission { Admitted, Parked, Rejected };
+
+    struct Waiter {
+        std::chrono::steady_clock::time_point deadline;
+        // called once, with true when the slot was handed over and false when it timed out
+        std::function<void(bool)> resume;
+    };
+
+    struct RouteAdmission {
+        AdmissionPolicy policy;
+        std::mutex mutex;
+        int active_count = 0;
+        // in arrival order, so also in deadline order
+        std::deque<Waiter> waiters;
+    };
+
+    int retry_after_seconds;
+    std::shared_ptr<BlockingExecutor> blocking_executor;
+
+    std::mutex timer_mutex;
+    std::condition_variable timer_changed;
+    std::vector<std::shared_ptr<RouteAdmission>> admissions;
+    long long int timer_generation = 0;
+    bool is_stopping = false;
+    std::thread timer;
+
+    auto _acquire_slot_or_park(RouteAdmission& admission, std::function<void(bool)> resume)
+        -> Admission;
+    // Hands the slot to the oldest waiter still in time, or frees it.
+    void _release_slot(RouteAdmission& admission);
+    void _resume(RouteAdmission& admission, Waiter waiter);
+    // Takes the waiters whose deadline has passed off the front of the queue.
+    static auto _take_expired_waiters(RouteAdmission& admission,
+                                      const std::chrono::steady_clock::time_point& now)
+        -> std::vector<Waiter>;
+    void _run_timer();
+    auto _make_overloaded_response(const std::string& message) -> crow::response;
 };
 
 #endif
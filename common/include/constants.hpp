@@ -2,17 +2,67 @@
 #define CONSTANTS_HPP
 
 #include <string>
+#include <utility>
+#include <vector>
+
+struct IndexSpec {
+    std::string collection_name;
+    // ordered (field, direction) pairs; direction is ignored for text indexes
+    std::vector<std::pair<std::string, int>> keys;
+    bool unique;
+    bool is_text;
+    // only documents that have every key field are indexed, so a unique index does not treat
+    // all documents without the key as duplicates of null
+    bool is_partial = false;
+};
 
 namespace Constants {
 const std::string DATETIME_FORMAT = "%d-%m-%Y %H:%M:%S";
 
 const std::string MONGO_URI = "mongodb://127.0.0.1:27017";
 const std::string DB_NAME = "CS3203";
+const std::string DEFAULT_MONGO_POOL_MAX_SIZE = "32";
+const std::string DEFAULT_MONGO_POOL_WAIT_TIMEOUT_MS = "5000";
+const int BULK_WRITE_CHUNK_SIZE = 1000;
+const int MONGO_DUPLICATE_KEY_ERROR_CODE = 11000;
+
+const std::string DEFAULT_WRITE_COALESCING_ENABLED = "false";
+const std::string DEFAULT_WRITE_COALESCING_WINDOW_MS = "5";
+const std::string DEFAULT_WRITE_COALESCING_MAX_BATCH_SIZE = "500";
+const std::string DEFAULT_WRITE_COALESCING_MAX_LATENCY_MS = "50";
+
+const std::string DEFAULT_BLOCKING_EXECUTOR_THREADS = "32";
+const std::string DEFAULT_BLOCKING_EXECUTOR_MAX_QUEUE_LENGTH = "1024";
+
+const std::string DEFAULT_RESPONSE_COMPRESSION_ENABLED = "true";
+const std::string DEFAULT_RESPONSE_COMPRESSION_MIN_SIZE = "1024";
+const std::string DEFAULT_RESPONSE_COMPRESSION_GZIP_LEVEL = "5";
+const std::string DEFAULT_RESPONSE_COMPRESSION_ZSTD_LEVEL = "3";
+
+const std::string DEFAULT_RESULT_CACHE_ENABLED = "true";
+const std::string DEFAULT_RESULT_CACHE_TTL_MS = "60000";
+const std::string DEFAULT_RESULT_CACHE_MAX_ENTRIES = "1024";
+const int COLLECTION_WATCH_MAX_AWAIT_MS = 1000;
+const int COLLECTION_WATCH_RETRY_MS = 30000;
+
+const std::string DEFAULT_REQUEST_COALESCING_ENABLED = "true";
+
+const std::string DEFAULT_COMPLAINT_ROLLUPS_ENABLED = "true";
+
+const std::string DEFAULT_COMPLAINT_COLUMN_STORE_ENABLED = "true";
+// without change streams every poll reloads all complaints, so it is slower than for replicas
+const std::string DEFAULT_COMPLAINT_COLUMN_STORE_POLL_INTERVAL_MS = "60000";
+const std::string DEFAULT_COMPLAINT_COLUMN_STORE_MAX_STALENESS_MS = "10000";
+
+const std::string DEFAULT_REPLICATED_COLLECTIONS =
+    "categories,sources,poll_templates,category_analytics";
+const std::string DEFAULT_REPLICATED_COLLECTION_POLL_INTERVAL_MS = "5000";
 
 const std::string COLLECTION_CATEGORIES = "categories";
 const std::string COLLECTION_SOURCES = "sources";
 const std::string COLLECTION_POSTS = "posts";
 const std::string COLLECTION_COMPLAINTS = "complaints";
+const std::string COLLECTION_COMPLAINT_ROLLUPS = "complaint_rollups";
 const std::string COLLECTION_CATEGORY_ANALYTICS = "category_analytics";
 const std::string COLLECTION_USERS = "users";
 const std::string COLLECTION_POLLS = "polls";
@@ -20,6 +70,26 @@ const std::string COLLECTION_POLL_TEMPLATES = "poll_templates";
 const std::string COLLECTION_POLL_RESPONSES = "poll_responses";
 const std::string COLLECTION_ANALYTICS_TASK_IDS = "analytics_task_ids";
 
+// Indexes every service ensures on startup for the collections it serves. Compound analytics
+// indexes lead with the equality fields of the $match, then the date range, then sentiment so the
+// statistics $group stages can be answered from the index alone.
+const std::vector<IndexSpec> INDEX_SPECS = {
+    {COLLECTION_CATEGORIES, {{"name", 1}}, true, false},
+    {COLLECTION_SOURCES, {{"name", 1}}, true, false},
+    {COLLECTION_POSTS, {{"id", 1}}, true, false, true},
+    {COLLECTION_POSTS, {{"date", 1}}, false, false},
+    {COLLECTION_COMPLAINTS, {{"id", 1}}, true, false, true},
+    {COLLECTION_COMPLAINTS, {{"date", 1}, {"sentiment", 1}}, false, false},
+    {COLLECTION_COMPLAINTS, {{"category", 1}, {"date", 1}, {"sentiment", 1}}, false, false},
+    {COLLECTION_COMPLAINTS, {{"source", 1}, {"date", 1}, {"sentiment", 1}}, false, false},
+    {COLLECTION_COMPLAINT_ROLLUPS, {{"date", 1}, {"category", 1}, {"source", 1}}, true, false},
+    {COLLECTION_CATEGORY_ANALYTICS, {{"name", 1}}, true, false},
+    {COLLECTION_USERS, {{"email", 1}}, true, false},
+    {COLLECTION_POLLS, {{"status", 1}}, false, false},
+    {COLLECTION_POLL_RESPONSES, {{"poll_id", 1}, {"user_id", 1}}, false, false},
+};
+const std::string DEFAULT_ENSURE_INDEXES_ON_STARTUP = "true";
+
 const std::string REDDIT_API_ID = "";
 const std::string REDDIT_API_SECRET = "";
 const std::string REDDIT_USERNAME = "";
@@ -33,6 +103,7 @@ const std::string ENV_FILE_DEFAULT_PATH = "./.env";
 
 const std::string DEFAULT_JWT_SECRET = "";
 const std::string DEFAULT_JWT_DURATION_IN_SECONDS = "3600";
+const std::string DEFAULT_JWT_CLAIMS_CACHE_MAX_ENTRIES = "4096";
 
 const int ANALYTICS_SERVER_PORT_NUMBER = 8082;
 const int MANAGEMENT_SERVER_PORT_NUMBER = 8083;
@@ -40,7 +111,33 @@ const int UPDATER_SERVER_PORT_NUMBER = 8084;
 const int USER_SERVER_PORT_NUMBER = 8085;
 const int DEFAULT_CONCURRENCY = 10;
 
+const int ADMISSION_RETRY_AFTER_SECONDS = 1;
+// cheap point lookups and counts
+const int ADMISSION_LIGHT_MAX_CONCURRENCY = 64;
+const int ADMISSION_LIGHT_MAX_QUEUE_LENGTH = 256;
+const int ADMISSION_LIGHT_MAX_WAIT_MS = 1000;
+// list reads and single-pass aggregations
+const int ADMISSION_MEDIUM_MAX_CONCURRENCY = 8;
+const int ADMISSION_MEDIUM_MAX_QUEUE_LENGTH = 32;
+const int ADMISSION_MEDIUM_MAX_WAIT_MS = 3000;
+// aggregations grouped over time
+const int ADMISSION_HEAVY_MAX_CONCURRENCY = 2;
+const int ADMISSION_HEAVY_MAX_QUEUE_LENGTH = 8;
+const int ADMISSION_HEAVY_MAX_WAIT_MS = 5000;
+const int ADMISSION_WRITE_MAX_CONCURRENCY = 8;
+const int ADMISSION_WRITE_MAX_QUEUE_LENGTH = 64;
+const int ADMISSION_WRITE_MAX_WAIT_MS = 3000;
+// updater jobs that call external services
+const int ADMISSION_JOB_MAX_CONCURRENCY = 1;
+const int ADMISSION_JOB_MAX_QUEUE_LENGTH = 2;
+const int ADMISSION_JOB_MAX_WAIT_MS = 1000;
+
 const std::string DEFAULT_ANALYTICS_URL = "";
+const std::string DEFAULT_ANALYTICS_SERVER_URL = "";
+const int ANALYTICS_SERVER_NOTIFY_TIMEOUT_MS = 2000;
+// groups a grouped statistics response may zero-fill, counting every combination of the group
+// values in every month
+const long long int MAX_ZERO_FILLED_GROUPS = 100000;
 }  // namespace Constants
 
 #endif  // CONSTANTS_HPP
\ No newline at end of file
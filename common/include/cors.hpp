@@ -10,7 +10,8 @@ struct CORS {
         if (req.method == "OPTIONS"_method) {
             res.add_header("Access-Control-Allow-Origin", "*");
             res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-            res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+            res.add_header("Access-Control-Allow-Headers",
+                           "Content-Type, Authorization, If-None-Match");
             res.code = 204;
             res.end();
         }
@@ -19,7 +20,10 @@ struct CORS {
     void after_handle(crow::request& req, crow::response& res, context& ctx) {
         res.add_header("Access-Control-Allow-Origin", "*");
         res.add_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-        res.add_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
+        res.add_header("Access-Control-Allow-Headers",
+                       "Content-Type, Authorization, If-None-Match");
+        // lets browser code read the ETag it should send back as If-None-Match
+        res.add_header("Access-Control-Expose-Headers", "ETag");
     }
 };
 
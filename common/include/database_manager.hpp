@@ -3,16 +3,104 @@
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <mongocxx/bulk_write.hpp>
+#include <mongocxx/change_stream.hpp>
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/pool.hpp>
+#include <string>
 #include <vector>
 
 #include "crow.h"
+#include "constants.hpp"
 #include "env_manager.hpp"
 
+// Keeps the pooled client checked out for as long as the cursor is alive, since a
+// mongocxx::cursor must not outlive (or share) the client it was created from.
+class PooledCursor {
+   public:
+    PooledCursor(mongocxx::pool::entry client, mongocxx::cursor cursor);
+
+    auto begin() -> mongocxx::cursor::iterator;
+    auto end() -> mongocxx::cursor::iterator;
+
+    operator mongocxx::cursor&();
+
+   private:
+    mongocxx::pool::entry client;
+    mongocxx::cursor cursor;
+};
+
+// Same as PooledCursor, for a change stream.
+class PooledChangeStream {
+   public:
+    PooledChangeStream(mongocxx::pool::entry client, mongocxx::change_stream change_stream);
+
+    auto begin() -> mongocxx::change_stream::iterator;
+    auto end() -> mongocxx::change_stream::iterator;
+
+   private:
+    mongocxx::pool::entry client;
+    mongocxx::change_stream change_stream;
+};
+
+enum class BulkWriteOperationType {
+    InsertOne,
+    UpdateOne,
+    UpdateMany,
+    ReplaceOne,
+    DeleteOne,
+    DeleteMany
+};
+
+struct BulkWriteOperation {
+    BulkWriteOperationType type;
+    // the document to insert, or the filter for every other operation type
+    bsoncxx::document::value document;
+    // the update or replacement document; unused for inserts and deletes
+    bsoncxx::document::value update_document;
+    bool upsert;
+
+    static auto insert_one(const bsoncxx::document::view& document) -> BulkWriteOperation;
+    static auto update_one(const bsoncxx::document::view& filter,
+                           const bsoncxx::document::view& update_document,
+                           const bool& upsert = false) -> BulkWriteOperation;
+    static auto update_many(const bsoncxx::document::view& filter,
+                            const bsoncxx::document::view& update_document,
+                            const bool& upsert = false) -> BulkWriteOperation;
+    static auto replace_one(const bsoncxx::document::view& filter,
+                            const bsoncxx::document::view& replacement,
+                            const bool& upsert = false) -> BulkWriteOperation;
+    static auto delete_one(const bsoncxx::document::view& filter) -> BulkWriteOperation;
+    static auto delete_many(const bsoncxx::document::view& filter) -> BulkWriteOperation;
+};
+
+enum class BulkWriteItemStatus { Succeeded, DuplicateKey, Failed };
+
+struct BulkWriteItemResult {
+    BulkWriteItemStatus status = BulkWriteItemStatus::Succeeded;
+    int error_code = 0;
+    std::string error_message;
+};
+
+struct BulkWriteResult {
+    // one entry per operation, in the order the operations were given
+    std::vector<BulkWriteItemResult> item_results;
+    long long int inserted_count = 0;
+    long long int matched_count = 0;
+    long long int modified_count = 0;
+    long long int deleted_count = 0;
+    long long int upserted_count = 0;
+
+    auto count(const BulkWriteItemStatus& status) const -> int;
+};
+
 class DatabaseManager {
    public:
-    DatabaseManager(const std::string& uri, const std::string& db_name);
+    DatabaseManager(
+        const std::string& uri, const std::string& db_name,
+        const int& pool_max_size = stoi(Constants::DEFAULT_MONGO_POOL_MAX_SIZE),
+        const int& pool_wait_timeout_ms = stoi(Constants::DEFAULT_MONGO_POOL_WAIT_TIMEOUT_MS));
 
     static std::shared_ptr<DatabaseManager> create_from_env(EnvManager env_manager = EnvManager());
 
@@ -21,7 +109,7 @@ class DatabaseManager {
         -> bsoncxx::stdx::optional<bsoncxx::document::value>;
 
     auto find(const std::string& collection_name, const bsoncxx::document::view& filter = {},
-              const mongocxx::options::find& option = {}) -> mongocxx::cursor;
+              const mongocxx::options::find& option = {}) -> PooledCursor;
 
     auto insert_one(const std::string& collection_name, const bsoncxx::document::view& document,
                     const mongocxx::options::insert& option = {})
@@ -50,16 +138,48 @@ class DatabaseManager {
                      const mongocxx::options::update& option = {})
         -> bsoncxx::stdx::optional<mongocxx::result::update>;
 
+    // Both return the document as it was before or after the write, as option asks, or nothing
+    // when no document matched.
+    auto find_one_and_update(const std::string& collection_name,
+                             const bsoncxx::document::view& filter,
+                             const bsoncxx::document::view& update_document,
+                             const mongocxx::options::find_one_and_update& option = {})
+        -> bsoncxx::stdx::optional<bsoncxx::document::value>;
+
     auto count_documents(const std::string& collection_name, const bsoncxx::document::view& filter,
                          const mongocxx::options::count& option = {}) -> long long int;
 
     auto aggregate(const std::string& collection_name, const mongocxx::pipeline& pipeline,
-                   const mongocxx::options::aggregate& option = {}) -> mongocxx::cursor;
+                   const mongocxx::options::aggregate& option = {}) -> PooledCursor;
+
+    // Throws if the deployment does not support change streams, e.g. a standalone server.
+    auto watch(const std::string& collection_name,
+               const mongocxx::options::change_stream& option = {}) -> PooledChangeStream;
+
+    auto create_index(const std::string& collection_name, const bsoncxx::document::view& keys,
+                      const bsoncxx::document::view& index_options = {})
+        -> bsoncxx::document::value;
+
+    auto list_indexes(const std::string& collection_name) -> std::vector<bsoncxx::document::value>;
+
+    // Runs the operations as unordered bulk writes of at most chunk_size operations each. A
+    // failing operation does not stop the others; its outcome is reported in item_results.
+    auto bulk_write(const std::string& collection_name,
+                    const std::vector<BulkWriteOperation>& operations,
+                    const int& chunk_size = Constants::BULK_WRITE_CHUNK_SIZE) -> BulkWriteResult;
 
    private:
     static mongocxx::instance instance;
-    mongocxx::client client;
-    mongocxx::database db;
+    mongocxx::pool pool;
+    std::string db_name;
+
+    static auto _create_pool_uri(const std::string& uri, const int& pool_max_size,
+                                 const int& pool_wait_timeout_ms) -> mongocxx::uri;
+    static void _append_bulk_write_operation(mongocxx::bulk_write& bulk,
+                                             const BulkWriteOperation& operation);
+    static void _record_bulk_write_errors(const bsoncxx::document::view& reply,
+                                          const size_t& chunk_start, const size_t& chunk_end,
+                                          BulkWriteResult& result);
 };
 
 #endif
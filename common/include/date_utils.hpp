@@ -23,6 +23,24 @@ auto utc_unix_timestamp_to_string(const long long int& utc_unix_timestamp,
 
 auto string_to_utc_unix_timestamp(const std::string& datetime, const std::string& format)
     -> long long int;
+
+// Converts many values with one format; DATETIME_FORMAT values take the fixed-format codec below.
+auto utc_unix_timestamps_to_strings(const std::vector<long long int>& utc_unix_timestamps,
+                                    const std::string& format) -> std::vector<std::string>;
+auto strings_to_utc_unix_timestamps(const std::vector<std::string>& datetimes,
+                                    const std::string& format) -> std::vector<long long int>;
+
+// Allocation-free codec for Constants::DATETIME_FORMAT ("dd-mm-YYYY HH:MM:SS"). Both return
+// false for anything outside that exact layout with a 4-digit year, which callers hand to the
+// iostream based functions above.
+const size_t DATETIME_LENGTH = 19;
+auto format_datetime(const long long int& utc_unix_timestamp, char* out) -> bool;
+auto parse_datetime(const char* datetime, const size_t& length, long long int& utc_unix_timestamp)
+    -> bool;
+auto _days_from_civil(long long int year, const unsigned int& month, const unsigned int& day)
+    -> long long int;
+void _civil_from_days(long long int days, long long int& year, unsigned int& month,
+                      unsigned int& day);
 }  // namespace DateUtils
 
 #endif
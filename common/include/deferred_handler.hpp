@@ -0,0 +1,15 @@
+#ifndef DEFERRED_HANDLER_HPP
+#define DEFERRED_HANDLER_HPP
+
+#include <functional>
+
+#include "crow.h"
+
+// A handler that answers later instead of returning the response, so waiting on e.g. a
+// coalesced write does not hold an executor thread. respond must be called exactly once, and
+// may be called from any thread.
+using respond_func_type = std::function<void(crow::response)>;
+using deferred_handler_func_type =
+    std::function<void(const crow::request&, const respond_func_type&)>;
+
+#endif  // DEFERRED_HANDLER_HPP
@@ -0,0 +1,48 @@
+#ifndef ENTITY_TAG_HPP
+#define ENTITY_TAG_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "crow.h"
+
+// Hashes a response body as it is written into a strong ETag, so bodies built in chunks do not
+// have to be hashed again once they are complete.
+class EntityTagHasher {
+   public:
+    EntityTagHasher();
+
+    void update(const std::string& chunk);
+    auto get_etag() const -> std::string;
+
+   private:
+    // 64-bit FNV-1a, which is stable across builds and processes unlike std::hash
+    uint64_t hash;
+    size_t size;
+};
+
+namespace EntityTagUtils {
+auto compute_etag(const std::string& body) -> std::string;
+
+// A compressed body is a different representation and needs its own strong ETag; the encoding is
+// appended the way Apache does, and ignored again when If-None-Match is compared.
+auto add_encoding_to_etag(const std::string& etag, const std::string& encoding_name)
+    -> std::string;
+
+// Weak comparison, as RFC 9110 prescribes for If-None-Match; "*" matches any ETag.
+auto matches_if_none_match(const std::string& if_none_match_header, const std::string& etag)
+    -> bool;
+
+// Gives a successful response the ETag of its body, unless it already has one. Read paths tag
+// their responses; only tagged responses are ever answered with a 304.
+auto tag_response(crow::response res) -> crow::response;
+// Turns a tagged response into a body-less 304 when the request's If-None-Match names its ETag.
+// BaseServer does this around the whole handler, so caches inside it see the full response.
+auto make_conditional_response(const crow::request& req, crow::response res) -> crow::response;
+auto make_not_modified_response(const std::string& etag) -> crow::response;
+
+// The opaque part of an ETag without the W/ prefix, the quotes and an encoding suffix.
+auto _get_opaque_tag(const std::string& etag) -> std::string;
+}  // namespace EntityTagUtils
+
+#endif  // ENTITY_TAG_HPP
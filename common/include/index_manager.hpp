@@ -0,0 +1,42 @@
+#ifndef INDEX_MANAGER_HPP
+#define INDEX_MANAGER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "database_manager.hpp"
+
+struct IndexReport {
+    std::vector<std::string> created;
+    std::vector<std::string> existing;
+    // registered indexes that could not be created, e.g. because of conflicting options
+    std::vector<std::string> missing;
+    // indexes on the collections that no spec registers
+    std::vector<std::string> unregistered;
+    // indexes with no recorded use since mongod started tracking them
+    std::vector<std::string> unused;
+};
+
+class IndexManager {
+   public:
+    IndexManager(std::shared_ptr<DatabaseManager> db_manager);
+
+    // Creates every spec whose collection is listed and reports on all indexes of those
+    // collections. Entries are formatted as "<collection>.<index name>".
+    auto ensure_indexes(const std::vector<std::string>& collection_names,
+                        const std::vector<IndexSpec>& index_specs = Constants::INDEX_SPECS)
+        -> IndexReport;
+
+    static auto get_index_name(const IndexSpec& index_spec) -> std::string;
+    static void log_report(const IndexReport& report);
+
+   private:
+    std::shared_ptr<DatabaseManager> db_manager;
+
+    auto _get_index_names(const std::string& collection_name) -> std::vector<std::string>;
+    auto _get_unused_index_names(const std::string& collection_name) -> std::vector<std::string>;
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef JSON_RESPONSE_BUILDER_HPP
+#define JSON_RESPONSE_BUILDER_HPP
+
+#include <functional>
+#include <string>
+
+#include "crow.h"
+
+// Builds a {"<key>": [...], <fields>} JSON response body one item at a time, handing each piece
+// to append_func as it is serialized, so the result is never held as a crow::json::wvalue tree.
+// This does not stream: crow sends a dynamic body in one piece once the handler responds, so the
+// whole body (or its compressed form) still ends up in the response.
+class JsonResponseBuilder {
+   public:
+    explicit JsonResponseBuilder(std::function<void(const std::string&)> append_func);
+
+    void begin_array(const std::string& key);
+    // item_json must already be a serialized JSON value
+    void append_array_item(const std::string& item_json);
+    // Closes the array and appends the remaining top-level fields.
+    void finish(const crow::json::wvalue& fields);
+
+    auto get_item_count() const -> size_t;
+
+   private:
+    std::function<void(const std::string&)> append_func;
+    size_t item_count;
+};
+
+#endif  // JSON_RESPONSE_BUILDER_HPP
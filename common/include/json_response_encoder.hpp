@@ -0,0 +1,29 @@
+#ifndef JSON_RESPONSE_ENCODER_HPP
+#define JSON_RESPONSE_ENCODER_HPP
+
+#include <bsoncxx/array/view.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/stdx/string_view.hpp>
+#include <bsoncxx/types/bson_value/view.hpp>
+#include <string>
+
+// Writes a BSON document straight into response JSON in one pass. The values match
+// bsoncxx::to_json followed by BaseApiStrategyUtils::parse_database_json_to_response_json: dates
+// in (sub)documents become DATETIME_FORMAT strings, ObjectIds stay {"$oid": "..."}, and arrays are
+// written as legacy extended JSON without any date rewriting.
+namespace JsonResponseEncoder {
+// Appends to out so one buffer can be reused across documents.
+void encode_document(const bsoncxx::document::view& document, std::string& out);
+auto encode_document(const bsoncxx::document::view& document) -> std::string;
+
+void _encode_document(const bsoncxx::document::view& document, std::string& out,
+                      const bool& rewrite_dates);
+void _encode_array(const bsoncxx::array::view& array, std::string& out);
+void _encode_value(const bsoncxx::types::bson_value::view& value, std::string& out,
+                   const bool& rewrite_dates);
+void _encode_string(const bsoncxx::stdx::string_view& str, std::string& out);
+void _encode_double(const double& number, std::string& out);
+void _encode_int64(const long long int& number, std::string& out);
+}  // namespace JsonResponseEncoder
+
+#endif  // JSON_RESPONSE_ENCODER_HPP
@@ -1,34 +1,75 @@
 #ifndef JWT_MANAGER_HPP
 #define JWT_MANAGER_HPP
 
+#include <jwt-cpp/jwt.h>
+
+#include <chrono>
 #include <functional>
+#include <list>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 #include "constants.hpp"
 #include "crow.h"
 #include "database_manager.hpp"
+#include "deferred_handler.hpp"
 #include "env_manager.hpp"
 
 enum class JwtAccessLevel { Personal, Admin, Citizen, None };
 
+struct JwtClaims {
+    std::string oid;
+    std::string role;
+    // time_point::max() when the token does not expire
+    std::chrono::system_clock::time_point expires_at;
+};
+
 class JwtManager {
    public:
     JwtManager(const std::string& jwt_secret = env_manager.read_env("JWT_SECRET",
                                                                     Constants::DEFAULT_JWT_SECRET),
                const int& jwt_duration_in_seconds = stoi(env_manager.read_env(
-                   "JWT_DURATION_IN_SECONDS", Constants::DEFAULT_JWT_DURATION_IN_SECONDS)));
+                   "JWT_DURATION_IN_SECONDS", Constants::DEFAULT_JWT_DURATION_IN_SECONDS)),
+               const int& jwt_claims_cache_max_entries = stoi(
+                   env_manager.read_env("JWT_CLAIMS_CACHE_MAX_ENTRIES",
+                                        Constants::DEFAULT_JWT_CLAIMS_CACHE_MAX_ENTRIES)));
 
     std::string generate_token(const std::string& oid, const std::string& role);
 
     auto jwt_protection_decorator(const std::function<crow::response(const crow::request&)>& func,
                                   const JwtAccessLevel& access_level)
         -> std::function<crow::response(const crow::request&)>;
+    auto jwt_protection_decorator(const deferred_handler_func_type& func,
+                                  const JwtAccessLevel& access_level) -> deferred_handler_func_type;
+
+    // Verifies the token once and returns its claims. Claims of recently verified tokens are
+    // served from an LRU cache until the token expires, so repeat requests skip the HMAC.
+    auto get_claims(const std::string& token) -> JwtClaims;
+
+    auto get_claims_cache_size() -> size_t;
 
    private:
     std::string jwt_secret;
     int jwt_duration_in_seconds;
+    // built once; verifying is const and safe to share across threads
+    jwt::verifier<jwt::default_clock, jwt::traits::kazuho_picojson> verifier;
+
+    size_t claims_cache_max_entries;
+    std::mutex claims_cache_mutex;
+    // most recently used first; keyed by the whole token, so only a byte-identical token that
+    // was verified before can skip verification
+    std::list<std::pair<std::string, JwtClaims>> claims_cache_entries;
+    std::unordered_map<std::string, std::list<std::pair<std::string, JwtClaims>>::iterator>
+        claims_cache;
 
-    std::string _get_from_token(const std::string& token, const std::string& key);
+    // The error response when the request does not have the access level, or nothing.
+    auto _authorize(const crow::request& req, const JwtAccessLevel& access_level)
+        -> bsoncxx::stdx::optional<crow::response>;
+    auto _verify_token(const std::string& token) -> JwtClaims;
+    auto _get_cached_claims(const std::string& token, JwtClaims& claims) -> bool;
+    void _cache_claims(const std::string& token, const JwtClaims& claims);
 
     static EnvManager env_manager;
 };
@@ -0,0 +1,34 @@
+#ifndef METRICS_MANAGER_HPP
+#define METRICS_MANAGER_HPP
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "crow.h"
+
+struct MetricSummary {
+    long long int count = 0;
+    double sum = 0;
+    double min = 0;
+    double max = 0;
+};
+
+// In-process counters and summaries, exposed by BaseServer on GET /metrics.
+class MetricsManager {
+   public:
+    void increment_counter(const std::string& name, const long long int& delta = 1);
+    void observe(const std::string& name, const double& value);
+
+    auto get_counter(const std::string& name) -> long long int;
+    auto get_summary(const std::string& name) -> MetricSummary;
+
+    auto to_json() -> crow::json::wvalue;
+
+   private:
+    std::mutex mutex;
+    std::map<std::string, long long int> counters;
+    std::map<std::string, MetricSummary> summaries;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef MSGPACK_RESPONSE_ENCODER_HPP
+#define MSGPACK_RESPONSE_ENCODER_HPP
+
+#include <bsoncxx/array/view.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/stdx/string_view.hpp>
+#include <bsoncxx/types/bson_value/view.hpp>
+#include <cstdint>
+#include <string>
+
+#include "crow.h"
+
+// Writes response bodies as MessagePack with the same shape JsonResponseEncoder gives them as
+// JSON, so clients only swap the decoder: dates in (sub)documents become DATETIME_FORMAT strings
+// and ObjectIds stay {"$oid": "..."}. Binary data is written as MessagePack bin instead of base64.
+namespace MsgpackResponseEncoder {
+// Append to out so one buffer can be reused across documents.
+void encode_document(const bsoncxx::document::view& document, std::string& out);
+void encode_json(const crow::json::rvalue& rval_json, std::string& out);
+
+void _encode_document(const bsoncxx::document::view& document, std::string& out,
+                      const bool& rewrite_dates);
+void _encode_array(const bsoncxx::array::view& array, std::string& out);
+void _encode_value(const bsoncxx::types::bson_value::view& value, std::string& out,
+                   const bool& rewrite_dates);
+
+void write_map_header(const size_t& size, std::string& out);
+void write_array_header(const size_t& size, std::string& out);
+void write_string(const bsoncxx::stdx::string_view& str, std::string& out);
+void write_int64(const long long int& number, std::string& out);
+void _write_uint64(const std::uint64_t& number, std::string& out);
+void _write_double(const double& number, std::string& out);
+void _write_binary(const std::uint8_t* bytes, const size_t& size, std::string& out);
+void _write_big_endian(const std::uint64_t& number, const int& byte_count, std::string& out);
+}  // namespace MsgpackResponseEncoder
+
+#endif  // MSGPACK_RESPONSE_ENCODER_HPP
@@ -0,0 +1,78 @@
+#ifndef REPLICATED_COLLECTION_HPP
+#define REPLICATED_COLLECTION_HPP
+
+#include <bsoncxx/document/value.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/stdx/optional.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "collection_watcher.hpp"
+#include "constants.hpp"
+#include "database_manager.hpp"
+#include "env_manager.hpp"
+
+// In-memory copy of a small, read-mostly collection such as categories. It is loaded when created
+// and reloaded as a whole on every change, so reads by _id or name and reads of the whole
+// collection never reach the database. Before the first successful load every read falls back to
+// it.
+class ReplicatedCollection {
+   public:
+    // Immutable once published; readers keep the snapshot they got while a reload swaps in the
+    // next one.
+    struct Snapshot {
+        std::vector<bsoncxx::document::value> documents;
+        std::unordered_map<std::string, size_t> index_by_oid;
+        std::unordered_map<std::string, size_t> index_by_name;
+        // the JSON body find_serialized would send for the whole collection, and its ETag
+        std::string all_documents_body;
+        std::string all_documents_etag;
+    };
+
+    ReplicatedCollection(std::shared_ptr<DatabaseManager> db_manager,
+                         const std::string& collection_name,
+                         const int& poll_interval_ms =
+                             stoi(Constants::DEFAULT_REPLICATED_COLLECTION_POLL_INTERVAL_MS));
+
+    ReplicatedCollection(const ReplicatedCollection&) = delete;
+    ReplicatedCollection& operator=(const ReplicatedCollection&) = delete;
+
+    // nullptr when the collection is not listed in REPLICATED_COLLECTIONS.
+    static std::shared_ptr<ReplicatedCollection> create_from_env(
+        std::shared_ptr<DatabaseManager> db_manager, const std::string& collection_name,
+        EnvManager env_manager = EnvManager());
+
+    // Reloads the collection; writers call it after their own writes so they read them back.
+    void refresh();
+
+    // Looks up the document matching a filter that is a single equality on _id (an ObjectId) or
+    // name (a string). Returns false when the filter has any other shape or nothing is loaded
+    // yet, leaving result untouched.
+    auto find_one(const bsoncxx::document::view& filter,
+                  bsoncxx::stdx::optional<bsoncxx::document::value>& result) -> bool;
+
+    // nullptr before the first successful load.
+    auto get_snapshot() -> std::shared_ptr<const Snapshot>;
+    auto get_db_manager() const -> std::shared_ptr<DatabaseManager>;
+    auto get_collection_name() const -> std::string;
+
+    static auto _make_snapshot(std::vector<bsoncxx::document::value> documents)
+        -> std::shared_ptr<const Snapshot>;
+
+   private:
+    std::shared_ptr<DatabaseManager> db_manager;
+    std::string collection_name;
+
+    std::mutex snapshot_mutex;
+    std::shared_ptr<const Snapshot> snapshot;
+    // serializes reloads so an older load never replaces a newer one
+    std::mutex refresh_mutex;
+
+    // declared last so its thread stops before the snapshot it refreshes is destroyed
+    std::unique_ptr<CollectionWatcher> watcher;
+};
+
+#endif  // REPLICATED_COLLECTION_HPP
@@ -0,0 +1,53 @@
+#ifndef REQUEST_COALESCER_HPP
+#define REQUEST_COALESCER_HPP
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "crow.h"
+#include "deferred_handler.hpp"
+#include "metrics_manager.hpp"
+
+// Lets concurrent identical reads share one execution: the first caller of a key runs it, and
+// every caller that arrives while it runs is parked without a thread and answered with a copy of
+// its response when it responds. Nothing is kept once the execution finishes; keeping results is
+// ResultCache's job.
+class RequestCoalescer {
+   public:
+    RequestCoalescer(const std::string& name, std::shared_ptr<MetricsManager> metrics_manager);
+
+    RequestCoalescer(const RequestCoalescer&) = delete;
+    RequestCoalescer& operator=(const RequestCoalescer&) = delete;
+
+    // Runs compute_func with a respond that answers every caller of the key, or parks respond
+    // until the running execution of the same key responds. An empty key is never shared. If
+    // compute_func throws before responding, the parked callers get a 500 and the exception is
+    // rethrown to the caller that ran it.
+    void get_or_compute(const std::string& key,
+                        const std::function<void(const respond_func_type&)>& compute_func,
+                        const respond_func_type& respond);
+
+    auto get_in_flight_count() -> size_t;
+
+   private:
+    struct Execution {
+        std::vector<respond_func_type> followers;
+    };
+
+    std::string name;
+    std::shared_ptr<MetricsManager> metrics_manager;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Execution>> in_flight;
+
+    // Ends the execution, so later callers start their own, and returns its parked callers.
+    auto _finish(const std::string& key, const std::shared_ptr<Execution>& execution)
+        -> std::vector<respond_func_type>;
+    auto _metric_name(const std::string& name) const -> std::string;
+};
+
+#endif  // REQUEST_COALESCER_HPP
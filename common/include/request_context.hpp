@@ -0,0 +1,77 @@
+#ifndef REQUEST_CONTEXT_HPP
+#define REQUEST_CONTEXT_HPP
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "crow.h"
+#include "response_compressor.hpp"
+#include "response_format.hpp"
+
+// State of one request that the handler pipeline would otherwise recompute: the parsed body, the
+// decoded JWT claims and how long each stage took. BaseServer creates it once per request; a
+// request runs on one executor thread from the first decorator to the response, so the context
+// of the request being served is tracked per thread.
+class RequestContext {
+   public:
+    explicit RequestContext(const crow::request& req);
+
+    // The context BaseServer created for req, or a new one for a request served outside of it
+    // (e.g. a strategy called directly in a test).
+    static auto get(const crow::request& req) -> std::shared_ptr<RequestContext>;
+    // The context of the request this thread is serving, or nullptr outside of BaseServer.
+    static auto get_current() -> std::shared_ptr<RequestContext>;
+
+    // Parsed on first use; an invalid body gives a falsy rvalue like crow::json::load does.
+    auto get_body() -> const crow::json::rvalue&;
+
+    // Negotiated from the Accept header on first use.
+    auto get_response_format() -> ResponseFormat;
+
+    // Set by BaseServer so responses written in chunks can be compressed as they are written.
+    void set_response_compressor(std::shared_ptr<const ResponseCompressor> response_compressor);
+    // nullptr when the request is served outside of BaseServer.
+    auto get_response_compressor() const -> std::shared_ptr<const ResponseCompressor>;
+
+    void set_jwt_claims(std::unordered_map<std::string, std::string> claims);
+    auto has_jwt_claims() const -> bool;
+    // Empty when the claim is missing.
+    auto get_jwt_claim(const std::string& key) const -> std::string;
+
+    // Records the time since the context was created under the given stage name.
+    void record_stage(const std::string& stage);
+    auto get_stage_timings() const -> const std::vector<std::pair<std::string, double>>&;
+    auto get_elapsed_ms() const -> double;
+
+    // Makes a context the current one of this thread for the lifetime of the scope.
+    class Scope {
+       public:
+        explicit Scope(std::shared_ptr<RequestContext> context);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        auto operator=(const Scope&) -> Scope& = delete;
+
+       private:
+        std::shared_ptr<RequestContext> previous;
+    };
+
+   private:
+    const crow::request& req;
+    bool is_body_parsed;
+    crow::json::rvalue body;
+    bool is_response_format_negotiated;
+    ResponseFormat response_format;
+    std::shared_ptr<const ResponseCompressor> response_compressor;
+    std::unordered_map<std::string, std::string> jwt_claims;
+    std::chrono::steady_clock::time_point start_time;
+    std::vector<std::pair<std::string, double>> stage_timings;
+
+    static thread_local std::shared_ptr<RequestContext> current;
+};
+
+#endif  // REQUEST_CONTEXT_HPP
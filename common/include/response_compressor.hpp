@@ -0,0 +1,96 @@
+#ifndef RESPONSE_COMPRESSOR_HPP
+#define RESPONSE_COMPRESSOR_HPP
+
+#include <zlib.h>
+#include <zstd.h>
+
+#include <memory>
+#include <string>
+
+#include "constants.hpp"
+#include "crow.h"
+#include "env_manager.hpp"
+
+enum class ContentEncoding { Identity, Gzip, Zstd };
+
+// One gzip or zstd stream; input can be fed in pieces and the output is appended as it is made.
+class StreamingCompressor {
+   public:
+    StreamingCompressor(const ContentEncoding& encoding, const int& level);
+    ~StreamingCompressor();
+
+    StreamingCompressor(const StreamingCompressor&) = delete;
+    StreamingCompressor& operator=(const StreamingCompressor&) = delete;
+
+    void write(const char* data, const size_t& size, std::string& out);
+    void finish(std::string& out);
+
+    static auto compress(const std::string& data, const ContentEncoding& encoding,
+                         const int& level) -> std::string;
+
+   private:
+    ContentEncoding encoding;
+    z_stream gzip_stream;
+    ZSTD_CCtx* zstd_context;
+    bool is_finished;
+};
+
+// Compresses a response body written in chunks. Chunks are kept as they are until the body
+// reaches min_size, so small responses are never compressed and large ones never sit uncompressed
+// in full.
+class ResponseBodyCompressor {
+   public:
+    ResponseBodyCompressor(crow::response& res, const ContentEncoding& encoding, const int& level,
+                           const size_t& min_size);
+
+    void write(const std::string& chunk);
+    // Ends the stream and sets Content-Encoding if anything was compressed.
+    void finish();
+
+   private:
+    crow::response& res;
+    ContentEncoding encoding;
+    int level;
+    size_t min_size;
+    std::unique_ptr<StreamingCompressor> compressor;
+};
+
+// Picks gzip or zstd from Accept-Encoding and compresses response bodies of at least min_size.
+// It runs on the executor thread that produced the response so the crow I/O threads never
+// compress.
+class ResponseCompressor {
+   public:
+    ResponseCompressor(
+        const bool& is_enabled = Constants::DEFAULT_RESPONSE_COMPRESSION_ENABLED == "true",
+        const size_t& min_size = stoul(Constants::DEFAULT_RESPONSE_COMPRESSION_MIN_SIZE),
+        const int& gzip_level = stoi(Constants::DEFAULT_RESPONSE_COMPRESSION_GZIP_LEVEL),
+        const int& zstd_level = stoi(Constants::DEFAULT_RESPONSE_COMPRESSION_ZSTD_LEVEL));
+
+    static std::shared_ptr<ResponseCompressor> create_from_env(
+        EnvManager env_manager = EnvManager());
+
+    // The accepted encoding with the highest q-value; zstd wins a tie since it is cheaper to
+    // produce at a similar ratio.
+    static auto negotiate_encoding(const std::string& accept_encoding_header) -> ContentEncoding;
+    static auto get_encoding_name(const ContentEncoding& encoding) -> std::string;
+
+    // Compresses a finished response in place. Responses that are small, empty or already
+    // encoded are left alone.
+    void compress_response(const crow::request& req, crow::response& res) const;
+    // For responses written in chunks; nullptr when the response should not be compressed.
+    auto make_body_compressor(const crow::request& req, crow::response& res) const
+        -> std::unique_ptr<ResponseBodyCompressor>;
+
+    auto get_is_enabled() const -> bool;
+
+   private:
+    bool is_enabled;
+    size_t min_size;
+    int gzip_level;
+    int zstd_level;
+
+    auto _get_encoding(const crow::request& req) const -> ContentEncoding;
+    auto _get_level(const ContentEncoding& encoding) const -> int;
+};
+
+#endif  // RESPONSE_COMPRESSOR_HPP
@@ -0,0 +1,33 @@
+#ifndef RESPONSE_FORMAT_HPP
+#define RESPONSE_FORMAT_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "crow.h"
+
+// Response body encodings a client can ask for with the Accept header. JSON is the default;
+// BSON and MessagePack save machine-to-machine callers the JSON encode and decode.
+enum class ResponseFormat { Json, Bson, MessagePack };
+
+namespace ResponseFormatUtils {
+// Picks the supported media type with the highest q-value, the earliest one on a tie. Missing,
+// wildcard or unsupported Accept headers give JSON so existing clients are unaffected.
+auto negotiate_response_format(const std::string& accept_header) -> ResponseFormat;
+auto get_content_type(const ResponseFormat& format) -> std::string;
+// Splits an Accept-style header into lower-cased values and their q-values (1 when absent).
+auto parse_weighted_header(const std::string& header)
+    -> std::vector<std::pair<std::string, double>>;
+
+// Encodes a response object that is not JSON. BSON keeps the JSON types (dates are already
+// strings by now); MessagePack has the same shape as the JSON body.
+auto encode_response_data(const crow::json::wvalue& data, const ResponseFormat& format)
+    -> std::string;
+
+auto _get_media_type_format(const std::string& media_type, ResponseFormat& format) -> bool;
+auto _parse_quality(const std::string& parameters) -> double;
+auto _trim(const std::string& str) -> std::string;
+}  // namespace ResponseFormatUtils
+
+#endif  // RESPONSE_FORMAT_HPP
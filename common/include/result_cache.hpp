@@ -0,0 +1,83 @@
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "collection_watcher.hpp"
+#include "constants.hpp"
+#include "crow.h"
+#include "database_manager.hpp"
+#include "env_manager.hpp"
+#include "metrics_manager.hpp"
+
+// Caches the successful responses of read endpoints whose result only depends on the request body
+// and on one collection. Entries expire after ttl_ms and are all dropped by invalidate(), which is
+// called on every change to the watched collection and by writers that notify the service.
+class ResultCache {
+   public:
+    ResultCache(const std::string& name, std::shared_ptr<MetricsManager> metrics_manager,
+                const bool& is_enabled = Constants::DEFAULT_RESULT_CACHE_ENABLED == "true",
+                const int& ttl_ms = stoi(Constants::DEFAULT_RESULT_CACHE_TTL_MS),
+                const int& max_entries = stoi(Constants::DEFAULT_RESULT_CACHE_MAX_ENTRIES));
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    static std::shared_ptr<ResultCache> create_from_env(
+        const std::string& name, std::shared_ptr<MetricsManager> metrics_manager,
+        EnvManager env_manager = EnvManager());
+
+    // The route, the negotiated response format and the request body with its object keys
+    // sorted, so equivalent requests share an entry. Empty when the body is not valid JSON.
+    static auto make_key(const std::string& route, const crow::request& req) -> std::string;
+
+    // Serves the cached response for the request, or calls compute_func and caches what it
+    // returns if it succeeded and nothing was invalidated while it ran.
+    auto get_or_compute(const std::string& route, const crow::request& req,
+                        const std::function<crow::response()>& compute_func) -> crow::response;
+
+    void invalidate();
+
+    // Invalidates the cache on every change to the collection from a background change stream.
+    // Without change streams the TTL and explicit invalidation stay in charge.
+    void watch_collection(std::shared_ptr<DatabaseManager> db_manager,
+                          const std::string& collection_name);
+
+    auto get_is_enabled() const -> bool;
+    auto size() -> size_t;
+
+   private:
+    struct Entry {
+        int code;
+        crow::ci_map headers;
+        std::string body;
+        std::chrono::steady_clock::time_point expires_at;
+    };
+
+    std::string name;
+    std::shared_ptr<MetricsManager> metrics_manager;
+    bool is_enabled;
+    std::chrono::milliseconds ttl;
+    size_t max_entries;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    // bumped by invalidate() so results computed before an invalidation are not stored
+    long long int generation = 0;
+
+    // declared last so its thread stops before the entries it invalidates are destroyed
+    std::unique_ptr<CollectionWatcher> watcher;
+
+    static void _append_canonical_json(const crow::json::rvalue& value, std::string& out);
+    void _store(const std::string& key, const crow::response& res,
+                const long long int& computed_generation);
+    void _evict(const std::chrono::steady_clock::time_point& now);
+    auto _metric_name(const std::string& name) const -> std::string;
+};
+
+#endif  // RESULT_CACHE_HPP
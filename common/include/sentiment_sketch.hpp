@@ -0,0 +1,50 @@
+#ifndef SENTIMENT_SKETCH_HPP
+#define SENTIMENT_SKETCH_HPP
+
+#include <array>
+#include <bsoncxx/document/value.hpp>
+#include <limits>
+#include <string>
+
+// Mergeable summary of a set of sentiments for estimating their quantiles: a count per
+// fixed-width bin over [-1, 1], with sentiments outside it counted in the nearest edge bin. Bin
+// counts only ever add up, so sketches merge by addition and can be kept in a database with $inc,
+// including removals. Estimates are the middle of the bin holding the quantile, so within half a
+// bin width (0.005) of the exact one for sentiments in [-1, 1], and inside the exact minimum and
+// maximum when they are known.
+class SentimentSketch {
+   public:
+    static constexpr int BIN_COUNT = 200;
+    static constexpr double MIN_SENTIMENT = -1.0;
+    // bins per unit of sentiment; the bin of s is floor((s - MIN_SENTIMENT) * BINS_PER_UNIT),
+    // which aggregation pipelines compute the same way
+    static constexpr double BINS_PER_UNIT = 100.0;
+
+    // Returns the bin of a sentiment, clamped to the edge bins. sentiment must not be NaN.
+    static auto get_bin(const double& sentiment) -> int;
+    // get_bin as an aggregation expression on a field path like "$sentiment", giving an int bin,
+    // or null when the field is not a number.
+    static auto make_bin_expression(const std::string& sentiment_path) -> bsoncxx::document::value;
+
+    void add(const double& sentiment, const long long int& count = 1);
+    // Ignores bins out of range.
+    void add_bin(const int& bin, const long long int& count);
+    // Narrows the estimates to what is known of the smallest and largest sentiment.
+    void include_range(const double& min_sentiment, const double& max_sentiment);
+    void merge(const SentimentSketch& other);
+
+    auto get_count() const -> long long int;
+    auto get_bin_count(const int& bin) const -> long long int;
+    // The estimated q-quantile for q in [0, 1]; 0 for an empty sketch.
+    auto get_quantile(const double& q) const -> double;
+    auto get_min() const -> double;
+    auto get_max() const -> double;
+
+   private:
+    std::array<long long int, BIN_COUNT> bins{};
+    long long int count = 0;
+    double min_sentiment = std::numeric_limits<double>::infinity();
+    double max_sentiment = -std::numeric_limits<double>::infinity();
+};
+
+#endif  // SENTIMENT_SKETCH_HPP
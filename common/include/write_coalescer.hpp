@@ -0,0 +1,81 @@
+#ifndef WRITE_COALESCER_HPP
+#define WRITE_COALESCER_HPP
+
+#include <bsoncxx/oid.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "constants.hpp"
+#include "database_manager.hpp"
+#include "env_manager.hpp"
+#include "metrics_manager.hpp"
+
+struct CoalescedInsertResult {
+    bsoncxx::oid oid;
+    BulkWriteItemResult item_result;
+};
+
+// Group commit for a single collection: concurrent insert_one calls are held for up to window_ms
+// (or until max_batch_size documents are waiting) and written together in one bulk write. Each
+// caller gets its own outcome back once its own document has been written, either by blocking
+// or through a callback.
+class WriteCoalescer {
+   public:
+    WriteCoalescer(
+        std::shared_ptr<DatabaseManager> db_manager, const std::string& collection_name,
+        std::shared_ptr<MetricsManager> metrics_manager,
+        const int& window_ms = stoi(Constants::DEFAULT_WRITE_COALESCING_WINDOW_MS),
+        const int& max_batch_size = stoi(Constants::DEFAULT_WRITE_COALESCING_MAX_BATCH_SIZE),
+        const int& max_latency_ms = stoi(Constants::DEFAULT_WRITE_COALESCING_MAX_LATENCY_MS));
+    ~WriteCoalescer();
+
+    WriteCoalescer(const WriteCoalescer&) = delete;
+    WriteCoalescer& operator=(const WriteCoalescer&) = delete;
+
+    static std::shared_ptr<WriteCoalescer> create_from_env(
+        std::shared_ptr<DatabaseManager> db_manager, const std::string& collection_name,
+        std::shared_ptr<MetricsManager> metrics_manager, EnvManager env_manager = EnvManager());
+
+    auto insert_one(const bsoncxx::document::view& document) -> CoalescedInsertResult;
+    // Returns once the document is queued; on_written is called from the flusher thread after
+    // the batch is written, so it should only hand the result off. When the queue is backlogged
+    // the document is written directly and on_written is called before this returns.
+    void insert_one(const bsoncxx::document::view& document,
+                    std::function<void(const CoalescedInsertResult&)> on_written);
+
+    auto get_max_batch_size() const -> int;
+
+   private:
+    struct PendingInsert {
+        bsoncxx::document::value document;
+        std::chrono::steady_clock::time_point enqueued_at;
+        std::function<void(const BulkWriteItemResult&)> on_written;
+    };
+
+    std::shared_ptr<DatabaseManager> db_manager;
+    std::string collection_name;
+    std::shared_ptr<MetricsManager> metrics_manager;
+    std::chrono::milliseconds window;
+    size_t max_batch_size;
+    std::chrono::milliseconds max_latency;
+
+    bool is_stopping = false;
+    std::mutex mutex;
+    std::condition_variable pending_changed;
+    std::deque<PendingInsert> pending_inserts;
+    std::thread flusher;
+
+    void _run_flusher();
+    void _flush(std::deque<PendingInsert>& batch);
+    auto _insert_directly(const bsoncxx::document::view& document) -> BulkWriteItemResult;
+    auto _metric_name(const std::string& name) const -> std::string;
+};
+
+#endif
@@ -0,0 +1,34 @@
+#include "analytics_notifier.hpp"
+
+#include <cpr/cpr.h>
+
+#include <iostream>
+
+AnalyticsNotifier::AnalyticsNotifier(const std::string& analytics_server_url,
+                                     std::shared_ptr<JwtManager> jwt_manager)
+    : analytics_server_url{analytics_server_url}, jwt_manager{jwt_manager} {}
+
+std::shared_ptr<AnalyticsNotifier> AnalyticsNotifier::create_from_env(
+    std::shared_ptr<JwtManager> jwt_manager, EnvManager env_manager) {
+    auto ANALYTICS_SERVER_URL =
+        env_manager.read_env("ANALYTICS_SERVER_URL", Constants::DEFAULT_ANALYTICS_SERVER_URL);
+    if (ANALYTICS_SERVER_URL.empty()) {
+        return nullptr;
+    }
+    return std::make_shared<AnalyticsNotifier>(ANALYTICS_SERVER_URL, jwt_manager);
+}
+
+void AnalyticsNotifier::notify_complaints_changed() {
+    auto token = jwt_manager->generate_token("", Constants::USERS_ROLE_ADMIN);
+    auto resp = cpr::Post(cpr::Url{analytics_server_url + "/complaints/invalidate_statistics"},
+                          cpr::Header{{"Content-Type", "application/json"},
+                                      {"Authorization", "Bearer " + token}},
+                          cpr::Body{"{}"},
+                          cpr::Timeout{Constants::ANALYTICS_SERVER_NOTIFY_TIMEOUT_MS});
+    if (resp.status_code != 200) {
+        std::cout << "[AnalyticsNotifier] Failed to notify the analytics server of changed "
+                     "complaints: "
+                  << (resp.error ? resp.error.message : std::to_string(resp.status_code))
+                  << std::endl;
+    }
+}
@@ -2,15 +2,23 @@
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <cstdint>
 #include <mongocxx/client.hpp>
 #include <mongocxx/exception/exception.hpp>
 #include <mongocxx/instance.hpp>
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include "base_api_strategy_utils.hpp"
+#include "binary_response_builder.hpp"
 #include "crow.h"
 #include "database_manager.hpp"
+#include "entity_tag.hpp"
+#include "json_response_builder.hpp"
+#include "request_context.hpp"
+#include "response_compressor.hpp"
+#include "response_format.hpp"
 
 using bsoncxx::builder::basic::kvp;
 using bsoncxx::builder::basic::make_document;
@@ -30,16 +38,33 @@ auto BaseApiHandler::find_one(
 
         auto result = db_manager->find_one(collection_name, filter, option);
 
-        if (!result.has_value()) {
-            return BaseApiStrategyUtils::make_success_response(
-                200, {},
-                "Server processed get request successfully but no matching documents found");
-        }
+        return _make_find_one_response(result, process_response_func);
+    } catch (const std::exception& e) {
+        return BaseApiStrategyUtils::make_error_response(500,
+                                                         std::string("Server error: ") + e.what());
+    }
+}
 
-        auto response_data = process_response_func(result.value());
+auto BaseApiHandler::find_one(
+    const crow::request& req, std::shared_ptr<ReplicatedCollection> replicated_collection,
+    std::function<
+        std::tuple<bsoncxx::document::value, mongocxx::options::find>(const crow::request&)>
+        process_request_func,
+    std::function<crow::json::wvalue(const bsoncxx::document::value&)> process_response_func)
+    -> crow::response {
+    try {
+        auto filter_and_option = process_request_func(req);
+        auto filter = std::get<0>(filter_and_option);
+        auto option = std::get<1>(filter_and_option);
 
-        return BaseApiStrategyUtils::make_success_response(
-            200, response_data, "Server processed get request successfully.");
+        // the replica holds whole documents, so projected reads still go to the database
+        bsoncxx::stdx::optional<bsoncxx::document::value> result;
+        if (option.projection() || !replicated_collection->find_one(filter.view(), result)) {
+            result = replicated_collection->get_db_manager()->find_one(
+                replicated_collection->get_collection_name(), filter, option);
+        }
+
+        return _make_find_one_response(result, process_response_func);
     } catch (const std::exception& e) {
         return BaseApiStrategyUtils::make_error_response(500,
                                                          std::string("Server error: ") + e.what());
@@ -64,8 +89,154 @@ auto BaseApiHandler::find(
 
         auto response_data = process_response_func(cursor);
 
-        return BaseApiStrategyUtils::make_success_response(
-            200, response_data, "Server processed get request successfully.");
+        return EntityTagUtils::tag_response(BaseApiStrategyUtils::make_success_response(
+            200, response_data, "Server processed get request successfully."));
+    } catch (const std::exception& e) {
+        return BaseApiStrategyUtils::make_error_response(500,
+                                                         std::string("Server error: ") + e.what());
+    }
+}
+
+auto BaseApiHandler::find_serialized(
+    const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
+    const std::string& collection_name,
+    std::function<std::tuple<bsoncxx::document::value, mongocxx::options::find,
+                             bsoncxx::document::value>(const crow::request&)>
+        process_request_func,
+    std::function<void(const bsoncxx::document::view&, std::string&)> process_document_func,
+    std::function<crow::json::wvalue(const crow::request&,
+                                     const bsoncxx::stdx::optional<bsoncxx::document::value>&,
+                                     const size_t&)>
+        process_fields_func) -> crow::response {
+    try {
+        auto filter_and_option_and_sort = process_request_func(req);
+        auto filter = std::get<0>(filter_and_option_and_sort);
+        auto option = std::get<1>(filter_and_option_and_sort);
+        auto sort = std::get<2>(filter_and_option_and_sort);
+        option.sort(sort.view());
+
+        auto cursor = db_manager->find(collection_name, filter, option);
+
+        // crow sends a dynamic response body in one piece once the handler returns, so the body is
+        // built in full here; an error part way through still replaces the whole response below
+        auto context = RequestContext::get(req);
+        auto format = context->get_response_format();
+        crow::response res(200);
+        res.set_header("Content-Type", ResponseFormatUtils::get_content_type(format));
+        // the body is compressed as it is built, so only its compressed form is held in full
+        auto response_compressor = context->get_response_compressor();
+        auto body_compressor = response_compressor && format == ResponseFormat::Json
+                                   ? response_compressor->make_body_compressor(req, res)
+                                   : nullptr;
+        // the ETag is taken from the uncompressed body, as compress_response would
+        EntityTagHasher etag_hasher;
+        JsonResponseBuilder json_builder(
+            [&res, &body_compressor, &etag_hasher](const std::string& piece) {
+                etag_hasher.update(piece);
+                if (body_compressor) {
+                    body_compressor->write(piece);
+                } else {
+                    res.body += piece;
+                }
+            });
+        // BSON and MessagePack callers get the documents as stored, so process_document_func
+        // only shapes JSON responses
+        std::unique_ptr<BinaryResponseBuilder> binary_builder;
+        if (format == ResponseFormat::Json) {
+            json_builder.begin_array("documents");
+        } else {
+            binary_builder = std::make_unique<BinaryResponseBuilder>(format, "documents");
+        }
+
+        std::string document_buffer;
+        // only the bytes of the latest document are kept, in a buffer reused across documents
+        std::vector<uint8_t> last_document_bytes;
+        for (auto&& doc : cursor) {
+            if (binary_builder) {
+                binary_builder->append_document(doc);
+            } else {
+                document_buffer.clear();
+                process_document_func(doc, document_buffer);
+                json_builder.append_array_item(document_buffer);
+            }
+            if (process_fields_func) {
+                last_document_bytes.assign(doc.data(), doc.data() + doc.length());
+            }
+        }
+
+        crow::json::wvalue fields;
+        if (process_fields_func) {
+            bsoncxx::stdx::optional<bsoncxx::document::value> last_document;
+            if (!last_document_bytes.empty()) {
+                last_document = bsoncxx::document::value{bsoncxx::document::view{
+                    last_document_bytes.data(), last_document_bytes.size()}};
+            }
+            auto item_count = binary_builder ? binary_builder->get_item_count()
+                                             : json_builder.get_item_count();
+            fields = process_fields_func(req, last_document, item_count);
+        }
+        fields["success"] = true;
+        fields["message"] = "Server processed get request successfully.";
+        if (binary_builder) {
+            res.body = binary_builder->finish(fields);
+            etag_hasher.update(res.body);
+        } else {
+            json_builder.finish(fields);
+            if (body_compressor) {
+                body_compressor->finish();
+            }
+        }
+
+        auto etag = etag_hasher.get_etag();
+        auto content_encoding = res.get_header_value("Content-Encoding");
+        if (!content_encoding.empty()) {
+            etag = EntityTagUtils::add_encoding_to_etag(etag, content_encoding);
+        }
+        res.set_header("ETag", etag);
+        return res;
+    } catch (const std::exception& e) {
+        return BaseApiStrategyUtils::make_error_response(500,
+                                                         std::string("Server error: ") + e.what());
+    }
+}
+
+auto BaseApiHandler::find_serialized(
+    const crow::request& req, std::shared_ptr<ReplicatedCollection> replicated_collection,
+    std::function<std::tuple<bsoncxx::document::value, mongocxx::options::find,
+                             bsoncxx::document::value>(const crow::request&)>
+        process_request_func) -> crow::response {
+    auto fallback_func = [&]() {
+        return find_serialized(req, replicated_collection->get_db_manager(),
+                               replicated_collection->get_collection_name(), process_request_func);
+    };
+    try {
+        auto filter_and_option_and_sort = process_request_func(req);
+        auto filter = std::get<0>(filter_and_option_and_sort);
+        auto option = std::get<1>(filter_and_option_and_sort);
+        auto sort = std::get<2>(filter_and_option_and_sort);
+        auto snapshot = replicated_collection->get_snapshot();
+        if (!snapshot || !filter.view().empty() || !sort.view().empty() || option.projection()) {
+            return fallback_func();
+        }
+
+        auto format = RequestContext::get(req)->get_response_format();
+        crow::response res(200);
+        res.set_header("Content-Type", ResponseFormatUtils::get_content_type(format));
+        if (format == ResponseFormat::Json) {
+            // compress_response still compresses the body per request
+            res.body = snapshot->all_documents_body;
+            res.set_header("ETag", snapshot->all_documents_etag);
+            return res;
+        }
+        BinaryResponseBuilder binary_builder(format, "documents");
+        for (const auto& doc : snapshot->documents) {
+            binary_builder.append_document(doc.view());
+        }
+        crow::json::wvalue fields;
+        fields["success"] = true;
+        fields["message"] = "Server processed get request successfully.";
+        res.body = binary_builder.finish(fields);
+        return EntityTagUtils::tag_response(std::move(res));
     } catch (const std::exception& e) {
         return BaseApiStrategyUtils::make_error_response(500,
                                                          std::string("Server error: ") + e.what());
@@ -106,6 +277,45 @@ auto BaseApiHandler::insert_one(
     }
 }
 
+void BaseApiHandler::insert_one(
+    const crow::request& req, std::shared_ptr<WriteCoalescer> write_coalescer,
+    const respond_func_type& respond,
+    std::function<
+        std::tuple<bsoncxx::document::value, mongocxx::options::insert>(const crow::request&)>
+        process_request_func,
+    std::function<crow::json::wvalue(const bsoncxx::oid&)> process_response_func) {
+    try {
+        auto document_and_option = process_request_func(req);
+        auto document = std::get<0>(document_and_option);
+
+        write_coalescer->insert_one(document.view(), [respond, process_response_func](
+                                                          const CoalescedInsertResult& result) {
+            if (result.item_result.status == BulkWriteItemStatus::DuplicateKey) {
+                respond(BaseApiStrategyUtils::make_error_response(409,
+                                                                  "Unique constraint violation!"));
+                return;
+            } else if (result.item_result.status == BulkWriteItemStatus::Failed) {
+                respond(BaseApiStrategyUtils::make_error_response(
+                    500, result.item_result.error_message));
+                return;
+            }
+
+            try {
+                auto response_data = process_response_func(result.oid);
+
+                respond(BaseApiStrategyUtils::make_success_response(
+                    200, response_data, "Server processed insert request successfully."));
+            } catch (const std::exception& e) {
+                respond(BaseApiStrategyUtils::make_error_response(
+                    500, std::string("Server error: ") + e.what()));
+            }
+        });
+    } catch (const std::exception& e) {
+        respond(BaseApiStrategyUtils::make_error_response(
+            500, std::string("Server error: ") + e.what()));
+    }
+}
+
 auto BaseApiHandler::delete_one(
     const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
     const std::string& collection_name,
@@ -182,6 +392,53 @@ auto BaseApiHandler::update_one(
     }
 }
 
+auto BaseApiHandler::delete_many(
+    const crow::request& req, std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager,
+    std::function<std::tuple<bsoncxx::document::value, mongocxx::options::delete_options>(
+        const crow::request&)>
+        process_request_func,
+    std::function<crow::json::wvalue(const long long int&)> process_response_func)
+    -> crow::response {
+    try {
+        auto filter_and_option = process_request_func(req);
+        auto filter = std::get<0>(filter_and_option);
+
+        auto deleted_count = complaint_rollup_manager->delete_many(filter.view());
+
+        auto response_data = process_response_func(deleted_count);
+
+        return BaseApiStrategyUtils::make_success_response(
+            200, response_data, "Server processed delete request successfully.");
+    } catch (const std::exception& e) {
+        return BaseApiStrategyUtils::make_error_response(500,
+                                                         std::string("Server error: ") + e.what());
+    }
+}
+
+auto BaseApiHandler::update_one(
+    const crow::request& req, std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager,
+    std::function<std::tuple<bsoncxx::document::value, bsoncxx::document::value,
+                             mongocxx::options::update>(const crow::request&)>
+        process_request_func,
+    std::function<crow::json::wvalue(const ComplaintRollupManager::UpdateResult&)>
+        process_response_func) -> crow::response {
+    try {
+        auto filter_and_update_doc_and_option = process_request_func(req);
+        auto filter = std::get<0>(filter_and_update_doc_and_option);
+        auto update_doc = std::get<1>(filter_and_update_doc_and_option);
+
+        auto result = complaint_rollup_manager->update_one(filter.view(), update_doc.view());
+
+        auto response_data = process_response_func(result);
+
+        return BaseApiStrategyUtils::make_success_response(
+            200, response_data, "Server processed update request successfully.");
+    } catch (const std::exception& e) {
+        return BaseApiStrategyUtils::make_error_response(500,
+                                                         std::string("Server error: ") + e.what());
+    }
+}
+
 auto BaseApiHandler::count_documents(
     const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
     const std::string& collection_name,
@@ -199,8 +456,8 @@ auto BaseApiHandler::count_documents(
 
         auto response_data = process_response_func(count);
 
-        return BaseApiStrategyUtils::make_success_response(
-            200, response_data, "Server processed count_documents request successfully.");
+        return EntityTagUtils::tag_response(BaseApiStrategyUtils::make_success_response(
+            200, response_data, "Server processed count_documents request successfully."));
     } catch (const std::exception& e) {
         return BaseApiStrategyUtils::make_error_response(500,
                                                          std::string("Server error: ") + e.what());
@@ -227,10 +484,25 @@ auto BaseApiHandler::aggregate(
 
         auto response_data = process_response_func(req, cursor);
 
-        return BaseApiStrategyUtils::make_success_response(
-            200, response_data, "Server processed aggregate request successfully.");
+        return EntityTagUtils::tag_response(BaseApiStrategyUtils::make_success_response(
+            200, response_data, "Server processed aggregate request successfully."));
     } catch (const std::exception& e) {
         return BaseApiStrategyUtils::make_error_response(500,
                                                          std::string("Server error: ") + e.what());
     }
-}
\ No newline at end of file
+}
+
+auto BaseApiHandler::_make_find_one_response(
+    const bsoncxx::stdx::optional<bsoncxx::document::value>& result,
+    const std::function<crow::json::wvalue(const bsoncxx::document::value&)>&
+        process_response_func) -> crow::response {
+    if (!result.has_value()) {
+        return EntityTagUtils::tag_response(BaseApiStrategyUtils::make_success_response(
+            200, {}, "Server processed get request successfully but no matching documents found"));
+    }
+
+    auto response_data = process_response_func(result.value());
+
+    return EntityTagUtils::tag_response(BaseApiStrategyUtils::make_success_response(
+        200, response_data, "Server processed get request successfully."));
+}
@@ -6,6 +6,8 @@
 
 #include "base_api_strategy_utils.hpp"
 #include "crow.h"
+#include "json_response_encoder.hpp"
+#include "request_context.hpp"
 
 using bsoncxx::builder::basic::kvp;
 using bsoncxx::builder::basic::make_document;
@@ -14,9 +16,13 @@ auto BaseApiStrategy::process_request_func_get_one(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::find> {
     BaseApiStrategyUtils::validate_fields(req, {"filter"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto filter = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["filter"]);
     mongocxx::options::find option;
+    if (auto projection = BaseApiStrategyUtils::parse_request_json_to_projection(body)) {
+        option.projection(std::move(*projection));
+    }
 
     return std::make_tuple(filter, option);
 }
@@ -24,18 +30,21 @@ auto BaseApiStrategy::process_request_func_get_one(const crow::request& req)
 auto BaseApiStrategy::process_response_func_get_one(const bsoncxx::document::value& doc)
     -> crow::json::wvalue {
     crow::json::wvalue response_data;
-    auto doc_json = bsoncxx::to_json(doc);
-    auto doc_rval = crow::json::load(doc_json);
-    auto pased_doc_wval = BaseApiStrategyUtils::parse_database_json_to_response_json(doc_rval);
-    response_data["document"] = std::move(pased_doc_wval);
+    response_data["document"] = crow::json::load(JsonResponseEncoder::encode_document(doc.view()));
     return response_data;
 }
 
+void BaseApiStrategy::process_document_func_get(const bsoncxx::document::view& doc,
+                                                 std::string& out) {
+    JsonResponseEncoder::encode_document(doc, out);
+}
+
 auto BaseApiStrategy::process_request_func_insert_one(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::insert> {
     BaseApiStrategyUtils::validate_fields(req, {"document"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto document = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["document"]);
     mongocxx::options::insert option;
 
@@ -50,6 +59,13 @@ auto BaseApiStrategy::process_response_func_insert_one(const mongocxx::result::i
     return response_data;
 }
 
+auto BaseApiStrategy::process_response_func_coalesced_insert_one(const bsoncxx::oid& oid)
+    -> crow::json::wvalue {
+    crow::json::wvalue response_data;
+    response_data["oid"] = oid.to_string();
+    return response_data;
+}
+
 auto BaseApiStrategy::process_response_func_delete_one(
     const mongocxx::result::delete_result& result) -> crow::json::wvalue {
     crow::json::wvalue response_data;
@@ -75,11 +91,28 @@ auto BaseApiStrategy::process_response_func_update_one(const mongocxx::result::u
     return response_data;
 }
 
+auto BaseApiStrategy::process_response_func_tracked_delete_many(const long long int& deleted_count)
+    -> crow::json::wvalue {
+    crow::json::wvalue response_data;
+    response_data["deleted_count"] = deleted_count;
+    return response_data;
+}
+
+auto BaseApiStrategy::process_response_func_tracked_update_one(
+    const ComplaintRollupManager::UpdateResult& result) -> crow::json::wvalue {
+    crow::json::wvalue response_data;
+    response_data["matched_count"] = result.matched_count;
+    response_data["modified_count"] = result.modified_count;
+    response_data["upserted_count"] = 0;
+    return response_data;
+}
+
 auto BaseApiStrategy::process_request_func_count_documents(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::count> {
     BaseApiStrategyUtils::validate_fields(req, {"filter"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto document = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["filter"]);
     mongocxx::options::count option;
 
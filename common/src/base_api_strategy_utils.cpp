@@ -1,6 +1,11 @@
 #include "base_api_strategy_utils.hpp"
 
+#include <algorithm>
+#include <bsoncxx/builder/basic/array.hpp>
 #include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/concatenate.hpp>
+#include <bsoncxx/builder/core.hpp>
+#include <bsoncxx/exception/exception.hpp>
 #include <bsoncxx/json.hpp>
 #include <vector>
 
@@ -8,13 +13,16 @@
 #include "crow.h"
 #include "database_manager.hpp"
 #include "date_utils.hpp"
+#include "request_context.hpp"
+#include "response_format.hpp"
 
 using bsoncxx::builder::basic::kvp;
 using bsoncxx::builder::basic::make_document;
 
 void BaseApiStrategyUtils::validate_fields(const crow::request& req,
                                            std::initializer_list<std::string> required_fields) {
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     if (!body and required_fields.size() > 0) {
         throw std::invalid_argument("Body is empty!");
     }
@@ -51,168 +59,421 @@ auto BaseApiStrategyUtils::parse_database_json_to_response_json(const crow::json
 
 auto BaseApiStrategyUtils::parse_request_json_to_database_bson(const crow::json::rvalue& rval_json)
     -> bsoncxx::document::value {
-    bsoncxx::builder::basic::document doc_builder;
+    bsoncxx::builder::core builder(false);
     for (const auto& sub_field : rval_json) {
-        std::string sub_field_key = static_cast<std::string>(sub_field.key());
-        if (sub_field.t() == crow::json::type::Object) {
-            auto sub_field_doc =
-                parse_request_json_to_database_bson_single_object(sub_field_key, sub_field);
-            auto sub_field_kvp = kvp(sub_field_key, sub_field_doc[sub_field_key].get_value());
-            doc_builder.append(std::move(sub_field_kvp));
-        } else if (sub_field.t() == crow::json::type::List) {
-            auto sub_field_doc =
-                parse_request_json_to_database_bson_single_array(sub_field_key, sub_field);
-            auto sub_field_kvp = kvp(sub_field_key, sub_field_doc[sub_field_key].get_value());
-            doc_builder.append(std::move(sub_field_kvp));
-        } else {
-            auto sub_field_doc =
-                parse_request_json_to_database_bson_single_primitive(sub_field_key, sub_field);
-            auto clean_sub_field_key =
-                _parse_request_json_to_database_bson_single_primitive_clean_key(sub_field_key);
-            auto sub_field_kvp =
-                kvp(clean_sub_field_key, sub_field_doc[clean_sub_field_key].get_value());
-            doc_builder.append(std::move(sub_field_kvp));
-        }
-    }
-
-    return doc_builder.extract();
-}
-
-auto BaseApiStrategyUtils::parse_request_json_to_database_bson_single_primitive(
-    const std::string& key, const crow::json::rvalue& rval_json) -> bsoncxx::document::value {
-    auto doc = _parse_request_json_to_database_bson_single_primitive(key, rval_json);
-    doc = _parse_request_json_to_database_bson_single_primitive_parse_inequality(key, doc);
-    return doc;
-}
-
-auto BaseApiStrategyUtils::_parse_request_json_to_database_bson_single_primitive(
-    const std::string& key, const crow::json::rvalue& rval_json) -> bsoncxx::document::value {
+        _append_request_json_field(builder, sub_field.key(), sub_field, true);
+    }
+    return builder.extract_document();
+}
+
+void BaseApiStrategyUtils::_append_request_json_field(bsoncxx::builder::core& builder,
+                                                      const std::string& key,
+                                                      const crow::json::rvalue& rval_json,
+                                                      const bool& is_top_level) {
+    bool is_primitive =
+        rval_json.t() != crow::json::type::Object and rval_json.t() != crow::json::type::List;
+    auto range_operator = is_primitive ? _get_range_operator(key) : bsoncxx::stdx::string_view();
+    if (range_operator.empty()) {
+        builder.key_view(key);
+        _append_request_json_value(builder, rval_json, _is_date_field(key));
+        return;
+    }
+
+    if (!is_top_level) {
+        throw std::invalid_argument("Invalid request: " + key +
+                                    " is only supported at the top level of a filter");
+    }
+
+    // "_from_date": x becomes "date": {"$gte": x}
+    auto prefix_length = range_operator == bsoncxx::stdx::string_view("$lte") ? LTE_SIGN.length()
+                                                                             : GTE_SIGN.length();
+    auto clean_key = bsoncxx::stdx::string_view(key).substr(prefix_length);
+    builder.key_view(clean_key);
+    builder.open_document();
+    builder.key_view(range_operator);
+    _append_request_json_value(builder, rval_json, _is_date_field(clean_key));
+    builder.close_document();
+}
+
+void BaseApiStrategyUtils::_append_request_json_value(bsoncxx::builder::core& builder,
+                                                      const crow::json::rvalue& rval_json,
+                                                      const bool& is_date_field) {
     switch (rval_json.t()) {
-        case crow::json::type::String:
-            if (DATE_FIELDS.find(key) != DATE_FIELDS.end()) {
-                auto unix_ts_val =
-                    DateUtils::string_to_utc_unix_timestamp(static_cast<std::string>(rval_json.s()),
-                                                            Constants::DATETIME_FORMAT) *
-                    1000;
-                return make_document(
-                    kvp(key, bsoncxx::types::b_date{std::chrono::milliseconds(unix_ts_val)}));
+        case crow::json::type::Object:
+            builder.open_document();
+            for (const auto& sub_field : rval_json) {
+                _append_request_json_field(builder, sub_field.key(), sub_field, false);
+            }
+            builder.close_document();
+            return;
+
+        case crow::json::type::List:
+            builder.open_array();
+            for (const auto& sub_field : rval_json) {
+                _append_request_json_value(builder, sub_field, false);
             }
-            return make_document(kvp(key, rval_json.s()));
+            builder.close_array();
+            return;
+
+        case crow::json::type::String: {
+            auto str = rval_json.s();
+            if (is_date_field) {
+                auto unix_ts_val = DateUtils::string_to_utc_unix_timestamp(
+                                       static_cast<std::string>(str), Constants::DATETIME_FORMAT) *
+                                   1000;
+                builder.append(bsoncxx::types::b_date{std::chrono::milliseconds(unix_ts_val)});
+                return;
+            }
+            builder.append(bsoncxx::types::b_string{
+                bsoncxx::stdx::string_view(str.begin(), str.size())});
+            return;
+        }
 
         case crow::json::type::Number:
             if (rval_json.nt() == crow::json::num_type::Signed_integer ||
                 rval_json.nt() == crow::json::num_type::Unsigned_integer) {
-                return make_document(kvp(key, rval_json.i()));
+                builder.append(static_cast<int64_t>(rval_json.i()));
+                return;
             }
             if (rval_json.nt() == crow::json::num_type::Floating_point ||
                 rval_json.nt() == crow::json::num_type::Double_precision_floating_point) {
-                return make_document(kvp(key, rval_json.d()));
+                builder.append(rval_json.d());
+                return;
             }
             if (rval_json.nt() == crow::json::num_type::Null) {
-                return make_document(kvp(key, bsoncxx::types::b_null{}));
+                builder.append(bsoncxx::types::b_null{});
+                return;
             }
             throw std::runtime_error("Unknown crow::json::num_type!");
 
         case crow::json::type::True:
         case crow::json::type::False:
-            return make_document(kvp(key, rval_json.b()));
+            builder.append(rval_json.b());
+            return;
 
         case crow::json::type::Null:
-            return make_document(kvp(key, bsoncxx::types::b_null{}));
+            builder.append(bsoncxx::types::b_null{});
+            return;
 
         default:
-            throw std::runtime_error("Non-primitive crow::json::type!");
+            throw std::runtime_error("Unknown crow::json::type!");
     }
 }
 
-auto BaseApiStrategyUtils::_parse_request_json_to_database_bson_single_primitive_clean_key(
-    const std::string& key) -> std::string {
-    if (key.substr(0, LTE_SIGN.length()) == LTE_SIGN) {
-        return key.substr(LTE_SIGN.length(), key.length());
+auto BaseApiStrategyUtils::_get_range_operator(const bsoncxx::stdx::string_view& key)
+    -> bsoncxx::stdx::string_view {
+    if (key.compare(0, LTE_SIGN.length(), LTE_SIGN) == 0) {
+        return "$lte";
     }
-
-    if (key.substr(0, GTE_SIGN.length()) == GTE_SIGN) {
-        return key.substr(GTE_SIGN.length(), key.length());
+    if (key.compare(0, GTE_SIGN.length(), GTE_SIGN) == 0) {
+        return "$gte";
     }
+    return "";
+}
+
+auto BaseApiStrategyUtils::_is_date_field(const bsoncxx::stdx::string_view& key) -> bool {
+    return std::find(DATE_FIELDS.begin(), DATE_FIELDS.end(), key) != DATE_FIELDS.end();
+}
 
-    return key;
+auto BaseApiStrategyUtils::parse_oid_str_to_oid_bson(const std::string& oid_str)
+    -> bsoncxx::document::value {
+    bsoncxx::oid oid{oid_str};
+    return make_document(kvp("_id", oid));
+}
+
+auto BaseApiStrategyUtils::parse_date_str_to_date_bson(const std::string& date_str)
+    -> bsoncxx::types::b_date {
+    auto date_ts =
+        DateUtils::string_to_utc_unix_timestamp(date_str, Constants::DATETIME_FORMAT) * 1000;
+    bsoncxx::types::b_date date_bson{std::chrono::milliseconds(date_ts)};
+    return date_bson;
 }
 
-auto BaseApiStrategyUtils::_parse_request_json_to_database_bson_single_primitive_parse_inequality(
-    const std::string& key, const bsoncxx::document::value& doc) -> bsoncxx::document::value {
-    if (key.substr(0, LTE_SIGN.length()) == LTE_SIGN) {
-        auto clean_key = key.substr(LTE_SIGN.length(), key.length());
-        return make_document(kvp(clean_key, make_document(kvp("$lte", doc[key].get_value()))));
+auto BaseApiStrategyUtils::parse_request_json_to_projection(
+    const crow::json::rvalue& body, const std::vector<std::string>& required_fields)
+    -> bsoncxx::stdx::optional<bsoncxx::document::value> {
+    if (!body || body.t() != crow::json::type::Object) {
+        return {};
     }
 
-    if (key.substr(0, GTE_SIGN.length()) == GTE_SIGN) {
-        auto clean_key = key.substr(GTE_SIGN.length(), key.length());
-        return make_document(kvp(clean_key, make_document(kvp("$gte", doc[key].get_value()))));
+    std::vector<std::string> fields;
+    std::vector<std::string> exclude_fields;
+    if (body.has("fields")) {
+        fields = _parse_request_json_to_field_names(body["fields"], "fields");
+    }
+    if (body.has("exclude_fields")) {
+        exclude_fields =
+            _parse_request_json_to_field_names(body["exclude_fields"], "exclude_fields");
     }
+    if (fields.empty() && exclude_fields.empty()) {
+        return {};
+    }
+
+    auto is_required = [&required_fields](const std::string& field) {
+        return std::find(required_fields.begin(), required_fields.end(), field) !=
+               required_fields.end();
+    };
 
-    return doc;
+    bsoncxx::builder::basic::document projection_builder;
+    if (!fields.empty()) {
+        // mongo only allows excluding _id inside an inclusion projection
+        for (const auto& field : exclude_fields) {
+            if (field != "_id") {
+                throw std::invalid_argument(
+                    "Invalid request: fields and exclude_fields cannot be combined.");
+            }
+        }
+        for (const auto& field : required_fields) {
+            if (std::find(fields.begin(), fields.end(), field) == fields.end()) {
+                fields.push_back(field);
+            }
+        }
+        for (const auto& field : fields) {
+            projection_builder.append(kvp(field, 1));
+        }
+        if (!exclude_fields.empty() && !is_required("_id")) {
+            projection_builder.append(kvp("_id", 0));
+        }
+    } else {
+        for (const auto& field : exclude_fields) {
+            if (!is_required(field)) {
+                projection_builder.append(kvp(field, 0));
+            }
+        }
+    }
+
+    auto projection = projection_builder.extract();
+    if (projection.view().empty()) {
+        return {};
+    }
+    return projection;
 }
 
-auto BaseApiStrategyUtils::parse_request_json_to_database_bson_single_array(
-    const std::string& key, const crow::json::rvalue& rval_json) -> bsoncxx::document::value {
-    bsoncxx::builder::basic::array arr_builder;
-    for (const auto& sub_field : const_cast<crow::json::rvalue&>(rval_json).lo()) {
-        if (sub_field.t() == crow::json::type::Object) {
-            auto sub_field_doc =
-                parse_request_json_to_database_bson_single_object(DEFAULT_KEY, sub_field);
-            arr_builder.append(sub_field_doc[DEFAULT_KEY].get_value());
-        } else if (sub_field.t() == crow::json::type::List) {
-            auto sub_field_doc =
-                parse_request_json_to_database_bson_single_array(DEFAULT_KEY, sub_field);
-            arr_builder.append(sub_field_doc[DEFAULT_KEY].get_value());
-        } else {
-            auto sub_field_doc =
-                parse_request_json_to_database_bson_single_primitive(DEFAULT_KEY, sub_field);
-            arr_builder.append(sub_field_doc[DEFAULT_KEY].get_value());
+auto BaseApiStrategyUtils::_parse_request_json_to_field_names(
+    const crow::json::rvalue& field_names_json, const std::string& key)
+    -> std::vector<std::string> {
+    if (field_names_json.t() != crow::json::type::List) {
+        throw std::invalid_argument("Field '" + key + "' must be an array of field names!");
+    }
+
+    std::vector<std::string> field_names;
+    for (const auto& field_name_json : field_names_json.lo()) {
+        if (field_name_json.t() != crow::json::type::String) {
+            throw std::invalid_argument("Field '" + key + "' must be an array of field names!");
+        }
+        std::string field_name = field_name_json.s();
+        if (field_name.empty() || field_name[0] == '$') {
+            throw std::invalid_argument("Invalid field name in '" + key + "': " + field_name);
         }
+        field_names.push_back(field_name);
     }
-    bsoncxx::array::value arr_val = arr_builder.extract();
-    return make_document(kvp(key, bsoncxx::types::b_array{arr_val.view()}));
+    return field_names;
 }
 
-auto BaseApiStrategyUtils::parse_request_json_to_database_bson_single_object(
-    const std::string& key, const crow::json::rvalue& rval_json) -> bsoncxx::document::value {
-    bsoncxx::builder::basic::document doc_builder;
-    for (const auto& sub_field : rval_json) {
-        std::string sub_field_key = static_cast<std::string>(sub_field.key());
-        if (sub_field.t() == crow::json::type::Object) {
-            auto sub_field_doc =
-                parse_request_json_to_database_bson_single_object(sub_field_key, sub_field);
-            auto sub_field_kvp = kvp(sub_field_key, sub_field_doc[sub_field_key].get_value());
-            doc_builder.append(std::move(sub_field_kvp));
-        } else if (sub_field.t() == crow::json::type::List) {
-            auto sub_field_doc =
-                parse_request_json_to_database_bson_single_array(sub_field_key, sub_field);
-            auto sub_field_kvp = kvp(sub_field_key, sub_field_doc[sub_field_key].get_value());
-            doc_builder.append(std::move(sub_field_kvp));
-        } else {
-            auto sub_field_doc =
-                parse_request_json_to_database_bson_single_primitive(sub_field_key, sub_field);
-            auto sub_field_kvp = kvp(sub_field_key, sub_field_doc[sub_field_key].get_value());
-            doc_builder.append(std::move(sub_field_kvp));
+auto BaseApiStrategyUtils::add_keyset_tiebreaker(const bsoncxx::document::view& sort)
+    -> bsoncxx::document::value {
+    if (sort["_id"]) {
+        return bsoncxx::document::value{sort};
+    }
+
+    // ties are broken in the direction of the last sort key so a descending sort stays descending
+    int direction = 1;
+    bsoncxx::builder::basic::document sort_builder;
+    for (const auto& element : sort) {
+        direction = _get_keyset_sort_direction(element);
+        sort_builder.append(kvp(element.key(), element.get_value()));
+    }
+    sort_builder.append(kvp("_id", direction));
+    return sort_builder.extract();
+}
+
+auto BaseApiStrategyUtils::create_keyset_cursor(const bsoncxx::document::view& sort,
+                                                const bsoncxx::document::view& last_document)
+    -> std::string {
+    bsoncxx::builder::basic::array key_builder;
+    for (const auto& element : sort) {
+        auto field = static_cast<std::string>(element.key());
+        auto value = _get_keyset_field_value(last_document, field);
+        if (value.view().type() == bsoncxx::type::k_array) {
+            throw std::invalid_argument("Invalid request: cannot page by sort field '" + field +
+                                        "', which holds an array.");
         }
+        key_builder.append(value.view());
     }
+    auto cursor_doc = make_document(kvp("sort", sort), kvp("key", key_builder.extract()));
 
-    return make_document(kvp(key, doc_builder.extract()));
+    // canonical extended JSON keeps dates, oids and number types intact across the round trip
+    auto cursor_json = bsoncxx::to_json(cursor_doc.view(), bsoncxx::ExtendedJsonMode::k_canonical);
+    return crow::utility::base64encode_urlsafe(cursor_json, cursor_json.size());
 }
 
-auto BaseApiStrategyUtils::parse_oid_str_to_oid_bson(const std::string& oid_str)
+auto BaseApiStrategyUtils::parse_keyset_cursor_to_filter(const std::string& cursor,
+                                                         const bsoncxx::document::view& sort)
     -> bsoncxx::document::value {
-    bsoncxx::oid oid{oid_str};
-    return make_document(kvp("_id", oid));
+    bsoncxx::stdx::optional<bsoncxx::document::value> cursor_doc;
+    try {
+        cursor_doc = bsoncxx::from_json(crow::utility::base64decode(cursor, cursor.size()));
+    } catch (const bsoncxx::exception& e) {
+        throw std::invalid_argument("Invalid cursor.");
+    }
+
+    auto cursor_sort = cursor_doc->view()["sort"];
+    auto cursor_key = cursor_doc->view()["key"];
+    if (!cursor_sort || !cursor_key || cursor_sort.type() != bsoncxx::type::k_document ||
+        cursor_key.type() != bsoncxx::type::k_array) {
+        throw std::invalid_argument("Invalid cursor.");
+    }
+    if (cursor_sort.get_document().value != sort) {
+        throw std::invalid_argument("Cursor was created for a different sort.");
+    }
+
+    std::vector<std::pair<std::string, bsoncxx::types::bson_value::view>> keys;
+    auto key_it = cursor_key.get_array().value.begin();
+    for (const auto& element : sort) {
+        if (key_it == cursor_key.get_array().value.end()) {
+            throw std::invalid_argument("Invalid cursor.");
+        }
+        keys.push_back({static_cast<std::string>(element.key()), key_it->get_value()});
+        ++key_it;
+    }
+
+    // (a, b, _id) > (x, y, z)  <=>  a > x  or  (a = x and b > y)  or  (a = x and b = y and _id > z)
+    // where each "a > x" may take several conditions; equality with null also matches missing
+    bsoncxx::builder::basic::array clauses;
+    auto sort_it = sort.begin();
+    for (size_t i = 0; i < keys.size(); ++i, ++sort_it) {
+        auto conditions = _make_keyset_after_conditions(keys[i].first, keys[i].second,
+                                                        _get_keyset_sort_direction(*sort_it));
+        for (const auto& condition : conditions) {
+            bsoncxx::builder::basic::document clause;
+            for (size_t j = 0; j < i; ++j) {
+                clause.append(kvp(keys[j].first, keys[j].second));
+            }
+            clause.append(bsoncxx::builder::concatenate(condition.view()));
+            clauses.append(clause.extract());
+        }
+    }
+
+    return make_document(kvp("$or", clauses.extract()));
 }
 
-auto BaseApiStrategyUtils::parse_date_str_to_date_bson(const std::string& date_str)
-    -> bsoncxx::types::b_date {
-    auto date_ts =
-        DateUtils::string_to_utc_unix_timestamp(date_str, Constants::DATETIME_FORMAT) * 1000;
-    bsoncxx::types::b_date date_bson{std::chrono::milliseconds(date_ts)};
-    return date_bson;
+// $type aliases of each rank of mongod's sort order, from first to last
+static const std::vector<std::vector<std::string>> KEYSET_TYPE_RANKS = {
+    {"minKey"},   {"null"}, {"number"}, {"symbol", "string"}, {"object"}, {"array"}, {"binData"},
+    {"objectId"}, {"bool"}, {"date"}, {"timestamp"}, {"regex"}, {"maxKey"}};
+static const size_t KEYSET_NULL_RANK = 1;
+
+auto BaseApiStrategyUtils::_get_keyset_type_rank(const bsoncxx::type& type) -> size_t {
+    switch (type) {
+        case bsoncxx::type::k_minkey:
+            return 0;
+        case bsoncxx::type::k_null:
+            return KEYSET_NULL_RANK;
+        case bsoncxx::type::k_int32:
+        case bsoncxx::type::k_int64:
+        case bsoncxx::type::k_double:
+        case bsoncxx::type::k_decimal128:
+            return 2;
+        case bsoncxx::type::k_symbol:
+        case bsoncxx::type::k_string:
+            return 3;
+        case bsoncxx::type::k_document:
+            return 4;
+        case bsoncxx::type::k_array:
+            return 5;
+        case bsoncxx::type::k_binary:
+            return 6;
+        case bsoncxx::type::k_oid:
+            return 7;
+        case bsoncxx::type::k_bool:
+            return 8;
+        case bsoncxx::type::k_date:
+            return 9;
+        case bsoncxx::type::k_timestamp:
+            return 10;
+        case bsoncxx::type::k_regex:
+            return 11;
+        case bsoncxx::type::k_maxkey:
+            return 12;
+        default:
+            throw std::invalid_argument("Invalid cursor: unsupported sort key type.");
+    }
+}
+
+auto BaseApiStrategyUtils::_make_keyset_after_conditions(
+    const std::string& field, const bsoncxx::types::bson_value::view& value, const int& direction)
+    -> std::vector<bsoncxx::document::value> {
+    auto rank = _get_keyset_type_rank(value.type());
+    if (rank == _get_keyset_type_rank(bsoncxx::type::k_array)) {
+        throw std::invalid_argument("Invalid cursor: arrays cannot be paged.");
+    }
+
+    std::vector<bsoncxx::document::value> conditions;
+    // $gt and $lt only match values of the same type, and null equals null
+    if (rank != KEYSET_NULL_RANK) {
+        auto comparison = direction > 0 ? "$gt" : "$lt";
+        conditions.push_back(make_document(kvp(field, make_document(kvp(comparison, value)))));
+    }
+
+    // values of the types sorted after (or before) this one; null is matched separately below
+    // since only an equality with null also matches a missing field
+    bsoncxx::builder::basic::array type_aliases;
+    bool has_type_aliases = false;
+    for (size_t other_rank = 0; other_rank < KEYSET_TYPE_RANKS.size(); ++other_rank) {
+        bool is_after = direction > 0 ? other_rank > rank : other_rank < rank;
+        if (!is_after || other_rank == KEYSET_NULL_RANK) {
+            continue;
+        }
+        for (const auto& type_alias : KEYSET_TYPE_RANKS[other_rank]) {
+            type_aliases.append(type_alias);
+            has_type_aliases = true;
+        }
+    }
+    if (has_type_aliases) {
+        conditions.push_back(
+            make_document(kvp(field, make_document(kvp("$type", type_aliases.extract())))));
+    }
+
+    if (direction < 0 && rank > KEYSET_NULL_RANK) {
+        conditions.push_back(make_document(kvp(field, bsoncxx::types::b_null{})));
+    }
+    return conditions;
+}
+
+auto BaseApiStrategyUtils::_get_keyset_sort_direction(const bsoncxx::document::element& direction)
+    -> int {
+    switch (direction.type()) {
+        case bsoncxx::type::k_int32:
+            return direction.get_int32().value < 0 ? -1 : 1;
+        case bsoncxx::type::k_int64:
+            return direction.get_int64().value < 0 ? -1 : 1;
+        case bsoncxx::type::k_double:
+            return direction.get_double().value < 0 ? -1 : 1;
+        default:
+            throw std::invalid_argument("Sort directions must be 1 or -1.");
+    }
+}
+
+auto BaseApiStrategyUtils::_get_keyset_field_value(const bsoncxx::document::view& document,
+                                                   const std::string& path)
+    -> bsoncxx::types::bson_value::value {
+    auto current = document;
+    size_t start = 0;
+    while (true) {
+        auto end = path.find('.', start);
+        auto element = current[path.substr(start, end - start)];
+        if (!element) {
+            return bsoncxx::types::bson_value::value{bsoncxx::types::b_null{}};
+        }
+        if (end == std::string::npos) {
+            return bsoncxx::types::bson_value::value{element.get_value()};
+        }
+        if (element.type() != bsoncxx::type::k_document) {
+            return bsoncxx::types::bson_value::value{bsoncxx::types::b_null{}};
+        }
+        current = element.get_document().value;
+        start = end + 1;
+    }
 }
 
 auto BaseApiStrategyUtils::make_error_response(int status_code, const std::string& message)
@@ -220,6 +481,10 @@ auto BaseApiStrategyUtils::make_error_response(int status_code, const std::strin
     crow::json::wvalue res;
     res["success"] = false;
     res["message"] = message;
+    auto format = _get_response_format();
+    if (format != ResponseFormat::Json) {
+        return _make_binary_response(status_code, res, format);
+    }
     return crow::response(status_code, res);
 }
 
@@ -227,5 +492,22 @@ auto BaseApiStrategyUtils::make_success_response(int status_code, crow::json::wv
                                                  const std::string& message) -> crow::response {
     data["success"] = true;
     data["message"] = message;
+    auto format = _get_response_format();
+    if (format != ResponseFormat::Json) {
+        return _make_binary_response(status_code, data, format);
+    }
     return crow::response(status_code, data);
+}
+
+auto BaseApiStrategyUtils::_get_response_format() -> ResponseFormat {
+    auto context = RequestContext::get_current();
+    return context ? context->get_response_format() : ResponseFormat::Json;
+}
+
+auto BaseApiStrategyUtils::_make_binary_response(int status_code, const crow::json::wvalue& data,
+                                                 const ResponseFormat& format) -> crow::response {
+    crow::response res(status_code);
+    res.set_header("Content-Type", ResponseFormatUtils::get_content_type(format));
+    res.body = ResponseFormatUtils::encode_response_data(data, format);
+    return res;
 }
\ No newline at end of file
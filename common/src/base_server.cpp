@@ -1,13 +1,56 @@
 #include "base_server.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 
-BaseServer::BaseServer(int port, int concurrency) : port(port), concurrency(concurrency) {}
+#include "base_api_strategy_utils.hpp"
+#include "database_manager.hpp"
+#include "entity_tag.hpp"
+#include "env_manager.hpp"
+#include "index_manager.hpp"
+#include "request_context.hpp"
+#include "result_cache.hpp"
+
+BaseServer::BaseServer(int port, int concurrency)
+    : port(port),
+      concurrency(concurrency),
+      blocking_executor(BlockingExecutor::create_from_env()),
+      jwt_manager(std::make_shared<JwtManager>()),
+      metrics_manager(std::make_shared<MetricsManager>()),
+      response_compressor(ResponseCompressor::create_from_env()) {}
+
+// Applies the conditional request, compression and stage timings of the request context decorator
+// to a response.
+static auto complete_response(const std::string& route, const crow::request& req,
+                              crow::response res, RequestContext& context,
+                              const std::shared_ptr<MetricsManager>& metrics_manager,
+                              const std::shared_ptr<ResponseCompressor>& response_compressor)
+    -> crow::response {
+    res = EntityTagUtils::make_conditional_response(req, std::move(res));
+    response_compressor->compress_response(req, res);
+    // the body depends on these headers, which shared caches need to know
+    res.add_header("Vary", response_compressor->get_is_enabled() ? "Accept, Accept-Encoding"
+                                                                 : "Accept");
+
+    context.record_stage("completed");
+    for (const auto& [stage, elapsed_ms] : context.get_stage_timings()) {
+        metrics_manager->observe("request." + route + "." + stage + "_ms", elapsed_ms);
+    }
+    return res;
+}
+
+static auto make_executor_overloaded_response() -> crow::response {
+    auto res = BaseApiStrategyUtils::make_error_response(
+        503, "Service overloaded: too many requests waiting for a worker.");
+    res.add_header("Retry-After", std::to_string(Constants::ADMISSION_RETRY_AFTER_SECONDS));
+    return res;
+}
 
 void BaseServer::_register_handler_func(
     const std::string& route, const std::function<crow::response(const crow::request&)>& func,
     const crow::HTTPMethod& method,
-    const std::function<handler_func_type(const handler_func_type&)>&
+    const std::function<deferred_handler_func_type(const handler_func_type&)>&
         concurrency_protection_decorator,
     const JwtAccessLevel& access_level,
     const std::function<handler_func_type(
@@ -18,17 +61,147 @@ void BaseServer::_register_handler_func(
     handler_funcs.push_back(handler_func);
 }
 
+void BaseServer::_register_handler_func(
+    const std::string& route, const deferred_handler_func_type& func,
+    const crow::HTTPMethod& method,
+    const std::function<deferred_handler_func_type(const deferred_handler_func_type&)>&
+        concurrency_protection_decorator,
+    const JwtAccessLevel& access_level,
+    const std::function<deferred_handler_func_type(
+        const deferred_handler_func_type&, const JwtAccessLevel& access_level)>&
+        jwt_protection_decorator) {
+    DeferredHandlerFunc handler_func = {route,        func,
+                                        method,       concurrency_protection_decorator,
+                                        access_level, jwt_protection_decorator};
+    deferred_handler_funcs.push_back(handler_func);
+}
+
 void BaseServer::_decorate_handler_funcs() {
-    for (auto& handler_func : handler_funcs) {
+    for (auto& handler_func : deferred_handler_funcs) {
         handler_func.func =
             handler_func.jwt_protection_decorator(handler_func.func, handler_func.access_level);
         handler_func.func = handler_func.concurrency_protection_decorator(handler_func.func);
+        handler_func.func = _request_coalescing_decorator(
+            handler_func.route, handler_func.access_level, handler_func.func);
+        handler_func.func = _request_context_decorator(handler_func.route, handler_func.func);
+    }
+    // admission control turns them into deferred handlers, so queued requests hold no thread
+    for (const auto& handler_func : handler_funcs) {
+        auto func =
+            handler_func.jwt_protection_decorator(handler_func.func, handler_func.access_level);
+        auto deferred_func = _request_coalescing_decorator(
+            handler_func.route, handler_func.access_level,
+            handler_func.concurrency_protection_decorator(func));
+        deferred_handler_funcs.push_back(
+            {handler_func.route, _request_context_decorator(handler_func.route, deferred_func),
+             handler_func.method, nullptr, handler_func.access_level, nullptr});
+    }
+    handler_funcs.clear();
+}
+
+auto BaseServer::_request_coalescing_decorator(const std::string& route,
+                                               const JwtAccessLevel& access_level,
+                                               const deferred_handler_func_type& func)
+    -> deferred_handler_func_type {
+    if (!request_coalescer ||
+        std::find(coalesced_routes.begin(), coalesced_routes.end(), route) ==
+            coalesced_routes.end()) {
+        return func;
+    }
+    auto request_coalescer = this->request_coalescer;
+    return [request_coalescer, route, access_level, func](const crow::request& req,
+                                                           const respond_func_type& respond) {
+        // serialized bodies are compressed for the Accept-Encoding, and a cached result may be
+        // answered with a 304 for the If-None-Match
+        std::string key_route = route + '\n' + req.get_header_value("Accept-Encoding") + '\n' +
+                                req.get_header_value("If-None-Match");
+        // parked callers skip the JWT check, so they may only share a response with callers
+        // that sent the same token
+        if (access_level != JwtAccessLevel::None) {
+            key_route += '\n' + req.get_header_value("Authorization");
+        }
+        request_coalescer->get_or_compute(
+            ResultCache::make_key(key_route, req),
+            [&req, &func](const respond_func_type& respond) { func(req, respond); }, respond);
+    };
+}
+
+auto BaseServer::_request_context_decorator(const std::string& route,
+                                            const deferred_handler_func_type& func)
+    -> deferred_handler_func_type {
+    auto metrics_manager = this->metrics_manager;
+    auto response_compressor = this->response_compressor;
+    return [metrics_manager, response_compressor, route, func](const crow::request& req,
+                                                               const respond_func_type& respond) {
+        auto context = std::make_shared<RequestContext>(req);
+        context->set_response_compressor(response_compressor);
+        RequestContext::Scope scope(context);
+
+        // the response may come from another thread, which has to serve the same context
+        func(req, [metrics_manager, response_compressor, route, &req, context,
+                   respond](crow::response res) {
+            RequestContext::Scope scope(context);
+            respond(complete_response(route, req, std::move(res), *context, metrics_manager,
+                                      response_compressor));
+        });
+    };
+}
+
+auto BaseServer::_make_async_handler_func(const deferred_handler_func_type& func)
+    -> std::function<void(const crow::request&, crow::response&)> {
+    auto executor = blocking_executor;
+    return [executor, func](const crow::request& req, crow::response& res) {
+        // crow keeps req and res alive until res.end() is called, which must happen only once
+        auto is_responded = std::make_shared<std::atomic<bool>>(false);
+        respond_func_type respond = [&req, &res, is_responded](crow::response result) {
+            if (is_responded->exchange(true)) {
+                return;
+            }
+            auto shared_result = std::make_shared<crow::response>(std::move(result));
+            req.post([&res, shared_result]() {
+                res = std::move(*shared_result);
+                res.end();
+            });
+        };
+
+        bool is_submitted = executor->submit([&req, func, respond]() {
+            try {
+                func(req, respond);
+            } catch (const std::exception& e) {
+                respond(BaseApiStrategyUtils::make_error_response(
+                    500, std::string("Server error: ") + e.what()));
+            }
+        });
+
+        if (!is_submitted) {
+            res = make_executor_overloaded_response();
+            res.end();
+        }
+    };
+}
+
+void BaseServer::_ensure_indexes() {
+    EnvManager env_manager;
+    if (indexed_collections.empty() ||
+        env_manager.read_env("ENSURE_INDEXES_ON_STARTUP",
+                             Constants::DEFAULT_ENSURE_INDEXES_ON_STARTUP) != "true") {
+        return;
+    }
+
+    try {
+        IndexManager index_manager(DatabaseManager::create_from_env(env_manager));
+        auto report = index_manager.ensure_indexes(indexed_collections);
+        IndexManager::log_report(report);
+    } catch (const std::exception& e) {
+        // serving without indexes is slow but still correct
+        std::cout << "[IndexManager] Could not ensure indexes: " << e.what() << std::endl;
     }
 }
 
 void BaseServer::_init_server() {
     _define_handler_funcs();
     _decorate_handler_funcs();
+    _ensure_indexes();
 }
 
 void BaseServer::serve() {
@@ -40,9 +213,21 @@ void BaseServer::serve() {
             auto app = std::make_unique<crow::App<CORS>>();
 
             app->loglevel(crow::LogLevel::Warning);
-            for (const auto& handler : handler_funcs) {
-                app->route_dynamic(handler.route).methods(handler.method)(handler.func);
+            for (const auto& handler : deferred_handler_funcs) {
+                app->route_dynamic(handler.route)
+                    .methods(handler.method)(_make_async_handler_func(handler.func));
             }
+            // served inline since it only reads in-process counters; the route names and
+            // volumes it reveals are for admins only
+            auto metrics_manager = this->metrics_manager;
+            app->route_dynamic("/metrics").methods(crow::HTTPMethod::Get)(
+                jwt_manager->jwt_protection_decorator(
+                    [metrics_manager](const crow::request& req) {
+                        return BaseApiStrategyUtils::make_success_response(
+                            200, metrics_manager->to_json(), "Server processed metrics request.");
+                    },
+                    JwtAccessLevel::Admin));
+            // I/O threads only; blocking work is sized separately by the executor
             app->concurrency(concurrency);
             std::cout << "Server starting on port " << port << std::endl;
             app->port(port).run();
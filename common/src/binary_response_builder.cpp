@@ -0,0 +1,58 @@
+#include "binary_response_builder.hpp"
+
+#include <bsoncxx/json.hpp>
+#include <bsoncxx/types.hpp>
+#include <stdexcept>
+
+#include "msgpack_response_encoder.hpp"
+
+BinaryResponseBuilder::BinaryResponseBuilder(const ResponseFormat& format, const std::string& key)
+    : format(format), key(key), bson_builder(false), item_count(0) {
+    if (format == ResponseFormat::Json) {
+        throw std::invalid_argument("JSON responses are built by JsonResponseBuilder");
+    }
+    if (format == ResponseFormat::Bson) {
+        bson_builder.key_owned(key);
+        bson_builder.open_array();
+    }
+}
+
+void BinaryResponseBuilder::append_document(const bsoncxx::document::view& document) {
+    if (format == ResponseFormat::Bson) {
+        bson_builder.append(bsoncxx::types::b_document{document});
+    } else {
+        MsgpackResponseEncoder::encode_document(document, msgpack_items);
+    }
+    item_count++;
+}
+
+auto BinaryResponseBuilder::finish(const crow::json::wvalue& fields) -> std::string {
+    auto fields_json = fields.t() == crow::json::type::Object ? fields.dump() : "{}";
+
+    if (format == ResponseFormat::Bson) {
+        bson_builder.close_array();
+        auto fields_document = bsoncxx::from_json(fields_json);
+        for (const auto& element : fields_document.view()) {
+            bson_builder.key_view(element.key());
+            bson_builder.append(element.get_value());
+        }
+        auto document = bson_builder.extract_document();
+        return std::string(reinterpret_cast<const char*>(document.view().data()),
+                           document.view().length());
+    }
+
+    auto fields_rval = crow::json::load(fields_json);
+    std::string out;
+    out.reserve(msgpack_items.size() + fields_json.size() + key.size() + 16);
+    MsgpackResponseEncoder::write_map_header(1 + fields_rval.size(), out);
+    MsgpackResponseEncoder::write_string(key, out);
+    MsgpackResponseEncoder::write_array_header(item_count, out);
+    out += msgpack_items;
+    for (const auto& field : fields_rval) {
+        MsgpackResponseEncoder::write_string(field.key(), out);
+        MsgpackResponseEncoder::encode_json(field, out);
+    }
+    return out;
+}
+
+auto BinaryResponseBuilder::get_item_count() const -> size_t { return item_count; }
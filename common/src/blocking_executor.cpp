@@ -0,0 +1,71 @@
+#include "blocking_executor.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+BlockingExecutor::BlockingExecutor(const int& num_threads, const int& max_queue_length)
+    : max_queue_length{max_queue_length} {
+    if (num_threads <= 0) {
+        throw std::invalid_argument("BlockingExecutor needs at least one thread.");
+    }
+    for (int i = 0; i < num_threads; ++i) {
+        workers.emplace_back([this]() { _run_worker(); });
+    }
+}
+
+BlockingExecutor::~BlockingExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_stopping = true;
+    }
+    task_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::shared_ptr<BlockingExecutor> BlockingExecutor::create_from_env(EnvManager env_manager) {
+    auto BLOCKING_EXECUTOR_THREADS = stoi(env_manager.read_env(
+        "BLOCKING_EXECUTOR_THREADS", Constants::DEFAULT_BLOCKING_EXECUTOR_THREADS));
+    auto BLOCKING_EXECUTOR_MAX_QUEUE_LENGTH =
+        stoi(env_manager.read_env("BLOCKING_EXECUTOR_MAX_QUEUE_LENGTH",
+                                  Constants::DEFAULT_BLOCKING_EXECUTOR_MAX_QUEUE_LENGTH));
+    return std::make_shared<BlockingExecutor>(BLOCKING_EXECUTOR_THREADS,
+                                              BLOCKING_EXECUTOR_MAX_QUEUE_LENGTH);
+}
+
+auto BlockingExecutor::submit(std::function<void()> task) -> bool {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (is_stopping || static_cast<int>(tasks.size()) >= max_queue_length) {
+            return false;
+        }
+        tasks.push(std::move(task));
+    }
+    task_available.notify_one();
+    return true;
+}
+
+auto BlockingExecutor::get_num_threads() const -> int { return workers.size(); }
+
+void BlockingExecutor::_run_worker() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            task_available.wait(lock, [this]() { return is_stopping || !tasks.empty(); });
+            // drain whatever is already queued before shutting down
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "[BlockingExecutor] Task failed: " << e.what() << std::endl;
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#include "collection_watcher.hpp"
+
+#include <chrono>
+#include <iostream>
+
+CollectionWatcher::CollectionWatcher(std::shared_ptr<DatabaseManager> db_manager,
+                                     const std::string& collection_name,
+                                     std::function<void()> on_change, const int& poll_interval_ms,
+                                     std::function<void()> on_poll)
+    : db_manager{db_manager},
+      collection_name{collection_name},
+      on_change{std::move(on_change)},
+      on_poll{on_poll ? std::move(on_poll) : this->on_change},
+      poll_interval{poll_interval_ms} {
+    watcher = std::thread([this]() { _run(); });
+}
+
+CollectionWatcher::~CollectionWatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_stopping = true;
+    }
+    stopping_changed.notify_all();
+    watcher.join();
+}
+
+void CollectionWatcher::_run() {
+    mongocxx::options::change_stream option;
+    option.max_await_time(std::chrono::milliseconds(Constants::COLLECTION_WATCH_MAX_AWAIT_MS));
+    bool is_failure_reported = false;
+
+    while (!is_stopping) {
+        try {
+            auto change_stream = db_manager->watch(collection_name, option);
+            // changes made while the stream was down were missed
+            on_change();
+            is_failure_reported = false;
+            while (!is_stopping) {
+                // each pass ends after max_await_time without changes
+                for (const auto& event : change_stream) {
+                    (void)event;
+                    on_change();
+                    if (is_stopping) {
+                        break;
+                    }
+                }
+            }
+        } catch (const std::exception& e) {
+            if (!is_failure_reported) {
+                std::cout << "[CollectionWatcher] Cannot watch " << collection_name
+                          << (poll_interval.count() > 0 ? ", polling instead: " : ": ")
+                          << e.what() << std::endl;
+                is_failure_reported = true;
+            }
+            if (poll_interval.count() <= 0) {
+                _wait(std::chrono::milliseconds(Constants::COLLECTION_WATCH_RETRY_MS));
+                continue;
+            }
+            if (!_wait(poll_interval)) {
+                break;
+            }
+            try {
+                on_poll();
+            } catch (const std::exception& e) {
+                std::cout << "[CollectionWatcher] Polling " << collection_name
+                          << " failed: " << e.what() << std::endl;
+            }
+        }
+    }
+}
+
+auto CollectionWatcher::_wait(const std::chrono::milliseconds& duration) -> bool {
+    std::unique_lock<std::mutex> lock(mutex);
+    return !stopping_changed.wait_for(lock, duration, [this]() { return is_stopping.load(); });
+}
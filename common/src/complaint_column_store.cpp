@@ -0,0 +1,469 @@
+#include "complaint_column_store.hpp"
+
+#include <algorithm>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/json.hpp>
+#include <bsoncxx/types.hpp>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#include "date_utils.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+static const int64_t MILLISECONDS_PER_DAY = 24LL * 60 * 60 * 1000;
+// a reload starts once no change arrived for the quiet period, or once the oldest change it loads
+// has waited the maximum delay, so steady writes still get loaded
+static const std::chrono::milliseconds RELOAD_QUIET_PERIOD(200);
+static const std::chrono::milliseconds MAX_RELOAD_DELAY(1000);
+// independent partial sums per lane, so the compiler can keep them in one vector register
+static const size_t LANES = 8;
+
+// Evaluates a filter on one row. Every condition is combined with & instead of &&, so the
+// scans that call it have no branches per row and compile to vector compares.
+struct RowMatcher {
+    const int64_t* dates;
+    const uint8_t* categories;
+    const uint16_t* sources;
+    const double* sentiments;
+    int64_t from_date;
+    int64_t to_date;
+    bool has_sentiment_range;
+    double from_sentiment;
+    double to_sentiment;
+    bool is_any_category;
+    uint8_t category;
+    bool is_any_source;
+    uint16_t source;
+
+    RowMatcher(const ComplaintColumnStore::Columns& columns,
+               const ComplaintColumnStore::Filter& filter)
+        : dates{columns.dates.data()},
+          categories{columns.categories.data()},
+          sources{columns.sources.data()},
+          sentiments{columns.sentiments.data()},
+          from_date{filter.from_date},
+          to_date{filter.to_date},
+          has_sentiment_range{filter.has_sentiment_range},
+          from_sentiment{filter.from_sentiment},
+          to_sentiment{filter.to_sentiment},
+          is_any_category{filter.category == ComplaintColumnStore::ANY_VALUE},
+          category{static_cast<uint8_t>(filter.category)},
+          is_any_source{filter.source == ComplaintColumnStore::ANY_VALUE},
+          source{static_cast<uint16_t>(filter.source)} {}
+
+    auto operator()(const size_t& i) const -> bool {
+        auto sentiment = sentiments[i];
+        bool is_sentiment_in_range = (sentiment >= from_sentiment) & (sentiment <= to_sentiment);
+        return (dates[i] >= from_date) & (dates[i] <= to_date) &
+               (is_any_category | (categories[i] == category)) &
+               (is_any_source | (sources[i] == source)) &
+               (!has_sentiment_range | is_sentiment_in_range);
+    }
+};
+
+// Returns the dictionary code of a value, adding it when it is new.
+template <typename Code>
+static auto encode(const bsoncxx::stdx::optional<std::string>& value,
+                   std::vector<std::string>& dictionary,
+                   std::unordered_map<std::string, Code>& codes, const Code& missing_code,
+                   const std::string& field_name) -> Code {
+    if (!value) {
+        return missing_code;
+    }
+    auto it = codes.find(*value);
+    if (it != codes.end()) {
+        return it->second;
+    }
+    if (dictionary.size() >= missing_code) {
+        throw std::runtime_error("Too many distinct complaint " + field_name + " values.");
+    }
+    auto code = static_cast<Code>(dictionary.size());
+    codes.emplace(*value, code);
+    dictionary.push_back(*value);
+    return code;
+}
+
+static auto get_string(const bsoncxx::document::view& complaint, const std::string& field_name)
+    -> bsoncxx::stdx::optional<std::string> {
+    auto element = complaint[field_name];
+    if (!element || element.type() != bsoncxx::type::k_string) {
+        return bsoncxx::stdx::nullopt;
+    }
+    return std::string(element.get_string().value);
+}
+
+auto ComplaintColumnStore::Columns::size() const -> size_t { return dates.size(); }
+
+void ComplaintColumnStore::Columns::append(const bsoncxx::document::view& complaint) {
+    auto date_element = complaint["date"];
+    auto date = date_element && date_element.type() == bsoncxx::type::k_date
+                    ? date_element.get_date().to_int64()
+                    : MISSING_DATE;
+
+    auto sentiment = std::numeric_limits<double>::quiet_NaN();
+    auto sentiment_element = complaint["sentiment"];
+    if (sentiment_element) {
+        switch (sentiment_element.type()) {
+            case bsoncxx::type::k_double:
+                sentiment = sentiment_element.get_double().value;
+                break;
+            case bsoncxx::type::k_int32:
+                sentiment = sentiment_element.get_int32().value;
+                break;
+            case bsoncxx::type::k_int64:
+                sentiment = static_cast<double>(sentiment_element.get_int64().value);
+                break;
+            default:
+                break;
+        }
+    }
+
+    append(date, get_string(complaint, "category"), get_string(complaint, "source"), sentiment);
+}
+
+void ComplaintColumnStore::Columns::append(const int64_t& date,
+                                           const bsoncxx::stdx::optional<std::string>& category,
+                                           const bsoncxx::stdx::optional<std::string>& source,
+                                           const double& sentiment) {
+    auto category_code =
+        encode(category, category_dictionary, category_codes, MISSING_CATEGORY, "category");
+    auto source_code = encode(source, source_dictionary, source_codes, MISSING_SOURCE, "source");
+
+    auto month = NO_MONTH;
+    if (date != MISSING_DATE) {
+        month = _get_month(date);
+        first_month = std::min(first_month, month);
+        last_month = std::max(last_month, month);
+    }
+
+    dates.push_back(date);
+    months.push_back(month);
+    categories.push_back(category_code);
+    sources.push_back(source_code);
+    sentiments.push_back(sentiment);
+}
+
+ComplaintColumnStore::ComplaintColumnStore(std::shared_ptr<DatabaseManager> db_manager,
+                                           const int& poll_interval_ms,
+                                           const int& max_staleness_ms)
+    : db_manager{db_manager},
+      max_staleness{max_staleness_ms},
+      unloaded_since{std::chrono::steady_clock::now()},
+      last_change_at{unloaded_since} {
+    loader = std::thread([this]() { _run_loader(); });
+    watcher = std::make_unique<CollectionWatcher>(
+        db_manager, Constants::COLLECTION_COMPLAINTS, [this]() { mark_changed(); },
+        poll_interval_ms, [this]() { _poll(); });
+}
+
+ComplaintColumnStore::~ComplaintColumnStore() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_stopping = true;
+    }
+    changed.notify_all();
+    loader.join();
+}
+
+std::shared_ptr<ComplaintColumnStore> ComplaintColumnStore::create_from_env(
+    std::shared_ptr<DatabaseManager> db_manager, EnvManager env_manager) {
+    auto COMPLAINT_COLUMN_STORE_ENABLED = env_manager.read_env(
+        "COMPLAINT_COLUMN_STORE_ENABLED", Constants::DEFAULT_COMPLAINT_COLUMN_STORE_ENABLED);
+    auto COMPLAINT_COLUMN_STORE_POLL_INTERVAL_MS =
+        stoi(env_manager.read_env("COMPLAINT_COLUMN_STORE_POLL_INTERVAL_MS",
+                                  Constants::DEFAULT_COMPLAINT_COLUMN_STORE_POLL_INTERVAL_MS));
+    auto COMPLAINT_COLUMN_STORE_MAX_STALENESS_MS =
+        stoi(env_manager.read_env("COMPLAINT_COLUMN_STORE_MAX_STALENESS_MS",
+                                  Constants::DEFAULT_COMPLAINT_COLUMN_STORE_MAX_STALENESS_MS));
+    if (COMPLAINT_COLUMN_STORE_ENABLED != "true") {
+        return nullptr;
+    }
+    return std::make_shared<ComplaintColumnStore>(
+        db_manager, COMPLAINT_COLUMN_STORE_POLL_INTERVAL_MS,
+        COMPLAINT_COLUMN_STORE_MAX_STALENESS_MS);
+}
+
+void ComplaintColumnStore::refresh() {
+    std::lock_guard<std::mutex> refresh_lock(refresh_mutex);
+    long long int loading_change_count;
+    auto loading_started_at = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        loading_change_count = change_count;
+    }
+
+    // read first, so a write that lands during the load moves it again for the next poll
+    auto version = _read_version();
+    auto next_columns = std::make_shared<Columns>();
+    mongocxx::options::find option;
+    option.projection(make_document(kvp("_id", 0), kvp("date", 1), kvp("category", 1),
+                                    kvp("source", 1), kvp("sentiment", 1)));
+    for (auto&& complaint : db_manager->find(Constants::COLLECTION_COMPLAINTS, {}, option)) {
+        next_columns->append(complaint);
+    }
+
+    std::function<void()> on_refresh;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        columns = std::move(next_columns);
+        loaded_change_count = std::max(loaded_change_count, loading_change_count);
+        // changes counted during the load came after it started, so this overstates their wait
+        unloaded_since = loading_started_at;
+        loaded_version = std::move(version);
+        on_refresh = this->on_refresh;
+    }
+    if (on_refresh) {
+        on_refresh();
+    }
+}
+
+auto ComplaintColumnStore::get_columns() -> std::shared_ptr<const Columns> {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (loaded_change_count != change_count &&
+        std::chrono::steady_clock::now() - unloaded_since > max_staleness) {
+        return nullptr;
+    }
+    return columns;
+}
+
+void ComplaintColumnStore::mark_changed() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto now = std::chrono::steady_clock::now();
+        if (loaded_change_count == change_count) {
+            unloaded_since = now;
+        }
+        last_change_at = now;
+        change_count++;
+    }
+    changed.notify_all();
+}
+
+void ComplaintColumnStore::set_on_refresh(std::function<void()> on_refresh) {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->on_refresh = std::move(on_refresh);
+}
+
+auto ComplaintColumnStore::compute_statistics(const Columns& columns, const Filter& filter,
+                                              const bool& is_by_month,
+                                              const Dimension& dimension) -> std::vector<Group> {
+    std::vector<Group> groups;
+    auto size = columns.size();
+    if (filter.matches_nothing || size == 0) {
+        return groups;
+    }
+    RowMatcher matches(columns, filter);
+    const auto* sentiments = columns.sentiments.data();
+
+    if (!is_by_month && dimension == Dimension::None) {
+        long long int counts[LANES] = {};
+        long long int sentiment_counts[LANES] = {};
+        double sentiment_sums[LANES] = {};
+        size_t i = 0;
+        for (; i + LANES <= size; i += LANES) {
+            for (size_t lane = 0; lane < LANES; ++lane) {
+                bool is_match = matches(i + lane);
+                auto sentiment = sentiments[i + lane];
+                bool has_sentiment = is_match & (sentiment == sentiment);
+                counts[lane] += is_match;
+                sentiment_counts[lane] += has_sentiment;
+                sentiment_sums[lane] += has_sentiment ? sentiment : 0.0;
+            }
+        }
+        for (; i < size; ++i) {
+            bool is_match = matches(i);
+            auto sentiment = sentiments[i];
+            bool has_sentiment = is_match & (sentiment == sentiment);
+            counts[0] += is_match;
+            sentiment_counts[0] += has_sentiment;
+            sentiment_sums[0] += has_sentiment ? sentiment : 0.0;
+        }
+
+        Statistics statistics;
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            statistics.count += counts[lane];
+            statistics.sentiment_count += sentiment_counts[lane];
+            statistics.sentiment_sum += sentiment_sums[lane];
+        }
+        // a separate pass, so the one above keeps no per-row branches
+        if (statistics.sentiment_count > 0) {
+            for (size_t row = 0; row < size; ++row) {
+                auto sentiment = sentiments[row];
+                if (sentiment == sentiment && matches(row)) {
+                    statistics.sentiment_sketch.add(sentiment);
+                }
+            }
+        }
+        if (statistics.count > 0) {
+            groups.push_back({NO_MONTH, ANY_VALUE, statistics});
+        }
+        return groups;
+    }
+
+    // one accumulator per (month, value) plus a last one that takes the rows that do not match
+    int32_t first_month = 0;
+    int32_t month_count = 1;
+    if (is_by_month) {
+        if (columns.first_month > columns.last_month) {
+            return groups;
+        }
+        // rows before from_date or after to_date never match, so their months need no cells
+        first_month = filter.from_date > MISSING_DATE
+                          ? std::max(columns.first_month, _get_month(filter.from_date))
+                          : columns.first_month;
+        auto last_month = std::min(columns.last_month, _get_month(filter.to_date));
+        if (first_month > last_month) {
+            return groups;
+        }
+        month_count = last_month - first_month + 1;
+    }
+    size_t value_count = 1;
+    if (dimension == Dimension::Category) {
+        value_count = columns.category_dictionary.size() + 1;
+    } else if (dimension == Dimension::Source) {
+        value_count = columns.source_dictionary.size() + 1;
+    }
+    std::vector<Statistics> cells(month_count * value_count + 1);
+    auto unmatched_cell = cells.size() - 1;
+
+    const auto* months = columns.months.data();
+    const auto* categories = columns.categories.data();
+    const auto* sources = columns.sources.data();
+    // missing values have the largest code, so clamping puts them in the last value
+    auto missing_value = static_cast<int>(value_count - 1);
+    for (size_t i = 0; i < size; ++i) {
+        int value = 0;
+        if (dimension == Dimension::Category) {
+            value = std::min<int>(categories[i], missing_value);
+        } else if (dimension == Dimension::Source) {
+            value = std::min<int>(sources[i], missing_value);
+        }
+        auto month_offset = is_by_month ? static_cast<int64_t>(months[i]) - first_month : 0;
+        bool is_match = matches(i) & (month_offset >= 0) & (month_offset < month_count);
+        auto cell = is_match ? month_offset * value_count + value : unmatched_cell;
+
+        auto sentiment = sentiments[i];
+        bool has_sentiment = sentiment == sentiment;
+        cells[cell].count += 1;
+        cells[cell].sentiment_count += has_sentiment;
+        cells[cell].sentiment_sum += has_sentiment ? sentiment : 0.0;
+        if (has_sentiment && cell != unmatched_cell) {
+            cells[cell].sentiment_sketch.add(sentiment);
+        }
+    }
+
+    for (size_t cell = 0; cell < unmatched_cell; ++cell) {
+        if (cells[cell].count == 0) {
+            continue;
+        }
+        auto month =
+            is_by_month ? first_month + static_cast<int32_t>(cell / value_count) : NO_MONTH;
+        auto value = static_cast<int>(cell % value_count);
+        if (dimension == Dimension::None) {
+            value = ANY_VALUE;
+        } else if (value == missing_value) {
+            value = dimension == Dimension::Category ? MISSING_CATEGORY : MISSING_SOURCE;
+        }
+        groups.push_back({month, value, cells[cell]});
+    }
+    return groups;
+}
+
+auto ComplaintColumnStore::count_sentiment_buckets(const Columns& columns, const Filter& filter,
+                                                   const std::vector<double>& boundaries)
+    -> std::vector<long long int> {
+    std::vector<long long int> counts(std::max<size_t>(boundaries.size(), 1), 0);
+    if (filter.matches_nothing || boundaries.size() < 2) {
+        return counts;
+    }
+    RowMatcher matches(columns, filter);
+    const auto* sentiments = columns.sentiments.data();
+    auto size = columns.size();
+    for (size_t i = 0; i < size; ++i) {
+        if (!matches(i)) {
+            continue;
+        }
+        auto sentiment = sentiments[i];
+        // NaN fails both comparisons, like a missing sentiment falls to $bucket's default
+        if (!(sentiment >= boundaries.front() && sentiment < boundaries.back())) {
+            counts.back()++;
+            continue;
+        }
+        auto bucket = std::upper_bound(boundaries.begin(), boundaries.end(), sentiment) -
+                      boundaries.begin() - 1;
+        counts[bucket]++;
+    }
+    return counts;
+}
+
+auto ComplaintColumnStore::_get_month(const int64_t& date) -> int32_t {
+    // floor division, so dates before 1970 fall in the right day
+    auto days = date / MILLISECONDS_PER_DAY - (date % MILLISECONDS_PER_DAY < 0 ? 1 : 0);
+    long long int year;
+    unsigned int month;
+    unsigned int day;
+    DateUtils::_civil_from_days(days, year, month, day);
+    // saturates for filter bounds near the ends of int64, and never returns NO_MONTH
+    auto months = (year - 1970) * 12 + month - 1;
+    return static_cast<int32_t>(std::max<long long int>(
+        std::min<long long int>(months, std::numeric_limits<int32_t>::max()), NO_MONTH + 1));
+}
+
+void ComplaintColumnStore::_run_loader() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        changed.wait(lock,
+                     [this]() { return is_stopping || loaded_change_count != change_count; });
+        _wait_for_changes_to_settle(lock);
+        if (is_stopping) {
+            return;
+        }
+        lock.unlock();
+        try {
+            refresh();
+            lock.lock();
+        } catch (const std::exception& e) {
+            std::cout << "[ComplaintColumnStore] Cannot load complaints, reading them from the "
+                         "database until they load: "
+                      << e.what() << std::endl;
+            lock.lock();
+            changed.wait_for(lock, std::chrono::milliseconds(Constants::COLLECTION_WATCH_RETRY_MS),
+                             [this]() { return is_stopping; });
+        }
+    }
+}
+
+void ComplaintColumnStore::_wait_for_changes_to_settle(std::unique_lock<std::mutex>& lock) {
+    while (!is_stopping) {
+        auto reload_at =
+            std::min(last_change_at + RELOAD_QUIET_PERIOD, unloaded_since + MAX_RELOAD_DELAY);
+        if (std::chrono::steady_clock::now() >= reload_at) {
+            return;
+        }
+        changed.wait_until(lock, reload_at);
+    }
+}
+
+void ComplaintColumnStore::_poll() {
+    auto version = _read_version();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (version == loaded_version) {
+            return;
+        }
+    }
+    mark_changed();
+}
+
+auto ComplaintColumnStore::_read_version() -> std::string {
+    auto count = db_manager->count_documents(Constants::COLLECTION_COMPLAINTS, {});
+    mongocxx::options::find option;
+    option.projection(make_document(kvp("_id", 1)));
+    option.sort(make_document(kvp("_id", -1)));
+    auto last = db_manager->find_one(Constants::COLLECTION_COMPLAINTS, {}, option);
+    // inserts move the largest _id and deletes the count; updates only show up when reported
+    return std::to_string(count) + " " + (last ? bsoncxx::to_json(last->view()) : "");
+}
@@ -0,0 +1,391 @@
+#include "complaint_rollup_manager.hpp"
+
+#include <algorithm>
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/json.hpp>
+#include <bsoncxx/types.hpp>
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+#include "date_utils.hpp"
+#include "sentiment_sketch.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
+using bsoncxx::builder::basic::make_document;
+
+static const long long int MILLISECONDS_PER_DAY = 24LL * 60 * 60 * 1000;
+static const int MAX_UPDATE_ATTEMPTS = 5;
+// the fields a complaint's contribution to the rollups is computed from
+static const char* const ROLLUP_FIELDS[] = {"date", "category", "source", "sentiment"};
+
+static auto get_sentiment(const bsoncxx::document::view& complaint, double& sentiment) -> bool {
+    auto element = complaint["sentiment"];
+    if (!element) {
+        return false;
+    }
+    switch (element.type()) {
+        case bsoncxx::type::k_double:
+            sentiment = element.get_double().value;
+            return true;
+        case bsoncxx::type::k_int32:
+            sentiment = element.get_int32().value;
+            return true;
+        case bsoncxx::type::k_int64:
+            sentiment = static_cast<double>(element.get_int64().value);
+            return true;
+        default:
+            return false;
+    }
+}
+
+ComplaintRollupManager::ComplaintRollupManager(std::shared_ptr<DatabaseManager> db_manager)
+    : db_manager{db_manager} {}
+
+std::shared_ptr<ComplaintRollupManager> ComplaintRollupManager::create_from_env(
+    std::shared_ptr<DatabaseManager> db_manager, EnvManager env_manager) {
+    auto COMPLAINT_ROLLUPS_ENABLED = env_manager.read_env(
+        "COMPLAINT_ROLLUPS_ENABLED", Constants::DEFAULT_COMPLAINT_ROLLUPS_ENABLED);
+    if (COMPLAINT_ROLLUPS_ENABLED != "true") {
+        return nullptr;
+    }
+    return std::make_shared<ComplaintRollupManager>(db_manager);
+}
+
+void ComplaintRollupManager::apply_inserts(const std::vector<bsoncxx::document::view>& complaints) {
+    std::map<std::string, Contribution> contributions;
+    for (const auto& complaint : complaints) {
+        _add_contribution(complaint, 1, contributions);
+    }
+    _apply(contributions);
+}
+
+auto ComplaintRollupManager::delete_many(const bsoncxx::document::view& filter)
+    -> long long int {
+    bsoncxx::builder::basic::document projection;
+    for (const auto* field : ROLLUP_FIELDS) {
+        projection.append(kvp(field, 1));
+    }
+    mongocxx::options::find option;
+    option.projection(projection.extract());
+
+    std::map<std::string, Contribution> contributions;
+    bsoncxx::builder::basic::array oids;
+    long long int found_count = 0;
+    for (auto&& complaint : db_manager->find(Constants::COLLECTION_COMPLAINTS, filter, option)) {
+        _add_contribution(complaint, -1, contributions);
+        oids.append(complaint["_id"].get_value());
+        ++found_count;
+    }
+    if (found_count == 0) {
+        return 0;
+    }
+
+    // complaints already deleted by another write were not found, and that write took them out
+    // of the rollups itself
+    auto result = db_manager->delete_many(
+        Constants::COLLECTION_COMPLAINTS,
+        make_document(kvp("_id", make_document(kvp("$in", oids.extract())))).view());
+    long long int deleted_count = result ? result.value().deleted_count() : 0;
+    if (deleted_count != found_count) {
+        // one got in between the find and the delete; which one is unknown, so the rollups are
+        // left to the count check of rebuild_if_out_of_sync
+        std::cout << "[ComplaintRollupManager] Deleted " << deleted_count << " of " << found_count
+                  << " complaints found, rebuild the rollups to catch up." << std::endl;
+    }
+    _apply_or_log(contributions);
+    return deleted_count;
+}
+
+auto ComplaintRollupManager::update_one(const bsoncxx::document::view& filter,
+                                        const bsoncxx::document::view& update_document)
+    -> UpdateResult {
+    mongocxx::options::find_one_and_update option;
+    option.return_document(mongocxx::options::return_document::k_after);
+    for (int attempt = 0; attempt < MAX_UPDATE_ATTEMPTS; ++attempt) {
+        auto before = db_manager->find_one(Constants::COLLECTION_COMPLAINTS, filter);
+        if (!before) {
+            return {0, 0};
+        }
+        auto after = db_manager->find_one_and_update(Constants::COLLECTION_COMPLAINTS,
+                                                     _make_unchanged_filter(before->view()).view(),
+                                                     update_document, option);
+        if (!after) {
+            continue;
+        }
+
+        std::map<std::string, Contribution> contributions;
+        _add_contribution(before->view(), -1, contributions);
+        _add_contribution(after->view(), 1, contributions);
+        _apply_or_log(contributions);
+        return {1, before->view() == after->view() ? 0 : 1};
+    }
+    throw std::runtime_error("The complaint kept changing while it was being updated.");
+}
+
+auto ComplaintRollupManager::rebuild() -> long long int {
+    auto month_start = make_document(
+        kvp("$dateFromParts", make_document(kvp("year", make_document(kvp("$year", "$date"))),
+                                            kvp("month", make_document(kvp("$month", "$date"))))));
+    auto is_number = make_document(kvp("$isNumber", "$sentiment"));
+    auto sentiment_count = make_document(kvp("$cond", make_array(is_number.view(), 1, 0)));
+    auto sentiment_square = make_document(kvp("$multiply", make_array("$sentiment", "$sentiment")));
+    // $min and $max skip nulls, so non-numeric sentiments do not count towards the range
+    auto numeric_sentiment = make_document(
+        kvp("$cond", make_array(is_number.view(), "$sentiment", bsoncxx::types::b_null())));
+    auto bin = SentimentSketch::make_bin_expression("$sentiment");
+
+    // per key and sentiment bin first, then per key with the bins gathered into a histogram
+    mongocxx::pipeline pipeline;
+    pipeline.match(make_document(kvp("date", make_document(kvp("$type", "date")))));
+    pipeline.group(make_document(
+        kvp("_id", make_document(kvp("date", month_start.view()), kvp("category", "$category"),
+                                 kvp("source", "$source"), kvp("bin", bin.view()))),
+        kvp("count", make_document(kvp("$sum", 1))),
+        kvp("sentiment_count", make_document(kvp("$sum", sentiment_count.view()))),
+        kvp("sentiment_sum", make_document(kvp("$sum", "$sentiment"))),
+        kvp("sentiment_sum_of_squares", make_document(kvp("$sum", sentiment_square.view()))),
+        kvp("sentiment_min", make_document(kvp("$min", numeric_sentiment.view()))),
+        kvp("sentiment_max", make_document(kvp("$max", numeric_sentiment.view())))));
+    pipeline.group(make_document(
+        kvp("_id", make_document(kvp("date", "$_id.date"), kvp("category", "$_id.category"),
+                                 kvp("source", "$_id.source"))),
+        kvp("count", make_document(kvp("$sum", "$count"))),
+        kvp("sentiment_count", make_document(kvp("$sum", "$sentiment_count"))),
+        kvp("sentiment_sum", make_document(kvp("$sum", "$sentiment_sum"))),
+        kvp("sentiment_sum_of_squares", make_document(kvp("$sum", "$sentiment_sum_of_squares"))),
+        kvp("sentiment_min", make_document(kvp("$min", "$sentiment_min"))),
+        kvp("sentiment_max", make_document(kvp("$max", "$sentiment_max"))),
+        kvp("bins", make_document(kvp("$push", make_document(kvp("k", "$_id.bin"),
+                                                             kvp("v", "$sentiment_count")))))));
+    // { "<bin>": count } for the bins of numeric sentiments
+    auto is_sentiment_bin =
+        make_document(kvp("$ne", make_array("$$this.k", bsoncxx::types::b_null())));
+    auto sentiment_bins = make_document(kvp(
+        "$filter", make_document(kvp("input", "$bins"), kvp("cond", is_sentiment_bin.view()))));
+    auto bin_entry = make_document(kvp("k", make_document(kvp("$toString", "$$this.k"))),
+                                   kvp("v", "$$this.v"));
+    auto histogram = make_document(
+        kvp("$arrayToObject", make_document(kvp(
+                                  "$map", make_document(kvp("input", sentiment_bins.view()),
+                                                        kvp("in", bin_entry.view()))))));
+    // a range of no sentiments is left out rather than null, which $min would keep
+    auto unless_null = [](const std::string& path) {
+        return make_document(kvp("$ifNull", make_array(path, "$$REMOVE")));
+    };
+    pipeline.project(make_document(
+        kvp("_id", 0), kvp("date", "$_id.date"), kvp("category", "$_id.category"),
+        kvp("source", "$_id.source"), kvp("count", 1), kvp("sentiment_count", 1),
+        kvp("sentiment_sum", 1), kvp("sentiment_sum_of_squares", 1),
+        kvp("sentiment_min", unless_null("$sentiment_min")),
+        kvp("sentiment_max", unless_null("$sentiment_max")),
+        kvp("sentiment_histogram", histogram.view())));
+    // $out swaps the collection in once it is complete and keeps its indexes
+    pipeline.out(Constants::COLLECTION_COMPLAINT_ROLLUPS);
+
+    for (auto&& doc : db_manager->aggregate(Constants::COLLECTION_COMPLAINTS, pipeline)) {
+        (void)doc;
+    }
+    return db_manager->count_documents(Constants::COLLECTION_COMPLAINT_ROLLUPS, {});
+}
+
+void ComplaintRollupManager::rebuild_if_out_of_sync() {
+    auto complaint_count = db_manager->count_documents(
+        Constants::COLLECTION_COMPLAINTS,
+        make_document(kvp("date", make_document(kvp("$type", "date")))).view());
+
+    mongocxx::pipeline pipeline;
+    pipeline.group(make_document(kvp("_id", bsoncxx::types::b_null()),
+                                 kvp("count", make_document(kvp("$sum", "$count")))));
+    long long int rollup_complaint_count = 0;
+    for (auto&& doc : db_manager->aggregate(Constants::COLLECTION_COMPLAINT_ROLLUPS, pipeline)) {
+        auto count = doc["count"];
+        rollup_complaint_count = count.type() == bsoncxx::type::k_int32
+                                     ? count.get_int32().value
+                                     : count.get_int64().value;
+    }
+    // rollups written before they kept sentiment histograms or ranges have none
+    auto is_missing = make_document(kvp("$exists", false));
+    auto rollups_without_histogram_count = db_manager->count_documents(
+        Constants::COLLECTION_COMPLAINT_ROLLUPS,
+        make_document(
+            kvp("sentiment_count", make_document(kvp("$gt", 0))),
+            kvp("$or", make_array(make_document(kvp("sentiment_histogram", is_missing.view())),
+                                  make_document(kvp("sentiment_min", is_missing.view())))))
+            .view());
+    if (complaint_count == rollup_complaint_count && rollups_without_histogram_count == 0) {
+        return;
+    }
+
+    auto rollup_count = rebuild();
+    std::cout << "[ComplaintRollupManager] Rebuilt " << rollup_count << " rollups of "
+              << complaint_count << " complaints" << std::endl;
+}
+
+auto ComplaintRollupManager::_make_key(const bsoncxx::document::view& complaint)
+    -> bsoncxx::stdx::optional<bsoncxx::document::value> {
+    auto date = complaint["date"];
+    if (!date || date.type() != bsoncxx::type::k_date) {
+        return bsoncxx::stdx::nullopt;
+    }
+    bsoncxx::builder::basic::document key;
+    key.append(kvp("date", _get_month_start(date.get_date())));
+    // a missing field is keyed as null, which matches the rollups rebuild() leaves it out of
+    for (const auto* field : {"category", "source"}) {
+        auto value = complaint[field];
+        if (value) {
+            key.append(kvp(field, value.get_value()));
+        } else {
+            key.append(kvp(field, bsoncxx::types::b_null()));
+        }
+    }
+    return key.extract();
+}
+
+auto ComplaintRollupManager::_get_month_start(const bsoncxx::types::b_date& date)
+    -> bsoncxx::types::b_date {
+    auto milliseconds = date.to_int64();
+    // floor division, so dates before 1970 fall in the right day
+    auto days = milliseconds / MILLISECONDS_PER_DAY -
+                (milliseconds % MILLISECONDS_PER_DAY < 0 ? 1 : 0);
+    long long int year;
+    unsigned int month;
+    unsigned int day;
+    DateUtils::_civil_from_days(days, year, month, day);
+    auto month_start_days = DateUtils::_days_from_civil(year, month, 1);
+    return bsoncxx::types::b_date{
+        std::chrono::milliseconds(month_start_days * MILLISECONDS_PER_DAY)};
+}
+
+void ComplaintRollupManager::_add_contribution(
+    const bsoncxx::document::view& complaint, const int& sign,
+    std::map<std::string, Contribution>& contributions) {
+    auto key = _make_key(complaint);
+    if (!key) {
+        return;
+    }
+    auto key_json = bsoncxx::to_json(key->view());
+    auto it = contributions.find(key_json);
+    if (it == contributions.end()) {
+        it = contributions
+                 .emplace(key_json, Contribution{std::move(*key), 0, 0, 0, 0, {},
+                                                 std::numeric_limits<double>::infinity(),
+                                                 -std::numeric_limits<double>::infinity(), false})
+                 .first;
+    }
+    auto& contribution = it->second;
+    contribution.count += sign;
+    double sentiment;
+    if (get_sentiment(complaint, sentiment)) {
+        contribution.sentiment_count += sign;
+        contribution.sentiment_sum += sign * sentiment;
+        contribution.sentiment_sum_of_squares += sign * sentiment * sentiment;
+        contribution.sentiment_histogram[SentimentSketch::get_bin(sentiment)] += sign;
+        if (sign > 0) {
+            contribution.sentiment_min = std::min(contribution.sentiment_min, sentiment);
+            contribution.sentiment_max = std::max(contribution.sentiment_max, sentiment);
+        } else {
+            contribution.has_removed_sentiment = true;
+        }
+    }
+}
+
+void ComplaintRollupManager::_apply_or_log(
+    const std::map<std::string, Contribution>& contributions) {
+    try {
+        _apply(contributions);
+    } catch (const std::exception& e) {
+        std::cout << "[ComplaintRollupManager] Cannot update rollups, rebuild them to catch up: "
+                  << e.what() << std::endl;
+    }
+}
+
+auto ComplaintRollupManager::_make_unchanged_filter(const bsoncxx::document::view& complaint)
+    -> bsoncxx::document::value {
+    bsoncxx::builder::basic::document filter;
+    filter.append(kvp("_id", complaint["_id"].get_value()));
+    for (const auto* field : ROLLUP_FIELDS) {
+        auto value = complaint[field];
+        if (value) {
+            filter.append(kvp(field, make_document(kvp("$eq", value.get_value()))));
+        } else {
+            filter.append(kvp(field, make_document(kvp("$exists", false))));
+        }
+    }
+    return filter.extract();
+}
+
+void ComplaintRollupManager::_apply(const std::map<std::string, Contribution>& contributions) {
+    std::vector<BulkWriteOperation> operations;
+    std::vector<const Contribution*> range_contributions;
+    for (const auto& [key_json, contribution] : contributions) {
+        // a sentiment that moves between bins of the same rollup leaves the counts unchanged
+        bool has_histogram_change = false;
+        bsoncxx::builder::basic::document increments;
+        increments.append(kvp("count", contribution.count),
+                          kvp("sentiment_count", contribution.sentiment_count),
+                          kvp("sentiment_sum", contribution.sentiment_sum),
+                          kvp("sentiment_sum_of_squares", contribution.sentiment_sum_of_squares));
+        for (const auto& [bin, count] : contribution.sentiment_histogram) {
+            if (count != 0) {
+                increments.append(kvp("sentiment_histogram." + std::to_string(bin), count));
+                has_histogram_change = true;
+            }
+        }
+        // e.g. an update that leaves the key and the sentiment of a complaint as they were
+        if (contribution.count == 0 && contribution.sentiment_count == 0 &&
+            contribution.sentiment_sum == 0 && contribution.sentiment_sum_of_squares == 0 &&
+            !has_histogram_change) {
+            continue;
+        }
+        bsoncxx::builder::basic::document update;
+        update.append(kvp("$inc", increments.extract()));
+        if (contribution.sentiment_min <= contribution.sentiment_max) {
+            update.append(
+                kvp("$min", make_document(kvp("sentiment_min", contribution.sentiment_min))),
+                kvp("$max", make_document(kvp("sentiment_max", contribution.sentiment_max))));
+        }
+        operations.push_back(
+            BulkWriteOperation::update_one(contribution.key.view(), update.view(), true));
+        if (contribution.has_removed_sentiment) {
+            range_contributions.push_back(&contribution);
+        }
+    }
+    if (operations.empty()) {
+        return;
+    }
+    auto result = db_manager->bulk_write(Constants::COLLECTION_COMPLAINT_ROLLUPS, operations);
+    if (result.count(BulkWriteItemStatus::Succeeded) != static_cast<int>(operations.size())) {
+        throw std::runtime_error("Some complaint rollups could not be updated.");
+    }
+    for (const auto* contribution : range_contributions) {
+        _recompute_sentiment_range(contribution->key.view());
+    }
+}
+
+void ComplaintRollupManager::_recompute_sentiment_range(const bsoncxx::document::view& key) {
+    auto month_start = key["date"].get_date();
+    // 32 days on is always in the next month
+    auto next_month_start = _get_month_start(bsoncxx::types::b_date{
+        month_start.value + std::chrono::milliseconds(32 * MILLISECONDS_PER_DAY)});
+    mongocxx::pipeline pipeline;
+    pipeline.match(make_document(
+        kvp("date", make_document(kvp("$gte", month_start), kvp("$lt", next_month_start))),
+        kvp("category", key["category"].get_value()), kvp("source", key["source"].get_value()),
+        kvp("sentiment", make_document(kvp("$type", "number")))));
+    pipeline.group(make_document(kvp("_id", bsoncxx::types::b_null()),
+                                 kvp("sentiment_min", make_document(kvp("$min", "$sentiment"))),
+                                 kvp("sentiment_max", make_document(kvp("$max", "$sentiment")))));
+
+    // left out rather than null when no sentiment is left, so a later $min still sets it
+    auto update = make_document(
+        kvp("$unset", make_document(kvp("sentiment_min", ""), kvp("sentiment_max", ""))));
+    for (auto&& range : db_manager->aggregate(Constants::COLLECTION_COMPLAINTS, pipeline)) {
+        update = make_document(
+            kvp("$set", make_document(kvp("sentiment_min", range["sentiment_min"].get_value()),
+                                      kvp("sentiment_max", range["sentiment_max"].get_value()))));
+    }
+    db_manager->update_one(Constants::COLLECTION_COMPLAINT_ROLLUPS, key, update.view());
+}
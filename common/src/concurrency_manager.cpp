@@ -1,10 +1,239 @@
 #include "concurrency_manager.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#include "base_api_strategy_utils.hpp"
+#include "request_context.hpp"
+
+const AdmissionPolicy ConcurrencyManager::LIGHT_ADMISSION_POLICY = {
+    Constants::ADMISSION_LIGHT_MAX_CONCURRENCY, Constants::ADMISSION_LIGHT_MAX_QUEUE_LENGTH,
+    Constants::ADMISSION_LIGHT_MAX_WAIT_MS};
+const AdmissionPolicy ConcurrencyManager::MEDIUM_ADMISSION_POLICY = {
+    Constants::ADMISSION_MEDIUM_MAX_CONCURRENCY, Constants::ADMISSION_MEDIUM_MAX_QUEUE_LENGTH,
+    Constants::ADMISSION_MEDIUM_MAX_WAIT_MS};
+const AdmissionPolicy ConcurrencyManager::HEAVY_ADMISSION_POLICY = {
+    Constants::ADMISSION_HEAVY_MAX_CONCURRENCY, Constants::ADMISSION_HEAVY_MAX_QUEUE_LENGTH,
+    Constants::ADMISSION_HEAVY_MAX_WAIT_MS};
+const AdmissionPolicy ConcurrencyManager::WRITE_ADMISSION_POLICY = {
+    Constants::ADMISSION_WRITE_MAX_CONCURRENCY, Constants::ADMISSION_WRITE_MAX_QUEUE_LENGTH,
+    Constants::ADMISSION_WRITE_MAX_WAIT_MS};
+const AdmissionPolicy ConcurrencyManager::JOB_ADMISSION_POLICY = {
+    Constants::ADMISSION_JOB_MAX_CONCURRENCY, Constants::ADMISSION_JOB_MAX_QUEUE_LENGTH,
+    Constants::ADMISSION_JOB_MAX_WAIT_MS};
+
+ConcurrencyManager::ConcurrencyManager(const int& retry_after_seconds,
+                                       std::shared_ptr<BlockingExecutor> blocking_executor)
+    : retry_after_seconds{retry_after_seconds},
+      blocking_executor{blocking_executor},
+      timer([this]() { _run_timer(); }) {}
+
+ConcurrencyManager::~ConcurrencyManager() {
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex);
+        is_stopping = true;
+    }
+    timer_changed.notify_all();
+    timer.join();
+}
+
 auto ConcurrencyManager::concurrency_protection_decorator(
-    const std::function<crow::response(const crow::request&)>& func)
-    -> std::function<crow::response(const crow::request&)> {
-    return [this, func](const crow::request& req) {
-        std::lock_guard<std::mutex> api_lock(this->mutex);
-        return func(req);
+    const std::function<crow::response(const crow::request&)>& func, const AdmissionPolicy& policy)
+    -> deferred_handler_func_type {
+    return concurrency_protection_decorator(
+        deferred_handler_func_type(
+            [func](const crow::request& req, const respond_func_type& respond) {
+                respond(func(req));
+            }),
+        policy);
+}
+
+auto ConcurrencyManager::concurrency_protection_decorator(const deferred_handler_func_type& func,
+                                                          const AdmissionPolicy& policy)
+    -> deferred_handler_func_type {
+    auto admission = std::make_shared<RouteAdmission>();
+    admission->policy = policy;
+    {
+        std::lock_guard<std::mutex> lock(timer_mutex);
+        admissions.push_back(admission);
+    }
+
+    return [this, func, admission](const crow::request& req, const respond_func_type& respond) {
+        auto is_released = std::make_shared<std::atomic<bool>>(false);
+        auto release_slot = [this, admission, is_released]() {
+            if (!is_released->exchange(true)) {
+                _release_slot(*admission);
+            }
+        };
+        auto start = [func, &req, respond, release_slot]() {
+            RequestContext::get(req)->record_stage("admitted");
+            try {
+                func(req, [release_slot, respond](crow::response res) {
+                    release_slot();
+                    respond(std::move(res));
+                });
+            } catch (...) {
+                release_slot();
+                throw;
+            }
+        };
+        // a parked request resumes on another thread, which has to serve the same context
+        auto context = RequestContext::get_current();
+        auto resume = [this, start, respond, context](bool is_admitted) {
+            RequestContext::Scope scope(context);
+            if (!is_admitted) {
+                respond(_make_overloaded_response(
+                    "Service overloaded: timed out waiting for this endpoint."));
+                return;
+            }
+            try {
+                start();
+            } catch (const std::exception& e) {
+                respond(BaseApiStrategyUtils::make_error_response(
+                    500, std::string("Server error: ") + e.what()));
+            }
+        };
+
+        switch (_acquire_slot_or_park(*admission, resume)) {
+            case Admission::Admitted:
+                start();
+                return;
+            case Admission::Parked:
+                return;
+            case Admission::Rejected:
+                respond(_make_overloaded_response(
+                    "Service overloaded: too many concurrent requests to this endpoint."));
+                return;
+        }
     };
 }
+
+auto ConcurrencyManager::_acquire_slot_or_park(RouteAdmission& admission,
+                                               std::function<void(bool)> resume) -> Admission {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<Waiter> expired;
+    Admission result;
+    {
+        std::lock_guard<std::mutex> lock(admission.mutex);
+        expired = _take_expired_waiters(admission, now);
+        if (admission.active_count < admission.policy.max_concurrency) {
+            admission.active_count++;
+            result = Admission::Admitted;
+        } else if (static_cast<int>(admission.waiters.size()) >=
+                   admission.policy.max_queue_length) {
+            // fail fast instead of growing an unbounded queue
+            result = Admission::Rejected;
+        } else {
+            admission.waiters.push_back(
+                {now + std::chrono::milliseconds(admission.policy.max_wait_ms), std::move(resume)});
+            result = Admission::Parked;
+        }
+    }
+    for (auto& waiter : expired) {
+        waiter.resume(false);
+    }
+    if (result == Admission::Parked) {
+        {
+            std::lock_guard<std::mutex> lock(timer_mutex);
+            timer_generation++;
+        }
+        timer_changed.notify_one();
+    }
+    return result;
+}
+
+void ConcurrencyManager::_release_slot(RouteAdmission& admission) {
+    std::vector<Waiter> expired;
+    bool has_next = false;
+    Waiter next;
+    {
+        std::lock_guard<std::mutex> lock(admission.mutex);
+        expired = _take_expired_waiters(admission, std::chrono::steady_clock::now());
+        if (admission.waiters.empty()) {
+            admission.active_count--;
+        } else {
+            // the slot goes to the waiter as it is, so no new request can take it in between
+            next = std::move(admission.waiters.front());
+            admission.waiters.pop_front();
+            has_next = true;
+        }
+    }
+    for (auto& waiter : expired) {
+        waiter.resume(false);
+    }
+    if (has_next) {
+        _resume(admission, std::move(next));
+    }
+}
+
+void ConcurrencyManager::_resume(RouteAdmission& admission, Waiter waiter) {
+    if (!blocking_executor) {
+        waiter.resume(true);
+        return;
+    }
+    auto resume = std::move(waiter.resume);
+    if (!blocking_executor->submit([resume]() { resume(true); })) {
+        // no worker can take it either, so the slot moves on and the request is turned away
+        _release_slot(admission);
+        resume(false);
+    }
+}
+
+auto ConcurrencyManager::_take_expired_waiters(RouteAdmission& admission,
+                                               const std::chrono::steady_clock::time_point& now)
+    -> std::vector<Waiter> {
+    std::vector<Waiter> expired;
+    while (!admission.waiters.empty() && admission.waiters.front().deadline <= now) {
+        expired.push_back(std::move(admission.waiters.front()));
+        admission.waiters.pop_front();
+    }
+    return expired;
+}
+
+void ConcurrencyManager::_run_timer() {
+    std::unique_lock<std::mutex> lock(timer_mutex);
+    while (!is_stopping) {
+        auto next_deadline = std::chrono::steady_clock::time_point::max();
+        for (const auto& admission : admissions) {
+            std::lock_guard<std::mutex> admission_lock(admission->mutex);
+            if (!admission->waiters.empty()) {
+                next_deadline = std::min(next_deadline, admission->waiters.front().deadline);
+            }
+        }
+        // woken early when a request is parked, since its deadline may come first
+        auto generation = timer_generation;
+        auto is_woken = [this, generation]() {
+            return is_stopping || timer_generation != generation;
+        };
+        if (next_deadline == std::chrono::steady_clock::time_point::max()) {
+            timer_changed.wait(lock, is_woken);
+        } else {
+            timer_changed.wait_until(lock, next_deadline, is_woken);
+        }
+        if (is_stopping) {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::vector<Waiter> expired;
+        for (const auto& admission : admissions) {
+            std::lock_guard<std::mutex> admission_lock(admission->mutex);
+            for (auto& waiter : _take_expired_waiters(*admission, now)) {
+                expired.push_back(std::move(waiter));
+            }
+        }
+        lock.unlock();
+        for (auto& waiter : expired) {
+            waiter.resume(false);
+        }
+        lock.lock();
+    }
+}
+
+auto ConcurrencyManager::_make_overloaded_response(const std::string& message) -> crow::response {
+    auto res = BaseApiStrategyUtils::make_error_response(503, message);
+    res.add_header("Retry-After", std::to_string(retry_after_seconds));
+    return res;
+}
@@ -2,45 +2,140 @@
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <algorithm>
 #include <mongocxx/client.hpp>
+#include <mongocxx/exception/bulk_write_exception.hpp>
 #include <mongocxx/instance.hpp>
+#include <mongocxx/model/write.hpp>
+#include <mongocxx/pool.hpp>
+#include <string>
 #include <vector>
 
 #include "constants.hpp"
 #include "crow.h"
 #include "env_manager.hpp"
 
+PooledCursor::PooledCursor(mongocxx::pool::entry client, mongocxx::cursor cursor)
+    : client{std::move(client)}, cursor{std::move(cursor)} {}
+
+auto PooledCursor::begin() -> mongocxx::cursor::iterator { return cursor.begin(); }
+
+auto PooledCursor::end() -> mongocxx::cursor::iterator { return cursor.end(); }
+
+PooledCursor::operator mongocxx::cursor&() { return cursor; }
+
+PooledChangeStream::PooledChangeStream(mongocxx::pool::entry client,
+                                       mongocxx::change_stream change_stream)
+    : client{std::move(client)}, change_stream{std::move(change_stream)} {}
+
+auto PooledChangeStream::begin() -> mongocxx::change_stream::iterator {
+    return change_stream.begin();
+}
+
+auto PooledChangeStream::end() -> mongocxx::change_stream::iterator {
+    return change_stream.end();
+}
+
+auto BulkWriteOperation::insert_one(const bsoncxx::document::view& document)
+    -> BulkWriteOperation {
+    return {BulkWriteOperationType::InsertOne, bsoncxx::document::value{document},
+            bsoncxx::document::value{bsoncxx::document::view{}}, false};
+}
+
+auto BulkWriteOperation::update_one(const bsoncxx::document::view& filter,
+                                    const bsoncxx::document::view& update_document,
+                                    const bool& upsert) -> BulkWriteOperation {
+    return {BulkWriteOperationType::UpdateOne, bsoncxx::document::value{filter},
+            bsoncxx::document::value{update_document}, upsert};
+}
+
+auto BulkWriteOperation::update_many(const bsoncxx::document::view& filter,
+                                     const bsoncxx::document::view& update_document,
+                                     const bool& upsert) -> BulkWriteOperation {
+    return {BulkWriteOperationType::UpdateMany, bsoncxx::document::value{filter},
+            bsoncxx::document::value{update_document}, upsert};
+}
+
+auto BulkWriteOperation::replace_one(const bsoncxx::document::view& filter,
+                                     const bsoncxx::document::view& replacement,
+                                     const bool& upsert) -> BulkWriteOperation {
+    return {BulkWriteOperationType::ReplaceOne, bsoncxx::document::value{filter},
+            bsoncxx::document::value{replacement}, upsert};
+}
+
+auto BulkWriteOperation::delete_one(const bsoncxx::document::view& filter)
+    -> BulkWriteOperation {
+    return {BulkWriteOperationType::DeleteOne, bsoncxx::document::value{filter},
+            bsoncxx::document::value{bsoncxx::document::view{}}, false};
+}
+
+auto BulkWriteOperation::delete_many(const bsoncxx::document::view& filter)
+    -> BulkWriteOperation {
+    return {BulkWriteOperationType::DeleteMany, bsoncxx::document::value{filter},
+            bsoncxx::document::value{bsoncxx::document::view{}}, false};
+}
+
+auto BulkWriteResult::count(const BulkWriteItemStatus& status) const -> int {
+    return std::count_if(
+        item_results.begin(), item_results.end(),
+        [&status](const BulkWriteItemResult& item_result) { return item_result.status == status; });
+}
+
 mongocxx::instance DatabaseManager::instance{};
 
-DatabaseManager::DatabaseManager(const std::string& uri, const std::string& db_name)
-    : client{mongocxx::uri{uri}}, db{client[db_name]} {}
+DatabaseManager::DatabaseManager(const std::string& uri, const std::string& db_name,
+                                 const int& pool_max_size, const int& pool_wait_timeout_ms)
+    : pool{_create_pool_uri(uri, pool_max_size, pool_wait_timeout_ms)}, db_name{db_name} {}
 
 std::shared_ptr<DatabaseManager> DatabaseManager::create_from_env(EnvManager env_manager) {
     auto MONGO_URI = env_manager.read_env("MONGO_URI", Constants::MONGO_URI);
     auto DB_NAME = env_manager.read_env("DB_NAME", Constants::DB_NAME);
-    return std::make_shared<DatabaseManager>(MONGO_URI, DB_NAME);
+    auto MONGO_POOL_MAX_SIZE =
+        stoi(env_manager.read_env("MONGO_POOL_MAX_SIZE", Constants::DEFAULT_MONGO_POOL_MAX_SIZE));
+    auto MONGO_POOL_WAIT_TIMEOUT_MS = stoi(env_manager.read_env(
+        "MONGO_POOL_WAIT_TIMEOUT_MS", Constants::DEFAULT_MONGO_POOL_WAIT_TIMEOUT_MS));
+    return std::make_shared<DatabaseManager>(MONGO_URI, DB_NAME, MONGO_POOL_MAX_SIZE,
+                                             MONGO_POOL_WAIT_TIMEOUT_MS);
+}
+
+auto DatabaseManager::_create_pool_uri(const std::string& uri, const int& pool_max_size,
+                                       const int& pool_wait_timeout_ms) -> mongocxx::uri {
+    // mongodb://host:port has no path, so the options need a leading "/" before the "?"
+    std::string separator = "&";
+    if (uri.find('?') == std::string::npos) {
+        auto scheme_end = uri.find("://");
+        auto hosts_start = scheme_end == std::string::npos ? 0 : scheme_end + 3;
+        separator = uri.find('/', hosts_start) == std::string::npos ? "/?" : "?";
+    }
+
+    return mongocxx::uri{uri + separator + "maxPoolSize=" + std::to_string(pool_max_size) +
+                         "&waitQueueTimeoutMS=" + std::to_string(pool_wait_timeout_ms)};
 }
 
 auto DatabaseManager::find_one(const std::string& collection_name,
                                const bsoncxx::document::view& filter,
                                const mongocxx::options::find& option)
     -> bsoncxx::stdx::optional<bsoncxx::document::value> {
-    auto collection = db[collection_name];
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
     return collection.find_one(filter, option);
 }
 
 auto DatabaseManager::find(const std::string& collection_name,
                            const bsoncxx::document::view& filter,
-                           const mongocxx::options::find& option) -> mongocxx::cursor {
-    auto collection = db[collection_name];
-    return collection.find(filter, option);
+                           const mongocxx::options::find& option) -> PooledCursor {
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
+    auto cursor = collection.find(filter, option);
+    return PooledCursor{std::move(client), std::move(cursor)};
 }
 
 auto DatabaseManager::insert_one(const std::string& collection_name,
                                  const bsoncxx::document::view& document,
                                  const mongocxx::options::insert& option)
     -> bsoncxx::stdx::optional<mongocxx::result::insert_one> {
-    auto collection = db[collection_name];
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
     return collection.insert_one(document, option);
 }
 
@@ -48,7 +143,8 @@ auto DatabaseManager::insert_many(const std::string& collection_name,
                                   const std::vector<bsoncxx::document::value>& documents,
                                   const mongocxx::options::insert& option)
     -> bsoncxx::stdx::optional<mongocxx::result::insert_many> {
-    auto collection = db[collection_name];
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
     return collection.insert_many(documents, option);
 }
 
@@ -56,7 +152,8 @@ auto DatabaseManager::delete_one(const std::string& collection_name,
                                  const bsoncxx::document::view& filter,
                                  const mongocxx::options::delete_options& option)
     -> bsoncxx::stdx::optional<mongocxx::result::delete_result> {
-    auto collection = db[collection_name];
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
     return collection.delete_one(filter, option);
 }
 
@@ -64,7 +161,8 @@ auto DatabaseManager::delete_many(const std::string& collection_name,
                                   const bsoncxx::document::view& filter,
                                   const mongocxx::options::delete_options& option)
     -> bsoncxx::stdx::optional<mongocxx::result::delete_result> {
-    auto collection = db[collection_name];
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
     return collection.delete_many(filter, option);
 }
 
@@ -73,7 +171,8 @@ auto DatabaseManager::update_one(const std::string& collection_name,
                                  const bsoncxx::document::view& update_document,
                                  const mongocxx::options::update& option)
     -> bsoncxx::stdx::optional<mongocxx::result::update> {
-    auto collection = db[collection_name];
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
     return collection.update_one(filter, update_document, option);
 }
 
@@ -82,20 +181,211 @@ auto DatabaseManager::update_many(const std::string& collection_name,
                                   const bsoncxx::document::view& update_document,
                                   const mongocxx::options::update& option)
     -> bsoncxx::stdx::optional<mongocxx::result::update> {
-    auto collection = db[collection_name];
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
     return collection.update_many(filter, update_document, option);
 }
 
+auto DatabaseManager::find_one_and_update(const std::string& collection_name,
+                                          const bsoncxx::document::view& filter,
+                                          const bsoncxx::document::view& update_document,
+                                          const mongocxx::options::find_one_and_update& option)
+    -> bsoncxx::stdx::optional<bsoncxx::document::value> {
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
+    return collection.find_one_and_update(filter, update_document, option);
+}
+
 auto DatabaseManager::count_documents(const std::string& collection_name,
                                       const bsoncxx::document::view& filter,
                                       const mongocxx::options::count& option) -> long long int {
-    auto collection = db[collection_name];
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
     return collection.count_documents(filter, option);
 }
 
 auto DatabaseManager::aggregate(const std::string& collection_name,
                                 const mongocxx::pipeline& pipeline,
-                                const mongocxx::options::aggregate& option) -> mongocxx::cursor {
-    auto collection = db[collection_name];
-    return collection.aggregate(pipeline, option);
+                                const mongocxx::options::aggregate& option) -> PooledCursor {
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
+    auto cursor = collection.aggregate(pipeline, option);
+    return PooledCursor{std::move(client), std::move(cursor)};
+}
+
+auto DatabaseManager::watch(const std::string& collection_name,
+                            const mongocxx::options::change_stream& option)
+    -> PooledChangeStream {
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
+    auto change_stream = collection.watch(option);
+    return PooledChangeStream{std::move(client), std::move(change_stream)};
+}
+
+auto DatabaseManager::create_index(const std::string& collection_name,
+                                   const bsoncxx::document::view& keys,
+                                   const bsoncxx::document::view& index_options)
+    -> bsoncxx::document::value {
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
+    return collection.create_index(keys, index_options);
+}
+
+auto DatabaseManager::list_indexes(const std::string& collection_name)
+    -> std::vector<bsoncxx::document::value> {
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
+    std::vector<bsoncxx::document::value> indexes;
+    for (auto&& index : collection.list_indexes()) {
+        indexes.emplace_back(index);
+    }
+    return indexes;
+}
+
+auto DatabaseManager::bulk_write(const std::string& collection_name,
+                                 const std::vector<BulkWriteOperation>& operations,
+                                 const int& chunk_size) -> BulkWriteResult {
+    if (chunk_size <= 0) {
+        throw std::invalid_argument("Bulk write chunk size must be positive.");
+    }
+
+    BulkWriteResult result;
+    result.item_results.resize(operations.size());
+    if (operations.empty()) {
+        return result;
+    }
+
+    auto client = pool.acquire();
+    auto collection = (*client)[db_name][collection_name];
+
+    mongocxx::options::bulk_write option;
+    option.ordered(false);
+
+    for (size_t chunk_start = 0; chunk_start < operations.size(); chunk_start += chunk_size) {
+        auto chunk_end = std::min(operations.size(), chunk_start + chunk_size);
+
+        auto bulk = collection.create_bulk_write(option);
+        for (auto i = chunk_start; i < chunk_end; ++i) {
+            _append_bulk_write_operation(bulk, operations[i]);
+        }
+
+        try {
+            auto chunk_result = bulk.execute();
+            if (chunk_result) {
+                result.inserted_count += chunk_result->inserted_count();
+                result.matched_count += chunk_result->matched_count();
+                result.modified_count += chunk_result->modified_count();
+                result.deleted_count += chunk_result->deleted_count();
+                result.upserted_count += chunk_result->upserted_count();
+            }
+        } catch (const mongocxx::bulk_write_exception& e) {
+            // an unordered bulk write still applies every operation that did not error
+            if (e.raw_server_error()) {
+                _record_bulk_write_errors(e.raw_server_error()->view(), chunk_start, chunk_end,
+                                          result);
+            } else {
+                for (auto i = chunk_start; i < chunk_end; ++i) {
+                    result.item_results[i] = {BulkWriteItemStatus::Failed, e.code().value(),
+                                              e.what()};
+                }
+            }
+        } catch (const mongocxx::exception& e) {
+            for (auto i = chunk_start; i < chunk_end; ++i) {
+                result.item_results[i] = {BulkWriteItemStatus::Failed, e.code().value(), e.what()};
+            }
+        }
+    }
+
+    return result;
+}
+
+void DatabaseManager::_append_bulk_write_operation(mongocxx::bulk_write& bulk,
+                                                   const BulkWriteOperation& operation) {
+    auto document = operation.document.view();
+    auto update_document = operation.update_document.view();
+
+    switch (operation.type) {
+        case BulkWriteOperationType::InsertOne:
+            bulk.append(mongocxx::model::insert_one{document});
+            break;
+        case BulkWriteOperationType::UpdateOne: {
+            mongocxx::model::update_one model{document, update_document};
+            model.upsert(operation.upsert);
+            bulk.append(model);
+            break;
+        }
+        case BulkWriteOperationType::UpdateMany: {
+            mongocxx::model::update_many model{document, update_document};
+            model.upsert(operation.upsert);
+            bulk.append(model);
+            break;
+        }
+        case BulkWriteOperationType::ReplaceOne: {
+            mongocxx::model::replace_one model{document, update_document};
+            model.upsert(operation.upsert);
+            bulk.append(model);
+            break;
+        }
+        case BulkWriteOperationType::DeleteOne:
+            bulk.append(mongocxx::model::delete_one{document});
+            break;
+        case BulkWriteOperationType::DeleteMany:
+            bulk.append(mongocxx::model::delete_many{document});
+            break;
+    }
+}
+
+void DatabaseManager::_record_bulk_write_errors(const bsoncxx::document::view& reply,
+                                                const size_t& chunk_start, const size_t& chunk_end,
+                                                BulkWriteResult& result) {
+    // the server may report counts as either 32-bit or 64-bit integers
+    auto read_count = [&reply](const std::string& key) -> long long int {
+        auto element = reply[key];
+        if (!element) {
+            return 0;
+        }
+        switch (element.type()) {
+            case bsoncxx::type::k_int32:
+                return element.get_int32().value;
+            case bsoncxx::type::k_int64:
+                return element.get_int64().value;
+            case bsoncxx::type::k_double:
+                return static_cast<long long int>(element.get_double().value);
+            default:
+                return 0;
+        }
+    };
+    result.inserted_count += read_count("nInserted");
+    result.matched_count += read_count("nMatched");
+    result.modified_count += read_count("nModified");
+    result.deleted_count += read_count("nRemoved");
+    result.upserted_count += read_count("nUpserted");
+
+    auto write_errors = reply["writeErrors"];
+    if (!write_errors || write_errors.get_array().value.empty()) {
+        // e.g. only a write concern error, so the outcome of each item is unknown
+        for (auto i = chunk_start; i < chunk_end; ++i) {
+            result.item_results[i] = {BulkWriteItemStatus::Failed, 0,
+                                      "Bulk write failed without per-item errors."};
+        }
+        return;
+    }
+
+    for (auto&& write_error : write_errors.get_array().value) {
+        auto error = write_error.get_document().value;
+        auto index = chunk_start + error["index"].get_int32().value;
+        if (index >= chunk_end) {
+            continue;
+        }
+
+        int code = error["code"].get_int32().value;
+        auto status = code == Constants::MONGO_DUPLICATE_KEY_ERROR_CODE
+                          ? BulkWriteItemStatus::DuplicateKey
+                          : BulkWriteItemStatus::Failed;
+        std::string message;
+        if (error["errmsg"]) {
+            message = std::string(error["errmsg"].get_string().value);
+        }
+        result.item_results[index] = {status, code, message};
+    }
 }
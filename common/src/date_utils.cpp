@@ -3,6 +3,7 @@
 #include <chrono>
 #include <cstdlib>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
 #include <sstream>
 
@@ -41,6 +42,13 @@ auto DateUtils::create_month_year_str(const int& month, const int& year) -> std:
 
 auto DateUtils::utc_unix_timestamp_to_string(const long long int& utc_unix_timestamp,
                                              const std::string& format) -> std::string {
+    if (format == Constants::DATETIME_FORMAT) {
+        std::string datetime(DATETIME_LENGTH, '\0');
+        if (format_datetime(utc_unix_timestamp, &datetime[0])) {
+            return datetime;
+        }
+    }
+
     std::time_t time = static_cast<std::time_t>(utc_unix_timestamp);
 
     std::tm utc_time = *std::gmtime(&time);
@@ -53,6 +61,12 @@ auto DateUtils::utc_unix_timestamp_to_string(const long long int& utc_unix_times
 
 auto DateUtils::string_to_utc_unix_timestamp(const std::string& datetime, const std::string& format)
     -> long long int {
+    long long int utc_unix_timestamp;
+    if (format == Constants::DATETIME_FORMAT &&
+        parse_datetime(datetime.data(), datetime.size(), utc_unix_timestamp)) {
+        return utc_unix_timestamp;
+    }
+
     std::tm tm = {};
     std::istringstream ss(datetime);
     ss >> std::get_time(&tm, format.c_str());
@@ -64,3 +78,125 @@ auto DateUtils::string_to_utc_unix_timestamp(const std::string& datetime, const
     std::time_t time = timegm(&tm);
     return static_cast<long long int>(time);
 }
+
+auto DateUtils::utc_unix_timestamps_to_strings(
+    const std::vector<long long int>& utc_unix_timestamps, const std::string& format)
+    -> std::vector<std::string> {
+    std::vector<std::string> datetimes;
+    datetimes.reserve(utc_unix_timestamps.size());
+    for (const auto& utc_unix_timestamp : utc_unix_timestamps) {
+        datetimes.push_back(utc_unix_timestamp_to_string(utc_unix_timestamp, format));
+    }
+    return datetimes;
+}
+
+auto DateUtils::strings_to_utc_unix_timestamps(const std::vector<std::string>& datetimes,
+                                               const std::string& format)
+    -> std::vector<long long int> {
+    std::vector<long long int> utc_unix_timestamps;
+    utc_unix_timestamps.reserve(datetimes.size());
+    for (const auto& datetime : datetimes) {
+        utc_unix_timestamps.push_back(string_to_utc_unix_timestamp(datetime, format));
+    }
+    return utc_unix_timestamps;
+}
+
+auto DateUtils::format_datetime(const long long int& utc_unix_timestamp, char* out) -> bool {
+    // floor division so times before the epoch fall on the previous day
+    long long int days = utc_unix_timestamp / 86400;
+    long long int seconds_of_day = utc_unix_timestamp % 86400;
+    if (seconds_of_day < 0) {
+        seconds_of_day += 86400;
+        days--;
+    }
+
+    long long int year;
+    unsigned int month;
+    unsigned int day;
+    _civil_from_days(days, year, month, day);
+    if (year < 1000 || year > 9999) {
+        return false;
+    }
+
+    auto write_two_digits = [](char* at, const long long int& value) {
+        at[0] = static_cast<char>('0' + value / 10);
+        at[1] = static_cast<char>('0' + value % 10);
+    };
+    write_two_digits(out, day);
+    out[2] = '-';
+    write_two_digits(out + 3, month);
+    out[5] = '-';
+    write_two_digits(out + 6, year / 100);
+    write_two_digits(out + 8, year % 100);
+    out[10] = ' ';
+    write_two_digits(out + 11, seconds_of_day / 3600);
+    out[13] = ':';
+    write_two_digits(out + 14, seconds_of_day / 60 % 60);
+    out[16] = ':';
+    write_two_digits(out + 17, seconds_of_day % 60);
+    return true;
+}
+
+auto DateUtils::parse_datetime(const char* datetime, const size_t& length,
+                               long long int& utc_unix_timestamp) -> bool {
+    if (length != DATETIME_LENGTH || datetime[2] != '-' || datetime[5] != '-' ||
+        datetime[10] != ' ' || datetime[13] != ':' || datetime[16] != ':') {
+        return false;
+    }
+
+    bool is_valid = true;
+    auto read_digits = [datetime, &is_valid](const size_t& start, const size_t& count) {
+        unsigned int value = 0;
+        for (size_t i = start; i < start + count; ++i) {
+            if (datetime[i] < '0' || datetime[i] > '9') {
+                is_valid = false;
+            }
+            value = value * 10 + static_cast<unsigned int>(datetime[i] - '0');
+        }
+        return value;
+    };
+    auto day = read_digits(0, 2);
+    auto month = read_digits(3, 2);
+    auto year = read_digits(6, 4);
+    auto hour = read_digits(11, 2);
+    auto minute = read_digits(14, 2);
+    auto second = read_digits(17, 2);
+
+    // the ranges std::get_time accepts; days past the end of a month roll over like timegm does
+    if (!is_valid || year < 1000 || month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 ||
+        minute > 59 || second > 60) {
+        return false;
+    }
+
+    utc_unix_timestamp =
+        _days_from_civil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+// Howard Hinnant's days_from_civil: days since 1970-01-01 in the proleptic Gregorian calendar.
+auto DateUtils::_days_from_civil(long long int year, const unsigned int& month,
+                                 const unsigned int& day) -> long long int {
+    year -= month <= 2;
+    long long int era = (year >= 0 ? year : year - 399) / 400;
+    auto year_of_era = static_cast<unsigned int>(year - era * 400);
+    unsigned int day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    unsigned int day_of_era =
+        year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + static_cast<long long int>(day_of_era) - 719468;
+}
+
+// Inverse of _days_from_civil.
+void DateUtils::_civil_from_days(long long int days, long long int& year, unsigned int& month,
+                                 unsigned int& day) {
+    days += 719468;
+    long long int era = (days >= 0 ? days : days - 146096) / 146097;
+    auto day_of_era = static_cast<unsigned int>(days - era * 146097);
+    unsigned int year_of_era =
+        (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    unsigned int day_of_year =
+        day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    unsigned int shifted_month = (5 * day_of_year + 2) / 153;
+    day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+    month = shifted_month < 10 ? shifted_month + 3 : shifted_month - 9;
+    year = static_cast<long long int>(year_of_era) + era * 400 + (month <= 2);
+}
@@ -0,0 +1,105 @@
+#include "entity_tag.hpp"
+
+#include <cstdio>
+#include <sstream>
+
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+static const char* const ENCODING_SUFFIXES[] = {"gzip", "zstd"};
+
+EntityTagHasher::EntityTagHasher() : hash{FNV_OFFSET_BASIS}, size{0} {}
+
+void EntityTagHasher::update(const std::string& chunk) {
+    for (unsigned char c : chunk) {
+        hash ^= c;
+        hash *= FNV_PRIME;
+    }
+    size += chunk.size();
+}
+
+auto EntityTagHasher::get_etag() const -> std::string {
+    // the length makes two bodies with colliding hashes still differ unless they also match in
+    // size
+    char buffer[48];
+    int length = std::snprintf(buffer, sizeof(buffer), "\"%016llx-%zx\"",
+                               static_cast<unsigned long long>(hash), size);
+    return std::string(buffer, length);
+}
+
+auto EntityTagUtils::compute_etag(const std::string& body) -> std::string {
+    EntityTagHasher hasher;
+    hasher.update(body);
+    return hasher.get_etag();
+}
+
+auto EntityTagUtils::add_encoding_to_etag(const std::string& etag,
+                                          const std::string& encoding_name) -> std::string {
+    if (etag.size() < 2 || etag.back() != '"') {
+        return etag;
+    }
+    return etag.substr(0, etag.size() - 1) + "-" + encoding_name + "\"";
+}
+
+auto EntityTagUtils::matches_if_none_match(const std::string& if_none_match_header,
+                                           const std::string& etag) -> bool {
+    if (if_none_match_header.empty() || etag.empty()) {
+        return false;
+    }
+    auto opaque_tag = _get_opaque_tag(etag);
+    std::stringstream stream(if_none_match_header);
+    std::string candidate;
+    while (std::getline(stream, candidate, ',')) {
+        auto start = candidate.find_first_not_of(" \t");
+        auto end = candidate.find_last_not_of(" \t");
+        if (start == std::string::npos) {
+            continue;
+        }
+        candidate = candidate.substr(start, end - start + 1);
+        if (candidate == "*" || _get_opaque_tag(candidate) == opaque_tag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto EntityTagUtils::tag_response(crow::response res) -> crow::response {
+    if (res.code == 200 && res.get_header_value("ETag").empty()) {
+        res.set_header("ETag", compute_etag(res.body));
+    }
+    return res;
+}
+
+auto EntityTagUtils::make_conditional_response(const crow::request& req, crow::response res)
+    -> crow::response {
+    auto etag = res.get_header_value("ETag");
+    if (res.code != 200 || etag.empty()) {
+        return res;
+    }
+    if (matches_if_none_match(req.get_header_value("If-None-Match"), etag)) {
+        return make_not_modified_response(etag);
+    }
+    return res;
+}
+
+auto EntityTagUtils::make_not_modified_response(const std::string& etag) -> crow::response {
+    crow::response res(304);
+    res.set_header("ETag", etag);
+    return res;
+}
+
+auto EntityTagUtils::_get_opaque_tag(const std::string& etag) -> std::string {
+    auto tag = etag.rfind("W/", 0) == 0 ? etag.substr(2) : etag;
+    if (tag.size() >= 2 && tag.front() == '"' && tag.back() == '"') {
+        tag = tag.substr(1, tag.size() - 2);
+    }
+    auto dash = tag.rfind('-');
+    if (dash != std::string::npos) {
+        auto suffix = tag.substr(dash + 1);
+        for (const auto* encoding_suffix : ENCODING_SUFFIXES) {
+            if (suffix == encoding_suffix) {
+                return tag.substr(0, dash);
+            }
+        }
+    }
+    return tag;
+}
@@ -0,0 +1,80 @@
+#include "hyper_log_log.hpp"
+
+#include <algorithm>
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <cmath>
+#include <cstdlib>
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
+using bsoncxx::builder::basic::make_document;
+
+auto HyperLogLog::make_register_expression(const std::string& path) -> bsoncxx::document::value {
+    // the low PRECISION bits of the hash, also for negative hashes whose $mod is negative
+    auto hash = make_document(kvp("$toHashedIndexKey", path));
+    auto remainder = make_document(kvp("$mod", make_array(hash.view(), REGISTER_COUNT)));
+    auto non_negative = make_document(kvp("$add", make_array(remainder.view(), REGISTER_COUNT)));
+    return make_document(
+        kvp("$toInt", make_document(kvp("$mod", make_array(non_negative.view(), REGISTER_COUNT)))));
+}
+
+auto HyperLogLog::make_rank_expression(const std::string& path) -> bsoncxx::document::value {
+    // the same operations as add_hash, with floor(log2(w)) for bit_width(w) - 1
+    auto hash = make_document(kvp("$toHashedIndexKey", path));
+    auto quotient = make_document(kvp("$divide", make_array(hash.view(), REGISTER_COUNT)));
+    auto rest = make_document(kvp("$abs", make_document(kvp("$trunc", quotient.view()))));
+    auto log2 =
+        make_document(kvp("$floor", make_document(kvp("$log", make_array(rest.view(), 2)))));
+    auto rank = make_document(kvp("$subtract", make_array(MAX_RANK - 1, log2.view())));
+    auto at_least_one = make_document(kvp("$max", make_array(1, rank.view())));
+    auto is_zero = make_document(kvp("$eq", make_array(rest.view(), 0)));
+    return make_document(kvp("$toInt", make_document(kvp("$cond", make_array(
+                                                              is_zero.view(), MAX_RANK,
+                                                              at_least_one.view())))));
+}
+
+void HyperLogLog::add_hash(const int64_t& hash) {
+    auto index = static_cast<int>(static_cast<uint64_t>(hash) & (REGISTER_COUNT - 1));
+    auto rest = static_cast<uint64_t>(std::llabs(hash / REGISTER_COUNT));
+    int bit_width = 0;
+    for (; rest > 0; rest >>= 1) {
+        bit_width++;
+    }
+    add_register(index, std::max(MAX_RANK - bit_width, 1));
+}
+
+void HyperLogLog::add_register(const int& index, const int& rank) {
+    if (index < 0 || index >= REGISTER_COUNT) {
+        return;
+    }
+    auto clamped_rank = static_cast<uint8_t>(std::min(std::max(rank, 0), MAX_RANK));
+    registers[index] = std::max(registers[index], clamped_rank);
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    for (int index = 0; index < REGISTER_COUNT; ++index) {
+        registers[index] = std::max(registers[index], other.registers[index]);
+    }
+}
+
+auto HyperLogLog::get_register(const int& index) const -> int {
+    return index >= 0 && index < REGISTER_COUNT ? registers[index] : 0;
+}
+
+auto HyperLogLog::estimate() const -> double {
+    double sum = 0;
+    int zero_count = 0;
+    for (auto rank : registers) {
+        sum += std::ldexp(1.0, -rank);
+        zero_count += rank == 0;
+    }
+    const double m = REGISTER_COUNT;
+    auto alpha = 0.7213 / (1 + 1.079 / m);
+    auto raw_estimate = alpha * m * m / sum;
+    // few distinct values leave registers empty, and counting those is more accurate
+    if (raw_estimate <= 2.5 * m && zero_count > 0) {
+        return m * std::log(m / zero_count);
+    }
+    return raw_estimate;
+}
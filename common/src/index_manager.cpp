@@ -0,0 +1,139 @@
+#include "index_manager.hpp"
+
+#include <algorithm>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <iostream>
+#include <mongocxx/exception/exception.hpp>
+#include <mongocxx/pipeline.hpp>
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+static const std::string DEFAULT_ID_INDEX_NAME = "_id_";
+
+IndexManager::IndexManager(std::shared_ptr<DatabaseManager> db_manager) : db_manager{db_manager} {}
+
+auto IndexManager::ensure_indexes(const std::vector<std::string>& collection_names,
+                                  const std::vector<IndexSpec>& index_specs) -> IndexReport {
+    IndexReport report;
+
+    for (const auto& collection_name : collection_names) {
+        auto existing_names = _get_index_names(collection_name);
+        std::vector<std::string> registered_names = {DEFAULT_ID_INDEX_NAME};
+
+        for (const auto& index_spec : index_specs) {
+            if (index_spec.collection_name != collection_name) {
+                continue;
+            }
+
+            auto name = get_index_name(index_spec);
+            registered_names.push_back(name);
+            if (std::find(existing_names.begin(), existing_names.end(), name) !=
+                existing_names.end()) {
+                report.existing.push_back(collection_name + "." + name);
+                continue;
+            }
+
+            bsoncxx::builder::basic::document keys;
+            for (const auto& [field, direction] : index_spec.keys) {
+                if (index_spec.is_text) {
+                    keys.append(kvp(field, "text"));
+                } else {
+                    keys.append(kvp(field, direction));
+                }
+            }
+            bsoncxx::builder::basic::document index_options;
+            index_options.append(kvp("name", name), kvp("unique", index_spec.unique));
+            if (index_spec.is_partial) {
+                bsoncxx::builder::basic::document partial_filter;
+                for (const auto& [field, direction] : index_spec.keys) {
+                    partial_filter.append(kvp(field, make_document(kvp("$exists", true))));
+                }
+                index_options.append(kvp("partialFilterExpression", partial_filter.extract()));
+            }
+
+            try {
+                db_manager->create_index(collection_name, keys.view(), index_options.view());
+                report.created.push_back(collection_name + "." + name);
+            } catch (const mongocxx::exception& e) {
+                std::cout << "[IndexManager] Could not create index " << collection_name << "."
+                          << name << ": " << e.what() << std::endl;
+                report.missing.push_back(collection_name + "." + name);
+            }
+        }
+
+        for (const auto& name : _get_index_names(collection_name)) {
+            if (std::find(registered_names.begin(), registered_names.end(), name) ==
+                registered_names.end()) {
+                report.unregistered.push_back(collection_name + "." + name);
+            }
+        }
+        for (const auto& name : _get_unused_index_names(collection_name)) {
+            report.unused.push_back(collection_name + "." + name);
+        }
+    }
+
+    return report;
+}
+
+auto IndexManager::get_index_name(const IndexSpec& index_spec) -> std::string {
+    // matches the name mongod generates, so indexes created by hand are recognised
+    std::string name;
+    for (const auto& [field, direction] : index_spec.keys) {
+        if (!name.empty()) {
+            name += "_";
+        }
+        name += field + "_" + (index_spec.is_text ? "text" : std::to_string(direction));
+    }
+    return name;
+}
+
+void IndexManager::log_report(const IndexReport& report) {
+    auto log_names = [](const std::string& label, const std::vector<std::string>& names) {
+        for (const auto& name : names) {
+            std::cout << "[IndexManager] " << label << ": " << name << std::endl;
+        }
+    };
+    log_names("Created index", report.created);
+    log_names("Missing index", report.missing);
+    log_names("Unregistered index", report.unregistered);
+    log_names("Unused index", report.unused);
+    std::cout << "[IndexManager] " << report.existing.size() + report.created.size() << " of "
+              << report.existing.size() + report.created.size() + report.missing.size()
+              << " registered indexes present." << std::endl;
+}
+
+auto IndexManager::_get_index_names(const std::string& collection_name)
+    -> std::vector<std::string> {
+    std::vector<std::string> names;
+    for (const auto& index : db_manager->list_indexes(collection_name)) {
+        names.push_back(std::string(index.view()["name"].get_string().value));
+    }
+    return names;
+}
+
+auto IndexManager::_get_unused_index_names(const std::string& collection_name)
+    -> std::vector<std::string> {
+    std::vector<std::string> names;
+    mongocxx::pipeline pipeline;
+    pipeline.index_stats();
+
+    try {
+        auto cursor = db_manager->aggregate(collection_name, pipeline);
+        for (auto&& stats : cursor) {
+            std::string name(stats["name"].get_string().value);
+            auto ops = stats["accesses"]["ops"];
+            auto op_count = ops.type() == bsoncxx::type::k_int64 ? ops.get_int64().value
+                                                                 : ops.get_int32().value;
+            if (op_count == 0 && name != DEFAULT_ID_INDEX_NAME) {
+                names.push_back(name);
+            }
+        }
+    } catch (const mongocxx::exception& e) {
+        // $indexStats needs extra privileges on some deployments; usage is then just not reported
+        std::cout << "[IndexManager] Could not read index usage for " << collection_name << ": "
+                  << e.what() << std::endl;
+    }
+    return names;
+}
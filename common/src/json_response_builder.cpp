@@ -0,0 +1,28 @@
+#include "json_response_builder.hpp"
+
+JsonResponseBuilder::JsonResponseBuilder(std::function<void(const std::string&)> append_func)
+    : append_func(std::move(append_func)), item_count(0) {}
+
+void JsonResponseBuilder::begin_array(const std::string& key) {
+    append_func("{\"" + crow::json::escape(key) + "\":[");
+}
+
+void JsonResponseBuilder::append_array_item(const std::string& item_json) {
+    if (item_count > 0) {
+        append_func(",");
+    }
+    append_func(item_json);
+    item_count++;
+}
+
+void JsonResponseBuilder::finish(const crow::json::wvalue& fields) {
+    // splice the fields object into the enclosing one by dropping its opening brace
+    auto fields_json = fields.t() == crow::json::type::Object ? fields.dump() : "{}";
+    if (fields_json != "{}") {
+        append_func("]," + fields_json.substr(1));
+    } else {
+        append_func("]}");
+    }
+}
+
+auto JsonResponseBuilder::get_item_count() const -> size_t { return item_count; }
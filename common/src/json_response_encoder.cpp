@@ -0,0 +1,244 @@
+#include "json_response_encoder.hpp"
+
+#include <bsoncxx/types.hpp>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "constants.hpp"
+#include "crow.h"
+#include "date_utils.hpp"
+
+void JsonResponseEncoder::encode_document(const bsoncxx::document::view& document,
+                                          std::string& out) {
+    _encode_document(document, out, true);
+}
+
+auto JsonResponseEncoder::encode_document(const bsoncxx::document::view& document)
+    -> std::string {
+    std::string out;
+    out.reserve(document.length() * 2);
+    encode_document(document, out);
+    return out;
+}
+
+void JsonResponseEncoder::_encode_document(const bsoncxx::document::view& document,
+                                           std::string& out, const bool& rewrite_dates) {
+    out += '{';
+    bool is_first = true;
+    for (const auto& element : document) {
+        if (!is_first) {
+            out += ',';
+        }
+        is_first = false;
+        _encode_string(element.key(), out);
+        out += ':';
+        _encode_value(element.get_value(), out, rewrite_dates);
+    }
+    out += '}';
+}
+
+void JsonResponseEncoder::_encode_array(const bsoncxx::array::view& array, std::string& out) {
+    out += '[';
+    bool is_first = true;
+    for (const auto& element : array) {
+        if (!is_first) {
+            out += ',';
+        }
+        is_first = false;
+        _encode_value(element.get_value(), out, false);
+    }
+    out += ']';
+}
+
+void JsonResponseEncoder::_encode_value(const bsoncxx::types::bson_value::view& value,
+                                        std::string& out, const bool& rewrite_dates) {
+    switch (value.type()) {
+        case bsoncxx::type::k_double:
+            _encode_double(value.get_double().value, out);
+            break;
+        case bsoncxx::type::k_string:
+            _encode_string(value.get_string().value, out);
+            break;
+        case bsoncxx::type::k_document:
+            _encode_document(value.get_document().value, out, rewrite_dates);
+            break;
+        case bsoncxx::type::k_array:
+            _encode_array(value.get_array().value, out);
+            break;
+        case bsoncxx::type::k_binary: {
+            auto binary = value.get_binary();
+            char sub_type[3];
+            std::snprintf(sub_type, sizeof(sub_type), "%02x",
+                          static_cast<unsigned int>(binary.sub_type));
+            out += "{\"$binary\":\"";
+            out += crow::utility::base64encode(binary.bytes, binary.size);
+            out += "\",\"$type\":\"";
+            out += sub_type;
+            out += "\"}";
+            break;
+        }
+        case bsoncxx::type::k_undefined:
+            out += "{\"$undefined\":true}";
+            break;
+        case bsoncxx::type::k_oid:
+            out += "{\"$oid\":\"";
+            out += value.get_oid().value.to_string();
+            out += "\"}";
+            break;
+        case bsoncxx::type::k_bool:
+            out += value.get_bool().value ? "true" : "false";
+            break;
+        case bsoncxx::type::k_date: {
+            auto milliseconds = value.get_date().to_int64();
+            if (rewrite_dates) {
+                char datetime[DateUtils::DATETIME_LENGTH];
+                out += '"';
+                if (DateUtils::format_datetime(milliseconds / 1000, datetime)) {
+                    out.append(datetime, DateUtils::DATETIME_LENGTH);
+                } else {
+                    out += DateUtils::utc_unix_timestamp_to_string(milliseconds / 1000,
+                                                                   Constants::DATETIME_FORMAT);
+                }
+                out += '"';
+            } else {
+                out += "{\"$date\":";
+                _encode_int64(milliseconds, out);
+                out += '}';
+            }
+            break;
+        }
+        case bsoncxx::type::k_null:
+            out += "null";
+            break;
+        case bsoncxx::type::k_regex: {
+            auto regex = value.get_regex();
+            out += "{\"$regex\":";
+            _encode_string(regex.regex, out);
+            out += ",\"$options\":";
+            _encode_string(regex.options, out);
+            out += '}';
+            break;
+        }
+        case bsoncxx::type::k_dbpointer: {
+            auto dbpointer = value.get_dbpointer();
+            out += "{\"$ref\":";
+            _encode_string(dbpointer.collection, out);
+            out += ",\"$id\":\"";
+            out += dbpointer.value.to_string();
+            out += "\"}";
+            break;
+        }
+        case bsoncxx::type::k_code:
+            out += "{\"$code\":";
+            _encode_string(value.get_code().code, out);
+            out += '}';
+            break;
+        case bsoncxx::type::k_symbol:
+            _encode_string(value.get_symbol().symbol, out);
+            break;
+        case bsoncxx::type::k_codewscope: {
+            auto codewscope = value.get_codewscope();
+            out += "{\"$code\":";
+            _encode_string(codewscope.code, out);
+            out += ",\"$scope\":";
+            _encode_document(codewscope.scope, out, rewrite_dates);
+            out += '}';
+            break;
+        }
+        case bsoncxx::type::k_int32:
+            _encode_int64(value.get_int32().value, out);
+            break;
+        case bsoncxx::type::k_timestamp: {
+            auto timestamp = value.get_timestamp();
+            out += "{\"$timestamp\":{\"t\":";
+            _encode_int64(timestamp.timestamp, out);
+            out += ",\"i\":";
+            _encode_int64(timestamp.increment, out);
+            out += "}}";
+            break;
+        }
+        case bsoncxx::type::k_int64:
+            _encode_int64(value.get_int64().value, out);
+            break;
+        case bsoncxx::type::k_decimal128:
+            out += "{\"$numberDecimal\":\"";
+            out += value.get_decimal128().value.to_string();
+            out += "\"}";
+            break;
+        case bsoncxx::type::k_maxkey:
+            out += "{\"$maxKey\":1}";
+            break;
+        case bsoncxx::type::k_minkey:
+            out += "{\"$minKey\":1}";
+            break;
+    }
+}
+
+void JsonResponseEncoder::_encode_string(const bsoncxx::stdx::string_view& str, std::string& out) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    out += '"';
+    // copy runs of characters that need no escaping in one append
+    size_t run_start = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        auto c = static_cast<unsigned char>(str[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        out.append(str.data() + run_start, i - run_start);
+        run_start = i + 1;
+        switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                out += "\\u00";
+                out += HEX_DIGITS[c >> 4];
+                out += HEX_DIGITS[c & 0xf];
+        }
+    }
+    out.append(str.data() + run_start, str.size() - run_start);
+    out += '"';
+}
+
+void JsonResponseEncoder::_encode_double(const double& number, std::string& out) {
+    // JSON has no representation for these; crow writes them as null as well
+    if (!std::isfinite(number)) {
+        out += "null";
+        return;
+    }
+
+    // shortest of the common precisions that still round-trips
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.15g", number);
+    if (std::strtod(buffer, nullptr) != number) {
+        std::snprintf(buffer, sizeof(buffer), "%.17g", number);
+    }
+    out += buffer;
+}
+
+void JsonResponseEncoder::_encode_int64(const long long int& number, std::string& out) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out.append(buffer, result.ptr);
+}
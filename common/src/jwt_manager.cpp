@@ -2,14 +2,22 @@
 
 #include <jwt-cpp/jwt.h>
 
+#include <algorithm>
 #include <chrono>
 #include <stdexcept>
 
 #include "base_api_strategy_utils.hpp"
 #include "crow.h"
+#include "request_context.hpp"
 
-JwtManager::JwtManager(const std::string& jwt_secret, const int& jwt_duration_in_seconds)
-    : jwt_secret{jwt_secret}, jwt_duration_in_seconds{jwt_duration_in_seconds} {}
+JwtManager::JwtManager(const std::string& jwt_secret, const int& jwt_duration_in_seconds,
+                       const int& jwt_claims_cache_max_entries)
+    : jwt_secret{jwt_secret},
+      jwt_duration_in_seconds{jwt_duration_in_seconds},
+      verifier{jwt::verify()
+                   .allow_algorithm(jwt::algorithm::hs256{jwt_secret})
+                   .with_issuer("auth0")},
+      claims_cache_max_entries{static_cast<size_t>(std::max(jwt_claims_cache_max_entries, 0))} {}
 
 EnvManager JwtManager::env_manager = EnvManager();
 
@@ -30,60 +38,137 @@ auto JwtManager::jwt_protection_decorator(
     const std::function<crow::response(const crow::request&)>& func,
     const JwtAccessLevel& access_level) -> std::function<crow::response(const crow::request&)> {
     return [this, func, access_level](const crow::request& req) {
-        if (access_level == JwtAccessLevel::None) {
-            return func(req);
+        auto error_response = _authorize(req, access_level);
+        if (error_response) {
+            return std::move(*error_response);
         }
+        return func(req);
+    };
+}
 
-        auto auth_header = req.get_header_value("Authorization");
-        if (auth_header.empty() || auth_header.substr(0, 7) != "Bearer ") {
-            return BaseApiStrategyUtils::make_error_response(
-                401, "Unauthorized: Missing or invalid Authorization header");
+auto JwtManager::jwt_protection_decorator(const deferred_handler_func_type& func,
+                                          const JwtAccessLevel& access_level)
+    -> deferred_handler_func_type {
+    return [this, func, access_level](const crow::request& req, const respond_func_type& respond) {
+        auto error_response = _authorize(req, access_level);
+        if (error_response) {
+            respond(std::move(*error_response));
+            return;
         }
-        std::string token = auth_header.substr(7);
-        auto oid_from_token = _get_from_token(token, "oid");
-        auto role_from_token = _get_from_token(token, "role");
-
-        switch (access_level) {
-            case JwtAccessLevel::Personal: {
-                auto body = crow::json::load(req.body);
-                auto oid_from_request = static_cast<std::string>(body["oid"]);
-                if (oid_from_token != oid_from_request) {
-                    return BaseApiStrategyUtils::make_error_response(
-                        401,
-                        "Invalid Personal Level Access: oid retrieved from JWT token is not the "
-                        "oid provided in the request.");
-                }
-                break;
-            }
-            case JwtAccessLevel::Admin: {
-                if (role_from_token != "Admin") {
-                    throw BaseApiStrategyUtils::make_error_response(
-                        401,
-                        "Invalid Admin Level Access: role retrieved from JWT token is below "
-                        "Admin.");
-                }
-                break;
+        func(req, respond);
+    };
+}
+
+auto JwtManager::_authorize(const crow::request& req, const JwtAccessLevel& access_level)
+    -> bsoncxx::stdx::optional<crow::response> {
+    if (access_level == JwtAccessLevel::None) {
+        return {};
+    }
+
+    auto auth_header = req.get_header_value("Authorization");
+    if (auth_header.empty() || auth_header.substr(0, 7) != "Bearer ") {
+        return BaseApiStrategyUtils::make_error_response(
+            401, "Unauthorized: Missing or invalid Authorization header");
+    }
+    std::string token = auth_header.substr(7);
+    auto claims = get_claims(token);
+    const auto& oid_from_token = claims.oid;
+    const auto& role_from_token = claims.role;
+
+    auto context = RequestContext::get(req);
+    context->set_jwt_claims({{"oid", oid_from_token}, {"role", role_from_token}});
+    context->record_stage("authenticated");
+
+    switch (access_level) {
+        case JwtAccessLevel::Personal: {
+            const auto& body = context->get_body();
+            auto oid_from_request = static_cast<std::string>(body["oid"]);
+            if (oid_from_token != oid_from_request) {
+                return BaseApiStrategyUtils::make_error_response(
+                    401,
+                    "Invalid Personal Level Access: oid retrieved from JWT token is not the "
+                    "oid provided in the request.");
             }
-            default: {
-                break;
+            break;
+        }
+        case JwtAccessLevel::Admin: {
+            if (role_from_token != "Admin") {
+                return BaseApiStrategyUtils::make_error_response(
+                    401,
+                    "Invalid Admin Level Access: role retrieved from JWT token is below "
+                    "Admin.");
             }
+            break;
         }
+        default: {
+            break;
+        }
+    }
 
-        return func(req);
-    };
+    return {};
 }
 
-std::string JwtManager::_get_from_token(const std::string& token, const std::string& key) {
+auto JwtManager::get_claims(const std::string& token) -> JwtClaims {
+    JwtClaims claims;
+    if (_get_cached_claims(token, claims)) {
+        return claims;
+    }
+    claims = _verify_token(token);
+    _cache_claims(token, claims);
+    return claims;
+}
+
+auto JwtManager::get_claims_cache_size() -> size_t {
+    std::lock_guard<std::mutex> lock(claims_cache_mutex);
+    return claims_cache.size();
+}
+
+auto JwtManager::_verify_token(const std::string& token) -> JwtClaims {
     try {
         auto decoded = jwt::decode(token);
-
-        auto verifier =
-            jwt::verify().allow_algorithm(jwt::algorithm::hs256{jwt_secret}).with_issuer("auth0");
         verifier.verify(decoded);
 
-        auto value = decoded.get_payload_claim(key).as_string();
-        return value;
+        JwtClaims claims;
+        claims.oid = decoded.get_payload_claim("oid").as_string();
+        claims.role = decoded.get_payload_claim("role").as_string();
+        claims.expires_at = decoded.has_expires_at()
+                                ? decoded.get_expires_at()
+                                : std::chrono::system_clock::time_point::max();
+        return claims;
     } catch (const std::exception& e) {
         throw std::runtime_error(std::string("Token verification failed: ") + e.what());
     }
-}
\ No newline at end of file
+}
+
+auto JwtManager::_get_cached_claims(const std::string& token, JwtClaims& claims) -> bool {
+    std::lock_guard<std::mutex> lock(claims_cache_mutex);
+    auto it = claims_cache.find(token);
+    if (it == claims_cache.end()) {
+        return false;
+    }
+    // an expired token is verified again, which rejects it
+    if (it->second->second.expires_at <= std::chrono::system_clock::now()) {
+        claims_cache_entries.erase(it->second);
+        claims_cache.erase(it);
+        return false;
+    }
+    claims_cache_entries.splice(claims_cache_entries.begin(), claims_cache_entries, it->second);
+    claims = it->second->second;
+    return true;
+}
+
+void JwtManager::_cache_claims(const std::string& token, const JwtClaims& claims) {
+    if (claims_cache_max_entries == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(claims_cache_mutex);
+    if (claims_cache.find(token) != claims_cache.end()) {
+        return;
+    }
+    if (claims_cache.size() >= claims_cache_max_entries) {
+        claims_cache.erase(claims_cache_entries.back().first);
+        claims_cache_entries.pop_back();
+    }
+    claims_cache_entries.emplace_front(token, claims);
+    claims_cache[token] = claims_cache_entries.begin();
+}
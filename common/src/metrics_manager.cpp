@@ -0,0 +1,52 @@
+#include "metrics_manager.hpp"
+
+#include <algorithm>
+
+void MetricsManager::increment_counter(const std::string& name, const long long int& delta) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counters[name] += delta;
+}
+
+void MetricsManager::observe(const std::string& name, const double& value) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& summary = summaries[name];
+    if (summary.count == 0) {
+        summary.min = value;
+        summary.max = value;
+    } else {
+        summary.min = std::min(summary.min, value);
+        summary.max = std::max(summary.max, value);
+    }
+    summary.count++;
+    summary.sum += value;
+}
+
+auto MetricsManager::get_counter(const std::string& name) -> long long int {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = counters.find(name);
+    return it == counters.end() ? 0 : it->second;
+}
+
+auto MetricsManager::get_summary(const std::string& name) -> MetricSummary {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = summaries.find(name);
+    return it == summaries.end() ? MetricSummary{} : it->second;
+}
+
+auto MetricsManager::to_json() -> crow::json::wvalue {
+    std::lock_guard<std::mutex> lock(mutex);
+    crow::json::wvalue json;
+    json["counters"] = crow::json::wvalue::object();
+    json["summaries"] = crow::json::wvalue::object();
+    for (const auto& [name, value] : counters) {
+        json["counters"][name] = value;
+    }
+    for (const auto& [name, summary] : summaries) {
+        json["summaries"][name]["count"] = summary.count;
+        json["summaries"][name]["sum"] = summary.sum;
+        json["summaries"][name]["min"] = summary.min;
+        json["summaries"][name]["max"] = summary.max;
+        json["summaries"][name]["mean"] = summary.count == 0 ? 0 : summary.sum / summary.count;
+    }
+    return json;
+}
@@ -0,0 +1,253 @@
+#include "msgpack_response_encoder.hpp"
+
+#include <bsoncxx/types.hpp>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#include "constants.hpp"
+#include "date_utils.hpp"
+#include "json_response_encoder.hpp"
+
+void MsgpackResponseEncoder::encode_document(const bsoncxx::document::view& document,
+                                             std::string& out) {
+    _encode_document(document, out, true);
+}
+
+void MsgpackResponseEncoder::encode_json(const crow::json::rvalue& rval_json, std::string& out) {
+    switch (rval_json.t()) {
+        case crow::json::type::Null:
+            out += '\xc0';
+            break;
+        case crow::json::type::False:
+            out += '\xc2';
+            break;
+        case crow::json::type::True:
+            out += '\xc3';
+            break;
+        case crow::json::type::Number:
+            if (rval_json.nt() == crow::json::num_type::Floating_point) {
+                _write_double(rval_json.d(), out);
+            } else if (rval_json.nt() == crow::json::num_type::Unsigned_integer) {
+                _write_uint64(rval_json.u(), out);
+            } else {
+                write_int64(rval_json.i(), out);
+            }
+            break;
+        case crow::json::type::String: {
+            std::string str = rval_json.s();
+            write_string(str, out);
+            break;
+        }
+        case crow::json::type::List:
+            write_array_header(rval_json.size(), out);
+            for (const auto& item : rval_json) {
+                encode_json(item, out);
+            }
+            break;
+        case crow::json::type::Object:
+            write_map_header(rval_json.size(), out);
+            for (const auto& field : rval_json) {
+                write_string(field.key(), out);
+                encode_json(field, out);
+            }
+            break;
+        default:
+            throw std::invalid_argument("Cannot encode JSON value as MessagePack");
+    }
+}
+
+void MsgpackResponseEncoder::_encode_document(const bsoncxx::document::view& document,
+                                              std::string& out, const bool& rewrite_dates) {
+    // MessagePack maps are length-prefixed and BSON documents do not store an element count
+    write_map_header(std::distance(document.begin(), document.end()), out);
+    for (const auto& element : document) {
+        write_string(element.key(), out);
+        _encode_value(element.get_value(), out, rewrite_dates);
+    }
+}
+
+void MsgpackResponseEncoder::_encode_array(const bsoncxx::array::view& array, std::string& out) {
+    write_array_header(std::distance(array.begin(), array.end()), out);
+    for (const auto& element : array) {
+        _encode_value(element.get_value(), out, false);
+    }
+}
+
+void MsgpackResponseEncoder::_encode_value(const bsoncxx::types::bson_value::view& value,
+                                           std::string& out, const bool& rewrite_dates) {
+    switch (value.type()) {
+        case bsoncxx::type::k_double:
+            _write_double(value.get_double().value, out);
+            break;
+        case bsoncxx::type::k_string:
+            write_string(value.get_string().value, out);
+            break;
+        case bsoncxx::type::k_symbol:
+            write_string(value.get_symbol().symbol, out);
+            break;
+        case bsoncxx::type::k_document:
+            _encode_document(value.get_document().value, out, rewrite_dates);
+            break;
+        case bsoncxx::type::k_array:
+            _encode_array(value.get_array().value, out);
+            break;
+        case bsoncxx::type::k_binary: {
+            auto binary = value.get_binary();
+            _write_binary(binary.bytes, binary.size, out);
+            break;
+        }
+        case bsoncxx::type::k_oid:
+            write_map_header(1, out);
+            write_string("$oid", out);
+            write_string(value.get_oid().value.to_string(), out);
+            break;
+        case bsoncxx::type::k_bool:
+            out += value.get_bool().value ? '\xc3' : '\xc2';
+            break;
+        case bsoncxx::type::k_date: {
+            auto milliseconds = value.get_date().to_int64();
+            if (!rewrite_dates) {
+                write_map_header(1, out);
+                write_string("$date", out);
+                write_int64(milliseconds, out);
+                break;
+            }
+            char datetime[DateUtils::DATETIME_LENGTH];
+            if (DateUtils::format_datetime(milliseconds / 1000, datetime)) {
+                write_string(bsoncxx::stdx::string_view(datetime, DateUtils::DATETIME_LENGTH),
+                             out);
+            } else {
+                write_string(DateUtils::utc_unix_timestamp_to_string(milliseconds / 1000,
+                                                                     Constants::DATETIME_FORMAT),
+                             out);
+            }
+            break;
+        }
+        case bsoncxx::type::k_null:
+            out += '\xc0';
+            break;
+        case bsoncxx::type::k_int32:
+            write_int64(value.get_int32().value, out);
+            break;
+        case bsoncxx::type::k_int64:
+            write_int64(value.get_int64().value, out);
+            break;
+        default: {
+            // types the services never store; reuse their extended JSON form
+            std::string value_json;
+            JsonResponseEncoder::_encode_value(value, value_json, rewrite_dates);
+            encode_json(crow::json::load(value_json), out);
+            break;
+        }
+    }
+}
+
+void MsgpackResponseEncoder::write_map_header(const size_t& size, std::string& out) {
+    if (size < 16) {
+        out += static_cast<char>(0x80 | size);
+    } else if (size <= 0xffff) {
+        out += '\xde';
+        _write_big_endian(size, 2, out);
+    } else {
+        out += '\xdf';
+        _write_big_endian(size, 4, out);
+    }
+}
+
+void MsgpackResponseEncoder::write_array_header(const size_t& size, std::string& out) {
+    if (size < 16) {
+        out += static_cast<char>(0x90 | size);
+    } else if (size <= 0xffff) {
+        out += '\xdc';
+        _write_big_endian(size, 2, out);
+    } else {
+        out += '\xdd';
+        _write_big_endian(size, 4, out);
+    }
+}
+
+void MsgpackResponseEncoder::write_string(const bsoncxx::stdx::string_view& str,
+                                          std::string& out) {
+    auto size = str.size();
+    if (size < 32) {
+        out += static_cast<char>(0xa0 | size);
+    } else if (size <= 0xff) {
+        out += '\xd9';
+        _write_big_endian(size, 1, out);
+    } else if (size <= 0xffff) {
+        out += '\xda';
+        _write_big_endian(size, 2, out);
+    } else {
+        out += '\xdb';
+        _write_big_endian(size, 4, out);
+    }
+    out.append(str.data(), size);
+}
+
+void MsgpackResponseEncoder::write_int64(const long long int& number, std::string& out) {
+    if (number >= 0) {
+        _write_uint64(static_cast<std::uint64_t>(number), out);
+    } else if (number >= -32) {
+        out += static_cast<char>(number);
+    } else if (number >= -0x80) {
+        out += '\xd0';
+        _write_big_endian(static_cast<std::uint64_t>(number), 1, out);
+    } else if (number >= -0x8000) {
+        out += '\xd1';
+        _write_big_endian(static_cast<std::uint64_t>(number), 2, out);
+    } else if (number >= -0x80000000LL) {
+        out += '\xd2';
+        _write_big_endian(static_cast<std::uint64_t>(number), 4, out);
+    } else {
+        out += '\xd3';
+        _write_big_endian(static_cast<std::uint64_t>(number), 8, out);
+    }
+}
+
+void MsgpackResponseEncoder::_write_uint64(const std::uint64_t& number, std::string& out) {
+    if (number < 0x80) {
+        out += static_cast<char>(number);
+    } else if (number <= 0xff) {
+        out += '\xcc';
+        _write_big_endian(number, 1, out);
+    } else if (number <= 0xffff) {
+        out += '\xcd';
+        _write_big_endian(number, 2, out);
+    } else if (number <= 0xffffffffULL) {
+        out += '\xce';
+        _write_big_endian(number, 4, out);
+    } else {
+        out += '\xcf';
+        _write_big_endian(number, 8, out);
+    }
+}
+
+void MsgpackResponseEncoder::_write_double(const double& number, std::string& out) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &number, sizeof(bits));
+    out += '\xcb';
+    _write_big_endian(bits, 8, out);
+}
+
+void MsgpackResponseEncoder::_write_binary(const std::uint8_t* bytes, const size_t& size,
+                                           std::string& out) {
+    if (size <= 0xff) {
+        out += '\xc4';
+        _write_big_endian(size, 1, out);
+    } else if (size <= 0xffff) {
+        out += '\xc5';
+        _write_big_endian(size, 2, out);
+    } else {
+        out += '\xc6';
+        _write_big_endian(size, 4, out);
+    }
+    out.append(reinterpret_cast<const char*>(bytes), size);
+}
+
+void MsgpackResponseEncoder::_write_big_endian(const std::uint64_t& number, const int& byte_count,
+                                               std::string& out) {
+    for (int shift = (byte_count - 1) * 8; shift >= 0; shift -= 8) {
+        out += static_cast<char>((number >> shift) & 0xff);
+    }
+}
@@ -0,0 +1,133 @@
+#include "replicated_collection.hpp"
+
+#include <bsoncxx/types.hpp>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+#include "base_api_strategy.hpp"
+#include "entity_tag.hpp"
+#include "json_response_builder.hpp"
+
+ReplicatedCollection::ReplicatedCollection(std::shared_ptr<DatabaseManager> db_manager,
+                                           const std::string& collection_name,
+                                           const int& poll_interval_ms)
+    : db_manager{db_manager}, collection_name{collection_name} {
+    try {
+        refresh();
+    } catch (const std::exception& e) {
+        std::cout << "[ReplicatedCollection] Cannot load " << collection_name
+                  << ", reading it from the database until it loads: " << e.what() << std::endl;
+    }
+    watcher = std::make_unique<CollectionWatcher>(
+        db_manager, collection_name, [this]() { refresh(); }, poll_interval_ms);
+}
+
+std::shared_ptr<ReplicatedCollection> ReplicatedCollection::create_from_env(
+    std::shared_ptr<DatabaseManager> db_manager, const std::string& collection_name,
+    EnvManager env_manager) {
+    auto REPLICATED_COLLECTIONS =
+        env_manager.read_env("REPLICATED_COLLECTIONS", Constants::DEFAULT_REPLICATED_COLLECTIONS);
+    auto REPLICATED_COLLECTION_POLL_INTERVAL_MS =
+        stoi(env_manager.read_env("REPLICATED_COLLECTION_POLL_INTERVAL_MS",
+                                  Constants::DEFAULT_REPLICATED_COLLECTION_POLL_INTERVAL_MS));
+
+    std::stringstream stream(REPLICATED_COLLECTIONS);
+    std::string replicated_collection_name;
+    while (std::getline(stream, replicated_collection_name, ',')) {
+        if (replicated_collection_name == collection_name) {
+            return std::make_shared<ReplicatedCollection>(db_manager, collection_name,
+                                                          REPLICATED_COLLECTION_POLL_INTERVAL_MS);
+        }
+    }
+    return nullptr;
+}
+
+void ReplicatedCollection::refresh() {
+    std::lock_guard<std::mutex> refresh_lock(refresh_mutex);
+    std::vector<bsoncxx::document::value> documents;
+    for (auto&& doc : db_manager->find(collection_name)) {
+        documents.emplace_back(doc);
+    }
+    auto next_snapshot = _make_snapshot(std::move(documents));
+
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    snapshot = std::move(next_snapshot);
+}
+
+auto ReplicatedCollection::find_one(const bsoncxx::document::view& filter,
+                                    bsoncxx::stdx::optional<bsoncxx::document::value>& result)
+    -> bool {
+    auto it = filter.begin();
+    if (it == filter.end() || std::next(it) != filter.end()) {
+        return false;
+    }
+    std::string index_key;
+    if (it->key() == "_id" && it->type() == bsoncxx::type::k_oid) {
+        index_key = it->get_oid().value.to_string();
+    } else if (it->key() == "name" && it->type() == bsoncxx::type::k_string) {
+        index_key = std::string(it->get_string().value);
+    } else {
+        return false;
+    }
+
+    auto current_snapshot = get_snapshot();
+    if (!current_snapshot) {
+        return false;
+    }
+    const auto& index = it->key() == "_id" ? current_snapshot->index_by_oid
+                                           : current_snapshot->index_by_name;
+    auto position = index.find(index_key);
+    if (position != index.end()) {
+        result = current_snapshot->documents[position->second];
+    }
+    return true;
+}
+
+auto ReplicatedCollection::get_snapshot() -> std::shared_ptr<const Snapshot> {
+    std::lock_guard<std::mutex> lock(snapshot_mutex);
+    return snapshot;
+}
+
+auto ReplicatedCollection::get_db_manager() const -> std::shared_ptr<DatabaseManager> {
+    return db_manager;
+}
+
+auto ReplicatedCollection::get_collection_name() const -> std::string { return collection_name; }
+
+auto ReplicatedCollection::_make_snapshot(std::vector<bsoncxx::document::value> documents)
+    -> std::shared_ptr<const Snapshot> {
+    auto next_snapshot = std::make_shared<Snapshot>();
+    next_snapshot->documents = std::move(documents);
+
+    EntityTagHasher etag_hasher;
+    JsonResponseBuilder builder([&next_snapshot, &etag_hasher](const std::string& piece) {
+        etag_hasher.update(piece);
+        next_snapshot->all_documents_body += piece;
+    });
+    builder.begin_array("documents");
+    std::string document_buffer;
+    for (size_t i = 0; i < next_snapshot->documents.size(); ++i) {
+        auto doc = next_snapshot->documents[i].view();
+        auto id = doc["_id"];
+        if (id && id.type() == bsoncxx::type::k_oid) {
+            next_snapshot->index_by_oid.emplace(id.get_oid().value.to_string(), i);
+        }
+        auto name = doc["name"];
+        if (name && name.type() == bsoncxx::type::k_string) {
+            // find_one returns any match, so the first document keeps a duplicated name
+            next_snapshot->index_by_name.emplace(std::string(name.get_string().value), i);
+        }
+        document_buffer.clear();
+        BaseApiStrategy::process_document_func_get(doc, document_buffer);
+        builder.append_array_item(document_buffer);
+    }
+    // the same fields find_serialized ends its responses with, so both bodies are identical
+    crow::json::wvalue fields;
+    fields["success"] = true;
+    fields["message"] = "Server processed get request successfully.";
+    builder.finish(fields);
+    next_snapshot->all_documents_etag = etag_hasher.get_etag();
+    return next_snapshot;
+}
@@ -0,0 +1,73 @@
+#include "request_coalescer.hpp"
+
+#include <exception>
+#include <utility>
+
+#include "base_api_strategy_utils.hpp"
+
+RequestCoalescer::RequestCoalescer(const std::string& name,
+                                   std::shared_ptr<MetricsManager> metrics_manager)
+    : name{name}, metrics_manager{metrics_manager} {}
+
+void RequestCoalescer::get_or_compute(
+    const std::string& key, const std::function<void(const respond_func_type&)>& compute_func,
+    const respond_func_type& respond) {
+    if (key.empty()) {
+        compute_func(respond);
+        return;
+    }
+
+    auto execution = std::make_shared<Execution>();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = in_flight.find(key);
+        if (it != in_flight.end()) {
+            it->second->followers.push_back(respond);
+            metrics_manager->increment_counter(_metric_name("coalesced"));
+            return;
+        }
+        in_flight.emplace(key, execution);
+    }
+    metrics_manager->increment_counter(_metric_name("executions"));
+
+    try {
+        compute_func([this, key, execution, respond](crow::response res) {
+            // crow::response cannot be copied, so each parked caller gets its parts
+            for (const auto& follower : _finish(key, execution)) {
+                crow::response copy(res.code);
+                copy.headers = res.headers;
+                copy.body = res.body;
+                follower(std::move(copy));
+            }
+            respond(std::move(res));
+        });
+    } catch (const std::exception& e) {
+        for (const auto& follower : _finish(key, execution)) {
+            follower(BaseApiStrategyUtils::make_error_response(
+                500, std::string("Server error: ") + e.what()));
+        }
+        throw;
+    }
+}
+
+auto RequestCoalescer::get_in_flight_count() -> size_t {
+    std::lock_guard<std::mutex> lock(mutex);
+    return in_flight.size();
+}
+
+auto RequestCoalescer::_finish(const std::string& key, const std::shared_ptr<Execution>& execution)
+    -> std::vector<respond_func_type> {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = in_flight.find(key);
+    // a later execution of the same key may already have taken the slot
+    if (it != in_flight.end() && it->second == execution) {
+        in_flight.erase(it);
+    }
+    std::vector<respond_func_type> followers;
+    followers.swap(execution->followers);
+    return followers;
+}
+
+auto RequestCoalescer::_metric_name(const std::string& name) const -> std::string {
+    return "request_coalescer." + this->name + "." + name;
+}
@@ -0,0 +1,78 @@
+#include "request_context.hpp"
+
+thread_local std::shared_ptr<RequestContext> RequestContext::current;
+
+RequestContext::RequestContext(const crow::request& req)
+    : req(req),
+      is_body_parsed(false),
+      is_response_format_negotiated(false),
+      response_format(ResponseFormat::Json),
+      start_time(std::chrono::steady_clock::now()) {}
+
+auto RequestContext::get(const crow::request& req) -> std::shared_ptr<RequestContext> {
+    if (current && &current->req == &req) {
+        return current;
+    }
+    return std::make_shared<RequestContext>(req);
+}
+
+auto RequestContext::get_current() -> std::shared_ptr<RequestContext> { return current; }
+
+auto RequestContext::get_body() -> const crow::json::rvalue& {
+    if (!is_body_parsed) {
+        body = crow::json::load(req.body);
+        is_body_parsed = true;
+    }
+    return body;
+}
+
+auto RequestContext::get_response_format() -> ResponseFormat {
+    if (!is_response_format_negotiated) {
+        response_format =
+            ResponseFormatUtils::negotiate_response_format(req.get_header_value("Accept"));
+        is_response_format_negotiated = true;
+    }
+    return response_format;
+}
+
+void RequestContext::set_response_compressor(
+    std::shared_ptr<const ResponseCompressor> response_compressor) {
+    this->response_compressor = std::move(response_compressor);
+}
+
+auto RequestContext::get_response_compressor() const
+    -> std::shared_ptr<const ResponseCompressor> {
+    return response_compressor;
+}
+
+void RequestContext::set_jwt_claims(std::unordered_map<std::string, std::string> claims) {
+    jwt_claims = std::move(claims);
+}
+
+auto RequestContext::has_jwt_claims() const -> bool { return !jwt_claims.empty(); }
+
+auto RequestContext::get_jwt_claim(const std::string& key) const -> std::string {
+    auto it = jwt_claims.find(key);
+    return it == jwt_claims.end() ? "" : it->second;
+}
+
+void RequestContext::record_stage(const std::string& stage) {
+    stage_timings.emplace_back(stage, get_elapsed_ms());
+}
+
+auto RequestContext::get_stage_timings() const
+    -> const std::vector<std::pair<std::string, double>>& {
+    return stage_timings;
+}
+
+auto RequestContext::get_elapsed_ms() const -> double {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time)
+        .count();
+}
+
+RequestContext::Scope::Scope(std::shared_ptr<RequestContext> context)
+    : previous(std::move(current)) {
+    current = std::move(context);
+}
+
+RequestContext::Scope::~Scope() { current = std::move(previous); }
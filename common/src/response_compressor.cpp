@@ -0,0 +1,242 @@
+#include "response_compressor.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include "entity_tag.hpp"
+#include "response_format.hpp"
+
+// output is produced in pieces of this size and appended to the body
+static const size_t COMPRESSION_OUTPUT_BUFFER_SIZE = 16 * 1024;
+
+StreamingCompressor::StreamingCompressor(const ContentEncoding& encoding, const int& level)
+    : encoding(encoding), zstd_context(nullptr), is_finished(false) {
+    std::memset(&gzip_stream, 0, sizeof(gzip_stream));
+    if (encoding == ContentEncoding::Gzip) {
+        // 15 window bits plus 16 selects the gzip wrapper instead of raw zlib
+        if (deflateInit2(&gzip_stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) !=
+            Z_OK) {
+            throw std::runtime_error("Failed to initialize gzip stream");
+        }
+    } else if (encoding == ContentEncoding::Zstd) {
+        zstd_context = ZSTD_createCCtx();
+        if (zstd_context == nullptr ||
+            ZSTD_isError(
+                ZSTD_CCtx_setParameter(zstd_context, ZSTD_c_compressionLevel, level))) {
+            ZSTD_freeCCtx(zstd_context);
+            throw std::runtime_error("Failed to initialize zstd stream");
+        }
+    } else {
+        throw std::invalid_argument("Identity encoding needs no compressor");
+    }
+}
+
+StreamingCompressor::~StreamingCompressor() {
+    if (encoding == ContentEncoding::Gzip) {
+        deflateEnd(&gzip_stream);
+    } else {
+        ZSTD_freeCCtx(zstd_context);
+    }
+}
+
+void StreamingCompressor::write(const char* data, const size_t& size, std::string& out) {
+    if (is_finished) {
+        throw std::runtime_error("Cannot write to a finished compression stream");
+    }
+    char buffer[COMPRESSION_OUTPUT_BUFFER_SIZE];
+
+    if (encoding == ContentEncoding::Gzip) {
+        gzip_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        gzip_stream.avail_in = static_cast<uInt>(size);
+        do {
+            gzip_stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            gzip_stream.avail_out = sizeof(buffer);
+            deflate(&gzip_stream, Z_NO_FLUSH);
+            out.append(buffer, sizeof(buffer) - gzip_stream.avail_out);
+        } while (gzip_stream.avail_out == 0);
+        return;
+    }
+
+    ZSTD_inBuffer input = {data, size, 0};
+    while (input.pos < input.size) {
+        ZSTD_outBuffer output = {buffer, sizeof(buffer), 0};
+        auto result = ZSTD_compressStream2(zstd_context, &output, &input, ZSTD_e_continue);
+        if (ZSTD_isError(result)) {
+            throw std::runtime_error(std::string("zstd compression failed: ") +
+                                     ZSTD_getErrorName(result));
+        }
+        out.append(buffer, output.pos);
+    }
+}
+
+void StreamingCompressor::finish(std::string& out) {
+    if (is_finished) {
+        return;
+    }
+    is_finished = true;
+    char buffer[COMPRESSION_OUTPUT_BUFFER_SIZE];
+
+    if (encoding == ContentEncoding::Gzip) {
+        gzip_stream.next_in = nullptr;
+        gzip_stream.avail_in = 0;
+        int result;
+        do {
+            gzip_stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            gzip_stream.avail_out = sizeof(buffer);
+            result = deflate(&gzip_stream, Z_FINISH);
+            out.append(buffer, sizeof(buffer) - gzip_stream.avail_out);
+        } while (result == Z_OK);
+        if (result != Z_STREAM_END) {
+            throw std::runtime_error("gzip compression failed");
+        }
+        return;
+    }
+
+    ZSTD_inBuffer input = {nullptr, 0, 0};
+    size_t remaining;
+    do {
+        ZSTD_outBuffer output = {buffer, sizeof(buffer), 0};
+        remaining = ZSTD_compressStream2(zstd_context, &output, &input, ZSTD_e_end);
+        if (ZSTD_isError(remaining)) {
+            throw std::runtime_error(std::string("zstd compression failed: ") +
+                                     ZSTD_getErrorName(remaining));
+        }
+        out.append(buffer, output.pos);
+    } while (remaining != 0);
+}
+
+auto StreamingCompressor::compress(const std::string& data, const ContentEncoding& encoding,
+                                   const int& level) -> std::string {
+    std::string out;
+    out.reserve(data.size() / 4);
+    StreamingCompressor compressor(encoding, level);
+    compressor.write(data.data(), data.size(), out);
+    compressor.finish(out);
+    return out;
+}
+
+ResponseBodyCompressor::ResponseBodyCompressor(crow::response& res,
+                                               const ContentEncoding& encoding, const int& level,
+                                               const size_t& min_size)
+    : res(res), encoding(encoding), level(level), min_size(min_size) {}
+
+void ResponseBodyCompressor::write(const std::string& chunk) {
+    if (compressor) {
+        compressor->write(chunk.data(), chunk.size(), res.body);
+        return;
+    }
+
+    res.body += chunk;
+    if (res.body.size() < min_size) {
+        return;
+    }
+    // the body is now large enough, so what was kept so far becomes the start of the stream
+    compressor = std::make_unique<StreamingCompressor>(encoding, level);
+    std::string uncompressed_body;
+    uncompressed_body.swap(res.body);
+    compressor->write(uncompressed_body.data(), uncompressed_body.size(), res.body);
+}
+
+void ResponseBodyCompressor::finish() {
+    if (!compressor) {
+        return;
+    }
+    compressor->finish(res.body);
+    res.set_header("Content-Encoding", ResponseCompressor::get_encoding_name(encoding));
+}
+
+ResponseCompressor::ResponseCompressor(const bool& is_enabled, const size_t& min_size,
+                                       const int& gzip_level, const int& zstd_level)
+    : is_enabled(is_enabled),
+      min_size(min_size),
+      gzip_level(gzip_level),
+      zstd_level(zstd_level) {}
+
+std::shared_ptr<ResponseCompressor> ResponseCompressor::create_from_env(
+    EnvManager env_manager) {
+    auto RESPONSE_COMPRESSION_ENABLED =
+        env_manager.read_env("RESPONSE_COMPRESSION_ENABLED",
+                             Constants::DEFAULT_RESPONSE_COMPRESSION_ENABLED) == "true";
+    auto RESPONSE_COMPRESSION_MIN_SIZE = stoul(env_manager.read_env(
+        "RESPONSE_COMPRESSION_MIN_SIZE", Constants::DEFAULT_RESPONSE_COMPRESSION_MIN_SIZE));
+    auto RESPONSE_COMPRESSION_GZIP_LEVEL = stoi(env_manager.read_env(
+        "RESPONSE_COMPRESSION_GZIP_LEVEL", Constants::DEFAULT_RESPONSE_COMPRESSION_GZIP_LEVEL));
+    auto RESPONSE_COMPRESSION_ZSTD_LEVEL = stoi(env_manager.read_env(
+        "RESPONSE_COMPRESSION_ZSTD_LEVEL", Constants::DEFAULT_RESPONSE_COMPRESSION_ZSTD_LEVEL));
+    return std::make_shared<ResponseCompressor>(
+        RESPONSE_COMPRESSION_ENABLED, RESPONSE_COMPRESSION_MIN_SIZE,
+        RESPONSE_COMPRESSION_GZIP_LEVEL, RESPONSE_COMPRESSION_ZSTD_LEVEL);
+}
+
+auto ResponseCompressor::negotiate_encoding(const std::string& accept_encoding_header)
+    -> ContentEncoding {
+    auto best_encoding = ContentEncoding::Identity;
+    double best_quality = 0;
+    for (const auto& [coding, quality] :
+         ResponseFormatUtils::parse_weighted_header(accept_encoding_header)) {
+        ContentEncoding encoding;
+        if (coding == "zstd") {
+            encoding = ContentEncoding::Zstd;
+        } else if (coding == "gzip" || coding == "x-gzip" || coding == "*") {
+            encoding = ContentEncoding::Gzip;
+        } else {
+            continue;
+        }
+        if (quality > best_quality ||
+            (quality == best_quality && quality > 0 && encoding == ContentEncoding::Zstd)) {
+            best_encoding = encoding;
+            best_quality = quality;
+        }
+    }
+    return best_encoding;
+}
+
+auto ResponseCompressor::get_encoding_name(const ContentEncoding& encoding) -> std::string {
+    switch (encoding) {
+        case ContentEncoding::Gzip:
+            return "gzip";
+        case ContentEncoding::Zstd:
+            return "zstd";
+        default:
+            return "identity";
+    }
+}
+
+void ResponseCompressor::compress_response(const crow::request& req, crow::response& res) const {
+    if (res.body.size() < min_size || !res.get_header_value("Content-Encoding").empty()) {
+        return;
+    }
+    auto encoding = _get_encoding(req);
+    if (encoding == ContentEncoding::Identity) {
+        return;
+    }
+    res.body = StreamingCompressor::compress(res.body, encoding, _get_level(encoding));
+    res.set_header("Content-Encoding", get_encoding_name(encoding));
+    auto etag = res.get_header_value("ETag");
+    if (!etag.empty()) {
+        res.set_header("ETag",
+                       EntityTagUtils::add_encoding_to_etag(etag, get_encoding_name(encoding)));
+    }
+}
+
+auto ResponseCompressor::make_body_compressor(const crow::request& req, crow::response& res) const
+    -> std::unique_ptr<ResponseBodyCompressor> {
+    auto encoding = _get_encoding(req);
+    if (encoding == ContentEncoding::Identity) {
+        return nullptr;
+    }
+    return std::make_unique<ResponseBodyCompressor>(res, encoding, _get_level(encoding), min_size);
+}
+
+auto ResponseCompressor::get_is_enabled() const -> bool { return is_enabled; }
+
+auto ResponseCompressor::_get_encoding(const crow::request& req) const -> ContentEncoding {
+    if (!is_enabled) {
+        return ContentEncoding::Identity;
+    }
+    return negotiate_encoding(req.get_header_value("Accept-Encoding"));
+}
+
+auto ResponseCompressor::_get_level(const ContentEncoding& encoding) const -> int {
+    return encoding == ContentEncoding::Zstd ? zstd_level : gzip_level;
+}
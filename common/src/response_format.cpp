@@ -0,0 +1,120 @@
+#include "response_format.hpp"
+
+#include <algorithm>
+#include <bsoncxx/json.hpp>
+#include <cctype>
+#include <cstdlib>
+
+#include "msgpack_response_encoder.hpp"
+
+auto ResponseFormatUtils::negotiate_response_format(const std::string& accept_header)
+    -> ResponseFormat {
+    auto best_format = ResponseFormat::Json;
+    double best_quality = 0;
+    for (const auto& [media_type, quality] : parse_weighted_header(accept_header)) {
+        ResponseFormat format;
+        if (_get_media_type_format(media_type, format) && quality > best_quality) {
+            best_format = format;
+            best_quality = quality;
+        }
+    }
+    return best_format;
+}
+
+auto ResponseFormatUtils::parse_weighted_header(const std::string& header)
+    -> std::vector<std::pair<std::string, double>> {
+    std::vector<std::pair<std::string, double>> values;
+    size_t start = 0;
+    while (start < header.size()) {
+        auto end = header.find(',', start);
+        if (end == std::string::npos) {
+            end = header.size();
+        }
+        auto item = header.substr(start, end - start);
+        start = end + 1;
+
+        auto parameters_start = item.find(';');
+        auto value = _trim(item.substr(0, parameters_start));
+        if (value.empty()) {
+            continue;
+        }
+        std::transform(value.begin(), value.end(), value.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+        auto quality = parameters_start == std::string::npos
+                           ? 1.0
+                           : _parse_quality(item.substr(parameters_start + 1));
+        values.emplace_back(std::move(value), quality);
+    }
+    return values;
+}
+
+auto ResponseFormatUtils::get_content_type(const ResponseFormat& format) -> std::string {
+    switch (format) {
+        case ResponseFormat::Bson:
+            return "application/bson";
+        case ResponseFormat::MessagePack:
+            return "application/msgpack";
+        default:
+            return "application/json";
+    }
+}
+
+auto ResponseFormatUtils::encode_response_data(const crow::json::wvalue& data,
+                                               const ResponseFormat& format) -> std::string {
+    auto data_json = data.dump();
+    switch (format) {
+        case ResponseFormat::Bson: {
+            auto document = bsoncxx::from_json(data_json);
+            return std::string(reinterpret_cast<const char*>(document.view().data()),
+                               document.view().length());
+        }
+        case ResponseFormat::MessagePack: {
+            std::string out;
+            MsgpackResponseEncoder::encode_json(crow::json::load(data_json), out);
+            return out;
+        }
+        default:
+            return data_json;
+    }
+}
+
+auto ResponseFormatUtils::_get_media_type_format(const std::string& media_type,
+                                                 ResponseFormat& format) -> bool {
+    if (media_type == "application/json") {
+        format = ResponseFormat::Json;
+    } else if (media_type == "application/bson") {
+        format = ResponseFormat::Bson;
+    } else if (media_type == "application/msgpack" || media_type == "application/x-msgpack" ||
+               media_type == "application/vnd.msgpack") {
+        format = ResponseFormat::MessagePack;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+auto ResponseFormatUtils::_parse_quality(const std::string& parameters) -> double {
+    size_t start = 0;
+    while (start < parameters.size()) {
+        auto end = parameters.find(';', start);
+        if (end == std::string::npos) {
+            end = parameters.size();
+        }
+        auto parameter = _trim(parameters.substr(start, end - start));
+        start = end + 1;
+        if (parameter.size() > 2 && (parameter[0] == 'q' || parameter[0] == 'Q') &&
+            parameter[1] == '=') {
+            return std::strtod(parameter.c_str() + 2, nullptr);
+        }
+    }
+    return 1.0;
+}
+
+auto ResponseFormatUtils::_trim(const std::string& str) -> std::string {
+    auto start = str.find_first_not_of(" \t");
+    if (start == std::string::npos) {
+        return "";
+    }
+    auto end = str.find_last_not_of(" \t");
+    return str.substr(start, end - start + 1);
+}
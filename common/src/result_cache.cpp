@@ -0,0 +1,193 @@
+#include "result_cache.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "entity_tag.hpp"
+#include "request_context.hpp"
+
+ResultCache::ResultCache(const std::string& name, std::shared_ptr<MetricsManager> metrics_manager,
+                         const bool& is_enabled, const int& ttl_ms, const int& max_entries)
+    : name{name},
+      metrics_manager{metrics_manager},
+      is_enabled{is_enabled},
+      ttl{ttl_ms},
+      max_entries{static_cast<size_t>(max_entries)} {
+    if (ttl_ms <= 0 || max_entries <= 0) {
+        throw std::invalid_argument("Result caching needs a positive TTL and entry limit.");
+    }
+}
+
+std::shared_ptr<ResultCache> ResultCache::create_from_env(
+    const std::string& name, std::shared_ptr<MetricsManager> metrics_manager,
+    EnvManager env_manager) {
+    auto RESULT_CACHE_ENABLED =
+        env_manager.read_env("RESULT_CACHE_ENABLED", Constants::DEFAULT_RESULT_CACHE_ENABLED) ==
+        "true";
+    auto RESULT_CACHE_TTL_MS =
+        stoi(env_manager.read_env("RESULT_CACHE_TTL_MS", Constants::DEFAULT_RESULT_CACHE_TTL_MS));
+    auto RESULT_CACHE_MAX_ENTRIES = stoi(env_manager.read_env(
+        "RESULT_CACHE_MAX_ENTRIES", Constants::DEFAULT_RESULT_CACHE_MAX_ENTRIES));
+    return std::make_shared<ResultCache>(name, metrics_manager, RESULT_CACHE_ENABLED,
+                                         RESULT_CACHE_TTL_MS, RESULT_CACHE_MAX_ENTRIES);
+}
+
+auto ResultCache::make_key(const std::string& route, const crow::request& req) -> std::string {
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    if (!body) {
+        return "";
+    }
+    std::string key = route;
+    key += '\n';
+    key += std::to_string(static_cast<int>(context->get_response_format()));
+    key += '\n';
+    _append_canonical_json(body, key);
+    return key;
+}
+
+auto ResultCache::get_or_compute(const std::string& route, const crow::request& req,
+                                 const std::function<crow::response()>& compute_func)
+    -> crow::response {
+    if (!is_enabled) {
+        return compute_func();
+    }
+    auto key = make_key(route, req);
+    if (key.empty()) {
+        return compute_func();
+    }
+
+    long long int computed_generation;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second.expires_at > std::chrono::steady_clock::now()) {
+            metrics_manager->increment_counter(_metric_name("hits"));
+            // the cache generation stands in for a collection version, so a client that
+            // already holds this result is answered without a query or a body copy
+            auto etag = it->second.headers.find("ETag");
+            if (etag != it->second.headers.end() &&
+                EntityTagUtils::matches_if_none_match(req.get_header_value("If-None-Match"),
+                                                      etag->second)) {
+                return EntityTagUtils::make_not_modified_response(etag->second);
+            }
+            crow::response res(it->second.code);
+            res.headers = it->second.headers;
+            res.body = it->second.body;
+            return res;
+        }
+        computed_generation = generation;
+    }
+    metrics_manager->increment_counter(_metric_name("misses"));
+
+    auto res = compute_func();
+    if (res.code == 200) {
+        _store(key, res, computed_generation);
+    }
+    return res;
+}
+
+void ResultCache::invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++generation;
+    entries.clear();
+    metrics_manager->increment_counter(_metric_name("invalidations"));
+}
+
+void ResultCache::watch_collection(std::shared_ptr<DatabaseManager> db_manager,
+                                   const std::string& collection_name) {
+    if (watcher) {
+        throw std::logic_error("A result cache watches at most one collection.");
+    }
+    watcher = std::make_unique<CollectionWatcher>(db_manager, collection_name,
+                                                  [this]() { invalidate(); });
+}
+
+auto ResultCache::get_is_enabled() const -> bool { return is_enabled; }
+
+auto ResultCache::size() -> size_t {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+void ResultCache::_append_canonical_json(const crow::json::rvalue& value, std::string& out) {
+    switch (value.t()) {
+        case crow::json::type::Object: {
+            std::vector<const crow::json::rvalue*> items;
+            for (const auto& item : value) {
+                items.push_back(&item);
+            }
+            std::sort(items.begin(), items.end(),
+                      [](const auto* lhs, const auto* rhs) { return lhs->key() < rhs->key(); });
+            out += '{';
+            for (size_t i = 0; i < items.size(); ++i) {
+                if (i > 0) {
+                    out += ',';
+                }
+                out += '"';
+                crow::json::escape(items[i]->key(), out);
+                out += "\":";
+                _append_canonical_json(*items[i], out);
+            }
+            out += '}';
+            break;
+        }
+        case crow::json::type::List: {
+            out += '[';
+            bool is_first = true;
+            for (const auto& item : value) {
+                if (!is_first) {
+                    out += ',';
+                }
+                is_first = false;
+                _append_canonical_json(item, out);
+            }
+            out += ']';
+            break;
+        }
+        case crow::json::type::String:
+            out += '"';
+            crow::json::escape(value.s(), out);
+            out += '"';
+            break;
+        default:
+            // numbers are re-serialized so 1.0 and 1.00 share a key
+            out += crow::json::wvalue(value).dump();
+            break;
+    }
+}
+
+void ResultCache::_store(const std::string& key, const crow::response& res,
+                         const long long int& computed_generation) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (generation != computed_generation) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (entries.size() >= max_entries && entries.find(key) == entries.end()) {
+        _evict(now);
+    }
+    entries[key] = {res.code, res.headers, res.body, now + ttl};
+}
+
+void ResultCache::_evict(const std::chrono::steady_clock::time_point& now) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        it = it->second.expires_at <= now ? entries.erase(it) : std::next(it);
+    }
+    if (entries.size() < max_entries) {
+        return;
+    }
+    // entries share one TTL, so the one expiring first is the oldest
+    auto oldest = std::min_element(entries.begin(), entries.end(),
+                                   [](const auto& lhs, const auto& rhs) {
+                                       return lhs.second.expires_at < rhs.second.expires_at;
+                                   });
+    entries.erase(oldest);
+    metrics_manager->increment_counter(_metric_name("evictions"));
+}
+
+auto ResultCache::_metric_name(const std::string& name) const -> std::string {
+    return "result_cache." + this->name + "." + name;
+}
@@ -0,0 +1,115 @@
+#include "sentiment_sketch.hpp"
+
+#include <algorithm>
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/types.hpp>
+#include <cmath>
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
+using bsoncxx::builder::basic::make_document;
+
+static auto get_bin_start(const int& bin) -> double {
+    return SentimentSketch::MIN_SENTIMENT + bin / SentimentSketch::BINS_PER_UNIT;
+}
+
+auto SentimentSketch::get_bin(const double& sentiment) -> int {
+    auto bin = std::floor((sentiment - MIN_SENTIMENT) * BINS_PER_UNIT);
+    return static_cast<int>(std::min<double>(std::max<double>(bin, 0), BIN_COUNT - 1));
+}
+
+auto SentimentSketch::make_bin_expression(const std::string& sentiment_path)
+    -> bsoncxx::document::value {
+    // the same double operations as get_bin, so both put a sentiment in the same bin
+    auto offset = make_document(kvp("$subtract", make_array(sentiment_path, MIN_SENTIMENT)));
+    auto scaled = make_document(kvp("$multiply", make_array(offset.view(), BINS_PER_UNIT)));
+    auto at_least_first = make_document(
+        kvp("$max", make_array(make_document(kvp("$floor", scaled.view())), 0)));
+    auto bin = make_document(kvp(
+        "$toInt", make_document(kvp("$min", make_array(at_least_first.view(), BIN_COUNT - 1)))));
+    return make_document(kvp(
+        "$cond", make_array(make_document(kvp("$isNumber", sentiment_path)), bin.view(),
+                            bsoncxx::types::b_null())));
+}
+
+void SentimentSketch::add(const double& sentiment, const long long int& count) {
+    add_bin(get_bin(sentiment), count);
+    if (count > 0) {
+        include_range(sentiment, sentiment);
+    }
+}
+
+void SentimentSketch::add_bin(const int& bin, const long long int& count) {
+    if (bin < 0 || bin >= BIN_COUNT) {
+        return;
+    }
+    bins[bin] += count;
+    this->count += count;
+}
+
+void SentimentSketch::include_range(const double& min_sentiment, const double& max_sentiment) {
+    this->min_sentiment = std::min(this->min_sentiment, min_sentiment);
+    this->max_sentiment = std::max(this->max_sentiment, max_sentiment);
+}
+
+void SentimentSketch::merge(const SentimentSketch& other) {
+    for (int bin = 0; bin < BIN_COUNT; ++bin) {
+        bins[bin] += other.bins[bin];
+    }
+    count += other.count;
+    include_range(other.min_sentiment, other.max_sentiment);
+}
+
+auto SentimentSketch::get_count() const -> long long int { return count; }
+
+auto SentimentSketch::get_bin_count(const int& bin) const -> long long int {
+    return bin >= 0 && bin < BIN_COUNT ? bins[bin] : 0;
+}
+
+auto SentimentSketch::get_quantile(const double& q) const -> double {
+    if (count <= 0) {
+        return 0;
+    }
+    auto rank = std::min(std::max(q, 0.0), 1.0) * count;
+    long long int before = 0;
+    for (int bin = 0; bin < BIN_COUNT; ++bin) {
+        if (bins[bin] > 0 && before + bins[bin] >= rank) {
+            // the middle of the bin is within half a bin width of any sentiment in it
+            auto estimate = get_bin_start(bin) + 0.5 / BINS_PER_UNIT;
+            return std::min(std::max(estimate, get_min()), get_max());
+        }
+        before += bins[bin];
+    }
+    return get_max();
+}
+
+auto SentimentSketch::get_min() const -> double {
+    if (count <= 0) {
+        return 0;
+    }
+    if (std::isfinite(min_sentiment)) {
+        return min_sentiment;
+    }
+    for (int bin = 0; bin < BIN_COUNT; ++bin) {
+        if (bins[bin] > 0) {
+            return get_bin_start(bin);
+        }
+    }
+    return 0;
+}
+
+auto SentimentSketch::get_max() const -> double {
+    if (count <= 0) {
+        return 0;
+    }
+    if (std::isfinite(max_sentiment)) {
+        return max_sentiment;
+    }
+    for (int bin = BIN_COUNT - 1; bin >= 0; --bin) {
+        if (bins[bin] > 0) {
+            return get_bin_start(bin + 1);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include "write_coalescer.hpp"
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <iostream>
+#include <mongocxx/exception/exception.hpp>
+#include <stdexcept>
+#include <vector>
+
+using bsoncxx::builder::basic::kvp;
+
+WriteCoalescer::WriteCoalescer(std::shared_ptr<DatabaseManager> db_manager,
+                               const std::string& collection_name,
+                               std::shared_ptr<MetricsManager> metrics_manager,
+                               const int& window_ms, const int& max_batch_size,
+                               const int& max_latency_ms)
+    : db_manager{db_manager},
+      collection_name{collection_name},
+      metrics_manager{metrics_manager},
+      window{window_ms},
+      max_batch_size{static_cast<size_t>(max_batch_size)},
+      max_latency{max_latency_ms} {
+    if (window_ms < 0 || max_batch_size <= 0 || max_latency_ms < window_ms) {
+        throw std::invalid_argument(
+            "Write coalescing needs a non-negative window, a positive batch size and a max "
+            "latency no shorter than the window.");
+    }
+    flusher = std::thread([this]() { _run_flusher(); });
+}
+
+WriteCoalescer::~WriteCoalescer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        is_stopping = true;
+    }
+    pending_changed.notify_all();
+    flusher.join();
+}
+
+std::shared_ptr<WriteCoalescer> WriteCoalescer::create_from_env(
+    std::shared_ptr<DatabaseManager> db_manager, const std::string& collection_name,
+    std::shared_ptr<MetricsManager> metrics_manager, EnvManager env_manager) {
+    auto WRITE_COALESCING_WINDOW_MS = stoi(env_manager.read_env(
+        "WRITE_COALESCING_WINDOW_MS", Constants::DEFAULT_WRITE_COALESCING_WINDOW_MS));
+    auto WRITE_COALESCING_MAX_BATCH_SIZE = stoi(env_manager.read_env(
+        "WRITE_COALESCING_MAX_BATCH_SIZE", Constants::DEFAULT_WRITE_COALESCING_MAX_BATCH_SIZE));
+    auto WRITE_COALESCING_MAX_LATENCY_MS = stoi(env_manager.read_env(
+        "WRITE_COALESCING_MAX_LATENCY_MS", Constants::DEFAULT_WRITE_COALESCING_MAX_LATENCY_MS));
+    return std::make_shared<WriteCoalescer>(db_manager, collection_name, metrics_manager,
+                                            WRITE_COALESCING_WINDOW_MS,
+                                            WRITE_COALESCING_MAX_BATCH_SIZE,
+                                            WRITE_COALESCING_MAX_LATENCY_MS);
+}
+
+auto WriteCoalescer::insert_one(const bsoncxx::document::view& document)
+    -> CoalescedInsertResult {
+    std::promise<CoalescedInsertResult> promise;
+    auto future = promise.get_future();
+    insert_one(document, [&promise](const CoalescedInsertResult& result) {
+        promise.set_value(result);
+    });
+    return future.get();
+}
+
+void WriteCoalescer::insert_one(const bsoncxx::document::view& document,
+                                std::function<void(const CoalescedInsertResult&)> on_written) {
+    // the oid is assigned here because a bulk write does not report inserted ids
+    bsoncxx::oid oid;
+    bsoncxx::builder::basic::document builder;
+    if (document["_id"]) {
+        if (document["_id"].type() != bsoncxx::type::k_oid) {
+            throw std::invalid_argument("Coalesced inserts only support ObjectId _id values.");
+        }
+        oid = document["_id"].get_oid().value;
+    } else {
+        builder.append(kvp("_id", oid));
+    }
+    for (const auto& element : document) {
+        builder.append(kvp(element.key(), element.get_value()));
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    bool is_backlogged =
+        !pending_inserts.empty() && now - pending_inserts.front().enqueued_at > max_latency;
+    if (is_stopping || is_backlogged) {
+        lock.unlock();
+        metrics_manager->increment_counter(_metric_name("bypassed_inserts"));
+        on_written({oid, _insert_directly(builder.view())});
+        return;
+    }
+
+    pending_inserts.push_back(
+        {builder.extract(), now, [oid, on_written](const BulkWriteItemResult& item_result) {
+             on_written({oid, item_result});
+         }});
+    if (pending_inserts.size() == 1 || pending_inserts.size() >= max_batch_size) {
+        pending_changed.notify_one();
+    }
+}
+
+auto WriteCoalescer::get_max_batch_size() const -> int { return static_cast<int>(max_batch_size); }
+
+void WriteCoalescer::_run_flusher() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        pending_changed.wait(lock, [this]() { return is_stopping || !pending_inserts.empty(); });
+        if (pending_inserts.empty()) {
+            return;
+        }
+
+        // hold the batch open for the window unless it fills up first
+        auto deadline = pending_inserts.front().enqueued_at + window;
+        pending_changed.wait_until(lock, deadline, [this]() {
+            return is_stopping || pending_inserts.size() >= max_batch_size;
+        });
+
+        std::deque<PendingInsert> batch;
+        while (!pending_inserts.empty() && batch.size() < max_batch_size) {
+            batch.push_back(std::move(pending_inserts.front()));
+            pending_inserts.pop_front();
+        }
+
+        lock.unlock();
+        _flush(batch);
+        lock.lock();
+    }
+}
+
+void WriteCoalescer::_flush(std::deque<PendingInsert>& batch) {
+    auto started_at = std::chrono::steady_clock::now();
+    metrics_manager->increment_counter(_metric_name("batches"));
+    metrics_manager->observe(_metric_name("batch_size"), batch.size());
+
+    std::vector<BulkWriteOperation> operations;
+    for (auto& pending_insert : batch) {
+        operations.push_back(BulkWriteOperation::insert_one(pending_insert.document.view()));
+        std::chrono::duration<double, std::milli> added_latency =
+            started_at - pending_insert.enqueued_at;
+        metrics_manager->observe(_metric_name("added_latency_ms"), added_latency.count());
+    }
+
+    std::vector<BulkWriteItemResult> item_results;
+    try {
+        item_results =
+            db_manager->bulk_write(collection_name, operations, max_batch_size).item_results;
+    } catch (const std::exception& e) {
+        std::cerr << "[WriteCoalescer] Batch insert into " << collection_name
+                  << " failed: " << e.what() << std::endl;
+        item_results.assign(batch.size(), {BulkWriteItemStatus::Failed, 0, e.what()});
+    }
+
+    // every caller is answered exactly once, even if an earlier callback throws
+    for (size_t i = 0; i < batch.size(); ++i) {
+        try {
+            batch[i].on_written(item_results[i]);
+        } catch (const std::exception& e) {
+            std::cerr << "[WriteCoalescer] Callback failed: " << e.what() << std::endl;
+        }
+    }
+}
+
+auto WriteCoalescer::_insert_directly(const bsoncxx::document::view& document)
+    -> BulkWriteItemResult {
+    try {
+        db_manager->insert_one(collection_name, document);
+        return {};
+    } catch (const mongocxx::exception& e) {
+        auto status = e.code().value() == Constants::MONGO_DUPLICATE_KEY_ERROR_CODE
+                          ? BulkWriteItemStatus::DuplicateKey
+                          : BulkWriteItemStatus::Failed;
+        return {status, e.code().value(), e.what()};
+    }
+}
+
+auto WriteCoalescer::_metric_name(const std::string& name) const -> std::string {
+    return "write_coalescer." + collection_name + "." + name;
+}
@@ -1,18 +1,36 @@
 #ifndef ANALYTICS_API_HANDLER_H
 #define ANALYTICS_API_HANDLER_H
 
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base_api_handler.hpp"
+#include "complaint_column_store.hpp"
+#include "complaint_rollup_manager.hpp"
 #include "crow.h"
 #include "database_manager.hpp"
+#include "replicated_collection.hpp"
+#include "result_cache.hpp"
 
 class AnalyticsApiHandler : public BaseApiHandler {
    public:
+    // Without a result cache every statistics request runs its aggregation. Without a rollup
+    // manager the over-time statistics are always aggregated from complaints. Without a column
+    // store the statistics are never scanned in-process.
+    explicit AnalyticsApiHandler(
+        std::shared_ptr<ResultCache> complaints_result_cache = nullptr,
+        std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager = nullptr,
+        std::shared_ptr<ComplaintColumnStore> complaint_column_store = nullptr);
+
     auto get_one_by_name(const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
                          const std::string& collection_name) -> crow::response;
 
+    auto get_one_by_name(const crow::request& req,
+                         std::shared_ptr<ReplicatedCollection> replicated_collection)
+        -> crow::response;
+
     auto get_complaints_statistics(const crow::request& req,
                                    std::shared_ptr<DatabaseManager> db_manager,
                                    const std::string& collection_name) -> crow::response;
@@ -34,7 +52,35 @@ class AnalyticsApiHandler : public BaseApiHandler {
         const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
         const std::string& collection_name) -> crow::response;
 
+    // Complaints are cached like their statistics; other collections are always aggregated.
+    auto get_distinct_count_over_time(const crow::request& req,
+                                      std::shared_ptr<DatabaseManager> db_manager,
+                                      const std::string& collection_name) -> crow::response;
+
+    // Called by writers of the complaints collection once they are done.
+    auto invalidate_complaints_statistics(const crow::request& req) -> crow::response;
+
    private:
+    std::shared_ptr<ResultCache> complaints_result_cache;
+    std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager;
+    std::shared_ptr<ComplaintColumnStore> complaint_column_store;
+
+    auto _can_use_complaint_rollups(const crow::request& req) -> bool;
+
+    // Answers from the column store, or with fallback_func while the store is stale or the
+    // request filters on fields it does not keep.
+    auto _scan_complaint_column_store(
+        const crow::request& req,
+        const std::function<bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>>(
+            const crow::request&, const ComplaintColumnStore::Columns&)>& scan_func,
+        const std::function<crow::json::wvalue(
+            const crow::request&, const std::vector<bsoncxx::document::value>&)>&
+            process_response_func,
+        const std::function<crow::response()>& fallback_func) -> crow::response;
+
+    auto _get_cached_complaints_statistics(const std::string& route, const crow::request& req,
+                                           const std::function<crow::response()>& compute_func)
+        -> crow::response;
 };
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <bsoncxx/stdx/optional.hpp>
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
 #include <mongocxx/uri.hpp>
@@ -11,6 +12,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "complaint_column_store.hpp"
 #include "crow.h"
 
 namespace AnalyticsApiStrategy {
@@ -27,8 +29,37 @@ auto process_request_func_get_complaints_statistics_grouped_over_time(const crow
 auto process_request_func_get_complaints_statistics_grouped_by_sentiment_value(
     const crow::request& req)
     -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate>;
+// For posts as well as complaints.
+auto process_request_func_get_distinct_count_over_time(const crow::request& req)
+    -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate>;
 
-auto create_pipeline_func_filter_and_group(const std::vector<bsoncxx::document::value>& documents)
+// complaint_rollups can answer the over-time statistics exactly when the filter selects whole
+// months and otherwise only rollup dimensions, and any grouping is by rollup dimensions.
+auto can_use_complaint_rollups(const crow::request& req) -> bool;
+auto _is_month_start(const long long int& utc_unix_timestamp) -> bool;
+// The same statistics as their complaints counterparts, summed from complaint_rollups instead.
+auto process_request_func_get_complaints_statistics_over_time_from_rollups(
+    const crow::request& req)
+    -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate>;
+auto process_request_func_get_complaints_statistics_grouped_over_time_from_rollups(
+    const crow::request& req)
+    -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate>;
+// The stages after the filter that compute the statistics of each group, including the sentiment
+// histogram the percentiles are estimated from. group_id is {"_id": <$group _id expression>}.
+auto _make_statistics_stages(const bsoncxx::document::view& group_id)
+    -> std::vector<bsoncxx::document::value>;
+// _make_statistics_stages over rollups, merging their histograms.
+auto _make_rollup_statistics_stages(const bsoncxx::document::view& group_id)
+    -> std::vector<bsoncxx::document::value>;
+auto _make_statistics_projection() -> bsoncxx::document::value;
+// The stages after the filter that give each group the HyperLogLog registers of distinct_field,
+// as a list of { register, rank }.
+auto _make_distinct_count_stages(const std::string& distinct_field,
+                                 const bsoncxx::document::view& group_id)
+    -> std::vector<bsoncxx::document::value>;
+
+// documents are the $match filter, then whole stages such as {"$group": ...}, in order
+auto create_pipeline_func_filter_and_stages(const std::vector<bsoncxx::document::value>& documents)
     -> mongocxx::pipeline;
 auto create_pipeline_func_filter_and_bucket(const std::vector<bsoncxx::document::value>& documents)
     -> mongocxx::pipeline;
@@ -47,6 +78,61 @@ auto process_response_func_get_complaints_statistics_grouped_over_time(const cro
     -> crow::json::wvalue;
 auto process_response_func_get_complaints_statistics_grouped_by_sentiment_value(
     const crow::request& req, mongocxx::cursor& cursor) -> crow::json::wvalue;
+auto process_response_func_get_distinct_count_over_time(const crow::request& req,
+                                                        mongocxx::cursor& cursor)
+    -> crow::json::wvalue;
+// The same, for the documents of the scan functions.
+auto process_response_func_get_complaints_statistics_from_scan(
+    const crow::request& req, const std::vector<bsoncxx::document::value>& documents)
+    -> crow::json::wvalue;
+auto process_response_func_get_complaints_statistics_over_time_from_scan(
+    const crow::request& req, const std::vector<bsoncxx::document::value>& documents)
+    -> crow::json::wvalue;
+auto process_response_func_get_complaints_statistics_grouped_from_scan(
+    const crow::request& req, const std::vector<bsoncxx::document::value>& documents)
+    -> crow::json::wvalue;
+auto process_response_func_get_complaints_statistics_grouped_over_time_from_scan(
+    const crow::request& req, const std::vector<bsoncxx::document::value>& documents)
+    -> crow::json::wvalue;
+auto process_response_func_get_complaints_statistics_grouped_by_sentiment_value_from_scan(
+    const crow::request& req, const std::vector<bsoncxx::document::value>& documents)
+    -> crow::json::wvalue;
+
+// The statistics scanned from the complaint column store, as the documents the aggregations
+// return; nullopt when the request uses a field or grouping the store does not keep. Requests are
+// validated like their aggregations first.
+auto scan_func_get_complaints_statistics(const crow::request& req,
+                                         const ComplaintColumnStore::Columns& columns)
+    -> bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>>;
+auto scan_func_get_complaints_statistics_over_time(const crow::request& req,
+                                                   const ComplaintColumnStore::Columns& columns)
+    -> bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>>;
+auto scan_func_get_complaints_statistics_grouped(const crow::request& req,
+                                                 const ComplaintColumnStore::Columns& columns)
+    -> bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>>;
+auto scan_func_get_complaints_statistics_grouped_over_time(
+    const crow::request& req, const ComplaintColumnStore::Columns& columns)
+    -> bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>>;
+auto scan_func_get_complaints_statistics_grouped_by_sentiment_value(
+    const crow::request& req, const ComplaintColumnStore::Columns& columns)
+    -> bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>>;
+// Supports date and sentiment ranges and equalities, and category and source equalities.
+auto _parse_column_store_filter(const crow::json::rvalue& filter_json,
+                                const ComplaintColumnStore::Columns& columns,
+                                ComplaintColumnStore::Filter& filter) -> bool;
+auto _parse_column_store_dimension(const std::string& group_by_field,
+                                   ComplaintColumnStore::Dimension& dimension) -> bool;
+auto _make_statistics_documents(const std::vector<ComplaintColumnStore::Group>& groups,
+                                const ComplaintColumnStore::Columns& columns,
+                                const std::string& group_by_field)
+    -> std::vector<bsoncxx::document::value>;
+
+auto _get_distinct_field(const crow::json::rvalue& body) -> std::string;
+// The fields of group_by_field, or of the group_by_fields list; throws when neither is valid.
+auto _get_group_by_fields(const crow::json::rvalue& body) -> std::vector<std::string>;
+// A compound $group _id with one key per field, after year and month when is_by_month.
+auto _make_group_id(const std::vector<std::string>& group_by_fields, const bool& is_by_month)
+    -> bsoncxx::document::value;
 
 auto _create_month_range(const std::string& start_date, const std::string& end_date)
     -> std::vector<std::pair<int, int>>;
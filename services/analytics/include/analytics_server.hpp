@@ -9,12 +9,17 @@
 
 #include "analytics_api_handler.hpp"
 #include "base_server.hpp"
+#include "complaint_column_store.hpp"
+#include "complaint_rollup_manager.hpp"
 #include "concurrency_manager.hpp"
 #include "constants.hpp"
 #include "cors.hpp"
 #include "crow.h"
 #include "database_manager.hpp"
 #include "jwt_manager.hpp"
+#include "replicated_collection.hpp"
+#include "request_coalescer.hpp"
+#include "result_cache.hpp"
 
 class AnalyticsServer : public BaseServer {
    public:
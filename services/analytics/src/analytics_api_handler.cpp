@@ -6,7 +6,18 @@
 
 #include "analytics_api_strategy.hpp"
 #include "base_api_strategy.hpp"
+#include "base_api_strategy_utils.hpp"
+#include "constants.hpp"
 #include "crow.h"
+#include "entity_tag.hpp"
+
+AnalyticsApiHandler::AnalyticsApiHandler(
+    std::shared_ptr<ResultCache> complaints_result_cache,
+    std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager,
+    std::shared_ptr<ComplaintColumnStore> complaint_column_store)
+    : complaints_result_cache{complaints_result_cache},
+      complaint_rollup_manager{complaint_rollup_manager},
+      complaint_column_store{complaint_column_store} {}
 
 auto AnalyticsApiHandler::get_one_by_name(const crow::request& req,
                                           std::shared_ptr<DatabaseManager> db_manager,
@@ -16,53 +27,203 @@ auto AnalyticsApiHandler::get_one_by_name(const crow::request& req,
                     BaseApiStrategy::process_response_func_get_one);
 }
 
-auto AnalyticsApiHandler::get_complaints_statistics(const crow::request& req,
-                                                    std::shared_ptr<DatabaseManager> db_manager,
-                                                    const std::string& collection_name)
+auto AnalyticsApiHandler::get_one_by_name(
+    const crow::request& req, std::shared_ptr<ReplicatedCollection> replicated_collection)
     -> crow::response {
-    return aggregate(req, db_manager, collection_name,
-                     AnalyticsApiStrategy::process_request_func_get_complaints_statistics,
-                     AnalyticsApiStrategy::create_pipeline_func_filter_and_group,
-                     AnalyticsApiStrategy::process_response_func_get_complaints_statistics);
+    return find_one(req, replicated_collection,
+                    AnalyticsApiStrategy::process_request_func_get_one_by_name,
+                    BaseApiStrategy::process_response_func_get_one);
+}
+
+auto AnalyticsApiHandler::get_complaints_statistics(
+    const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
+    const std::string& collection_name) -> crow::response {
+    auto aggregate_func = [&]() {
+        return aggregate(
+            req, db_manager, collection_name,
+            AnalyticsApiStrategy::process_request_func_get_complaints_statistics,
+            AnalyticsApiStrategy::create_pipeline_func_filter_and_stages,
+            AnalyticsApiStrategy::process_response_func_get_complaints_statistics);
+    };
+    auto compute_func = [&]() {
+        return _scan_complaint_column_store(
+            req, AnalyticsApiStrategy::scan_func_get_complaints_statistics,
+            AnalyticsApiStrategy::process_response_func_get_complaints_statistics_from_scan,
+            aggregate_func);
+    };
+    return _get_cached_complaints_statistics(__func__, req, compute_func);
 }
 
 auto AnalyticsApiHandler::get_complaints_statistics_over_time(
     const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
     const std::string& collection_name) -> crow::response {
-    return aggregate(
-        req, db_manager, collection_name,
-        AnalyticsApiStrategy::process_request_func_get_complaints_statistics_over_time,
-        AnalyticsApiStrategy::create_pipeline_func_filter_and_group,
-        AnalyticsApiStrategy::process_response_func_get_complaints_statistics_over_time);
+    auto aggregate_func = [&]() {
+        if (_can_use_complaint_rollups(req)) {
+            return aggregate(
+                req, db_manager, Constants::COLLECTION_COMPLAINT_ROLLUPS,
+                AnalyticsApiStrategy::
+                    process_request_func_get_complaints_statistics_over_time_from_rollups,
+                AnalyticsApiStrategy::create_pipeline_func_filter_and_stages,
+                AnalyticsApiStrategy::process_response_func_get_complaints_statistics_over_time);
+        }
+        return aggregate(
+            req, db_manager, collection_name,
+            AnalyticsApiStrategy::process_request_func_get_complaints_statistics_over_time,
+            AnalyticsApiStrategy::create_pipeline_func_filter_and_stages,
+            AnalyticsApiStrategy::process_response_func_get_complaints_statistics_over_time);
+    };
+    auto compute_func = [&]() {
+        return _scan_complaint_column_store(
+            req, AnalyticsApiStrategy::scan_func_get_complaints_statistics_over_time,
+            AnalyticsApiStrategy::
+                process_response_func_get_complaints_statistics_over_time_from_scan,
+            aggregate_func);
+    };
+    return _get_cached_complaints_statistics(__func__, req, compute_func);
 }
 
 auto AnalyticsApiHandler::get_complaints_statistics_grouped(
     const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
     const std::string& collection_name) -> crow::response {
-    return aggregate(req, db_manager, collection_name,
-                     AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped,
-                     AnalyticsApiStrategy::create_pipeline_func_filter_and_group,
-                     AnalyticsApiStrategy::process_response_func_get_complaints_statistics_grouped);
+    auto aggregate_func = [&]() {
+        return aggregate(
+            req, db_manager, collection_name,
+            AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped,
+            AnalyticsApiStrategy::create_pipeline_func_filter_and_stages,
+            AnalyticsApiStrategy::process_response_func_get_complaints_statistics_grouped);
+    };
+    auto compute_func = [&]() {
+        return _scan_complaint_column_store(
+            req, AnalyticsApiStrategy::scan_func_get_complaints_statistics_grouped,
+            AnalyticsApiStrategy::
+                process_response_func_get_complaints_statistics_grouped_from_scan,
+            aggregate_func);
+    };
+    return _get_cached_complaints_statistics(__func__, req, compute_func);
 }
 
 auto AnalyticsApiHandler::get_complaints_statistics_grouped_over_time(
     const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
     const std::string& collection_name) -> crow::response {
-    return aggregate(
-        req, db_manager, collection_name,
-        AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped_over_time,
-        AnalyticsApiStrategy::create_pipeline_func_filter_and_group,
-        AnalyticsApiStrategy::process_response_func_get_complaints_statistics_grouped_over_time);
+    auto aggregate_func = [&]() {
+        if (_can_use_complaint_rollups(req)) {
+            return aggregate(
+                req, db_manager, Constants::COLLECTION_COMPLAINT_ROLLUPS,
+                AnalyticsApiStrategy::
+                    process_request_func_get_complaints_statistics_grouped_over_time_from_rollups,
+                AnalyticsApiStrategy::create_pipeline_func_filter_and_stages,
+                AnalyticsApiStrategy::
+                    process_response_func_get_complaints_statistics_grouped_over_time);
+        }
+        return aggregate(
+            req, db_manager, collection_name,
+            AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped_over_time,
+            AnalyticsApiStrategy::create_pipeline_func_filter_and_stages,
+            AnalyticsApiStrategy::
+                process_response_func_get_complaints_statistics_grouped_over_time);
+    };
+    auto compute_func = [&]() {
+        return _scan_complaint_column_store(
+            req, AnalyticsApiStrategy::scan_func_get_complaints_statistics_grouped_over_time,
+            AnalyticsApiStrategy::
+                process_response_func_get_complaints_statistics_grouped_over_time_from_scan,
+            aggregate_func);
+    };
+    return _get_cached_complaints_statistics(__func__, req, compute_func);
 }
 
 auto AnalyticsApiHandler::get_complaints_statistics_grouped_by_sentiment_value(
     const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
     const std::string& collection_name) -> crow::response {
-    return aggregate(
-        req, db_manager, collection_name,
-        AnalyticsApiStrategy::
-            process_request_func_get_complaints_statistics_grouped_by_sentiment_value,
-        AnalyticsApiStrategy::create_pipeline_func_filter_and_bucket,
-        AnalyticsApiStrategy::
-            process_response_func_get_complaints_statistics_grouped_by_sentiment_value);
-}
\ No newline at end of file
+    auto aggregate_func = [&]() {
+        return aggregate(
+            req, db_manager, collection_name,
+            AnalyticsApiStrategy::
+                process_request_func_get_complaints_statistics_grouped_by_sentiment_value,
+            AnalyticsApiStrategy::create_pipeline_func_filter_and_bucket,
+            AnalyticsApiStrategy::
+                process_response_func_get_complaints_statistics_grouped_by_sentiment_value);
+    };
+    auto compute_func = [&]() {
+        return _scan_complaint_column_store(
+            req,
+            AnalyticsApiStrategy::scan_func_get_complaints_statistics_grouped_by_sentiment_value,
+            AnalyticsApiStrategy::
+                process_response_func_get_complaints_statistics_grouped_by_sentiment_value_from_scan,
+            aggregate_func);
+    };
+    return _get_cached_complaints_statistics(__func__, req, compute_func);
+}
+
+auto AnalyticsApiHandler::get_distinct_count_over_time(
+    const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
+    const std::string& collection_name) -> crow::response {
+    auto aggregate_func = [&]() {
+        return aggregate(req, db_manager, collection_name,
+                         AnalyticsApiStrategy::process_request_func_get_distinct_count_over_time,
+                         AnalyticsApiStrategy::create_pipeline_func_filter_and_stages,
+                         AnalyticsApiStrategy::process_response_func_get_distinct_count_over_time);
+    };
+    // the complaints cache is only invalidated by complaint writes
+    if (collection_name == Constants::COLLECTION_COMPLAINTS) {
+        return _get_cached_complaints_statistics(__func__, req, aggregate_func);
+    }
+    return aggregate_func();
+}
+
+auto AnalyticsApiHandler::invalidate_complaints_statistics(const crow::request& req)
+    -> crow::response {
+    // the cache may still be refilled from columns that miss the change, and is invalidated
+    // again once the change is loaded
+    if (complaint_column_store) {
+        complaint_column_store->mark_changed();
+    }
+    if (complaints_result_cache) {
+        complaints_result_cache->invalidate();
+    }
+    crow::json::wvalue response_data;
+    return BaseApiStrategyUtils::make_success_response(
+        200, response_data, "Server processed invalidate statistics request successfully.");
+}
+
+auto AnalyticsApiHandler::_get_cached_complaints_statistics(
+    const std::string& route, const crow::request& req,
+    const std::function<crow::response()>& compute_func) -> crow::response {
+    if (!complaints_result_cache) {
+        return compute_func();
+    }
+    return complaints_result_cache->get_or_compute(route, req, compute_func);
+}
+
+auto AnalyticsApiHandler::_can_use_complaint_rollups(const crow::request& req) -> bool {
+    return complaint_rollup_manager && AnalyticsApiStrategy::can_use_complaint_rollups(req);
+}
+
+auto AnalyticsApiHandler::_scan_complaint_column_store(
+    const crow::request& req,
+    const std::function<bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>>(
+        const crow::request&, const ComplaintColumnStore::Columns&)>& scan_func,
+    const std::function<crow::json::wvalue(const crow::request&,
+                                           const std::vector<bsoncxx::document::value>&)>&
+        process_response_func,
+    const std::function<crow::response()>& fallback_func) -> crow::response {
+    if (!complaint_column_store) {
+        return fallback_func();
+    }
+    auto columns = complaint_column_store->get_columns();
+    if (!columns) {
+        return fallback_func();
+    }
+    try {
+        auto documents = scan_func(req, *columns);
+        if (!documents) {
+            return fallback_func();
+        }
+        auto response_data = process_response_func(req, *documents);
+        return EntityTagUtils::tag_response(BaseApiStrategyUtils::make_success_response(
+            200, response_data, "Server processed aggregate request successfully."));
+    } catch (const std::exception& e) {
+        return BaseApiStrategyUtils::make_error_response(
+            500, std::string("Server error: ") + e.what());
+    }
+}
@@ -1,25 +1,39 @@
 #include "analytics_api_strategy.hpp"
 
+#include <algorithm>
+#include <bsoncxx/builder/basic/array.hpp>
 #include <bsoncxx/json.hpp>
+#include <cmath>
+#include <map>
+#include <set>
 #include <string>
 #include <tuple>
 #include <unordered_map>
 
 #include "base_api_strategy_utils.hpp"
+#include "constants.hpp"
 #include "crow.h"
 #include "date_utils.hpp"
+#include "hyper_log_log.hpp"
+#include "request_context.hpp"
+#include "sentiment_sketch.hpp"
 
 using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
 using bsoncxx::builder::basic::make_document;
 
 auto AnalyticsApiStrategy::process_request_func_get_one_by_name(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::find> {
     BaseApiStrategyUtils::validate_fields(req, {"name"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto filter = make_document(kvp("name", body["name"].s()));
 
     mongocxx::options::find option;
+    if (auto projection = BaseApiStrategyUtils::parse_request_json_to_projection(body)) {
+        option.projection(std::move(*projection));
+    }
 
     return std::make_tuple(filter, option);
 }
@@ -28,15 +42,17 @@ auto AnalyticsApiStrategy::process_request_func_get_complaints_statistics(const
     -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate> {
     BaseApiStrategyUtils::validate_fields(req, {"filter"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto filter = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["filter"]);
-    auto group = make_document(kvp("_id", bsoncxx::types::b_null()),
-                               kvp("count", make_document(kvp("$sum", 1))),
-                               kvp("avg_sentiment", make_document(kvp("$avg", "$sentiment"))));
 
-    std::vector<bsoncxx::document::value> documents = {filter, group};
+    std::vector<bsoncxx::document::value> documents = {filter};
+    auto stages = _make_statistics_stages(make_document(kvp("_id", bsoncxx::types::b_null())));
+    documents.insert(documents.end(), stages.begin(), stages.end());
 
     mongocxx::options::aggregate option;
+    // the first $group has a row per group and sentiment bin, up to 200 times the groups
+    option.allow_disk_use(true);
 
     return std::make_tuple(documents, option);
 }
@@ -46,7 +62,8 @@ auto AnalyticsApiStrategy::process_request_func_get_complaints_statistics_over_t
     -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate> {
     BaseApiStrategyUtils::validate_fields(req, {"filter"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     if (!body["filter"].has("_from_date")) {
         throw std::invalid_argument("Invalid request: missing _from_date field in filter");
     }
@@ -55,15 +72,13 @@ auto AnalyticsApiStrategy::process_request_func_get_complaints_statistics_over_t
     }
 
     auto filter = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["filter"]);
-    auto group = make_document(
-        kvp("_id", make_document(kvp("year", make_document(kvp("$year", "$date"))),
-                                 kvp("month", make_document(kvp("$month", "$date"))))),
-        kvp("count", make_document(kvp("$sum", 1))),
-        kvp("avg_sentiment", make_document(kvp("$avg", "$sentiment"))));
 
-    std::vector<bsoncxx::document::value> documents = {filter, group};
+    std::vector<bsoncxx::document::value> documents = {filter};
+    auto stages = _make_statistics_stages(make_document(kvp("_id", _make_group_id({}, true))));
+    documents.insert(documents.end(), stages.begin(), stages.end());
 
     mongocxx::options::aggregate option;
+    option.allow_disk_use(true);
 
     return std::make_tuple(documents, option);
 }
@@ -71,19 +86,23 @@ auto AnalyticsApiStrategy::process_request_func_get_complaints_statistics_over_t
 auto AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped(
     const crow::request& req)
     -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate> {
-    BaseApiStrategyUtils::validate_fields(req, {"group_by_field", "filter"});
+    BaseApiStrategyUtils::validate_fields(req, {"filter"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    auto group_by_fields = _get_group_by_fields(body);
     auto filter = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["filter"]);
 
-    auto group_by_field = static_cast<std::string>(body["group_by_field"].s());
-    auto group =
-        make_document(kvp("_id", "$" + group_by_field), kvp("count", make_document(kvp("$sum", 1))),
-                      kvp("avg_sentiment", make_document(kvp("$avg", "$sentiment"))));
+    auto group_id = body.has("group_by_fields")
+                        ? make_document(kvp("_id", _make_group_id(group_by_fields, false)))
+                        : make_document(kvp("_id", "$" + group_by_fields[0]));
 
-    std::vector<bsoncxx::document::value> documents = {filter, group};
+    std::vector<bsoncxx::document::value> documents = {filter};
+    auto stages = _make_statistics_stages(group_id);
+    documents.insert(documents.end(), stages.begin(), stages.end());
 
     mongocxx::options::aggregate option;
+    option.allow_disk_use(true);
 
     return std::make_tuple(documents, option);
 }
@@ -91,9 +110,11 @@ auto AnalyticsApiStrategy::process_request_func_get_complaints_statistics_groupe
 auto AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped_over_time(
     const crow::request& req)
     -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate> {
-    BaseApiStrategyUtils::validate_fields(req, {"group_by_field", "filter"});
+    BaseApiStrategyUtils::validate_fields(req, {"filter"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    auto group_by_fields = _get_group_by_fields(body);
     if (!body["filter"].has("_from_date")) {
         throw std::invalid_argument("Invalid request: missing _from_date field in filter");
     }
@@ -103,17 +124,46 @@ auto AnalyticsApiStrategy::process_request_func_get_complaints_statistics_groupe
 
     auto filter = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["filter"]);
 
-    auto group_by_field = static_cast<std::string>(body["group_by_field"].s());
-    auto group =
-        make_document(kvp("_id", make_document(kvp("year", make_document(kvp("$year", "$date"))),
-                                               kvp("month", make_document(kvp("$month", "$date"))),
-                                               kvp(group_by_field, "$" + group_by_field))),
-                      kvp("count", make_document(kvp("$sum", 1))),
-                      kvp("avg_sentiment", make_document(kvp("$avg", "$sentiment"))));
+    std::vector<bsoncxx::document::value> documents = {filter};
+    auto stages =
+        _make_statistics_stages(make_document(kvp("_id", _make_group_id(group_by_fields, true))));
+    documents.insert(documents.end(), stages.begin(), stages.end());
+
+    mongocxx::options::aggregate option;
+    option.allow_disk_use(true);
+
+    return std::make_tuple(documents, option);
+}
 
-    std::vector<bsoncxx::document::value> documents = {filter, group};
+auto AnalyticsApiStrategy::process_request_func_get_distinct_count_over_time(
+    const crow::request& req)
+    -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate> {
+    BaseApiStrategyUtils::validate_fields(req, {"filter", "distinct_field"});
+
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    if (!body["filter"].has("_from_date")) {
+        throw std::invalid_argument("Invalid request: missing _from_date field in filter");
+    }
+    if (!body["filter"].has("_to_date")) {
+        throw std::invalid_argument("Invalid request: missing _to_date field in filter");
+    }
+    auto distinct_field = _get_distinct_field(body);
+    std::vector<std::string> group_by_fields;
+    if (body.has("group_by_field") || body.has("group_by_fields")) {
+        group_by_fields = _get_group_by_fields(body);
+    }
+
+    auto filter = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["filter"]);
+
+    std::vector<bsoncxx::document::value> documents = {filter};
+    auto stages = _make_distinct_count_stages(
+        distinct_field, make_document(kvp("_id", _make_group_id(group_by_fields, true))));
+    documents.insert(documents.end(), stages.begin(), stages.end());
 
     mongocxx::options::aggregate option;
+    // a group per month, group value and register can outgrow the memory limit of $group
+    option.allow_disk_use(true);
 
     return std::make_tuple(documents, option);
 }
@@ -124,7 +174,8 @@ auto AnalyticsApiStrategy::
         -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate> {
     BaseApiStrategyUtils::validate_fields(req, {"filter", "bucket_size"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     if (!body["filter"].has("_from_date")) {
         throw std::invalid_argument("Invalid request: missing _from_date field in filter");
     }
@@ -164,15 +215,482 @@ auto AnalyticsApiStrategy::
     return std::make_tuple(documents, option);
 }
 
-auto AnalyticsApiStrategy::create_pipeline_func_filter_and_group(
+auto AnalyticsApiStrategy::can_use_complaint_rollups(const crow::request& req) -> bool {
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    if (body.t() != crow::json::type::Object || !body.has("filter") ||
+        body["filter"].t() != crow::json::type::Object) {
+        return false;
+    }
+    if (body.has("group_by_field") || body.has("group_by_fields")) {
+        std::vector<std::string> group_by_fields;
+        try {
+            group_by_fields = _get_group_by_fields(body);
+        } catch (const std::exception& e) {
+            // the complaints path reports the invalid grouping
+            return false;
+        }
+        for (const auto& group_by_field : group_by_fields) {
+            if (group_by_field != "category" && group_by_field != "source") {
+                return false;
+            }
+        }
+    }
+
+    bool has_from_date = false;
+    bool has_to_date = false;
+    for (const auto& field : body["filter"]) {
+        const auto& key = field.key();
+        if (field.t() != crow::json::type::String) {
+            return false;
+        }
+        if (key == "category" || key == "source") {
+            continue;
+        }
+        if (key != "_from_date" && key != "_to_date") {
+            return false;
+        }
+        auto date = field.s();
+        long long int utc_unix_timestamp;
+        if (!DateUtils::parse_datetime(date.begin(), date.size(), utc_unix_timestamp)) {
+            return false;
+        }
+        // _to_date is inclusive, so a whole month ends one second before the next one starts
+        auto is_from_date = key == "_from_date";
+        if (!_is_month_start(is_from_date ? utc_unix_timestamp : utc_unix_timestamp + 1)) {
+            return false;
+        }
+        if (is_from_date) {
+            has_from_date = true;
+        } else {
+            has_to_date = true;
+        }
+    }
+    return has_from_date && has_to_date;
+}
+
+auto AnalyticsApiStrategy::_is_month_start(const long long int& utc_unix_timestamp) -> bool {
+    const long long int seconds_per_day = 24 * 60 * 60;
+    if (utc_unix_timestamp % seconds_per_day != 0) {
+        return false;
+    }
+    long long int year;
+    unsigned int month;
+    unsigned int day;
+    DateUtils::_civil_from_days(utc_unix_timestamp / seconds_per_day, year, month, day);
+    return day == 1;
+}
+
+auto AnalyticsApiStrategy::process_request_func_get_complaints_statistics_over_time_from_rollups(
+    const crow::request& req)
+    -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate> {
+    auto [documents, option] = process_request_func_get_complaints_statistics_over_time(req);
+
+    auto stages = _make_rollup_statistics_stages(
+        make_document(kvp("_id", _make_group_id({}, true))));
+    documents.erase(documents.begin() + 1, documents.end());
+    documents.insert(documents.end(), stages.begin(), stages.end());
+
+    return std::make_tuple(documents, option);
+}
+
+auto AnalyticsApiStrategy::
+    process_request_func_get_complaints_statistics_grouped_over_time_from_rollups(
+        const crow::request& req)
+        -> std::tuple<std::vector<bsoncxx::document::value>, mongocxx::options::aggregate> {
+    auto [documents, option] =
+        process_request_func_get_complaints_statistics_grouped_over_time(req);
+
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    auto stages = _make_rollup_statistics_stages(
+        make_document(kvp("_id", _make_group_id(_get_group_by_fields(body), true))));
+    documents.erase(documents.begin() + 1, documents.end());
+    documents.insert(documents.end(), stages.begin(), stages.end());
+
+    return std::make_tuple(documents, option);
+}
+
+auto AnalyticsApiStrategy::_make_statistics_stages(const bsoncxx::document::view& group_id)
+    -> std::vector<bsoncxx::document::value> {
+    auto is_number = make_document(kvp("$isNumber", "$sentiment"));
+    auto numeric_sentiment = make_document(
+        kvp("$cond", make_array(is_number.view(), "$sentiment", bsoncxx::types::b_null())));
+    // per group and sentiment bin first, so the second $group gathers each group's histogram
+    auto bin_group = make_document(
+        kvp("_id", make_document(kvp("group", group_id["_id"].get_value()),
+                                 kvp("bin", SentimentSketch::make_bin_expression("$sentiment")))),
+        kvp("count", make_document(kvp("$sum", 1))),
+        kvp("sentiment_count",
+            make_document(kvp("$sum", make_document(kvp(
+                                          "$cond", make_array(is_number.view(), 1, 0)))))),
+        kvp("sentiment_sum", make_document(kvp("$sum", "$sentiment"))),
+        kvp("min_sentiment", make_document(kvp("$min", numeric_sentiment.view()))),
+        kvp("max_sentiment", make_document(kvp("$max", numeric_sentiment.view()))));
+    auto group = make_document(
+        kvp("_id", "$_id.group"), kvp("count", make_document(kvp("$sum", "$count"))),
+        kvp("sentiment_count", make_document(kvp("$sum", "$sentiment_count"))),
+        kvp("sentiment_sum", make_document(kvp("$sum", "$sentiment_sum"))),
+        kvp("min_sentiment", make_document(kvp("$min", "$min_sentiment"))),
+        kvp("max_sentiment", make_document(kvp("$max", "$max_sentiment"))),
+        kvp("sentiment_histogram",
+            make_document(kvp("$push", make_document(kvp("bin", "$_id.bin"),
+                                                     kvp("count", "$sentiment_count"))))));
+
+    return {make_document(kvp("$group", bin_group)), make_document(kvp("$group", group)),
+            make_document(kvp("$project", _make_statistics_projection()))};
+}
+
+auto AnalyticsApiStrategy::_make_rollup_statistics_stages(const bsoncxx::document::view& group_id)
+    -> std::vector<bsoncxx::document::value> {
+    // one row per rollup and histogram bin; only the first row of a rollup adds its totals
+    auto project = make_document(
+        kvp("date", 1), kvp("category", 1), kvp("source", 1), kvp("count", 1),
+        kvp("sentiment_count", 1), kvp("sentiment_sum", 1), kvp("sentiment_min", 1),
+        kvp("sentiment_max", 1),
+        kvp("bins", make_document(kvp(
+                        "$objectToArray",
+                        make_document(kvp("$ifNull", make_array("$sentiment_histogram",
+                                                                make_document())))))));
+    auto unwind = make_document(kvp("path", "$bins"), kvp("includeArrayIndex", "bin_index"),
+                                kvp("preserveNullAndEmptyArrays", true));
+    auto is_first_row = make_document(
+        kvp("$lte", make_array(make_document(kvp("$ifNull", make_array("$bin_index", 0))), 0)));
+    auto first_row_sum = [&is_first_row](const std::string& field) {
+        return make_document(kvp(
+            "$sum", make_document(kvp("$cond", make_array(is_first_row.view(), field, 0)))));
+    };
+    auto bin_group = make_document(
+        kvp("_id", make_document(kvp("group", group_id["_id"].get_value()),
+                                 kvp("bin", "$bins.k"))),
+        kvp("count", first_row_sum("$count")),
+        kvp("sentiment_count", first_row_sum("$sentiment_count")),
+        kvp("sentiment_sum", first_row_sum("$sentiment_sum")),
+        // every row of a rollup has its range, so repeating it does not change the extremes
+        kvp("min_sentiment", make_document(kvp("$min", "$sentiment_min"))),
+        kvp("max_sentiment", make_document(kvp("$max", "$sentiment_max"))),
+        kvp("bin_count", make_document(kvp("$sum", "$bins.v"))));
+    auto group = make_document(
+        kvp("_id", "$_id.group"), kvp("count", make_document(kvp("$sum", "$count"))),
+        kvp("sentiment_count", make_document(kvp("$sum", "$sentiment_count"))),
+        kvp("sentiment_sum", make_document(kvp("$sum", "$sentiment_sum"))),
+        kvp("min_sentiment", make_document(kvp("$min", "$min_sentiment"))),
+        kvp("max_sentiment", make_document(kvp("$max", "$max_sentiment"))),
+        kvp("sentiment_histogram",
+            make_document(kvp("$push", make_document(kvp("bin", "$_id.bin"),
+                                                     kvp("count", "$bin_count"))))));
+    // rollups whose complaints were all deleted stay behind with a zero count
+    auto match = make_document(kvp("count", make_document(kvp("$gt", 0))));
+
+    return {make_document(kvp("$project", project)), make_document(kvp("$unwind", unwind)),
+            make_document(kvp("$group", bin_group)), make_document(kvp("$group", group)),
+            make_document(kvp("$match", match)),
+            make_document(kvp("$project", _make_statistics_projection()))};
+}
+
+auto AnalyticsApiStrategy::_make_statistics_projection() -> bsoncxx::document::value {
+    // null like $avg over complaints without sentiments
+    auto avg_sentiment = make_document(kvp(
+        "$cond",
+        make_array(make_document(kvp("$gt", make_array("$sentiment_count", 0))),
+                   make_document(kvp("$divide", make_array("$sentiment_sum", "$sentiment_count"))),
+                   bsoncxx::types::b_null())));
+    return make_document(kvp("count", 1), kvp("avg_sentiment", avg_sentiment),
+                         kvp("min_sentiment", 1), kvp("max_sentiment", 1),
+                         kvp("sentiment_histogram", 1));
+}
+
+auto AnalyticsApiStrategy::_make_distinct_count_stages(const std::string& distinct_field,
+                                                       const bsoncxx::document::view& group_id)
+    -> std::vector<bsoncxx::document::value> {
+    auto path = "$" + distinct_field;
+    // like $addToSet, documents without the field are not counted
+    auto match = make_document(
+        kvp(distinct_field, make_document(kvp("$ne", bsoncxx::types::b_null()))));
+    // the largest rank per group and register, so each group holds at most REGISTER_COUNT rows
+    auto register_group = make_document(
+        kvp("_id", make_document(kvp("group", group_id["_id"].get_value()),
+                                 kvp("register", HyperLogLog::make_register_expression(path)))),
+        kvp("rank", make_document(kvp("$max", HyperLogLog::make_rank_expression(path)))));
+    auto group = make_document(
+        kvp("_id", "$_id.group"),
+        kvp("registers", make_document(kvp("$push", make_document(kvp("register", "$_id.register"),
+                                                                  kvp("rank", "$rank"))))));
+
+    return {make_document(kvp("$match", match)), make_document(kvp("$group", register_group)),
+            make_document(kvp("$group", group))};
+}
+
+auto AnalyticsApiStrategy::scan_func_get_complaints_statistics(
+    const crow::request& req, const ComplaintColumnStore::Columns& columns)
+    -> bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>> {
+    process_request_func_get_complaints_statistics(req);
+
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    ComplaintColumnStore::Filter filter;
+    if (!_parse_column_store_filter(body["filter"], columns, filter)) {
+        return bsoncxx::stdx::nullopt;
+    }
+
+    auto groups = ComplaintColumnStore::compute_statistics(columns, filter, false,
+                                                           ComplaintColumnStore::Dimension::None);
+    return _make_statistics_documents(groups, columns, "");
+}
+
+auto AnalyticsApiStrategy::scan_func_get_complaints_statistics_over_time(
+    const crow::request& req, const ComplaintColumnStore::Columns& columns)
+    -> bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>> {
+    process_request_func_get_complaints_statistics_over_time(req);
+
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    ComplaintColumnStore::Filter filter;
+    if (!_parse_column_store_filter(body["filter"], columns, filter)) {
+        return bsoncxx::stdx::nullopt;
+    }
+
+    auto groups = ComplaintColumnStore::compute_statistics(columns, filter, true,
+                                                           ComplaintColumnStore::Dimension::None);
+    return _make_statistics_documents(groups, columns, "");
+}
+
+auto AnalyticsApiStrategy::scan_func_get_complaints_statistics_grouped(
+    const crow::request& req, const ComplaintColumnStore::Columns& columns)
+    -> bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>> {
+    process_request_func_get_complaints_statistics_grouped(req);
+
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    // the store groups by one dimension, and the documents have the group_by_field shape
+    if (body.has("group_by_fields")) {
+        return bsoncxx::stdx::nullopt;
+    }
+    auto group_by_field = static_cast<std::string>(body["group_by_field"].s());
+    ComplaintColumnStore::Filter filter;
+    ComplaintColumnStore::Dimension dimension;
+    if (!_parse_column_store_filter(body["filter"], columns, filter) ||
+        !_parse_column_store_dimension(group_by_field, dimension)) {
+        return bsoncxx::stdx::nullopt;
+    }
+
+    auto groups = ComplaintColumnStore::compute_statistics(columns, filter, false, dimension);
+    return _make_statistics_documents(groups, columns, group_by_field);
+}
+
+auto AnalyticsApiStrategy::scan_func_get_complaints_statistics_grouped_over_time(
+    const crow::request& req, const ComplaintColumnStore::Columns& columns)
+    -> bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>> {
+    process_request_func_get_complaints_statistics_grouped_over_time(req);
+
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    // the store groups by one dimension, and the documents have the group_by_field shape
+    if (body.has("group_by_fields")) {
+        return bsoncxx::stdx::nullopt;
+    }
+    auto group_by_field = static_cast<std::string>(body["group_by_field"].s());
+    ComplaintColumnStore::Filter filter;
+    ComplaintColumnStore::Dimension dimension;
+    if (!_parse_column_store_filter(body["filter"], columns, filter) ||
+        !_parse_column_store_dimension(group_by_field, dimension)) {
+        return bsoncxx::stdx::nullopt;
+    }
+
+    auto groups = ComplaintColumnStore::compute_statistics(columns, filter, true, dimension);
+    return _make_statistics_documents(groups, columns, group_by_field);
+}
+
+auto AnalyticsApiStrategy::scan_func_get_complaints_statistics_grouped_by_sentiment_value(
+    const crow::request& req, const ComplaintColumnStore::Columns& columns)
+    -> bsoncxx::stdx::optional<std::vector<bsoncxx::document::value>> {
+    // the boundaries come from the $bucket stage so both paths bucket alike
+    auto documents_and_option =
+        process_request_func_get_complaints_statistics_grouped_by_sentiment_value(req);
+    const auto& bucket = std::get<0>(documents_and_option)[1];
+    std::vector<double> boundaries;
+    for (const auto& boundary : bucket.view()["boundaries"].get_array().value) {
+        boundaries.push_back(boundary.get_double().value);
+    }
+
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    ComplaintColumnStore::Filter filter;
+    if (!_parse_column_store_filter(body["filter"], columns, filter)) {
+        return bsoncxx::stdx::nullopt;
+    }
+
+    auto counts = ComplaintColumnStore::count_sentiment_buckets(columns, filter, boundaries);
+    std::vector<bsoncxx::document::value> documents;
+    for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+        if (counts[i] > 0) {
+            documents.push_back(make_document(kvp("_id", boundaries[i]),
+                                              kvp("count", static_cast<int64_t>(counts[i]))));
+        }
+    }
+    if (counts.back() > 0) {
+        documents.push_back(make_document(kvp("_id", "OutOfRange"),
+                                          kvp("count", static_cast<int64_t>(counts.back()))));
+    }
+    return documents;
+}
+
+auto AnalyticsApiStrategy::_parse_column_store_filter(const crow::json::rvalue& filter_json,
+                                                      const ComplaintColumnStore::Columns& columns,
+                                                      ComplaintColumnStore::Filter& filter)
+    -> bool {
+    if (filter_json.t() != crow::json::type::Object) {
+        return false;
+    }
+    bool has_date_bound = false;
+    for (const auto& field : filter_json) {
+        const auto& key = field.key();
+        if (key == "_from_date" || key == "_to_date" || key == "date") {
+            if (field.t() != crow::json::type::String) {
+                return false;
+            }
+            auto date = DateUtils::string_to_utc_unix_timestamp(
+                            static_cast<std::string>(field.s()), Constants::DATETIME_FORMAT) *
+                        1000;
+            if (key != "_to_date") {
+                filter.from_date = std::max<int64_t>(filter.from_date, date);
+            }
+            if (key != "_from_date") {
+                filter.to_date = std::min<int64_t>(filter.to_date, date);
+            }
+            has_date_bound = true;
+        } else if (key == "_from_sentiment" || key == "_to_sentiment" || key == "sentiment") {
+            if (field.t() != crow::json::type::Number) {
+                return false;
+            }
+            auto sentiment = field.d();
+            if (key != "_to_sentiment") {
+                filter.from_sentiment = std::max(filter.from_sentiment, sentiment);
+            }
+            if (key != "_from_sentiment") {
+                filter.to_sentiment = std::min(filter.to_sentiment, sentiment);
+            }
+            filter.has_sentiment_range = true;
+        } else if (key == "category" || key == "source") {
+            if (field.t() != crow::json::type::String) {
+                return false;
+            }
+            auto value = static_cast<std::string>(field.s());
+            int code = ComplaintColumnStore::ANY_VALUE;
+            if (key == "category") {
+                auto it = columns.category_codes.find(value);
+                code = it != columns.category_codes.end() ? it->second : code;
+            } else {
+                auto it = columns.source_codes.find(value);
+                code = it != columns.source_codes.end() ? it->second : code;
+            }
+            auto& filter_code = key == "category" ? filter.category : filter.source;
+            if (code == ComplaintColumnStore::ANY_VALUE ||
+                (filter_code != ComplaintColumnStore::ANY_VALUE && filter_code != code)) {
+                filter.matches_nothing = true;
+            }
+            filter_code = code;
+        } else {
+            return false;
+        }
+    }
+    // like a range on a missing field, any date bound leaves out complaints without a date
+    if (has_date_bound && filter.from_date == ComplaintColumnStore::MISSING_DATE) {
+        filter.from_date = ComplaintColumnStore::MISSING_DATE + 1;
+    }
+    return true;
+}
+
+auto AnalyticsApiStrategy::_parse_column_store_dimension(
+    const std::string& group_by_field, ComplaintColumnStore::Dimension& dimension) -> bool {
+    if (group_by_field == "category") {
+        dimension = ComplaintColumnStore::Dimension::Category;
+        return true;
+    }
+    if (group_by_field == "source") {
+        dimension = ComplaintColumnStore::Dimension::Source;
+        return true;
+    }
+    return false;
+}
+
+auto AnalyticsApiStrategy::_make_statistics_documents(
+    const std::vector<ComplaintColumnStore::Group>& groups,
+    const ComplaintColumnStore::Columns& columns, const std::string& group_by_field)
+    -> std::vector<bsoncxx::document::value> {
+    auto append_value = [&](bsoncxx::builder::basic::document& builder, const std::string& key,
+                            const int& value) {
+        const auto& dictionary =
+            group_by_field == "category" ? columns.category_dictionary : columns.source_dictionary;
+        if (static_cast<size_t>(value) < dictionary.size()) {
+            builder.append(kvp(key, dictionary[value]));
+        } else {
+            builder.append(kvp(key, bsoncxx::types::b_null()));
+        }
+    };
+
+    std::vector<bsoncxx::document::value> documents;
+    documents.reserve(groups.size());
+    for (const auto& group : groups) {
+        bsoncxx::builder::basic::document document;
+        if (group.month != ComplaintColumnStore::NO_MONTH) {
+            // floor division, so months before 1970 fall in the right year
+            auto year = 1970 + (group.month >= 0 ? group.month / 12 : (group.month - 11) / 12);
+            auto month = group.month - (year - 1970) * 12 + 1;
+            bsoncxx::builder::basic::document id;
+            id.append(kvp("year", year), kvp("month", month));
+            if (!group_by_field.empty()) {
+                append_value(id, group_by_field, group.value);
+            }
+            document.append(kvp("_id", id.extract()));
+        } else if (!group_by_field.empty()) {
+            append_value(document, "_id", group.value);
+        } else {
+            document.append(kvp("_id", bsoncxx::types::b_null()));
+        }
+
+        const auto& statistics = group.statistics;
+        document.append(kvp("count", static_cast<int64_t>(statistics.count)));
+        // null like $avg when no complaint in the group has a sentiment
+        if (statistics.sentiment_count > 0) {
+            document.append(
+                kvp("avg_sentiment", statistics.sentiment_sum / statistics.sentiment_count));
+        } else {
+            document.append(kvp("avg_sentiment", bsoncxx::types::b_null()));
+        }
+        // the same sentiment fields as the pipelines produce, with only the non-empty bins
+        const auto& sketch = statistics.sentiment_sketch;
+        if (sketch.get_count() > 0) {
+            document.append(kvp("min_sentiment", sketch.get_min()),
+                            kvp("max_sentiment", sketch.get_max()));
+        } else {
+            document.append(kvp("min_sentiment", bsoncxx::types::b_null()),
+                            kvp("max_sentiment", bsoncxx::types::b_null()));
+        }
+        bsoncxx::builder::basic::array histogram;
+        for (int bin = 0; bin < SentimentSketch::BIN_COUNT; ++bin) {
+            if (sketch.get_bin_count(bin) > 0) {
+                histogram.append(
+                    make_document(kvp("bin", bin), kvp("count", static_cast<int64_t>(
+                                                                    sketch.get_bin_count(bin)))));
+            }
+        }
+        document.append(kvp("sentiment_histogram", histogram.extract()));
+        documents.push_back(document.extract());
+    }
+    return documents;
+}
+
+auto AnalyticsApiStrategy::create_pipeline_func_filter_and_stages(
     const std::vector<bsoncxx::document::value>& documents) -> mongocxx::pipeline {
     mongocxx::pipeline pipeline{};
 
     const auto& filter = documents[0];
-    const auto& group = documents[1];
 
     pipeline.match(filter.view());
-    pipeline.group(group.view());
+    for (size_t i = 1; i < documents.size(); ++i) {
+        pipeline.append_stage(documents[i].view());
+    }
 
     return pipeline;
 }
@@ -190,61 +708,126 @@ auto AnalyticsApiStrategy::create_pipeline_func_filter_and_bucket(
     return pipeline;
 }
 
-auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics(const crow::request& req,
-                                                                           mongocxx::cursor& cursor)
-    -> crow::json::wvalue {
+// Percentiles estimated from the sentiment histogram of a statistics document.
+static const std::vector<std::pair<std::string, double>> SENTIMENT_PERCENTILES = {
+    {"p50_sentiment", 0.5}, {"p90_sentiment", 0.9}, {"p99_sentiment", 0.99}};
+
+// Rebuilds the sentiment sketch of a statistics document. Bins are numbers from complaints and
+// strings from rollups; complaints without a sentiment have a null bin.
+static auto make_sentiment_sketch(const crow::json::rvalue& document) -> SentimentSketch {
+    SentimentSketch sketch;
+    if (document.has("sentiment_histogram") &&
+        document["sentiment_histogram"].t() == crow::json::type::List) {
+        for (const auto& bin : document["sentiment_histogram"]) {
+            if (!bin.has("bin") || !bin.has("count")) {
+                continue;
+            }
+            if (bin["bin"].t() == crow::json::type::Number) {
+                sketch.add_bin(static_cast<int>(bin["bin"].i()), bin["count"].i());
+            } else if (bin["bin"].t() == crow::json::type::String) {
+                sketch.add_bin(std::stoi(static_cast<std::string>(bin["bin"].s())),
+                               bin["count"].i());
+            }
+        }
+    }
+    auto is_number = [&document](const std::string& key) {
+        return document.has(key) && document[key].t() == crow::json::type::Number;
+    };
+    if (is_number("min_sentiment") && is_number("max_sentiment")) {
+        sketch.include_range(document["min_sentiment"].d(), document["max_sentiment"].d());
+    }
+    return sketch;
+}
+
+// The statistics of a group as returned: count, average, and the sentiment range and percentiles,
+// which are null like the average when no complaint in the group has a sentiment.
+static void set_statistics(crow::json::wvalue& result, const crow::json::rvalue& document) {
+    result["count"] = document["count"];
+    result["avg_sentiment"] = document["avg_sentiment"];
+    auto sketch = make_sentiment_sketch(document);
+    if (sketch.get_count() == 0) {
+        result["min_sentiment"] = crow::json::wvalue();
+        result["max_sentiment"] = crow::json::wvalue();
+        for (const auto& [key, q] : SENTIMENT_PERCENTILES) {
+            result[key] = crow::json::wvalue();
+        }
+        return;
+    }
+    result["min_sentiment"] = sketch.get_min();
+    result["max_sentiment"] = sketch.get_max();
+    for (const auto& [key, q] : SENTIMENT_PERCENTILES) {
+        result[key] = sketch.get_quantile(q);
+    }
+}
+
+// The statistics of a group without complaints.
+static void set_empty_statistics(crow::json::wvalue& result) {
+    result["count"] = 0;
+    result["avg_sentiment"] = 0;
+    result["min_sentiment"] = 0;
+    result["max_sentiment"] = 0;
+    for (const auto& [key, q] : SENTIMENT_PERCENTILES) {
+        result[key] = 0;
+    }
+}
+
+template <typename Documents>
+static auto _process_response_func_get_complaints_statistics(
+    const crow::request& req, Documents& documents) -> crow::json::wvalue {
     crow::json::wvalue response_data;
-    response_data["statistics"]["count"] = 0;
-    response_data["statistics"]["avg_sentiment"] = 0;
-    for (const auto& document : cursor) {
+    set_empty_statistics(response_data["statistics"]);
+    for (const auto& document : documents) {
         auto document_json = bsoncxx::to_json(document);
         crow::json::rvalue rval_json = crow::json::load(document_json);
-        response_data["statistics"]["count"] = rval_json["count"];
-        response_data["statistics"]["avg_sentiment"] = rval_json["avg_sentiment"];
+        set_statistics(response_data["statistics"], rval_json);
     }
     return response_data;
 }
 
-auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_over_time(
-    const crow::request& req, mongocxx::cursor& cursor) -> crow::json::wvalue {
-    auto body = crow::json::load(req.body);
+auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics(const crow::request& req,
+                                                                           mongocxx::cursor& cursor)
+    -> crow::json::wvalue {
+    return _process_response_func_get_complaints_statistics(req, cursor);
+}
+
+auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_from_scan(
+    const crow::request& req, const std::vector<bsoncxx::document::value>& documents)
+    -> crow::json::wvalue {
+    return _process_response_func_get_complaints_statistics(req, documents);
+}
+
+template <typename Documents>
+static auto _process_response_func_get_complaints_statistics_over_time(
+    const crow::request& req, Documents& documents) -> crow::json::wvalue {
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
 
     auto start_date = static_cast<std::string>(body["filter"]["_from_date"].s());
     auto end_date = static_cast<std::string>(body["filter"]["_to_date"].s());
-    auto month_range = _create_month_range(start_date, end_date);
-
-    struct Statistics {
-        int count;
-        double avg_sentiment;
-    };
+    auto month_range = AnalyticsApiStrategy::_create_month_range(start_date, end_date);
 
-    std::map<std::pair<int, int>, Statistics> mapper;
+    std::map<std::pair<int, int>, crow::json::wvalue> mapper;
 
-    for (auto&& document : cursor) {
+    for (auto&& document : documents) {
         auto doc_json = bsoncxx::to_json(document);
         auto doc_rval_json = crow::json::load(doc_json);
 
         int month = doc_rval_json["_id"]["month"].i();
         int year = doc_rval_json["_id"]["year"].i();
 
-        int count = doc_rval_json["count"].i();
-        double avg_sentiment = doc_rval_json["avg_sentiment"].d();
-
-        mapper[{month, year}] = Statistics{count, avg_sentiment};
+        set_statistics(mapper[{month, year}], doc_rval_json);
     }
 
     std::vector<crow::json::wvalue> result;
     for (const auto& [month, year] : month_range) {
-        Statistics stat{0, 0};
-        if (mapper.find({month, year}) != mapper.end()) {
-            stat.count = mapper[{month, year}].count;
-            stat.avg_sentiment = mapper[{month, year}].avg_sentiment;
-        }
-
         crow::json::wvalue wval_json;
         wval_json["date"] = DateUtils::create_month_year_str(month, year);
-        wval_json["data"]["count"] = stat.count;
-        wval_json["data"]["avg_sentiment"] = stat.avg_sentiment;
+        auto statistics = mapper.find({month, year});
+        if (statistics != mapper.end()) {
+            wval_json["data"] = std::move(statistics->second);
+        } else {
+            set_empty_statistics(wval_json["data"]);
+        }
         result.push_back(std::move(wval_json));
     }
 
@@ -253,24 +836,147 @@ auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_over_
     return response_data;
 }
 
-auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_grouped(
+auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_over_time(
     const crow::request& req, mongocxx::cursor& cursor) -> crow::json::wvalue {
+    return _process_response_func_get_complaints_statistics_over_time(req, cursor);
+}
+
+auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_over_time_from_scan(
+    const crow::request& req, const std::vector<bsoncxx::document::value>& documents)
+    -> crow::json::wvalue {
+    return _process_response_func_get_complaints_statistics_over_time(req, documents);
+}
+
+// The value of a group_by_fields dimension as a result key; complaints without the field are
+// grouped under "null".
+static auto get_group_value(const crow::json::rvalue& group_id, const std::string& field)
+    -> std::string {
+    if (!group_id.has(field) || group_id[field].t() == crow::json::type::Null) {
+        return "null";
+    }
+    if (group_id[field].t() == crow::json::type::String) {
+        return group_id[field].s();
+    }
+    return crow::json::wvalue(group_id[field]).dump();
+}
+
+// The values of each dimension: the known ones, then any other value found, so every branch of
+// the nested result has the same keys.
+static auto get_dimension_values(const std::vector<std::string>& group_by_fields,
+                                 const std::set<std::vector<std::string>>& found_keys)
+    -> std::vector<std::vector<std::string>> {
+    std::vector<std::vector<std::string>> dimension_values;
+    for (size_t i = 0; i < group_by_fields.size(); ++i) {
+        std::vector<std::string> values;
+        auto known_values =
+            AnalyticsApiStrategy::GROUP_BY_FIELD_VALUES_MAPPER.find(group_by_fields[i]);
+        if (known_values != AnalyticsApiStrategy::GROUP_BY_FIELD_VALUES_MAPPER.end()) {
+            values = known_values->second;
+        }
+        std::set<std::string> found_values;
+        for (const auto& key : found_keys) {
+            found_values.insert(key[i]);
+        }
+        for (const auto& value : found_values) {
+            if (std::find(values.begin(), values.end(), value) == values.end()) {
+                values.push_back(value);
+            }
+        }
+        dimension_values.push_back(std::move(values));
+    }
+    return dimension_values;
+}
+
+static void check_group_count(const long long int& group_count) {
+    if (group_count > Constants::MAX_ZERO_FILLED_GROUPS) {
+        throw std::invalid_argument(
+            "Invalid request: too many groups, narrow the filter or group by fewer fields");
+    }
+}
+
+// Every combination of the dimension values is filled in each month, so their number is bounded
+// before building them.
+static void check_zero_filled_group_count(
+    const std::vector<std::vector<std::string>>& dimension_values, const size_t& month_count) {
+    long long int group_count = std::max<long long int>(month_count, 1);
+    for (const auto& values : dimension_values) {
+        // stopping once over the limit keeps the product from overflowing
+        if (group_count > Constants::MAX_ZERO_FILLED_GROUPS) {
+            break;
+        }
+        group_count *= std::max<long long int>(values.size(), 1);
+    }
+    check_group_count(group_count);
+}
+
+// Nests the statistics one level per dimension, filling missing combinations with set_empty.
+static void fill_nested_statistics(
+    crow::json::wvalue& result, const std::vector<std::vector<std::string>>& dimension_values,
+    std::map<std::vector<std::string>, crow::json::wvalue>& statistics,
+    std::vector<std::string>& key,
+    void (*set_empty)(crow::json::wvalue&) = set_empty_statistics) {
+    if (key.size() == dimension_values.size()) {
+        auto found = statistics.find(key);
+        if (found != statistics.end()) {
+            result = std::move(found->second);
+        } else {
+            set_empty(result);
+        }
+        return;
+    }
+    for (const auto& value : dimension_values[key.size()]) {
+        key.push_back(value);
+        fill_nested_statistics(result[value], dimension_values, statistics, key, set_empty);
+        key.pop_back();
+    }
+}
+
+template <typename Documents>
+static auto _process_response_func_get_complaints_statistics_grouped(
+    const crow::request& req, Documents& documents) -> crow::json::wvalue {
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    if (body.has("group_by_fields")) {
+        auto group_by_fields = AnalyticsApiStrategy::_get_group_by_fields(body);
+        std::map<std::vector<std::string>, crow::json::wvalue> statistics;
+        std::set<std::vector<std::string>> found_keys;
+        long long int group_count = 0;
+        for (auto&& document : documents) {
+            // every document is a group of the filled result, so reading stops past the limit
+            check_group_count(++group_count);
+            auto rval_json = crow::json::load(bsoncxx::to_json(document));
+            std::vector<std::string> key;
+            for (const auto& group_by_field : group_by_fields) {
+                key.push_back(get_group_value(rval_json["_id"], group_by_field));
+            }
+            set_statistics(statistics[key], rval_json);
+            found_keys.insert(std::move(key));
+        }
+
+        auto dimension_values = get_dimension_values(group_by_fields, found_keys);
+        check_zero_filled_group_count(dimension_values, 1);
+        crow::json::wvalue result;
+        std::vector<std::string> key;
+        fill_nested_statistics(result, dimension_values, statistics, key);
+        crow::json::wvalue response_data;
+        response_data["statistics"] = std::move(result);
+        return response_data;
+    }
+
     std::unordered_set<std::string> exists;
 
     crow::json::wvalue result;
-    for (auto&& document : cursor) {
+    for (auto&& document : documents) {
         auto document_json = bsoncxx::to_json(document);
         crow::json::rvalue rval_json = crow::json::load(document_json);
 
         crow::json::wvalue sub_result;
-        sub_result["count"] = rval_json["count"];
-        sub_result["avg_sentiment"] = rval_json["avg_sentiment"];
+        set_statistics(sub_result, rval_json);
         auto group_by_field_value = rval_json["_id"].s();
         result[group_by_field_value] = std::move(sub_result);
         exists.insert(group_by_field_value);
     }
 
-    auto body = crow::json::load(req.body);
     auto group_by_field = static_cast<std::string>(body["group_by_field"].s());
     auto group_by_field_values = AnalyticsApiStrategy::GROUP_BY_FIELD_VALUES_MAPPER[group_by_field];
     for (const auto& group_by_field_value : group_by_field_values) {
@@ -278,8 +984,7 @@ auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_group
             continue;
         }
         crow::json::wvalue sub_result;
-        sub_result["count"] = 0;
-        sub_result["avg_sentiment"] = 0;
+        set_empty_statistics(sub_result);
         result[group_by_field_value] = std::move(sub_result);
         exists.insert(group_by_field_value);
     }
@@ -289,18 +994,70 @@ auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_group
     return response_data;
 }
 
-auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_grouped_over_time(
+auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_grouped(
     const crow::request& req, mongocxx::cursor& cursor) -> crow::json::wvalue {
-    auto body = crow::json::load(req.body);
+    return _process_response_func_get_complaints_statistics_grouped(req, cursor);
+}
+
+auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_grouped_from_scan(
+    const crow::request& req, const std::vector<bsoncxx::document::value>& documents)
+    -> crow::json::wvalue {
+    return _process_response_func_get_complaints_statistics_grouped(req, documents);
+}
+
+template <typename Documents>
+static auto _process_response_func_get_complaints_statistics_grouped_over_time(
+    const crow::request& req, Documents& documents) -> crow::json::wvalue {
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
 
-    auto group_by_field = static_cast<std::string>(body["group_by_field"].s());
     auto start_date = static_cast<std::string>(body["filter"]["_from_date"].s());
     auto end_date = static_cast<std::string>(body["filter"]["_to_date"].s());
-    auto month_range = _create_month_range(start_date, end_date);
+    auto month_range = AnalyticsApiStrategy::_create_month_range(start_date, end_date);
+
+    if (body.has("group_by_fields")) {
+        auto group_by_fields = AnalyticsApiStrategy::_get_group_by_fields(body);
+        // statistics of each combination of values, per month
+        std::map<std::pair<int, int>, std::map<std::vector<std::string>, crow::json::wvalue>>
+            mapper;
+        std::set<std::vector<std::string>> found_keys;
+        long long int group_count = 0;
+        for (auto&& document : documents) {
+            check_group_count(++group_count);
+            auto rval_json = crow::json::load(bsoncxx::to_json(document));
+            std::vector<std::string> key;
+            for (const auto& group_by_field : group_by_fields) {
+                key.push_back(get_group_value(rval_json["_id"], group_by_field));
+            }
+            auto month_year = std::make_pair(static_cast<int>(rval_json["_id"]["month"].i()),
+                                             static_cast<int>(rval_json["_id"]["year"].i()));
+            set_statistics(mapper[month_year][key], rval_json);
+            found_keys.insert(std::move(key));
+        }
 
-    std::map<std::pair<int, int>, crow::json::wvalue> mapper;
+        auto dimension_values = get_dimension_values(group_by_fields, found_keys);
+        check_zero_filled_group_count(dimension_values, month_range.size());
+        std::vector<crow::json::wvalue> result;
+        for (const auto& month_year : month_range) {
+            crow::json::wvalue sub_result;
+            sub_result["date"] =
+                DateUtils::create_month_year_str(month_year.first, month_year.second);
+            std::vector<std::string> key;
+            fill_nested_statistics(sub_result["data"], dimension_values, mapper[month_year], key);
+            result.push_back(std::move(sub_result));
+        }
 
-    for (auto&& document : cursor) {
+        crow::json::wvalue response_data;
+        response_data["statistics"] = std::move(result);
+        return response_data;
+    }
+
+    auto group_by_field = static_cast<std::string>(body["group_by_field"].s());
+
+    // statistics of each group value, per month
+    std::map<std::pair<int, int>, std::unordered_map<std::string, crow::json::wvalue>> mapper;
+
+    for (auto&& document : documents) {
         auto doc_json = bsoncxx::to_json(document);
         auto rval_json = crow::json::load(doc_json);
 
@@ -309,13 +1066,7 @@ auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_group
         int year = rval_json["_id"]["year"].i();
 
         auto month_year = std::make_pair(month, year);
-        if (mapper.find(month_year) == mapper.end()) {
-            crow::json::wvalue data;
-            mapper[month_year] = std::move(data);
-        }
-
-        mapper[month_year][group_by_field_value]["count"] = rval_json["count"];
-        mapper[month_year][group_by_field_value]["avg_sentiment"] = rval_json["avg_sentiment"];
+        set_statistics(mapper[month_year][group_by_field_value], rval_json);
     }
 
     const auto& group_by_field_values =
@@ -323,11 +1074,7 @@ auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_group
 
     std::vector<crow::json::wvalue> result;
     for (const auto& month_year : month_range) {
-        if (mapper.find(month_year) == mapper.end()) {
-            mapper[month_year] = crow::json::wvalue{};
-        }
-
-        auto rval_json = crow::json::load(mapper[month_year].dump());
+        auto& month_statistics = mapper[month_year];
 
         int month = month_year.first;
         int year = month_year.second;
@@ -337,14 +1084,12 @@ auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_group
         crow::json::wvalue sub_result;
         for (const auto& group_by_field_value : group_by_field_values) {
             sub_result["date"] = month_year_str;
-            sub_result["data"][group_by_field_value]["count"] = 0;
-            sub_result["data"][group_by_field_value]["avg_sentiment"] = 0;
-
-            if (rval_json.t() != crow::json::type::Null and rval_json.has(group_by_field_value)) {
-                sub_result["data"][group_by_field_value]["count"] =
-                    rval_json[group_by_field_value]["count"];
-                sub_result["data"][group_by_field_value]["avg_sentiment"] =
-                    rval_json[group_by_field_value]["avg_sentiment"];
+
+            auto statistics = month_statistics.find(group_by_field_value);
+            if (statistics != month_statistics.end()) {
+                sub_result["data"][group_by_field_value] = std::move(statistics->second);
+            } else {
+                set_empty_statistics(sub_result["data"][group_by_field_value]);
             }
         }
         result.push_back(std::move(sub_result));
@@ -355,16 +1100,29 @@ auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_group
     return response_data;
 }
 
+auto AnalyticsApiStrategy::process_response_func_get_complaints_statistics_grouped_over_time(
+    const crow::request& req, mongocxx::cursor& cursor) -> crow::json::wvalue {
+    return _process_response_func_get_complaints_statistics_grouped_over_time(req, cursor);
+}
+
 auto AnalyticsApiStrategy::
-    process_response_func_get_complaints_statistics_grouped_by_sentiment_value(
-        const crow::request& req, mongocxx::cursor& cursor) -> crow::json::wvalue {
-    auto body = crow::json::load(req.body);
+    process_response_func_get_complaints_statistics_grouped_over_time_from_scan(
+        const crow::request& req, const std::vector<bsoncxx::document::value>& documents)
+        -> crow::json::wvalue {
+    return _process_response_func_get_complaints_statistics_grouped_over_time(req, documents);
+}
+
+template <typename Documents>
+static auto _process_response_func_get_complaints_statistics_grouped_by_sentiment_value(
+    const crow::request& req, Documents& documents) -> crow::json::wvalue {
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     double bucket_size = body["bucket_size"].d();
 
     std::unordered_set<double> added_left_bounds;
 
     std::vector<crow::json::wvalue> result;
-    for (auto&& doc : cursor) {
+    for (auto&& doc : documents) {
         auto doc_json = bsoncxx::to_json(doc);
         crow::json::rvalue rval_json = crow::json::load(doc_json);
 
@@ -393,6 +1151,164 @@ auto AnalyticsApiStrategy::
     return response_data;
 }
 
+auto AnalyticsApiStrategy::
+    process_response_func_get_complaints_statistics_grouped_by_sentiment_value(
+        const crow::request& req, mongocxx::cursor& cursor) -> crow::json::wvalue {
+    return _process_response_func_get_complaints_statistics_grouped_by_sentiment_value(req, cursor);
+}
+
+auto AnalyticsApiStrategy::
+    process_response_func_get_complaints_statistics_grouped_by_sentiment_value_from_scan(
+        const crow::request& req, const std::vector<bsoncxx::document::value>& documents)
+        -> crow::json::wvalue {
+    return _process_response_func_get_complaints_statistics_grouped_by_sentiment_value(
+        req, documents);
+}
+
+// The sketch of a distinct count document from its (register, rank) pairs.
+static auto make_hyper_log_log(const crow::json::rvalue& document) -> HyperLogLog {
+    HyperLogLog sketch;
+    if (document.has("registers") && document["registers"].t() == crow::json::type::List) {
+        for (const auto& pair : document["registers"]) {
+            sketch.add_register(static_cast<int>(pair["register"].i()),
+                                static_cast<int>(pair["rank"].i()));
+        }
+    }
+    return sketch;
+}
+
+static void set_distinct_count(crow::json::wvalue& result, const HyperLogLog& sketch) {
+    result["distinct_approx"] = static_cast<int64_t>(std::llround(sketch.estimate()));
+}
+
+static void set_empty_distinct_count(crow::json::wvalue& result) {
+    result["distinct_approx"] = 0;
+}
+
+auto AnalyticsApiStrategy::process_response_func_get_distinct_count_over_time(
+    const crow::request& req, mongocxx::cursor& cursor) -> crow::json::wvalue {
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+
+    auto start_date = static_cast<std::string>(body["filter"]["_from_date"].s());
+    auto end_date = static_cast<std::string>(body["filter"]["_to_date"].s());
+    auto month_range = _create_month_range(start_date, end_date);
+    std::vector<std::string> group_by_fields;
+    if (body.has("group_by_field") || body.has("group_by_fields")) {
+        group_by_fields = _get_group_by_fields(body);
+    }
+
+    // the sketch of each combination of values per month, merged into the sketches of the range
+    std::map<std::pair<int, int>, std::map<std::vector<std::string>, HyperLogLog>> mapper;
+    std::map<std::vector<std::string>, HyperLogLog> range_sketches;
+    HyperLogLog total_sketch;
+    std::set<std::vector<std::string>> found_keys;
+    for (auto&& document : cursor) {
+        auto rval_json = crow::json::load(bsoncxx::to_json(document));
+        std::vector<std::string> key;
+        for (const auto& group_by_field : group_by_fields) {
+            key.push_back(get_group_value(rval_json["_id"], group_by_field));
+        }
+        auto month_year = std::make_pair(static_cast<int>(rval_json["_id"]["month"].i()),
+                                         static_cast<int>(rval_json["_id"]["year"].i()));
+        auto sketch = make_hyper_log_log(rval_json);
+        range_sketches[key].merge(sketch);
+        total_sketch.merge(sketch);
+        mapper[month_year][key] = sketch;
+        found_keys.insert(std::move(key));
+    }
+
+    auto to_counts = [](const std::map<std::vector<std::string>, HyperLogLog>& sketches) {
+        std::map<std::vector<std::string>, crow::json::wvalue> counts;
+        for (const auto& [key, sketch] : sketches) {
+            set_distinct_count(counts[key], sketch);
+        }
+        return counts;
+    };
+    auto dimension_values = get_dimension_values(group_by_fields, found_keys);
+    check_zero_filled_group_count(dimension_values, month_range.size());
+    std::vector<crow::json::wvalue> result;
+    for (const auto& month_year : month_range) {
+        crow::json::wvalue sub_result;
+        sub_result["date"] = DateUtils::create_month_year_str(month_year.first, month_year.second);
+        auto counts = to_counts(mapper[month_year]);
+        std::vector<std::string> key;
+        fill_nested_statistics(sub_result["data"], dimension_values, counts, key,
+                               set_empty_distinct_count);
+        result.push_back(std::move(sub_result));
+    }
+
+    crow::json::wvalue response_data;
+    response_data["statistics"] = std::move(result);
+    set_distinct_count(response_data["total"], total_sketch);
+    if (!group_by_fields.empty()) {
+        auto counts = to_counts(range_sketches);
+        std::vector<std::string> key;
+        fill_nested_statistics(response_data["total"]["data"], dimension_values, counts, key,
+                               set_empty_distinct_count);
+    }
+    return response_data;
+}
+
+auto AnalyticsApiStrategy::_get_distinct_field(const crow::json::rvalue& body) -> std::string {
+    if (body["distinct_field"].t() != crow::json::type::String) {
+        throw std::invalid_argument("Invalid request: distinct_field must be a field name");
+    }
+    auto distinct_field = static_cast<std::string>(body["distinct_field"].s());
+    if (distinct_field.empty() || distinct_field[0] == '$') {
+        throw std::invalid_argument("Invalid request: invalid distinct_field " + distinct_field);
+    }
+    return distinct_field;
+}
+
+auto AnalyticsApiStrategy::_get_group_by_fields(const crow::json::rvalue& body)
+    -> std::vector<std::string> {
+    if (body.has("group_by_field") && body.has("group_by_fields")) {
+        throw std::invalid_argument(
+            "Invalid request: use either group_by_field or group_by_fields");
+    }
+    if (body.has("group_by_field")) {
+        return {static_cast<std::string>(body["group_by_field"].s())};
+    }
+    if (!body.has("group_by_fields")) {
+        throw std::invalid_argument("Invalid request: missing group_by_field");
+    }
+
+    const auto& fields_json = body["group_by_fields"];
+    if (fields_json.t() != crow::json::type::List || fields_json.size() == 0) {
+        throw std::invalid_argument("Invalid request: group_by_fields must be a non-empty list");
+    }
+    std::vector<std::string> group_by_fields;
+    for (const auto& field : fields_json) {
+        if (field.t() != crow::json::type::String) {
+            throw std::invalid_argument("Invalid request: group_by_fields must be field names");
+        }
+        auto group_by_field = static_cast<std::string>(field.s());
+        // only fields with a known, small set of values, so the combinations stay few
+        if (GROUP_BY_FIELD_VALUES_MAPPER.count(group_by_field) == 0 ||
+            std::find(group_by_fields.begin(), group_by_fields.end(), group_by_field) !=
+                group_by_fields.end()) {
+            throw std::invalid_argument("Invalid request: invalid group_by_fields field " +
+                                        group_by_field);
+        }
+        group_by_fields.push_back(group_by_field);
+    }
+    return group_by_fields;
+}
+
+auto AnalyticsApiStrategy::_make_group_id(const std::vector<std::string>& group_by_fields,
+                                          const bool& is_by_month) -> bsoncxx::document::value {
+    bsoncxx::builder::basic::document group_id;
+    if (is_by_month) {
+        group_id.append(kvp("year", make_document(kvp("$year", "$date"))),
+                        kvp("month", make_document(kvp("$month", "$date"))));
+    }
+    for (const auto& group_by_field : group_by_fields) {
+        group_id.append(kvp(group_by_field, "$" + group_by_field));
+    }
+    return group_id.extract();
+}
+
 auto AnalyticsApiStrategy::_create_month_range(const std::string& start_date,
                                                const std::string& end_date)
     -> std::vector<std::pair<int, int>> {
@@ -1,18 +1,76 @@
 #include "analytics_server.hpp"
 
-AnalyticsServer::AnalyticsServer(int port, int concurrency) : BaseServer(port, concurrency) {}
+AnalyticsServer::AnalyticsServer(int port, int concurrency) : BaseServer(port, concurrency) {
+    indexed_collections = {Constants::COLLECTION_COMPLAINTS,
+                           Constants::COLLECTION_CATEGORY_ANALYTICS,
+                           Constants::COLLECTION_COMPLAINT_ROLLUPS, Constants::COLLECTION_POSTS};
+    coalesced_routes = {"/category_analytics/get_by_name",
+                        "/complaints/get_statistics",
+                        "/complaints/get_statistics_over_time",
+                        "/complaints/get_statistics_grouped",
+                        "/complaints/get_statistics_grouped_over_time",
+                        "/complaints/get_statistics_grouped_by_sentiment_value",
+                        "/complaints/get_distinct_count_over_time",
+                        "/posts/get_distinct_count_over_time"};
+}
 
 void AnalyticsServer::_define_handler_funcs() {
-    auto api_handler = std::make_shared<AnalyticsApiHandler>();
     auto db_manager = DatabaseManager::create_from_env();
 
-    auto concurrency_manager = std::make_shared<ConcurrencyManager>();
-    auto concurrency_protection_decorator =
+    // statistics only change when complaints are written, which is rare next to how often the
+    // dashboards ask for them
+    auto complaints_result_cache =
+        ResultCache::create_from_env(Constants::COLLECTION_COMPLAINTS, metrics_manager);
+    if (complaints_result_cache->get_is_enabled()) {
+        complaints_result_cache->watch_collection(db_manager, Constants::COLLECTION_COMPLAINTS);
+    }
+    // a shared dashboard sends the same statistics requests from many clients at once
+    EnvManager env_manager;
+    if (env_manager.read_env("REQUEST_COALESCING_ENABLED",
+                             Constants::DEFAULT_REQUEST_COALESCING_ENABLED) == "true") {
+        request_coalescer = std::make_shared<RequestCoalescer>("analytics", metrics_manager);
+    }
+    // over-time statistics read a few rollups per month instead of every complaint in the range
+    auto complaint_rollup_manager = ComplaintRollupManager::create_from_env(db_manager);
+    if (complaint_rollup_manager) {
+        try {
+            complaint_rollup_manager->rebuild_if_out_of_sync();
+        } catch (const std::exception& e) {
+            // rollups that may be incomplete are worse than slow statistics
+            std::cout << "[AnalyticsServer] Cannot build complaint rollups, reading complaints: "
+                      << e.what() << std::endl;
+            complaint_rollup_manager = nullptr;
+        }
+    }
+    // statistics are scanned in-process while the store is current, and aggregated otherwise
+    auto complaint_column_store = ComplaintColumnStore::create_from_env(db_manager);
+    // results scanned from columns that missed a change are dropped once the change is loaded
+    if (complaint_column_store && complaints_result_cache->get_is_enabled()) {
+        complaint_column_store->set_on_refresh(
+            [complaints_result_cache]() { complaints_result_cache->invalidate(); });
+    }
+    auto api_handler = std::make_shared<AnalyticsApiHandler>(
+        complaints_result_cache, complaint_rollup_manager, complaint_column_store);
+
+    auto concurrency_manager = std::make_shared<ConcurrencyManager>(
+        Constants::ADMISSION_RETRY_AFTER_SECONDS, blocking_executor);
+    auto light_concurrency_protection_decorator =
+        [concurrency_manager](const std::function<crow::response(const crow::request&)> func) {
+            return concurrency_manager->concurrency_protection_decorator(
+                func, ConcurrencyManager::LIGHT_ADMISSION_POLICY);
+        };
+    auto medium_concurrency_protection_decorator =
+        [concurrency_manager](const std::function<crow::response(const crow::request&)> func) {
+            return concurrency_manager->concurrency_protection_decorator(
+                func, ConcurrencyManager::MEDIUM_ADMISSION_POLICY);
+        };
+    auto heavy_concurrency_protection_decorator =
         [concurrency_manager](const std::function<crow::response(const crow::request&)> func) {
-            return concurrency_manager->concurrency_protection_decorator(func);
+            return concurrency_manager->concurrency_protection_decorator(
+                func, ConcurrencyManager::HEAVY_ADMISSION_POLICY);
         };
 
-    auto jwt_manager = std::make_shared<JwtManager>();
+    auto jwt_manager = this->jwt_manager;
     auto jwt_protection_decorator =
         [jwt_manager](const std::function<crow::response(const crow::request&)> func,
                       const JwtAccessLevel& access_level) {
@@ -21,12 +79,20 @@ void AnalyticsServer::_define_handler_funcs() {
 
     auto COLLECTION_CATEGORY_ANALYTICS = Constants::COLLECTION_CATEGORY_ANALYTICS;
 
+    // one document per category, rewritten only when the updater recomputes them
+    auto category_analytics_replica =
+        ReplicatedCollection::create_from_env(db_manager, COLLECTION_CATEGORY_ANALYTICS);
+
     _register_handler_func(
         "/category_analytics/get_by_name",
-        [api_handler, db_manager, COLLECTION_CATEGORY_ANALYTICS](const crow::request& req) {
+        [api_handler, db_manager, COLLECTION_CATEGORY_ANALYTICS,
+         category_analytics_replica](const crow::request& req) {
+            if (category_analytics_replica) {
+                return api_handler->get_one_by_name(req, category_analytics_replica);
+            }
             return api_handler->get_one_by_name(req, db_manager, COLLECTION_CATEGORY_ANALYTICS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 
     auto COLLECTION_COMPLAINTS = Constants::COLLECTION_COMPLAINTS;
@@ -36,7 +102,7 @@ void AnalyticsServer::_define_handler_funcs() {
         [api_handler, db_manager, COLLECTION_COMPLAINTS](const crow::request& req) {
             return api_handler->get_complaints_statistics(req, db_manager, COLLECTION_COMPLAINTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, medium_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 
     _register_handler_func(
@@ -45,7 +111,7 @@ void AnalyticsServer::_define_handler_funcs() {
             return api_handler->get_complaints_statistics_over_time(req, db_manager,
                                                                     COLLECTION_COMPLAINTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, heavy_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 
     _register_handler_func(
@@ -54,7 +120,7 @@ void AnalyticsServer::_define_handler_funcs() {
             return api_handler->get_complaints_statistics_grouped(req, db_manager,
                                                                   COLLECTION_COMPLAINTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, medium_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 
     _register_handler_func(
@@ -63,7 +129,7 @@ void AnalyticsServer::_define_handler_funcs() {
             return api_handler->get_complaints_statistics_grouped_over_time(req, db_manager,
                                                                             COLLECTION_COMPLAINTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, heavy_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 
     _register_handler_func(
@@ -72,6 +138,33 @@ void AnalyticsServer::_define_handler_funcs() {
             return api_handler->get_complaints_statistics_grouped_by_sentiment_value(
                 req, db_manager, COLLECTION_COMPLAINTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, medium_concurrency_protection_decorator, JwtAccessLevel::None,
+        jwt_protection_decorator);
+
+    _register_handler_func(
+        "/complaints/get_distinct_count_over_time",
+        [api_handler, db_manager, COLLECTION_COMPLAINTS](const crow::request& req) {
+            return api_handler->get_distinct_count_over_time(req, db_manager,
+                                                             COLLECTION_COMPLAINTS);
+        },
+        crow::HTTPMethod::Post, heavy_concurrency_protection_decorator, JwtAccessLevel::None,
+        jwt_protection_decorator);
+
+    auto COLLECTION_POSTS = Constants::COLLECTION_POSTS;
+
+    _register_handler_func(
+        "/posts/get_distinct_count_over_time",
+        [api_handler, db_manager, COLLECTION_POSTS](const crow::request& req) {
+            return api_handler->get_distinct_count_over_time(req, db_manager, COLLECTION_POSTS);
+        },
+        crow::HTTPMethod::Post, heavy_concurrency_protection_decorator, JwtAccessLevel::None,
+        jwt_protection_decorator);
+
+    _register_handler_func(
+        "/complaints/invalidate_statistics",
+        [api_handler](const crow::request& req) {
+            return api_handler->invalidate_complaints_statistics(req);
+        },
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
 }
\ No newline at end of file
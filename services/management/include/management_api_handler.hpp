@@ -5,17 +5,26 @@
 #include <string>
 
 #include "base_api_handler.hpp"
+#include "complaint_rollup_manager.hpp"
 #include "crow.h"
 #include "database_manager.hpp"
+#include "replicated_collection.hpp"
 
 class ManagementApiHandler : public BaseApiHandler {
    public:
     auto get_one_by_oid(const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
                         const std::string& collection_name) -> crow::response;
 
+    auto get_one_by_oid(const crow::request& req,
+                        std::shared_ptr<ReplicatedCollection> replicated_collection)
+        -> crow::response;
+
     auto get_all(const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
                  const std::string& collection_name) -> crow::response;
 
+    auto get_all(const crow::request& req,
+                 std::shared_ptr<ReplicatedCollection> replicated_collection) -> crow::response;
+
     auto get_by_daterange(const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
                           const std::string& collection_name) -> crow::response;
 
@@ -35,6 +44,19 @@ class ManagementApiHandler : public BaseApiHandler {
     auto update_one_by_oid(const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
                            const std::string& collection_name) -> crow::response;
 
+    // The complaint writes above, made through the rollup manager.
+    auto delete_one_by_oid(const crow::request& req,
+                           std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager)
+        -> crow::response;
+
+    auto delete_many_by_oids(const crow::request& req,
+                             std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager)
+        -> crow::response;
+
+    auto update_one_by_oid(const crow::request& req,
+                           std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager)
+        -> crow::response;
+
    private:
 };
 
@@ -31,9 +31,16 @@ auto process_request_func_delete_many_by_oids(const crow::request& req)
 auto process_request_func_update_one_by_oid(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, bsoncxx::document::value, mongocxx::options::update>;
 
-auto process_response_func_get(mongocxx::cursor& cursor) -> crow::json::wvalue;
+// Adds next_cursor to a get_many page requested with after.
+auto process_fields_func_get_many(const crow::request& req,
+                                  const bsoncxx::stdx::optional<bsoncxx::document::value>& last_doc,
+                                  const size_t& document_count) -> crow::json::wvalue;
 auto process_response_func_get_statistics_poll_responses(mongocxx::cursor& cursor)
     -> crow::json::wvalue;
+
+auto _parse_sort(const crow::json::rvalue& body) -> bsoncxx::document::value;
+// The requested sort with the keyset _id tie-breaker; only numeric directions can be paged.
+auto _get_many_sort(const crow::json::rvalue& body) -> bsoncxx::document::value;
 }  // namespace ManagementApiStrategy
 
 #endif
\ No newline at end of file
@@ -7,13 +7,19 @@
 #include <string>
 #include <vector>
 
+#include "analytics_notifier.hpp"
 #include "base_server.hpp"
+#include "complaint_rollup_manager.hpp"
 #include "concurrency_manager.hpp"
 #include "constants.hpp"
 #include "cors.hpp"
 #include "crow.h"
 #include "database_manager.hpp"
+#include "env_manager.hpp"
 #include "management_api_handler.hpp"
+#include "replicated_collection.hpp"
+#include "request_coalescer.hpp"
+#include "write_coalescer.hpp"
 
 class ManagementServer : public BaseServer {
    public:
@@ -16,28 +16,42 @@ auto ManagementApiHandler::get_one_by_oid(const crow::request& req,
                     BaseApiStrategy::process_response_func_get_one);
 }
 
+auto ManagementApiHandler::get_one_by_oid(
+    const crow::request& req, std::shared_ptr<ReplicatedCollection> replicated_collection)
+    -> crow::response {
+    return find_one(req, replicated_collection,
+                    ManagementApiStrategy::process_request_func_get_one_by_oid,
+                    BaseApiStrategy::process_response_func_get_one);
+}
+
 auto ManagementApiHandler::get_all(const crow::request& req,
                                    std::shared_ptr<DatabaseManager> db_manager,
                                    const std::string& collection_name) -> crow::response {
-    return find(req, db_manager, collection_name,
-                ManagementApiStrategy::process_request_func_get_all,
-                ManagementApiStrategy::process_response_func_get);
+    return find_serialized(req, db_manager, collection_name,
+                           ManagementApiStrategy::process_request_func_get_all);
+}
+
+auto ManagementApiHandler::get_all(const crow::request& req,
+                                   std::shared_ptr<ReplicatedCollection> replicated_collection)
+    -> crow::response {
+    return find_serialized(req, replicated_collection,
+                           ManagementApiStrategy::process_request_func_get_all);
 }
 
 auto ManagementApiHandler::get_by_daterange(const crow::request& req,
                                             std::shared_ptr<DatabaseManager> db_manager,
                                             const std::string& collection_name) -> crow::response {
-    return find(req, db_manager, collection_name,
-                ManagementApiStrategy::process_request_func_get_by_daterange,
-                ManagementApiStrategy::process_response_func_get);
+    return find_serialized(req, db_manager, collection_name,
+                           ManagementApiStrategy::process_request_func_get_by_daterange);
 }
 
 auto ManagementApiHandler::get_many(const crow::request& req,
                                     std::shared_ptr<DatabaseManager> db_manager,
                                     const std::string& collection_name) -> crow::response {
-    return find(req, db_manager, collection_name,
-                ManagementApiStrategy::process_request_func_get_many,
-                ManagementApiStrategy::process_response_func_get);
+    return find_serialized(req, db_manager, collection_name,
+                           ManagementApiStrategy::process_request_func_get_many,
+                           BaseApiStrategy::process_document_func_get,
+                           ManagementApiStrategy::process_fields_func_get_many);
 }
 
 auto ManagementApiHandler::get_statistics_poll_responses(
@@ -71,4 +85,26 @@ auto ManagementApiHandler::update_one_by_oid(const crow::request& req,
     return update_one(req, db_manager, collection_name,
                       ManagementApiStrategy::process_request_func_update_one_by_oid,
                       BaseApiStrategy::process_response_func_update_one);
+}
+
+auto ManagementApiHandler::delete_one_by_oid(
+    const crow::request& req, std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager)
+    -> crow::response {
+    // the filter is on _id, so at most one complaint is deleted
+    return delete_many(req, complaint_rollup_manager,
+                       ManagementApiStrategy::process_request_func_delete_one_by_oid);
+}
+
+auto ManagementApiHandler::delete_many_by_oids(
+    const crow::request& req, std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager)
+    -> crow::response {
+    return delete_many(req, complaint_rollup_manager,
+                       ManagementApiStrategy::process_request_func_delete_many_by_oids);
+}
+
+auto ManagementApiHandler::update_one_by_oid(
+    const crow::request& req, std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager)
+    -> crow::response {
+    return update_one(req, complaint_rollup_manager,
+                      ManagementApiStrategy::process_request_func_update_one_by_oid);
 }
\ No newline at end of file
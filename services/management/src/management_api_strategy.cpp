@@ -1,5 +1,6 @@
 #include "management_api_strategy.hpp"
 
+#include <bsoncxx/builder/basic/array.hpp>
 #include <bsoncxx/json.hpp>
 #include <string>
 #include <tuple>
@@ -7,81 +8,136 @@
 
 #include "base_api_strategy_utils.hpp"
 #include "crow.h"
+#include "request_context.hpp"
 
 using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
 using bsoncxx::builder::basic::make_document;
 
 auto ManagementApiStrategy::process_request_func_get_one_by_oid(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::find> {
     BaseApiStrategyUtils::validate_fields(req, {"oid"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto filter = BaseApiStrategyUtils::parse_oid_str_to_oid_bson(body["oid"].s());
 
     mongocxx::options::find option;
+    if (auto projection = BaseApiStrategyUtils::parse_request_json_to_projection(body)) {
+        option.projection(std::move(*projection));
+    }
 
     return std::make_tuple(filter, option);
 }
 
 auto ManagementApiStrategy::process_request_func_get_many(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::find, bsoncxx::document::value> {
-    BaseApiStrategyUtils::validate_fields(req, {"filter", "page_size", "page_number"});
+    BaseApiStrategyUtils::validate_fields(req, {"filter", "page_size"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto filter = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["filter"]);
 
     auto page_size = body["page_size"].i();
-    auto page_number = body["page_number"].i();
-
     if (page_size < 1) {
         throw std::invalid_argument("Invalid page_size < 1.");
     }
 
-    if (page_number < 1) {
-        throw std::invalid_argument("Invalid page_number < 1.");
+    if (body.has("page_number") == body.has("after")) {
+        throw std::invalid_argument("Invalid request: exactly one of page_number or after needed.");
+    }
+
+    // page_number requests keep the sort as given; only keyset pages need the _id tie-breaker
+    auto is_keyset_page = body.has("after");
+    auto sort = is_keyset_page ? _get_many_sort(body) : _parse_sort(body);
+
+    // sort keys stay in the projection so next_cursor can still be built from the last document
+    std::vector<std::string> sort_fields;
+    if (is_keyset_page) {
+        for (const auto& element : sort.view()) {
+            sort_fields.push_back(static_cast<std::string>(element.key()));
+        }
     }
 
     mongocxx::options::find option;
-    option.skip((page_number - 1) * page_size);
     option.limit(page_size);
+    if (auto projection =
+            BaseApiStrategyUtils::parse_request_json_to_projection(body, sort_fields)) {
+        option.projection(std::move(*projection));
+    }
+
+    if (body.has("page_number")) {
+        auto page_number = body["page_number"].i();
+        if (page_number < 1) {
+            throw std::invalid_argument("Invalid page_number < 1.");
+        }
+        option.skip((page_number - 1) * page_size);
+    } else if (!std::string(body["after"].s()).empty()) {
+        // an empty cursor asks for the first page
+        auto after_filter =
+            BaseApiStrategyUtils::parse_keyset_cursor_to_filter(body["after"].s(), sort.view());
+        filter = make_document(kvp("$and", make_array(filter.view(), after_filter.view())));
+    }
+
+    return std::make_tuple(filter, option, sort);
+}
+
+auto ManagementApiStrategy::process_fields_func_get_many(
+    const crow::request& req, const bsoncxx::stdx::optional<bsoncxx::document::value>& last_doc,
+    const size_t& document_count) -> crow::json::wvalue {
+    crow::json::wvalue response_data;
+
+    // pages asked for by page_number continue by page_number
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    if (!body.has("after")) {
+        return response_data;
+    }
+
+    // a short page is the last one, so there is nothing to continue from
+    if (last_doc && static_cast<int64_t>(document_count) == body["page_size"].i()) {
+        response_data["next_cursor"] =
+            BaseApiStrategyUtils::create_keyset_cursor(_get_many_sort(body).view(), *last_doc);
+    } else {
+        response_data["next_cursor"] = nullptr;
+    }
 
+    return response_data;
+}
+
+auto ManagementApiStrategy::_parse_sort(const crow::json::rvalue& body)
+    -> bsoncxx::document::value {
     bsoncxx::document::value sort = make_document();
     if (body.has("sort")) {
         sort = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["sort"]);
     }
+    return sort;
+}
 
-    return std::make_tuple(filter, option, sort);
+auto ManagementApiStrategy::_get_many_sort(const crow::json::rvalue& body)
+    -> bsoncxx::document::value {
+    return BaseApiStrategyUtils::add_keyset_tiebreaker(_parse_sort(body).view());
 }
 
 auto ManagementApiStrategy::process_request_func_get_all(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::find, bsoncxx::document::value> {
     auto filter = make_document();
     mongocxx::options::find option;
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
+    if (auto projection = BaseApiStrategyUtils::parse_request_json_to_projection(body)) {
+        option.projection(std::move(*projection));
+    }
     bsoncxx::document::value sort = make_document();
     return std::make_tuple(filter, option, sort);
 }
 
-auto ManagementApiStrategy::process_response_func_get(mongocxx::cursor& cursor)
-    -> crow::json::wvalue {
-    crow::json::wvalue response_data;
-
-    std::vector<crow::json::wvalue> documents;
-    for (auto&& doc : cursor) {
-        auto doc_json = bsoncxx::to_json(doc);
-        auto doc_rval = crow::json::load(doc_json);
-        auto pased_doc_wval = BaseApiStrategyUtils::parse_database_json_to_response_json(doc_rval);
-        documents.push_back(std::move(pased_doc_wval));
-    }
-
-    response_data["documents"] = std::move(documents);
-    return response_data;
-}
-
 auto ManagementApiStrategy::process_request_func_get_by_daterange(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::find, bsoncxx::document::value> {
     BaseApiStrategyUtils::validate_fields(req, {"start_date", "end_date"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto start_date = BaseApiStrategyUtils::parse_date_str_to_date_bson(body["start_date"].s());
     auto end_date = BaseApiStrategyUtils::parse_date_str_to_date_bson(body["end_date"].s());
 
@@ -89,6 +145,9 @@ auto ManagementApiStrategy::process_request_func_get_by_daterange(const crow::re
         make_document(kvp("date", make_document(kvp("$gte", start_date), kvp("$lte", end_date))));
 
     mongocxx::options::find option;
+    if (auto projection = BaseApiStrategyUtils::parse_request_json_to_projection(body)) {
+        option.projection(std::move(*projection));
+    }
 
     bsoncxx::document::value sort = make_document();
     if (body.has("sort")) {
@@ -102,7 +161,8 @@ auto ManagementApiStrategy::process_request_func_delete_one_by_oid(const crow::r
     -> std::tuple<bsoncxx::document::value, mongocxx::options::delete_options> {
     BaseApiStrategyUtils::validate_fields(req, {"oid"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto filter = BaseApiStrategyUtils::parse_oid_str_to_oid_bson(body["oid"].s());
 
     mongocxx::options::delete_options option;
@@ -114,7 +174,8 @@ auto ManagementApiStrategy::process_request_func_delete_many_by_oids(const crow:
     -> std::tuple<bsoncxx::document::value, mongocxx::options::delete_options> {
     BaseApiStrategyUtils::validate_fields(req, {"oids"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     if (body["oids"].t() != crow::json::type::List) {
         throw std::invalid_argument("Field 'oids' must be an array!");
     }
@@ -138,7 +199,8 @@ auto ManagementApiStrategy::process_request_func_update_one_by_oid(const crow::r
     -> std::tuple<bsoncxx::document::value, bsoncxx::document::value, mongocxx::options::update> {
     BaseApiStrategyUtils::validate_fields(req, {"oid", "update_document"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto filter = BaseApiStrategyUtils::parse_oid_str_to_oid_bson(body["oid"].s());
 
     auto update_doc =
@@ -154,7 +216,8 @@ auto ManagementApiStrategy::process_request_func_get_statistics_poll_responses(
     -> std::tuple<bsoncxx::document::value, mongocxx::options::find, bsoncxx::document::value> {
     BaseApiStrategyUtils::validate_fields(req, {"filter"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto filter = BaseApiStrategyUtils::parse_request_json_to_database_bson(body["filter"]);
 
     mongocxx::options::find option;
@@ -1,18 +1,48 @@
 #include "management_server.hpp"
 
-ManagementServer::ManagementServer(int port, int concurrency) : BaseServer(port, concurrency) {}
+ManagementServer::ManagementServer(int port, int concurrency) : BaseServer(port, concurrency) {
+    indexed_collections = {Constants::COLLECTION_CATEGORIES, Constants::COLLECTION_POSTS,
+                           Constants::COLLECTION_COMPLAINTS, Constants::COLLECTION_POLLS,
+                           Constants::COLLECTION_POLL_TEMPLATES,
+                           Constants::COLLECTION_POLL_RESPONSES,
+                           Constants::COLLECTION_COMPLAINT_ROLLUPS};
+    coalesced_routes = {"/categories/get_all",          "/categories/get_by_oid",
+                        "/posts/get_by_daterange",      "/complaints/get_by_oid",
+                        "/complaints/get_by_daterange", "/complaints/get_many",
+                        "/polls/get_by_oid",            "/polls/get_many",
+                        "/poll_templates/get_all",      "/poll_templates/get_by_oid",
+                        "/poll_responses/get_one",      "/poll_responses/get_many",
+                        "/poll_responses/get_statistics"};
+}
 
 void ManagementServer::_define_handler_funcs() {
+    EnvManager env_manager;
+    if (env_manager.read_env("REQUEST_COALESCING_ENABLED",
+                             Constants::DEFAULT_REQUEST_COALESCING_ENABLED) == "true") {
+        request_coalescer = std::make_shared<RequestCoalescer>("management", metrics_manager);
+    }
     auto api_handler = std::make_shared<ManagementApiHandler>();
     auto db_manager = DatabaseManager::create_from_env();
 
-    auto concurrency_manager = std::make_shared<ConcurrencyManager>();
-    auto concurrency_protection_decorator =
+    auto concurrency_manager = std::make_shared<ConcurrencyManager>(
+        Constants::ADMISSION_RETRY_AFTER_SECONDS, blocking_executor);
+    auto light_concurrency_protection_decorator =
         [concurrency_manager](const std::function<crow::response(const crow::request&)> func) {
-            return concurrency_manager->concurrency_protection_decorator(func);
+            return concurrency_manager->concurrency_protection_decorator(
+                func, ConcurrencyManager::LIGHT_ADMISSION_POLICY);
+        };
+    auto medium_concurrency_protection_decorator =
+        [concurrency_manager](const std::function<crow::response(const crow::request&)> func) {
+            return concurrency_manager->concurrency_protection_decorator(
+                func, ConcurrencyManager::MEDIUM_ADMISSION_POLICY);
+        };
+    auto write_concurrency_protection_decorator =
+        [concurrency_manager](const std::function<crow::response(const crow::request&)> func) {
+            return concurrency_manager->concurrency_protection_decorator(
+                func, ConcurrencyManager::WRITE_ADMISSION_POLICY);
         };
 
-    auto jwt_manager = std::make_shared<JwtManager>();
+    auto jwt_manager = this->jwt_manager;
     auto jwt_protection_decorator =
         [jwt_manager](const std::function<crow::response(const crow::request&)> func,
                       const JwtAccessLevel& access_level) {
@@ -21,47 +51,80 @@ void ManagementServer::_define_handler_funcs() {
 
     const auto COLLECTION_CATEGORIES = Constants::COLLECTION_CATEGORIES;
 
+    // small and read on every page, so reads are served from memory when replicated
+    auto categories_replica =
+        ReplicatedCollection::create_from_env(db_manager, COLLECTION_CATEGORIES);
+    // the change stream catches up eventually, but the admin making the change reads it back
+    // right away
+    auto refresh_categories_replica = [categories_replica](const crow::response& res) {
+        if (!categories_replica || res.code != 200) {
+            return;
+        }
+        try {
+            categories_replica->refresh();
+        } catch (const std::exception& e) {
+            std::cout << "[ManagementServer] Cannot refresh categories: " << e.what() << std::endl;
+        }
+    };
+
     _register_handler_func(
         "/categories/get_count",
         [api_handler, db_manager, COLLECTION_CATEGORIES](const crow::request& req) {
             return api_handler->count_documents(req, db_manager, COLLECTION_CATEGORIES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/categories/get_all",
-        [api_handler, db_manager, COLLECTION_CATEGORIES](const crow::request& req) {
+        [api_handler, db_manager, COLLECTION_CATEGORIES,
+         categories_replica](const crow::request& req) {
+            if (categories_replica) {
+                return api_handler->get_all(req, categories_replica);
+            }
             return api_handler->get_all(req, db_manager, COLLECTION_CATEGORIES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/categories/get_by_oid",
-        [api_handler, db_manager, COLLECTION_CATEGORIES](const crow::request& req) {
+        [api_handler, db_manager, COLLECTION_CATEGORIES,
+         categories_replica](const crow::request& req) {
+            if (categories_replica) {
+                return api_handler->get_one_by_oid(req, categories_replica);
+            }
             return api_handler->get_one_by_oid(req, db_manager, COLLECTION_CATEGORIES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/categories/insert_one",
-        [api_handler, db_manager, COLLECTION_CATEGORIES](const crow::request& req) {
-            return api_handler->insert_one(req, db_manager, COLLECTION_CATEGORIES);
+        [api_handler, db_manager, COLLECTION_CATEGORIES,
+         refresh_categories_replica](const crow::request& req) {
+            auto res = api_handler->insert_one(req, db_manager, COLLECTION_CATEGORIES);
+            refresh_categories_replica(res);
+            return res;
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Admin,
+        crow::HTTPMethod::Post, write_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
     _register_handler_func(
         "/categories/delete_by_oid",
-        [api_handler, db_manager, COLLECTION_CATEGORIES](const crow::request& req) {
-            return api_handler->delete_one_by_oid(req, db_manager, COLLECTION_CATEGORIES);
+        [api_handler, db_manager, COLLECTION_CATEGORIES,
+         refresh_categories_replica](const crow::request& req) {
+            auto res = api_handler->delete_one_by_oid(req, db_manager, COLLECTION_CATEGORIES);
+            refresh_categories_replica(res);
+            return res;
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Admin,
+        crow::HTTPMethod::Post, write_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
     _register_handler_func(
         "/categories/update_by_oid",
-        [api_handler, db_manager, COLLECTION_CATEGORIES](const crow::request& req) {
-            return api_handler->update_one_by_oid(req, db_manager, COLLECTION_CATEGORIES);
+        [api_handler, db_manager, COLLECTION_CATEGORIES,
+         refresh_categories_replica](const crow::request& req) {
+            auto res = api_handler->update_one_by_oid(req, db_manager, COLLECTION_CATEGORIES);
+            refresh_categories_replica(res);
+            return res;
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Admin,
+        crow::HTTPMethod::Post, write_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
 
     const auto COLLECTION_POSTS = Constants::COLLECTION_POSTS;
@@ -71,14 +134,14 @@ void ManagementServer::_define_handler_funcs() {
         [api_handler, db_manager, COLLECTION_POSTS](const crow::request& req) {
             return api_handler->count_documents(req, db_manager, COLLECTION_POSTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/posts/get_by_daterange",
         [api_handler, db_manager, COLLECTION_POSTS](const crow::request& req) {
             return api_handler->get_by_daterange(req, db_manager, COLLECTION_POSTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, medium_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 
     const auto COLLECTION_COMPLAINTS = Constants::COLLECTION_COMPLAINTS;
@@ -88,49 +151,72 @@ void ManagementServer::_define_handler_funcs() {
         [api_handler, db_manager, COLLECTION_COMPLAINTS](const crow::request& req) {
             return api_handler->count_documents(req, db_manager, COLLECTION_COMPLAINTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/complaints/get_by_oid",
         [api_handler, db_manager, COLLECTION_COMPLAINTS](const crow::request& req) {
             return api_handler->get_one_by_oid(req, db_manager, COLLECTION_COMPLAINTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/complaints/get_by_daterange",
         [api_handler, db_manager, COLLECTION_COMPLAINTS](const crow::request& req) {
             return api_handler->get_by_daterange(req, db_manager, COLLECTION_COMPLAINTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, medium_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/complaints/get_many",
         [api_handler, db_manager, COLLECTION_COMPLAINTS](const crow::request& req) {
             return api_handler->get_many(req, db_manager, COLLECTION_COMPLAINTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, medium_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
+    // complaint_rollups follow every complaint write so over-time statistics stay exact, and the
+    // analytics service is told to drop the statistics it cached
+    auto complaint_rollup_manager = ComplaintRollupManager::create_from_env(db_manager);
+    auto analytics_notifier = AnalyticsNotifier::create_from_env(jwt_manager);
+    auto notify_complaints_changed = [analytics_notifier](const crow::response& res) {
+        if (analytics_notifier && res.code == 200) {
+            analytics_notifier->notify_complaints_changed();
+        }
+        return res;
+    };
+
     _register_handler_func(
         "/complaints/delete_by_oid",
-        [api_handler, db_manager, COLLECTION_COMPLAINTS](const crow::request& req) {
-            return api_handler->delete_one_by_oid(req, db_manager, COLLECTION_COMPLAINTS);
+        [api_handler, db_manager, COLLECTION_COMPLAINTS, complaint_rollup_manager,
+         notify_complaints_changed](const crow::request& req) {
+            return notify_complaints_changed(
+                complaint_rollup_manager
+                    ? api_handler->delete_one_by_oid(req, complaint_rollup_manager)
+                    : api_handler->delete_one_by_oid(req, db_manager, COLLECTION_COMPLAINTS));
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Admin,
+        crow::HTTPMethod::Post, write_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
     _register_handler_func(
         "/complaints/delete_many_by_oids",
-        [api_handler, db_manager, COLLECTION_COMPLAINTS](const crow::request& req) {
-            return api_handler->delete_many_by_oids(req, db_manager, COLLECTION_COMPLAINTS);
+        [api_handler, db_manager, COLLECTION_COMPLAINTS, complaint_rollup_manager,
+         notify_complaints_changed](const crow::request& req) {
+            return notify_complaints_changed(
+                complaint_rollup_manager
+                    ? api_handler->delete_many_by_oids(req, complaint_rollup_manager)
+                    : api_handler->delete_many_by_oids(req, db_manager, COLLECTION_COMPLAINTS));
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Admin,
+        crow::HTTPMethod::Post, write_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
     _register_handler_func(
         "/complaints/update_by_oid",
-        [api_handler, db_manager, COLLECTION_COMPLAINTS](const crow::request& req) {
-            return api_handler->update_one_by_oid(req, db_manager, COLLECTION_COMPLAINTS);
+        [api_handler, db_manager, COLLECTION_COMPLAINTS, complaint_rollup_manager,
+         notify_complaints_changed](const crow::request& req) {
+            return notify_complaints_changed(
+                complaint_rollup_manager
+                    ? api_handler->update_one_by_oid(req, complaint_rollup_manager)
+                    : api_handler->update_one_by_oid(req, db_manager, COLLECTION_COMPLAINTS));
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Admin,
+        crow::HTTPMethod::Post, write_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
 
     const auto COLLECTION_POLLS = Constants::COLLECTION_POLLS;
@@ -140,104 +226,148 @@ void ManagementServer::_define_handler_funcs() {
         [api_handler, db_manager, COLLECTION_POLLS](const crow::request& req) {
             return api_handler->insert_one(req, db_manager, COLLECTION_POLLS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Admin,
+        crow::HTTPMethod::Post, write_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
     _register_handler_func(
         "/polls/get_by_oid",
         [api_handler, db_manager, COLLECTION_POLLS](const crow::request& req) {
             return api_handler->get_one_by_oid(req, db_manager, COLLECTION_POLLS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/polls/get_many",
         [api_handler, db_manager, COLLECTION_POLLS](const crow::request& req) {
             return api_handler->get_many(req, db_manager, COLLECTION_POLLS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, medium_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/polls/get_count",
         [api_handler, db_manager, COLLECTION_POLLS](const crow::request& req) {
             return api_handler->count_documents(req, db_manager, COLLECTION_POLLS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/polls/delete_by_oid",
         [api_handler, db_manager, COLLECTION_POLLS](const crow::request& req) {
             return api_handler->delete_one_by_oid(req, db_manager, COLLECTION_POLLS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Admin,
+        crow::HTTPMethod::Post, write_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
     _register_handler_func(
         "/polls/delete_many_by_oids",
         [api_handler, db_manager, COLLECTION_POLLS](const crow::request& req) {
             return api_handler->delete_many_by_oids(req, db_manager, COLLECTION_POLLS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Admin,
+        crow::HTTPMethod::Post, write_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
     _register_handler_func(
         "/polls/update_by_oid",
         [api_handler, db_manager, COLLECTION_POLLS](const crow::request& req) {
             return api_handler->update_one_by_oid(req, db_manager, COLLECTION_POLLS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Admin,
+        crow::HTTPMethod::Post, write_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
 
     const auto COLLECTION_POLL_TEMPLATES = Constants::COLLECTION_POLL_TEMPLATES;
 
+    auto poll_templates_replica =
+        ReplicatedCollection::create_from_env(db_manager, COLLECTION_POLL_TEMPLATES);
+
     _register_handler_func(
         "/poll_templates/get_all",
-        [api_handler, db_manager, COLLECTION_POLL_TEMPLATES](const crow::request& req) {
+        [api_handler, db_manager, COLLECTION_POLL_TEMPLATES,
+         poll_templates_replica](const crow::request& req) {
+            if (poll_templates_replica) {
+                return api_handler->get_all(req, poll_templates_replica);
+            }
             return api_handler->get_all(req, db_manager, COLLECTION_POLL_TEMPLATES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/poll_templates/get_by_oid",
-        [api_handler, db_manager, COLLECTION_POLL_TEMPLATES](const crow::request& req) {
+        [api_handler, db_manager, COLLECTION_POLL_TEMPLATES,
+         poll_templates_replica](const crow::request& req) {
+            if (poll_templates_replica) {
+                return api_handler->get_one_by_oid(req, poll_templates_replica);
+            }
             return api_handler->get_one_by_oid(req, db_manager, COLLECTION_POLL_TEMPLATES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 
     const auto COLLECTION_POLL_RESPONSES = Constants::COLLECTION_POLL_RESPONSES;
 
+    // live polls produce bursts of inserts, so they can opt in to being written in batches
+    std::shared_ptr<WriteCoalescer> poll_responses_write_coalescer;
+    if (env_manager.read_env("WRITE_COALESCING_ENABLED",
+                             Constants::DEFAULT_WRITE_COALESCING_ENABLED) == "true") {
+        poll_responses_write_coalescer = WriteCoalescer::create_from_env(
+            db_manager, COLLECTION_POLL_RESPONSES, metrics_manager, env_manager);
+    }
+
     _register_handler_func(
         "/poll_responses/get_count",
         [api_handler, db_manager, COLLECTION_POLL_RESPONSES](const crow::request& req) {
             return api_handler->count_documents(req, db_manager, COLLECTION_POLL_RESPONSES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/poll_responses/get_one",
         [api_handler, db_manager, COLLECTION_POLL_RESPONSES](const crow::request& req) {
             return api_handler->find_one(req, db_manager, COLLECTION_POLL_RESPONSES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, light_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/poll_responses/get_many",
         [api_handler, db_manager, COLLECTION_POLL_RESPONSES](const crow::request& req) {
             return api_handler->get_many(req, db_manager, COLLECTION_POLL_RESPONSES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
-        jwt_protection_decorator);
-    _register_handler_func(
-        "/poll_responses/insert_one",
-        [api_handler, db_manager, COLLECTION_POLL_RESPONSES](const crow::request& req) {
-            return api_handler->insert_one(req, db_manager, COLLECTION_POLL_RESPONSES);
-        },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::Citizen,
+        crow::HTTPMethod::Post, medium_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
+    if (poll_responses_write_coalescer) {
+        // a batch only fills up when that many inserts can wait for it, and a waiting insert
+        // holds no executor thread
+        AdmissionPolicy coalesced_write_admission_policy = {
+            poll_responses_write_coalescer->get_max_batch_size(),
+            Constants::ADMISSION_WRITE_MAX_QUEUE_LENGTH, Constants::ADMISSION_WRITE_MAX_WAIT_MS};
+        _register_handler_func(
+            "/poll_responses/insert_one",
+            [api_handler, poll_responses_write_coalescer](const crow::request& req,
+                                                          const respond_func_type& respond) {
+                api_handler->insert_one(req, poll_responses_write_coalescer, respond);
+            },
+            crow::HTTPMethod::Post,
+            [concurrency_manager,
+             coalesced_write_admission_policy](const deferred_handler_func_type& func) {
+                return concurrency_manager->concurrency_protection_decorator(
+                    func, coalesced_write_admission_policy);
+            },
+            JwtAccessLevel::Citizen,
+            [jwt_manager](const deferred_handler_func_type& func,
+                          const JwtAccessLevel& access_level) {
+                return jwt_manager->jwt_protection_decorator(func, access_level);
+            });
+    } else {
+        _register_handler_func(
+            "/poll_responses/insert_one",
+            [api_handler, db_manager, COLLECTION_POLL_RESPONSES](const crow::request& req) {
+                return api_handler->insert_one(req, db_manager, COLLECTION_POLL_RESPONSES);
+            },
+            crow::HTTPMethod::Post, write_concurrency_protection_decorator,
+            JwtAccessLevel::Citizen, jwt_protection_decorator);
+    }
     _register_handler_func(
         "/poll_responses/get_statistics",
         [api_handler, db_manager, COLLECTION_POLL_RESPONSES](const crow::request& req) {
             return api_handler->get_statistics_poll_responses(req, db_manager,
                                                               COLLECTION_POLL_RESPONSES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, medium_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 }
\ No newline at end of file
@@ -3,14 +3,21 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "analytics_notifier.hpp"
+#include "complaint_rollup_manager.hpp"
 #include "crow.h"
 #include "database_manager.hpp"
 #include "reddit_manager.hpp"
 
 class UpdaterApiHandler {
    public:
-    UpdaterApiHandler();
+    // Without a rollup manager complaint_rollups are not kept up to date, and without a notifier
+    // the analytics service is not told when complaints change.
+    explicit UpdaterApiHandler(
+        std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager = nullptr,
+        std::shared_ptr<AnalyticsNotifier> analytics_notifier = nullptr);
 
     auto update_posts(const crow::request& req, std::shared_ptr<DatabaseManager> db_manager)
         -> crow::response;
@@ -24,10 +31,19 @@ class UpdaterApiHandler {
     auto clear_analytics(const crow::request& req, std::shared_ptr<DatabaseManager> db_manager,
                          const std::string& collection_name) -> crow::response;
 
+    auto rebuild_complaint_rollups(const crow::request& req) -> crow::response;
+
    private:
     std::shared_ptr<RedditManager> reddit_manager;
+    std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager;
     EnvManager env_manager;
     std::string analytics_url;
+    // the analytics server caches complaint statistics until it is told complaints changed
+    std::shared_ptr<AnalyticsNotifier> analytics_notifier;
+
+    void _notify_complaints_changed();
+    void _apply_complaint_inserts(const std::vector<BulkWriteOperation>& operations,
+                                  const BulkWriteResult& result);
 };
 
 #endif
\ No newline at end of file
@@ -11,21 +11,27 @@
 #include "base_api_strategy_utils.hpp"
 #include "constants.hpp"
 #include "crow.h"
+#include "request_context.hpp"
 
 using bsoncxx::builder::basic::kvp;
 using bsoncxx::builder::basic::make_document;
 
-UpdaterApiHandler::UpdaterApiHandler()
+UpdaterApiHandler::UpdaterApiHandler(
+    std::shared_ptr<ComplaintRollupManager> complaint_rollup_manager,
+    std::shared_ptr<AnalyticsNotifier> analytics_notifier)
     : reddit_manager(RedditManager::create_from_env()),
+      complaint_rollup_manager(complaint_rollup_manager),
       env_manager(EnvManager()),
-      analytics_url(env_manager.read_env("ANALYTICS_URL", Constants::DEFAULT_ANALYTICS_URL)) {}
+      analytics_url(env_manager.read_env("ANALYTICS_URL", Constants::DEFAULT_ANALYTICS_URL)),
+      analytics_notifier(analytics_notifier) {}
 
 auto UpdaterApiHandler::update_posts(const crow::request& req,
                                      std::shared_ptr<DatabaseManager> db_manager)
     -> crow::response {
     try {
         BaseApiStrategyUtils::validate_fields(req, {"subreddit"});
-        auto body = crow::json::load(req.body);
+        auto context = RequestContext::get(req);
+        const auto& body = context->get_body();
         auto subreddit = body["subreddit"].s();
         auto json_docs = reddit_manager->get_posts(subreddit);
         std::vector<bsoncxx::document::value> bson_docs;
@@ -36,28 +42,24 @@ auto UpdaterApiHandler::update_posts(const crow::request& req,
             bson_docs.push_back(std::move(bson_doc));
         }
 
-        int successful_insertions = 0;
-        int ignored_insertions = 0;
-        int failed_insertions = 0;
-
+        std::vector<BulkWriteOperation> operations;
         for (auto& bson_doc : bson_docs) {
-            try {
-                db_manager->insert_one(Constants::COLLECTION_POSTS, bson_doc);
-                successful_insertions += 1;
-            } catch (const mongocxx::exception& e) {
-                if (e.code().value() == 11000) {
-                    // duplicate
-                    ignored_insertions += 1;
-                } else {
-                    std::cout << "Failed to insert post to db: " << e.what() << std::endl;
-                    failed_insertions += 1;
-                }
-            } catch (const std::exception& e) {
-                std::cout << "Failed to insert post to db: " << e.what() << std::endl;
-                failed_insertions += 1;
+            operations.push_back(BulkWriteOperation::insert_one(bson_doc.view()));
+        }
+
+        // posts already stored hit the unique index on id and are reported as duplicates
+        auto result = db_manager->bulk_write(Constants::COLLECTION_POSTS, operations);
+        for (const auto& item_result : result.item_results) {
+            if (item_result.status == BulkWriteItemStatus::Failed) {
+                std::cout << "Failed to insert post to db: " << item_result.error_message
+                          << std::endl;
             }
         }
 
+        int successful_insertions = result.count(BulkWriteItemStatus::Succeeded);
+        int ignored_insertions = result.count(BulkWriteItemStatus::DuplicateKey);
+        int failed_insertions = result.count(BulkWriteItemStatus::Failed);
+
         crow::json::wvalue response_data;
         response_data["successful_insertions"] = successful_insertions;
         response_data["ignored_insertions"] = ignored_insertions;
@@ -85,7 +87,7 @@ auto UpdaterApiHandler::run_analytics(const crow::request& req,
 
         auto url = URL_MAPPER[collection_name];
 
-        crow::json::wvalue body = crow::json::load(req.body);
+        crow::json::wvalue body = RequestContext::get(req)->get_body();
         std::string body_str = body.dump();
         auto resp = cpr::Post(cpr::Url{url}, cpr::Header{{"Content-Type", "application/json"}},
                               cpr::Body{body_str});
@@ -117,6 +119,10 @@ auto UpdaterApiHandler::retrieve_analytics(const crow::request& req,
             {Constants::COLLECTION_POLL_TEMPLATES, analytics_url + "/category_analytics_status"},
         };
 
+        // results are grouped per target collection so each is written in one bulk write
+        std::unordered_map<std::string, std::vector<BulkWriteOperation>> result_operations;
+        std::unordered_map<std::string, std::vector<bsoncxx::document::value>> task_id_filters;
+
         for (auto&& doc : task_id_cursor) {
             auto doc_json = bsoncxx::to_json(doc);
             auto doc_rval = crow::json::load(doc_json);
@@ -125,17 +131,42 @@ auto UpdaterApiHandler::retrieve_analytics(const crow::request& req,
             auto collection = doc_rval["collection"].s();
             auto url = BASE_URL_MAPPER[collection] + "/" + task_id;
 
-            auto resp = cpr::Get(cpr::Url{url});
-            auto resp_json = crow::json::load(resp.text);
-            auto resp_bson = BaseApiStrategyUtils::parse_request_json_to_database_bson(resp_json);
             try {
-                db_manager->insert_one(collection, resp_bson);
-                db_manager->delete_one(collection, doc);
+                auto resp = cpr::Get(cpr::Url{url});
+                auto resp_json = crow::json::load(resp.text);
+                auto resp_bson =
+                    BaseApiStrategyUtils::parse_request_json_to_database_bson(resp_json);
+                result_operations[collection].push_back(
+                    BulkWriteOperation::insert_one(resp_bson.view()));
+                task_id_filters[collection].push_back(
+                    make_document(kvp("_id", doc["_id"].get_value())));
             } catch (const std::exception& e) {
                 std::cout << e.what() << std::endl;
             }
         }
 
+        // a task is forgotten once its result is stored. A duplicate key means an earlier retrieve
+        // already stored it, so only tasks whose write failed stay in analytics_task_ids
+        std::vector<BulkWriteOperation> task_id_operations;
+        for (auto& [collection, operations] : result_operations) {
+            auto result = db_manager->bulk_write(collection, operations);
+            if (collection == Constants::COLLECTION_COMPLAINTS &&
+                result.count(BulkWriteItemStatus::Succeeded) > 0) {
+                _apply_complaint_inserts(operations, result);
+                _notify_complaints_changed();
+            }
+            for (size_t i = 0; i < result.item_results.size(); ++i) {
+                const auto& item_result = result.item_results[i];
+                if (item_result.status == BulkWriteItemStatus::Failed) {
+                    std::cout << item_result.error_message << std::endl;
+                    continue;
+                }
+                task_id_operations.push_back(
+                    BulkWriteOperation::delete_one(task_id_filters[collection][i].view()));
+            }
+        }
+        db_manager->bulk_write(Constants::COLLECTION_ANALYTICS_TASK_IDS, task_id_operations);
+
         crow::json::wvalue response_data;
         return BaseApiStrategyUtils::make_success_response(
             200, response_data, "Server processed retrieve analytics request successfully.");
@@ -159,4 +190,45 @@ auto UpdaterApiHandler::clear_analytics(const crow::request& req,
         return BaseApiStrategyUtils::make_error_response(500,
                                                          std::string("Server error: ") + e.what());
     }
-}
\ No newline at end of file
+}
+
+auto UpdaterApiHandler::rebuild_complaint_rollups(const crow::request& req) -> crow::response {
+    try {
+        if (!complaint_rollup_manager) {
+            throw std::runtime_error("Complaint rollups are disabled.");
+        }
+        crow::json::wvalue response_data;
+        response_data["rollup_count"] = complaint_rollup_manager->rebuild();
+        _notify_complaints_changed();
+        return BaseApiStrategyUtils::make_success_response(
+            200, response_data, "Server processed rebuild complaint rollups request successfully.");
+    } catch (const std::exception& e) {
+        return BaseApiStrategyUtils::make_error_response(500,
+                                                         std::string("Server error: ") + e.what());
+    }
+}
+
+void UpdaterApiHandler::_notify_complaints_changed() {
+    if (analytics_notifier) {
+        analytics_notifier->notify_complaints_changed();
+    }
+}
+
+void UpdaterApiHandler::_apply_complaint_inserts(const std::vector<BulkWriteOperation>& operations,
+                                                 const BulkWriteResult& result) {
+    if (!complaint_rollup_manager) {
+        return;
+    }
+    std::vector<bsoncxx::document::view> complaints;
+    for (size_t i = 0; i < result.item_results.size(); ++i) {
+        if (result.item_results[i].status == BulkWriteItemStatus::Succeeded) {
+            complaints.push_back(operations[i].document.view());
+        }
+    }
+    try {
+        complaint_rollup_manager->apply_inserts(complaints);
+    } catch (const std::exception& e) {
+        std::cout << "Failed to update complaint rollups, rebuild them to catch up: " << e.what()
+                  << std::endl;
+    }
+}
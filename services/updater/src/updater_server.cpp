@@ -1,18 +1,28 @@
 #include "updater_server.hpp"
 
-UpdaterServer::UpdaterServer(int port, int concurrency) : BaseServer(port, concurrency) {}
+UpdaterServer::UpdaterServer(int port, int concurrency) : BaseServer(port, concurrency) {
+    indexed_collections = {Constants::COLLECTION_POSTS, Constants::COLLECTION_COMPLAINTS,
+                           Constants::COLLECTION_CATEGORY_ANALYTICS,
+                           Constants::COLLECTION_ANALYTICS_TASK_IDS,
+                           Constants::COLLECTION_COMPLAINT_ROLLUPS};
+}
 
 void UpdaterServer::_define_handler_funcs() {
-    auto api_handler = std::make_shared<UpdaterApiHandler>();
     auto db_manager = DatabaseManager::create_from_env();
+    auto complaint_rollup_manager = ComplaintRollupManager::create_from_env(db_manager);
+    auto analytics_notifier = AnalyticsNotifier::create_from_env(jwt_manager);
+    auto api_handler =
+        std::make_shared<UpdaterApiHandler>(complaint_rollup_manager, analytics_notifier);
 
-    auto concurrency_manager = std::make_shared<ConcurrencyManager>();
-    auto concurrency_protection_decorator =
+    auto concurrency_manager = std::make_shared<ConcurrencyManager>(
+        Constants::ADMISSION_RETRY_AFTER_SECONDS, blocking_executor);
+    auto job_concurrency_protection_decorator =
         [concurrency_manager](const std::function<crow::response(const crow::request&)> func) {
-            return concurrency_manager->concurrency_protection_decorator(func);
+            return concurrency_manager->concurrency_protection_decorator(
+                func, ConcurrencyManager::JOB_ADMISSION_POLICY);
         };
 
-    auto jwt_manager = std::make_shared<JwtManager>();
+    auto jwt_manager = this->jwt_manager;
     auto jwt_protection_decorator =
         [jwt_manager](const std::function<crow::response(const crow::request&)> func,
                       const JwtAccessLevel& access_level) {
@@ -24,14 +34,14 @@ void UpdaterServer::_define_handler_funcs() {
         [api_handler, db_manager](const crow::request& req) {
             return api_handler->update_posts(req, db_manager);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, job_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/analytics/retrieve_all",
         [api_handler, db_manager](const crow::request& req) {
             return api_handler->retrieve_analytics(req, db_manager);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, job_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 
     const auto COLLECTION_COMPLAINTS = Constants::COLLECTION_COMPLAINTS;
@@ -41,7 +51,14 @@ void UpdaterServer::_define_handler_funcs() {
         [api_handler, db_manager, COLLECTION_COMPLAINTS](const crow::request& req) {
             return api_handler->run_analytics(req, db_manager, COLLECTION_COMPLAINTS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, job_concurrency_protection_decorator, JwtAccessLevel::None,
+        jwt_protection_decorator);
+    _register_handler_func(
+        "/complaint_rollups/rebuild",
+        [api_handler](const crow::request& req) {
+            return api_handler->rebuild_complaint_rollups(req);
+        },
+        crow::HTTPMethod::Post, job_concurrency_protection_decorator, JwtAccessLevel::Admin,
         jwt_protection_decorator);
 
     const auto COLLECTION_CATEGORY_ANALYTICS = Constants::COLLECTION_CATEGORY_ANALYTICS;
@@ -51,14 +68,14 @@ void UpdaterServer::_define_handler_funcs() {
         [api_handler, db_manager, COLLECTION_CATEGORY_ANALYTICS](const crow::request& req) {
             return api_handler->run_analytics(req, db_manager, COLLECTION_CATEGORY_ANALYTICS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, job_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/category_analytics/clear",
         [api_handler, db_manager, COLLECTION_CATEGORY_ANALYTICS](const crow::request& req) {
             return api_handler->clear_analytics(req, db_manager, COLLECTION_CATEGORY_ANALYTICS);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, job_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 
     const auto COLLECTION_POLL_TEMPLATES = Constants::COLLECTION_POLL_TEMPLATES;
@@ -68,13 +85,13 @@ void UpdaterServer::_define_handler_funcs() {
         [api_handler, db_manager, COLLECTION_POLL_TEMPLATES](const crow::request& req) {
             return api_handler->run_analytics(req, db_manager, COLLECTION_POLL_TEMPLATES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, job_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
     _register_handler_func(
         "/poll_analytics/clear",
         [api_handler, db_manager, COLLECTION_POLL_TEMPLATES](const crow::request& req) {
             return api_handler->clear_analytics(req, db_manager, COLLECTION_POLL_TEMPLATES);
         },
-        crow::HTTPMethod::Post, concurrency_protection_decorator, JwtAccessLevel::None,
+        crow::HTTPMethod::Post, job_concurrency_protection_decorator, JwtAccessLevel::None,
         jwt_protection_decorator);
 }
\ No newline at end of file
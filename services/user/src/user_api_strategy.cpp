@@ -6,7 +6,9 @@
 
 #include "base_api_strategy_utils.hpp"
 #include "crow.h"
+#include "json_response_encoder.hpp"
 #include "jwt_manager.hpp"
+#include "request_context.hpp"
 
 using bsoncxx::builder::basic::kvp;
 using bsoncxx::builder::basic::make_document;
@@ -15,7 +17,8 @@ auto UserApiStrategy::process_request_func_login(const crow::request& req)
     -> std::tuple<bsoncxx::document::value, mongocxx::options::find> {
     BaseApiStrategyUtils::validate_fields(req, {"email", "password"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     auto email = body["email"].s();
 
     auto filter = make_document(kvp("email", email));
@@ -30,7 +33,8 @@ auto UserApiStrategy::_process_request_func_create_account(const crow::request&
     -> std::tuple<bsoncxx::document::value, mongocxx::options::insert> {
     BaseApiStrategyUtils::validate_fields(req, {"document"});
 
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
 
     auto account_rval = body["document"];
     crow::json::wvalue account;
@@ -94,7 +98,8 @@ auto UserApiStrategy::_sha256(const std::string& input) -> std::string {
 
 auto UserApiStrategy::process_response_func_login(const bsoncxx::document::value& doc,
                                                   const crow::request& req) -> crow::json::wvalue {
-    auto body = crow::json::load(req.body);
+    auto context = RequestContext::get(req);
+    const auto& body = context->get_body();
     std::string password = body["password"].s();
 
     auto document_json = bsoncxx::to_json(doc);
@@ -125,10 +130,7 @@ auto UserApiStrategy::process_response_func_login(const bsoncxx::document::value
 auto UserApiStrategy::process_response_func_get_one_profile_by_oid(
     const bsoncxx::document::value& doc) -> crow::json::wvalue {
     crow::json::wvalue profile;
-    auto doc_json = bsoncxx::to_json(doc);
-    auto doc_rval = crow::json::load(doc_json);
-    auto parsed_doc_wval = BaseApiStrategyUtils::parse_database_json_to_response_json(doc_rval);
-    auto parsed_doc_rval = crow::json::load(parsed_doc_wval.dump());
+    auto parsed_doc_rval = crow::json::load(JsonResponseEncoder::encode_document(doc.view()));
     profile["_id"] = parsed_doc_rval["_id"];
     profile["name"] = parsed_doc_rval["name"];
     profile["email"] = parsed_doc_rval["email"];
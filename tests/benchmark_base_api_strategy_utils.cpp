@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/json.hpp>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "base_api_strategy_utils.hpp"
+#include "crow.h"
+
+// Run with:
+//   ./runTests --gtest_also_run_disabled_tests --gtest_filter='*Benchmark*'
+
+static const int BENCHMARK_ITERATIONS = 200;
+static const int BENCHMARK_FILTER_CLAUSES = 200;
+static const int BENCHMARK_BULK_DOCUMENTS = 1000;
+
+// A get_many style filter with many range keys and a large $or.
+static auto make_filter_payload() -> std::string {
+    std::string payload = R"({"_from_date": "01-01-2023 00:00:00",
+        "_to_date": "31-12-2023 23:59:59", "_from_sentiment": -0.5, "_to_sentiment": 0.5,
+        "$or": [)";
+    for (int i = 0; i < BENCHMARK_FILTER_CLAUSES; ++i) {
+        payload += (i > 0 ? "," : "");
+        payload += R"({"category": "Category )" + std::to_string(i) +
+                   R"(", "source": "Reddit", "sentiment": )" + std::to_string(i % 10 / 10.0) + "}";
+    }
+    return payload + "]}";
+}
+
+// An insert_many style body: complaint documents with dates and nested arrays.
+static auto make_bulk_documents_payload() -> std::string {
+    std::string payload = R"({"documents": [)";
+    for (int i = 0; i < BENCHMARK_BULK_DOCUMENTS; ++i) {
+        payload += (i > 0 ? "," : "");
+        payload += R"({"id": "t3_)" + std::to_string(i) +
+                   R"(", "title": "Complaint about the void deck lights", "description": ")" +
+                   std::string(400, 'x') +
+                   R"(", "category": "Housing", "source": "Reddit", "date": "01-02-2020 00:00:00",
+                   "sentiment": 0.25, "is_resolved": false, "comments": ["first", "second"]})";
+    }
+    return payload + "]}";
+}
+
+static auto time_per_iteration_us(const std::function<void()>& func) -> double {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; ++i) {
+        func();
+    }
+    auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() -
+                                                             start);
+    return elapsed.count() / BENCHMARK_ITERATIONS;
+}
+
+// Times parse_request_json_to_database_bson against the crow parse it starts from and against
+// bsoncxx::from_json, which builds BSON from the same payload without any rewriting.
+TEST(ParseRequestJsonToDatabaseBsonBenchmark, DISABLED_FilterAndBulkDocumentPayloads) {
+    std::cout << std::setw(16) << "payload" << std::setw(16) << "crow load us" << std::setw(16)
+              << "transcode us" << std::setw(16) << "from_json us" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+
+    for (const auto& [name, payload] :
+         {std::make_pair("filter", make_filter_payload()),
+          std::make_pair("bulk documents", make_bulk_documents_payload())}) {
+        auto rval = crow::json::load(payload);
+        ASSERT_TRUE(rval);
+
+        auto load_us = time_per_iteration_us([&payload]() { crow::json::load(payload); });
+        auto transcode_us = time_per_iteration_us(
+            [&rval]() { BaseApiStrategyUtils::parse_request_json_to_database_bson(rval); });
+        auto from_json_us = time_per_iteration_us([&payload]() { bsoncxx::from_json(payload); });
+
+        std::cout << std::setw(16) << name << std::setw(16) << load_us << std::setw(16)
+                  << transcode_us << std::setw(16) << from_json_us << std::endl;
+    }
+}
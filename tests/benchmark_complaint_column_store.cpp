@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "complaint_column_store.hpp"
+#include "constants.hpp"
+#include "database_manager.hpp"
+#include "date_utils.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+// Benchmarks are disabled by default since they need a running mongod and take a while.
+// Run them with:
+//   ./runTests --gtest_also_run_disabled_tests --gtest_filter='*Benchmark*'
+
+static const int BENCHMARK_COMPLAINTS = 10000000;
+static const int BENCHMARK_INSERT_BATCH_SIZE = 10000;
+static const int BENCHMARK_CATEGORIES = 20;
+static const int BENCHMARK_SOURCES = 4;
+// 01-01-2020 00:00:00 UTC, and complaints spread over four years from it
+static const int64_t BENCHMARK_FIRST_DATE = 1577836800000LL;
+static const int64_t BENCHMARK_DATE_STEP = 4LL * 365 * 24 * 60 * 60 * 1000 / BENCHMARK_COMPLAINTS;
+
+template <typename Func>
+static auto time_ms(Func func) -> double {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+static auto make_complaint(const int& i) -> bsoncxx::document::value {
+    return make_document(
+        kvp("date", bsoncxx::types::b_date{
+                        std::chrono::milliseconds(BENCHMARK_FIRST_DATE + i * BENCHMARK_DATE_STEP)}),
+        kvp("category", "Category " + std::to_string(i % BENCHMARK_CATEGORIES)),
+        kvp("source", "Source " + std::to_string(i % BENCHMARK_SOURCES)),
+        kvp("sentiment", (i % 200 - 100) / 100.0));
+}
+
+// Compares a grouped-over-time scan of the column store against the $match / $group pipeline
+// the analytics service otherwise runs, over the same complaints.
+TEST(ComplaintColumnStoreBenchmark, DISABLED_GroupedOverTimeAgainstAggregation) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    db_manager->delete_many(Constants::COLLECTION_COMPLAINTS, make_document().view());
+    for (int i = 0; i < BENCHMARK_COMPLAINTS; i += BENCHMARK_INSERT_BATCH_SIZE) {
+        std::vector<bsoncxx::document::value> complaints;
+        for (int j = i; j < i + BENCHMARK_INSERT_BATCH_SIZE; ++j) {
+            complaints.push_back(make_complaint(j));
+        }
+        db_manager->insert_many(Constants::COLLECTION_COMPLAINTS, complaints);
+    }
+
+    auto from_date =
+        DateUtils::string_to_utc_unix_timestamp("01-01-2021 00:00:00", Constants::DATETIME_FORMAT);
+    auto to_date =
+        DateUtils::string_to_utc_unix_timestamp("31-12-2022 23:59:59", Constants::DATETIME_FORMAT);
+
+    ComplaintColumnStore::Columns columns;
+    auto load_ms = time_ms([&]() {
+        for (auto&& complaint : db_manager->find(Constants::COLLECTION_COMPLAINTS, {})) {
+            columns.append(complaint);
+        }
+    });
+
+    ComplaintColumnStore::Filter filter;
+    filter.from_date = from_date * 1000;
+    filter.to_date = to_date * 1000;
+    std::vector<ComplaintColumnStore::Group> groups;
+    auto scan_ms = time_ms([&]() {
+        groups = ComplaintColumnStore::compute_statistics(
+            columns, filter, true, ComplaintColumnStore::Dimension::Category);
+    });
+
+    mongocxx::pipeline pipeline;
+    pipeline.match(make_document(kvp(
+        "date", make_document(
+                    kvp("$gte", bsoncxx::types::b_date{std::chrono::seconds(from_date)}),
+                    kvp("$lte", bsoncxx::types::b_date{std::chrono::seconds(to_date)})))));
+    pipeline.group(make_document(
+        kvp("_id", make_document(kvp("year", make_document(kvp("$year", "$date"))),
+                                 kvp("month", make_document(kvp("$month", "$date"))),
+                                 kvp("category", "$category"))),
+        kvp("count", make_document(kvp("$sum", 1))),
+        kvp("avg_sentiment", make_document(kvp("$avg", "$sentiment")))));
+    size_t aggregated_group_count = 0;
+    auto aggregate_ms = time_ms([&]() {
+        for (auto&& doc : db_manager->aggregate(Constants::COLLECTION_COMPLAINTS, pipeline)) {
+            (void)doc;
+            aggregated_group_count++;
+        }
+    });
+
+    EXPECT_EQ(groups.size(), aggregated_group_count);
+    std::cout << std::fixed << std::setprecision(1) << "[ComplaintColumnStoreBenchmark] "
+              << BENCHMARK_COMPLAINTS << " complaints, " << groups.size() << " groups\n"
+              << "  load:      " << load_ms << " ms\n"
+              << "  aggregate: " << aggregate_ms << " ms\n"
+              << "  scan:      " << scan_ms << " ms (" << aggregate_ms / scan_ms << "x)"
+              << std::endl;
+
+    db_manager->delete_many(Constants::COLLECTION_COMPLAINTS, make_document().view());
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "constants.hpp"
+#include "date_utils.hpp"
+
+// Run with:
+//   ./runTests --gtest_also_run_disabled_tests --gtest_filter='*Benchmark*'
+
+static const int BENCHMARK_TIMESTAMPS = 200000;
+
+// "%T" is equivalent to "%H:%M:%S" but skips the fixed-format codec.
+static const std::string IOSTREAM_DATETIME_FORMAT = "%d-%m-%Y %T";
+
+static auto make_benchmark_timestamps() -> std::vector<long long int> {
+    std::vector<long long int> timestamps;
+    timestamps.reserve(BENCHMARK_TIMESTAMPS);
+    for (int i = 0; i < BENCHMARK_TIMESTAMPS; ++i) {
+        timestamps.push_back(1580515200LL + i * 977LL);
+    }
+    return timestamps;
+}
+
+template <typename Func>
+static auto time_ms(Func func) -> double {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// Compares the fixed-format codec against std::put_time / std::get_time.
+TEST(DateUtilsBenchmark, DISABLED_FixedFormatCodecAgainstIostreamPath) {
+    auto timestamps = make_benchmark_timestamps();
+    std::vector<std::string> fast_datetimes;
+    std::vector<std::string> iostream_datetimes;
+    std::vector<long long int> fast_timestamps;
+    std::vector<long long int> iostream_timestamps;
+
+    auto fast_format_ms = time_ms([&]() {
+        fast_datetimes =
+            DateUtils::utc_unix_timestamps_to_strings(timestamps, Constants::DATETIME_FORMAT);
+    });
+    auto iostream_format_ms = time_ms([&]() {
+        iostream_datetimes =
+            DateUtils::utc_unix_timestamps_to_strings(timestamps, IOSTREAM_DATETIME_FORMAT);
+    });
+    auto fast_parse_ms = time_ms([&]() {
+        fast_timestamps =
+            DateUtils::strings_to_utc_unix_timestamps(fast_datetimes, Constants::DATETIME_FORMAT);
+    });
+    auto iostream_parse_ms = time_ms([&]() {
+        iostream_timestamps =
+            DateUtils::strings_to_utc_unix_timestamps(fast_datetimes, IOSTREAM_DATETIME_FORMAT);
+    });
+
+    EXPECT_EQ(fast_datetimes, iostream_datetimes);
+    EXPECT_EQ(fast_timestamps, timestamps);
+    EXPECT_EQ(iostream_timestamps, timestamps);
+
+    std::cout << std::fixed << std::setprecision(1) << "[DateUtilsBenchmark] "
+              << BENCHMARK_TIMESTAMPS << " timestamps\n"
+              << "  format: iostream " << iostream_format_ms << " ms, fixed-format "
+              << fast_format_ms << " ms (" << iostream_format_ms / fast_format_ms << "x)\n"
+              << "  parse:  iostream " << iostream_parse_ms << " ms, fixed-format "
+              << fast_parse_ms << " ms (" << iostream_parse_ms / fast_parse_ms << "x)"
+              << std::endl;
+}
+
+// Formats straight into a caller-owned buffer, as the JSON response encoder does.
+TEST(DateUtilsBenchmark, DISABLED_FormatIntoBuffer) {
+    auto timestamps = make_benchmark_timestamps();
+    char datetime[DateUtils::DATETIME_LENGTH];
+    size_t checksum = 0;
+
+    auto buffer_ms = time_ms([&]() {
+        for (const auto& timestamp : timestamps) {
+            DateUtils::format_datetime(timestamp, datetime);
+            checksum += static_cast<size_t>(datetime[0]);
+        }
+    });
+
+    EXPECT_GT(checksum, 0u);
+    std::cout << std::fixed << std::setprecision(1) << "[DateUtilsBenchmark] "
+              << BENCHMARK_TIMESTAMPS << " timestamps formatted into a buffer in " << buffer_ms
+              << " ms" << std::endl;
+}
@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/json.hpp>
+#include <bsoncxx/oid.hpp>
+#include <bsoncxx/types.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base_api_strategy_utils.hpp"
+#include "crow.h"
+#include "json_response_encoder.hpp"
+#include "msgpack_response_encoder.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
+using bsoncxx::builder::basic::make_document;
+
+// Run with:
+//   ./runTests --gtest_also_run_disabled_tests --gtest_filter='*Benchmark*'
+
+static const int BENCHMARK_DOCUMENTS = 20000;
+
+// Complaint-shaped documents, the bulk of what the read endpoints return.
+static auto make_benchmark_documents() -> std::vector<bsoncxx::document::value> {
+    std::vector<bsoncxx::document::value> documents;
+    for (int i = 0; i < BENCHMARK_DOCUMENTS; ++i) {
+        bsoncxx::types::b_date date{std::chrono::milliseconds{1580515200000LL + i * 60000LL}};
+        documents.push_back(make_document(
+            kvp("_id", bsoncxx::oid()), kvp("id", "t3_" + std::to_string(i)),
+            kvp("title", "Complaint about the void deck lights " + std::to_string(i)),
+            kvp("description", std::string(400, 'x')), kvp("category", "Housing"),
+            kvp("source", "Reddit"), kvp("date", date), kvp("sentiment", (i % 200 - 100) / 100.0),
+            kvp("comments", make_array("first", "second")),
+            kvp("meta", make_document(kvp("score", i), kvp("created_utc", date)))));
+    }
+    return documents;
+}
+
+template <typename EncodeFunc>
+static auto time_encoding(const std::vector<bsoncxx::document::value>& documents,
+                          EncodeFunc encode_func) -> std::pair<double, size_t> {
+    size_t total_bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& doc : documents) {
+        total_bytes += encode_func(doc.view());
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                             start);
+    return {elapsed.count(), total_bytes};
+}
+
+// Compares the one-pass encoder against to_json + crow::json::load + wvalue + dump.
+TEST(JsonResponseEncoderBenchmark, DISABLED_EncoderAgainstWvaluePath) {
+    auto documents = make_benchmark_documents();
+
+    auto [wvalue_ms, wvalue_bytes] =
+        time_encoding(documents, [](const bsoncxx::document::view& doc) {
+            auto doc_rval = crow::json::load(bsoncxx::to_json(doc));
+            return BaseApiStrategyUtils::parse_database_json_to_response_json(doc_rval)
+                .dump()
+                .size();
+        });
+
+    std::string buffer;
+    auto [encoder_ms, encoder_bytes] =
+        time_encoding(documents, [&buffer](const bsoncxx::document::view& doc) {
+            buffer.clear();
+            JsonResponseEncoder::encode_document(doc, buffer);
+            return buffer.size();
+        });
+
+    std::cout << std::setw(12) << "path" << std::setw(14) << "total ms" << std::setw(14)
+              << "docs/ms" << std::setw(14) << "bytes" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(12) << "wvalue" << std::setw(14) << wvalue_ms << std::setw(14)
+              << BENCHMARK_DOCUMENTS / wvalue_ms << std::setw(14) << wvalue_bytes << std::endl;
+    std::cout << std::setw(12) << "encoder" << std::setw(14) << encoder_ms << std::setw(14)
+              << BENCHMARK_DOCUMENTS / encoder_ms << std::setw(14) << encoder_bytes << std::endl;
+
+    EXPECT_LT(encoder_ms, wvalue_ms);
+}
+
+// Compares the JSON response against the binary formats a client can ask for with Accept.
+TEST(JsonResponseEncoderBenchmark, DISABLED_BinaryFormatsAgainstJson) {
+    auto documents = make_benchmark_documents();
+
+    std::string buffer;
+    auto [json_ms, json_bytes] =
+        time_encoding(documents, [&buffer](const bsoncxx::document::view& doc) {
+            buffer.clear();
+            JsonResponseEncoder::encode_document(doc, buffer);
+            return buffer.size();
+        });
+    auto [msgpack_ms, msgpack_bytes] =
+        time_encoding(documents, [&buffer](const bsoncxx::document::view& doc) {
+            buffer.clear();
+            MsgpackResponseEncoder::encode_document(doc, buffer);
+            return buffer.size();
+        });
+    // BSON responses copy the stored bytes
+    auto [bson_ms, bson_bytes] =
+        time_encoding(documents, [&buffer](const bsoncxx::document::view& doc) {
+            buffer.assign(reinterpret_cast<const char*>(doc.data()), doc.length());
+            return buffer.size();
+        });
+
+    std::cout << std::setw(12) << "format" << std::setw(14) << "total ms" << std::setw(14)
+              << "docs/ms" << std::setw(14) << "bytes" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(12) << "json" << std::setw(14) << json_ms << std::setw(14)
+              << BENCHMARK_DOCUMENTS / json_ms << std::setw(14) << json_bytes << std::endl;
+    std::cout << std::setw(12) << "msgpack" << std::setw(14) << msgpack_ms << std::setw(14)
+              << BENCHMARK_DOCUMENTS / msgpack_ms << std::setw(14) << msgpack_bytes << std::endl;
+    std::cout << std::setw(12) << "bson" << std::setw(14) << bson_ms << std::setw(14)
+              << BENCHMARK_DOCUMENTS / bson_ms << std::setw(14) << bson_bytes << std::endl;
+
+    EXPECT_LT(msgpack_bytes, json_bytes);
+}
@@ -0,0 +1,98 @@
+#include <cpr/cpr.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/builder/basic/kvp.hpp>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "constants.hpp"
+#include "database_manager.hpp"
+#include "management_server.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+// Benchmarks are disabled by default since they need a running mongod and take a while.
+// Run them with:
+//   ./runTests --gtest_also_run_disabled_tests --gtest_filter='*Benchmark*'
+
+static const int BENCHMARK_BASE_PORT = 18180;
+static const int BENCHMARK_CLIENT_THREADS = 32;
+static const int BENCHMARK_REQUESTS_PER_CLIENT = 50;
+static const int BENCHMARK_SEED_DOCUMENTS = 500;
+
+// Fires concurrent /complaints/get_many requests and returns (requests per second, failures).
+static auto run_get_many_load(int port) -> std::pair<double, int> {
+    std::string url = "http://localhost:" + std::to_string(port) + "/complaints/get_many";
+    std::string request_body = R"json({
+        "filter": {},
+        "page_size": 50,
+        "page_number": 3
+    })json";
+
+    std::atomic<int> failed_requests{0};
+    std::vector<std::thread> clients;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCHMARK_CLIENT_THREADS; ++i) {
+        clients.emplace_back([&]() {
+            for (int j = 0; j < BENCHMARK_REQUESTS_PER_CLIENT; ++j) {
+                auto r = cpr::Post(cpr::Url{url}, cpr::Body{request_body},
+                                   cpr::Header{{"Content-Type", "application/json"}});
+                if (r.status_code != 200) {
+                    failed_requests++;
+                }
+            }
+        });
+    }
+    for (auto& client : clients) {
+        client.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    double total_requests = BENCHMARK_CLIENT_THREADS * BENCHMARK_REQUESTS_PER_CLIENT;
+    return {total_requests / elapsed.count(), failed_requests.load()};
+}
+
+// Measures /complaints/get_many throughput while increasing the number of crow worker threads.
+// Read routes no longer hold a global lock, so throughput should grow with the thread count
+// until Mongo or the client pool becomes the bottleneck.
+TEST(ManagementServerBenchmark, DISABLED_GetManyThroughputScalesWithConcurrency) {
+    setenv("DB_NAME", "test_db", 1);
+    auto db_ptr = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    db_ptr->delete_many(Constants::COLLECTION_COMPLAINTS, make_document());
+
+    std::vector<bsoncxx::document::value> documents;
+    for (int i = 0; i < BENCHMARK_SEED_DOCUMENTS; ++i) {
+        documents.push_back(make_document(kvp("title", "Complaint " + std::to_string(i)),
+                                          kvp("category", "Housing"), kvp("source", "Reddit"),
+                                          kvp("sentiment", (i % 200 - 100) / 100.0)));
+    }
+    db_ptr->insert_many(Constants::COLLECTION_COMPLAINTS, documents);
+
+    std::cout << std::setw(12) << "threads" << std::setw(16) << "requests/s" << std::setw(12)
+              << "failed" << std::endl;
+
+    for (int concurrency : {1, 2, 4, 8, 16}) {
+        int port = BENCHMARK_BASE_PORT + concurrency;
+        std::thread server_thread([port, concurrency]() {
+            ManagementServer server(port, concurrency);
+            server.serve();
+        });
+        server_thread.detach();
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+        auto [throughput, failed_requests] = run_get_many_load(port);
+        std::cout << std::setw(12) << concurrency << std::setw(16) << std::fixed
+                  << std::setprecision(1) << throughput << std::setw(12) << failed_requests
+                  << std::endl;
+        EXPECT_EQ(failed_requests, 0);
+    }
+
+    db_ptr->delete_many(Constants::COLLECTION_COMPLAINTS, make_document());
+}
@@ -1,6 +1,7 @@
 #include <bsoncxx/builder/basic/array.hpp>
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <limits>
 #include <mongocxx/options/aggregate.hpp>
 #include <mongocxx/options/find.hpp>
 #include <mongocxx/pipeline.hpp>
@@ -12,8 +13,10 @@
 #include <vector>
 
 #include "analytics_api_strategy.hpp"
+#include "constants.hpp"
 #include "crow.h"
 #include "gtest/gtest.h"
+#include "sentiment_sketch.hpp"
 
 using bsoncxx::to_json;
 using bsoncxx::builder::basic::kvp;
@@ -41,17 +44,20 @@ TEST(AnalyticsApiStrategyTest, ProcessRequestGetComplaintsStatistics) {
 
     auto result = AnalyticsApiStrategy::process_request_func_get_complaints_statistics(req);
     auto documents = std::get<0>(result);
-    // Expect two stages: filter and group.
-    ASSERT_EQ(documents.size(), 2u);
+    // Expect the filter, a group per sentiment bin, a group per group and a projection.
+    ASSERT_EQ(documents.size(), 4u);
 
     std::string filter_json = to_json(documents[0].view());
-    std::string group_json = to_json(documents[1].view());
+    std::string group_json = to_json(documents[2].view());
+    std::string project_json = to_json(documents[3].view());
 
     // Verify the filter stage contains the expected filter.
     EXPECT_NE(filter_json.find("{ \"complaint\" : true }"), std::string::npos);
-    // Verify the group stage contains $sum and $avg operators.
+    // Verify the group stage sums the counts and gathers the sentiment histogram.
     EXPECT_NE(group_json.find("\"$sum\""), std::string::npos);
-    EXPECT_NE(group_json.find("\"$avg\""), std::string::npos);
+    EXPECT_NE(group_json.find("\"sentiment_histogram\""), std::string::npos);
+    // Verify the average sentiment is computed from the sums.
+    EXPECT_NE(project_json.find("\"$divide\""), std::string::npos);
 }
 
 // --------- Test for process_request_func_get_complaints_statistics_over_time ---------
@@ -64,7 +70,7 @@ TEST(AnalyticsApiStrategyTest, ProcessRequestGetComplaintsStatisticsOverTime) {
     auto result =
         AnalyticsApiStrategy::process_request_func_get_complaints_statistics_over_time(req);
     auto documents = std::get<0>(result);
-    ASSERT_EQ(documents.size(), 2u);
+    ASSERT_EQ(documents.size(), 4u);
 
     std::string filter_json = to_json(documents[0].view());
     std::string group_json = to_json(documents[1].view());
@@ -83,15 +89,128 @@ TEST(AnalyticsApiStrategyTest, ProcessRequestGetComplaintsStatisticsGrouped) {
 
     auto result = AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped(req);
     auto documents = std::get<0>(result);
-    ASSERT_EQ(documents.size(), 2u);
+    ASSERT_EQ(documents.size(), 4u);
 
     std::string group_json = to_json(documents[1].view());
     std::cout << group_json << std::endl;
 
     // Verify that the group stage groups by the field "category".
     EXPECT_NE(group_json.find("\"$category\""), std::string::npos);
-    // Verify that the group stage contains an average sentiment calculation.
-    EXPECT_NE(group_json.find("\"$avg\""), std::string::npos);
+    // Verify that the projection contains an average sentiment calculation.
+    EXPECT_NE(to_json(documents[3].view()).find("\"$divide\""), std::string::npos);
+}
+
+// --------- Test for group_by_fields in process_request_func_get_complaints_statistics_grouped
+// ---------
+TEST(AnalyticsApiStrategyTest, ProcessRequestGetComplaintsStatisticsGroupedByFields) {
+    crow::request req;
+    req.body = "{\"group_by_fields\": [\"category\", \"source\"], \"filter\": {}}";
+
+    auto result = AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped(req);
+    auto documents = std::get<0>(result);
+    ASSERT_EQ(documents.size(), 4u);
+    // one compound _id, so one pass groups by every field
+    EXPECT_EQ(to_json(documents[1].view()["$group"]["_id"]["group"].get_document().view()),
+              "{ \"category\" : \"$category\", \"source\" : \"$source\" }");
+
+    for (const auto* body :
+         {"{\"group_by_fields\": [], \"filter\": {}}",
+          "{\"group_by_fields\": [\"category\", \"category\"], \"filter\": {}}",
+          "{\"group_by_fields\": [\"month\"], \"filter\": {}}",
+          "{\"group_by_fields\": [\"author\"], \"filter\": {}}",
+          "{\"group_by_field\": \"source\", \"group_by_fields\": [\"category\"], \"filter\": {}}",
+          "{\"filter\": {}}"}) {
+        crow::request invalid_req;
+        invalid_req.body = body;
+        EXPECT_THROW(
+            AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped(
+                invalid_req),
+            std::invalid_argument);
+    }
+}
+
+// --------- Test for group_by_fields in process_response_func_get_complaints_statistics_grouped
+// ---------
+TEST(AnalyticsApiStrategyTest, ProcessResponseGetComplaintsStatisticsGroupedByFields) {
+    crow::request req;
+    req.body = "{\"group_by_fields\": [\"source\", \"category\"], \"filter\": {}}";
+
+    std::vector<bsoncxx::document::value> documents;
+    documents.push_back(make_document(
+        kvp("_id", make_document(kvp("source", "Reddit"), kvp("category", "Housing"))),
+        kvp("count", 2), kvp("avg_sentiment", 0.25)));
+    documents.push_back(make_document(kvp("_id", make_document(kvp("category", "Legal"))),
+                                      kvp("count", 1), kvp("avg_sentiment", -0.5)));
+
+    auto response = crow::json::load(
+        AnalyticsApiStrategy::process_response_func_get_complaints_statistics_grouped_from_scan(
+            req, documents)
+            .dump());
+    const auto& statistics = response["statistics"];
+    EXPECT_EQ(statistics["Reddit"]["Housing"]["count"].i(), 2);
+    EXPECT_DOUBLE_EQ(statistics["Reddit"]["Housing"]["avg_sentiment"].d(), 0.25);
+    // known values are zero-filled, and a missing source is grouped under null
+    EXPECT_EQ(statistics["Reddit"]["Transport"]["count"].i(), 0);
+    EXPECT_EQ(statistics["null"]["Legal"]["count"].i(), 1);
+    EXPECT_EQ(statistics["null"]["Housing"]["count"].i(), 0);
+    EXPECT_EQ(statistics["Reddit"].size(),
+              AnalyticsApiStrategy::GROUP_BY_FIELD_VALUES_MAPPER["category"].size());
+
+    // found values are zero-filled too, so too many combinations of them are refused
+    std::vector<bsoncxx::document::value> many_documents;
+    for (int i = 0; i < 1000; ++i) {
+        many_documents.push_back(make_document(
+            kvp("_id", make_document(kvp("category", "Category " + std::to_string(i)))),
+            kvp("count", 1), kvp("avg_sentiment", 0.0)));
+    }
+    for (int i = 0; i < 100; ++i) {
+        many_documents.push_back(make_document(
+            kvp("_id", make_document(kvp("source", "Source " + std::to_string(i)))),
+            kvp("count", 1), kvp("avg_sentiment", 0.0)));
+    }
+    EXPECT_THROW(
+        AnalyticsApiStrategy::process_response_func_get_complaints_statistics_grouped_from_scan(
+            req, many_documents),
+        std::invalid_argument);
+}
+
+// --------- Test for the sentiment percentiles of process_response_func_get_complaints_statistics
+// ---------
+TEST(AnalyticsApiStrategyTest, ProcessResponseGetComplaintsStatisticsPercentiles) {
+    crow::request req;
+    req.body = "{\"filter\": {}}";
+
+    // a histogram from rollups, with string bins and a null bin for complaints without sentiment
+    std::vector<bsoncxx::document::value> documents;
+    documents.push_back(make_document(
+        kvp("_id", bsoncxx::types::b_null()), kvp("count", 5), kvp("avg_sentiment", 0.0),
+        kvp("min_sentiment", -0.5), kvp("max_sentiment", 0.5),
+        kvp("sentiment_histogram",
+            make_array(make_document(kvp("bin", "50"), kvp("count", 2)),
+                       make_document(kvp("bin", bsoncxx::types::b_null()), kvp("count", 0)),
+                       make_document(kvp("bin", "150"), kvp("count", 2))))));
+
+    auto response = crow::json::load(
+        AnalyticsApiStrategy::process_response_func_get_complaints_statistics_from_scan(
+            req, documents)
+            .dump());
+    const auto& statistics = response["statistics"];
+    EXPECT_EQ(statistics["count"].i(), 5);
+    EXPECT_DOUBLE_EQ(statistics["min_sentiment"].d(), -0.5);
+    EXPECT_DOUBLE_EQ(statistics["max_sentiment"].d(), 0.5);
+    // within half a bin of the exact median, and never past the exact maximum
+    EXPECT_NEAR(statistics["p50_sentiment"].d(), -0.5, 0.5 / SentimentSketch::BINS_PER_UNIT + 1e-9);
+    EXPECT_DOUBLE_EQ(statistics["p90_sentiment"].d(), 0.5);
+    EXPECT_DOUBLE_EQ(statistics["p99_sentiment"].d(), 0.5);
+
+    // no complaints
+    documents.clear();
+    response = crow::json::load(
+        AnalyticsApiStrategy::process_response_func_get_complaints_statistics_from_scan(
+            req, documents)
+            .dump());
+    EXPECT_EQ(response["statistics"]["count"].i(), 0);
+    EXPECT_EQ(response["statistics"]["p50_sentiment"].i(), 0);
 }
 
 // --------- Test for process_request_func_get_complaints_statistics_grouped_over_time ---------
@@ -104,15 +223,43 @@ TEST(AnalyticsApiStrategyTest, ProcessRequestGetComplaintsStatisticsGroupedOverT
     auto result =
         AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped_over_time(req);
     auto documents = std::get<0>(result);
-    ASSERT_EQ(documents.size(), 2u);
+    ASSERT_EQ(documents.size(), 4u);
 
-    std::string group_json = to_json(documents[1].view());
+    std::string group_json =
+        to_json(documents[1].view()["$group"]["_id"]["group"].get_document().view());
     std::cout << group_json << std::endl;
     // Verify that the grouping is done on year, month, and category.
     EXPECT_EQ(group_json,
-              "{ \"_id\" : { \"year\" : { \"$year\" : \"$date\" }, \"month\" : { \"$month\" : "
-              "\"$date\" }, \"category\" : \"$category\" }, \"count\" : { \"$sum\" : 1 }, "
-              "\"avg_sentiment\" : { \"$avg\" : \"$sentiment\" } }");
+              "{ \"year\" : { \"$year\" : \"$date\" }, \"month\" : { \"$month\" : \"$date\" }, "
+              "\"category\" : \"$category\" }");
+}
+
+// --------- Test for the largest results of get_complaints_statistics_grouped_over_time ---------
+TEST(AnalyticsApiStrategyTest, GetComplaintsStatisticsGroupedOverTimeGroupLimit) {
+    crow::request req;
+    req.body =
+        "{\"group_by_fields\": [\"category\"], \"filter\": {\"_from_date\": "
+        "\"01-01-2020 00:00:00\", \"_to_date\": \"31-01-2020 23:59:59\"}}";
+
+    // the groups per sentiment bin may not fit the memory limit of $group
+    auto option = std::get<1>(
+        AnalyticsApiStrategy::process_request_func_get_complaints_statistics_grouped_over_time(
+            req));
+    ASSERT_TRUE(option.allow_disk_use().has_value());
+    EXPECT_TRUE(*option.allow_disk_use());
+
+    // one group more than can be zero-filled is refused
+    std::vector<bsoncxx::document::value> documents;
+    for (long long int i = 0; i <= Constants::MAX_ZERO_FILLED_GROUPS; ++i) {
+        documents.push_back(make_document(
+            kvp("_id", make_document(kvp("year", 2020), kvp("month", 1),
+                                     kvp("category", "Category " + std::to_string(i)))),
+            kvp("count", 1), kvp("avg_sentiment", 0.0)));
+    }
+    EXPECT_THROW(AnalyticsApiStrategy::
+                     process_response_func_get_complaints_statistics_grouped_over_time_from_scan(
+                         req, documents),
+                 std::invalid_argument);
 }
 
 // --------- Test for process_request_func_get_complaints_statistics_grouped_by_sentiment_value
@@ -137,6 +284,156 @@ TEST(AnalyticsApiStrategyTest, ProcessRequestGetComplaintsStatisticsGroupedBySen
     EXPECT_NE(bucket_json.find("output"), std::string::npos);
 }
 
+// --------- Test for process_request_func_get_distinct_count_over_time ---------
+TEST(AnalyticsApiStrategyTest, ProcessRequestGetDistinctCountOverTime) {
+    crow::request req;
+    req.body =
+        "{\"distinct_field\": \"sub_source\", \"group_by_field\": \"category\", \"filter\": "
+        "{\"_from_date\": \"01-01-2020 00:00:00\", \"_to_date\": \"31-12-2020 23:59:59\"}}";
+
+    auto [documents, option] =
+        AnalyticsApiStrategy::process_request_func_get_distinct_count_over_time(req);
+    // filter, match on the field, a group per register and a group per group
+    ASSERT_EQ(documents.size(), 4u);
+    EXPECT_EQ(to_json(documents[1].view()),
+              "{ \"$match\" : { \"sub_source\" : { \"$ne\" : null } } }");
+    EXPECT_EQ(to_json(documents[2].view()["$group"]["_id"]["group"].get_document().view()),
+              "{ \"year\" : { \"$year\" : \"$date\" }, \"month\" : { \"$month\" : \"$date\" }, "
+              "\"category\" : \"$category\" }");
+    EXPECT_NE(to_json(documents[3].view()).find("\"registers\""), std::string::npos);
+    EXPECT_TRUE(option.allow_disk_use().value_or(false));
+
+    for (const auto* body :
+         {"{\"distinct_field\": \"$sub_source\", \"filter\": {\"_from_date\": \"01-01-2020 "
+          "00:00:00\", \"_to_date\": \"31-12-2020 23:59:59\"}}",
+          "{\"distinct_field\": 1, \"filter\": {\"_from_date\": \"01-01-2020 00:00:00\", "
+          "\"_to_date\": \"31-12-2020 23:59:59\"}}",
+          "{\"distinct_field\": \"sub_source\", \"filter\": {\"_from_date\": \"01-01-2020 "
+          "00:00:00\"}}"}) {
+        crow::request invalid_req;
+        invalid_req.body = body;
+        EXPECT_THROW(
+            AnalyticsApiStrategy::process_request_func_get_distinct_count_over_time(invalid_req),
+            std::invalid_argument);
+    }
+}
+
+// --------- Test for can_use_complaint_rollups ---------
+TEST(AnalyticsApiStrategyTest, CanUseComplaintRollups) {
+    auto can_use = [](const std::string& body) {
+        crow::request req;
+        req.body = body;
+        return AnalyticsApiStrategy::can_use_complaint_rollups(req);
+    };
+
+    // whole months, filtered and grouped by rollup dimensions
+    EXPECT_TRUE(
+        can_use("{\"filter\": {\"_from_date\": \"01-01-2020 00:00:00\", \"_to_date\": "
+                "\"31-12-2020 23:59:59\"}}"));
+    EXPECT_TRUE(
+        can_use("{\"group_by_field\": \"source\", \"filter\": {\"_from_date\": \"01-02-2020 "
+                "00:00:00\", \"_to_date\": \"29-02-2020 23:59:59\", \"category\": \"Housing\"}}"));
+
+    // part of a month
+    EXPECT_FALSE(
+        can_use("{\"filter\": {\"_from_date\": \"02-01-2020 00:00:00\", \"_to_date\": "
+                "\"31-12-2020 23:59:59\"}}"));
+    EXPECT_FALSE(
+        can_use("{\"filter\": {\"_from_date\": \"01-01-2020 00:00:00\", \"_to_date\": "
+                "\"31-12-2020 00:00:00\"}}"));
+    // a field the rollups do not keep
+    EXPECT_FALSE(
+        can_use("{\"filter\": {\"_from_date\": \"01-01-2020 00:00:00\", \"_to_date\": "
+                "\"31-12-2020 23:59:59\", \"_from_sentiment\": 0.5}}"));
+    EXPECT_FALSE(
+        can_use("{\"group_by_field\": \"title\", \"filter\": {\"_from_date\": \"01-01-2020 "
+                "00:00:00\", \"_to_date\": \"31-12-2020 23:59:59\"}}"));
+    // the complaints path reports the missing dates
+    EXPECT_FALSE(can_use("{\"filter\": {\"_from_date\": \"01-01-2020 00:00:00\"}}"));
+    EXPECT_FALSE(can_use("{}"));
+}
+
+// --------- Test for process_request_func_get_complaints_statistics_grouped_over_time_from_rollups
+// ---------
+TEST(AnalyticsApiStrategyTest, ProcessRequestGetComplaintsStatisticsGroupedOverTimeFromRollups) {
+    crow::request req;
+    req.body =
+        "{\"group_by_field\": \"category\", \"filter\": {\"_from_date\": \"01-01-2020 00:00:00\", "
+        "\"_to_date\": \"31-12-2020 23:59:59\"}}";
+
+    auto result = AnalyticsApiStrategy::
+        process_request_func_get_complaints_statistics_grouped_over_time_from_rollups(req);
+    auto documents = std::get<0>(result);
+    // filter, histogram bins, a group per bin, a group per group, match after grouping and
+    // project
+    ASSERT_EQ(documents.size(), 7u);
+
+    EXPECT_TRUE(documents[2].view()["$unwind"]);
+    std::string group_json =
+        to_json(documents[3].view()["$group"]["_id"]["group"].get_document().view());
+    EXPECT_EQ(group_json,
+              "{ \"year\" : { \"$year\" : \"$date\" }, \"month\" : { \"$month\" : \"$date\" }, "
+              "\"category\" : \"$category\" }");
+    EXPECT_NE(to_json(documents[6].view()).find("\"$divide\""), std::string::npos);
+}
+
+// --------- Test for scan_func_get_complaints_statistics_grouped_over_time ---------
+TEST(AnalyticsApiStrategyTest, ScanGetComplaintsStatisticsGroupedOverTime) {
+    ComplaintColumnStore::Columns columns;
+    // 15-01-2020 and 15-02-2020 10:00:00 UTC
+    columns.append(1579082400000LL, std::string("Housing"), std::string("Reddit"), 0.5);
+    columns.append(1579082400000LL, std::string("Housing"), std::string("Reddit"), -0.25);
+    columns.append(1581760800000LL, std::string("Transport"), std::string("Reddit"),
+                   std::numeric_limits<double>::quiet_NaN());
+
+    crow::request req;
+    req.body =
+        "{\"group_by_field\": \"category\", \"filter\": {\"_from_date\": \"01-01-2020 00:00:00\", "
+        "\"_to_date\": \"31-12-2020 23:59:59\"}}";
+    auto documents =
+        AnalyticsApiStrategy::scan_func_get_complaints_statistics_grouped_over_time(req, columns);
+    ASSERT_TRUE(documents.has_value());
+    ASSERT_EQ(documents->size(), 2u);
+    // shaped like the documents of the aggregation
+    EXPECT_EQ(to_json((*documents)[0].view()),
+              "{ \"_id\" : { \"year\" : 2020, \"month\" : 1, \"category\" : \"Housing\" }, "
+              "\"count\" : 2, \"avg_sentiment\" : 0.125, \"min_sentiment\" : -0.25, "
+              "\"max_sentiment\" : 0.5, \"sentiment_histogram\" : [ { \"bin\" : 75, "
+              "\"count\" : 1 }, { \"bin\" : 150, \"count\" : 1 } ] }");
+    EXPECT_NE(to_json((*documents)[1].view())
+                  .find("\"count\" : 1, \"avg_sentiment\" : null, \"min_sentiment\" : null"),
+              std::string::npos);
+
+    // a field the column store does not keep
+    req.body =
+        "{\"group_by_field\": \"category\", \"filter\": {\"_from_date\": \"01-01-2020 00:00:00\", "
+        "\"_to_date\": \"31-12-2020 23:59:59\", \"title\": \"Noise\"}}";
+    EXPECT_FALSE(
+        AnalyticsApiStrategy::scan_func_get_complaints_statistics_grouped_over_time(req, columns)
+            .has_value());
+}
+
+// --------- Test for scan_func_get_complaints_statistics_grouped_by_sentiment_value ---------
+TEST(AnalyticsApiStrategyTest, ScanGetComplaintsStatisticsGroupedBySentimentValue) {
+    ComplaintColumnStore::Columns columns;
+    columns.append(1579082400000LL, std::string("Housing"), std::string("Reddit"), 0.5);
+    columns.append(1579082400000LL, std::string("Housing"), std::string("Reddit"), 0.75);
+    columns.append(1579082400000LL, std::string("Housing"), std::string("Reddit"),
+                   std::numeric_limits<double>::quiet_NaN());
+
+    crow::request req;
+    req.body =
+        "{\"bucket_size\": 1.0, \"filter\": {\"_from_date\": \"01-01-2020 00:00:00\", "
+        "\"_to_date\": \"31-12-2020 23:59:59\", \"category\": \"Housing\"}}";
+    auto documents = AnalyticsApiStrategy::
+        scan_func_get_complaints_statistics_grouped_by_sentiment_value(req, columns);
+    ASSERT_TRUE(documents.has_value());
+    ASSERT_EQ(documents->size(), 2u);
+    EXPECT_EQ(to_json((*documents)[0].view()), "{ \"_id\" : 0.0, \"count\" : 2 }");
+    // a complaint without a sentiment falls to the default bucket
+    EXPECT_EQ(to_json((*documents)[1].view()), "{ \"_id\" : \"OutOfRange\", \"count\" : 1 }");
+}
+
 // --------- Test for _create_month_range ---------
 TEST(AnalyticsApiStrategyTest, CreateMonthRange) {
     // Note: This function is declared in the header. We assume its implementation returns a vector
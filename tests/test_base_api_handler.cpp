@@ -2,6 +2,7 @@
 
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
+#include <cstdint>
 #include <cstdlib>
 #include <functional>
 #include <mongocxx/client.hpp>
@@ -13,6 +14,7 @@
 #include "constants.hpp"
 #include "crow.h"
 #include "database_manager.hpp"
+#include "entity_tag.hpp"
 #include "env_manager.hpp"
 
 using bsoncxx::builder::basic::kvp;
@@ -98,6 +100,95 @@ TEST(BaseApiHandlerTest, FindMultiple) {
     cleanup_collection(*db_ptr, collection);
 }
 
+// -------- Test for find_serialized with the fields taken from the last document --------
+TEST(BaseApiHandlerTest, FindSerialized) {
+    auto db_ptr = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    BaseApiHandler handler;
+    std::string collection = "test_handler_find_serialized";
+    cleanup_collection(*db_ptr, collection);
+
+    for (int i = 0; i < 50; ++i) {
+        db_ptr->insert_one(collection,
+                           make_document(kvp("stream_test", true), kvp("value", i)).view());
+    }
+
+    auto process_request_func = [](const crow::request& req)
+        -> std::tuple<bsoncxx::document::value, mongocxx::options::find, bsoncxx::document::value> {
+        mongocxx::options::find options{};
+        return {make_document(kvp("stream_test", true)), options, make_document(kvp("value", 1))};
+    };
+
+    auto process_fields_func =
+        [](const crow::request& req,
+           const bsoncxx::stdx::optional<bsoncxx::document::value>& last_document,
+           const size_t& document_count) -> crow::json::wvalue {
+        crow::json::wvalue fields;
+        fields["last_value"] =
+            last_document ? last_document->view()["value"].get_int32().value : -1;
+        fields["document_count"] = document_count;
+        return fields;
+    };
+
+    crow::request req;
+    auto response =
+        handler.find_serialized(req, db_ptr, collection, process_request_func,
+                                BaseApiStrategy::process_document_func_get, process_fields_func);
+    EXPECT_EQ(response.code, 200);
+
+    auto body = crow::json::load(response.body);
+    ASSERT_TRUE(body);
+    EXPECT_TRUE(body["success"].b());
+    ASSERT_EQ(body["documents"].size(), 50);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(body["documents"][i]["value"].i(), i);
+    }
+    EXPECT_EQ(body["last_value"].i(), 49);
+    EXPECT_EQ(body["document_count"].i(), 50);
+    // the ETag hashed piece by piece matches one taken over the whole body
+    EXPECT_EQ(response.get_header_value("ETag"), EntityTagUtils::compute_etag(response.body));
+
+    cleanup_collection(*db_ptr, collection);
+}
+
+// -------- Test that find_serialized returns the stored documents as BSON when asked to --------
+TEST(BaseApiHandlerTest, FindSerializedBson) {
+    auto db_ptr = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    BaseApiHandler handler;
+    std::string collection = "test_handler_find_serialized_bson";
+    cleanup_collection(*db_ptr, collection);
+
+    for (int i = 0; i < 5; ++i) {
+        db_ptr->insert_one(collection,
+                           make_document(kvp("stream_test", true), kvp("value", i)).view());
+    }
+
+    auto process_request_func = [](const crow::request& req)
+        -> std::tuple<bsoncxx::document::value, mongocxx::options::find, bsoncxx::document::value> {
+        mongocxx::options::find options{};
+        return {make_document(kvp("stream_test", true)), options, make_document(kvp("value", 1))};
+    };
+
+    crow::request req;
+    req.add_header("Accept", "application/bson");
+    auto response = handler.find_serialized(req, db_ptr, collection, process_request_func);
+    EXPECT_EQ(response.code, 200);
+    EXPECT_EQ(response.get_header_value("Content-Type"), "application/bson");
+
+    bsoncxx::document::view body(reinterpret_cast<const std::uint8_t*>(response.body.data()),
+                                 response.body.size());
+    EXPECT_TRUE(body["success"].get_bool().value);
+    auto documents = body["documents"].get_array().value;
+    int i = 0;
+    for (const auto& document : documents) {
+        EXPECT_EQ(document["value"].get_int32().value, i);
+        EXPECT_EQ(document["_id"].type(), bsoncxx::type::k_oid);
+        i++;
+    }
+    EXPECT_EQ(i, 5);
+
+    cleanup_collection(*db_ptr, collection);
+}
+
 // -------- Test for insert_one --------
 TEST(BaseApiHandlerTest, InsertOne) {
     auto db_ptr = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
@@ -5,6 +5,8 @@
 #include <bsoncxx/builder/basic/document.hpp>
 #include <bsoncxx/json.hpp>
 #include <bsoncxx/types.hpp>
+#include <chrono>
+#include <iterator>
 #include <stdexcept>
 #include <string>
 #include <vector>
@@ -144,6 +146,60 @@ TEST(ParseRequestJsonToDatabaseBsonTest, ConvertsInequalityOperatorGTE) {
     EXPECT_EQ(bsoncxx::to_json(output_doc), bsoncxx::to_json(expected_doc));
 }
 
+// Test that range keys on date fields become a date range on the clean key
+TEST(ParseRequestJsonToDatabaseBsonTest, ConvertsDateRange) {
+    auto input = crow::json::load(
+        "{\"_from_date\": \"01-01-1970 00:00:00\", \"_to_date\": \"01-01-1970 00:00:01\"}");
+    ASSERT_TRUE(input);
+
+    auto output_doc = BaseApiStrategyUtils::parse_request_json_to_database_bson(input);
+
+    auto expected_doc = make_document(
+        kvp("date", make_document(kvp("$gte", bsoncxx::types::b_date{std::chrono::seconds{0}}))),
+        kvp("date", make_document(kvp("$lte", bsoncxx::types::b_date{std::chrono::seconds{1}}))));
+    EXPECT_EQ(bsoncxx::to_json(output_doc), bsoncxx::to_json(expected_doc));
+}
+
+// Test that date fields are converted inside nested objects but not inside arrays
+TEST(ParseRequestJsonToDatabaseBsonTest, ConvertsNestedDateFieldsOnly) {
+    auto input = crow::json::load(
+        "{\"$or\": [{\"date_closed\": \"01-01-1970 00:00:00\"}], "
+        "\"labels\": [\"01-01-1970 00:00:00\"]}");
+    ASSERT_TRUE(input);
+
+    auto output_doc = BaseApiStrategyUtils::parse_request_json_to_database_bson(input);
+
+    auto view = output_doc.view();
+    auto or_clause = view["$or"].get_array().value[0].get_document().value;
+    EXPECT_EQ(or_clause["date_closed"].type(), bsoncxx::type::k_date);
+    EXPECT_EQ(view["labels"].get_array().value[0].type(), bsoncxx::type::k_string);
+}
+
+// Test that range keys are rejected below the top level
+TEST(ParseRequestJsonToDatabaseBsonTest, RejectsNestedRangeKey) {
+    auto input = crow::json::load("{\"$or\": [{\"_from_age\": 30}]}");
+    ASSERT_TRUE(input);
+
+    EXPECT_THROW(BaseApiStrategyUtils::parse_request_json_to_database_bson(input),
+                 std::invalid_argument);
+}
+
+// Test that strings, booleans, nulls and doubles keep their BSON types
+TEST(ParseRequestJsonToDatabaseBsonTest, ConvertsPrimitiveTypes) {
+    auto input = crow::json::load(
+        "{\"text\": \"a \\\"quoted\\\" value\", \"flag\": true, \"nothing\": null, "
+        "\"score\": 0.5}");
+    ASSERT_TRUE(input);
+
+    auto output_doc = BaseApiStrategyUtils::parse_request_json_to_database_bson(input);
+
+    auto view = output_doc.view();
+    EXPECT_EQ(std::string(view["text"].get_string().value), "a \"quoted\" value");
+    EXPECT_TRUE(view["flag"].get_bool().value);
+    EXPECT_EQ(view["nothing"].type(), bsoncxx::type::k_null);
+    EXPECT_DOUBLE_EQ(view["score"].get_double().value, 0.5);
+}
+
 // ----- Test for parse_oid_str_to_oid_bson -----
 // This function converts an OID string to a bson document.
 
@@ -208,4 +264,146 @@ TEST(MakeSuccessResponseTest, ReturnsSuccessResponse) {
     EXPECT_TRUE(json_body["success"].b());
     EXPECT_EQ(json_body["message"].s(), success_msg);
     EXPECT_EQ(json_body["data_field"].s(), "value1");
-}
\ No newline at end of file
+}
+// ----- Tests for keyset pagination helpers -----
+
+TEST(KeysetPaginationTest, AddsIdTiebreakerInLastDirection) {
+    auto sort = BaseApiStrategyUtils::add_keyset_tiebreaker(
+        make_document(kvp("date", -1), kvp("category", -1)).view());
+    EXPECT_EQ(sort.view()["_id"].get_int32().value, -1);
+
+    auto empty_sort = BaseApiStrategyUtils::add_keyset_tiebreaker(make_document().view());
+    EXPECT_EQ(empty_sort.view()["_id"].get_int32().value, 1);
+
+    auto id_sort = BaseApiStrategyUtils::add_keyset_tiebreaker(make_document(kvp("_id", -1)));
+    EXPECT_EQ(bsoncxx::to_json(id_sort.view()), bsoncxx::to_json(make_document(kvp("_id", -1))));
+}
+
+TEST(KeysetPaginationTest, CursorRoundTripsToRangeFilter) {
+    auto sort = BaseApiStrategyUtils::add_keyset_tiebreaker(make_document(kvp("value", 1)));
+    bsoncxx::oid oid;
+    auto last_document = make_document(kvp("_id", oid), kvp("value", 7), kvp("other", "x"));
+
+    auto cursor = BaseApiStrategyUtils::create_keyset_cursor(sort.view(), last_document.view());
+    EXPECT_EQ(cursor.find("value"), std::string::npos) << "Cursor should be opaque.";
+
+    auto filter = BaseApiStrategyUtils::parse_keyset_cursor_to_filter(cursor, sort.view());
+    auto clauses = filter.view()["$or"].get_array().value;
+    auto first = (*clauses.begin()).get_document().value;
+    auto later_types = (*std::next(clauses.begin(), 1)).get_document().value;
+    auto third = (*std::next(clauses.begin(), 2)).get_document().value;
+
+    EXPECT_EQ(first["value"]["$gt"].get_int32().value, 7);
+    // strings and other types sorted after numbers follow the last number
+    EXPECT_TRUE(later_types["value"]["$type"]);
+    EXPECT_EQ(third["value"].get_int32().value, 7);
+    EXPECT_EQ(third["_id"]["$gt"].get_oid().value, oid);
+}
+
+TEST(KeysetPaginationTest, PagesPastMissingAndArrayKeys) {
+    auto sort = BaseApiStrategyUtils::add_keyset_tiebreaker(make_document(kvp("value", 1)));
+    bsoncxx::oid oid;
+    auto missing_document = make_document(kvp("_id", oid));
+    auto cursor =
+        BaseApiStrategyUtils::create_keyset_cursor(sort.view(), missing_document.view());
+
+    // a missing key sorts as null, so every non-null value comes after it
+    auto filter = BaseApiStrategyUtils::parse_keyset_cursor_to_filter(cursor, sort.view());
+    auto clauses = filter.view()["$or"].get_array().value;
+    auto first = (*clauses.begin()).get_document().value;
+    auto second = (*std::next(clauses.begin())).get_document().value;
+    EXPECT_FALSE(first["value"]["$gt"]);
+    EXPECT_TRUE(first["value"]["$type"]);
+    EXPECT_EQ(second["value"].type(), bsoncxx::type::k_null);
+    EXPECT_EQ(second["_id"]["$gt"].get_oid().value, oid);
+
+    // descending, null and missing values come after every number
+    auto descending_sort =
+        BaseApiStrategyUtils::add_keyset_tiebreaker(make_document(kvp("value", -1)));
+    auto descending_cursor = BaseApiStrategyUtils::create_keyset_cursor(
+        descending_sort.view(), make_document(kvp("_id", oid), kvp("value", 7)).view());
+    auto descending_filter =
+        BaseApiStrategyUtils::parse_keyset_cursor_to_filter(descending_cursor,
+                                                            descending_sort.view());
+    bool has_null_clause = false;
+    for (const auto& clause : descending_filter.view()["$or"].get_array().value) {
+        auto value = clause.get_document().value["value"];
+        has_null_clause = has_null_clause || (value && value.type() == bsoncxx::type::k_null &&
+                                              !clause.get_document().value["_id"]);
+    }
+    EXPECT_TRUE(has_null_clause);
+
+    auto array_document =
+        make_document(kvp("_id", oid), kvp("value", bsoncxx::builder::basic::make_array(1, 2)));
+    EXPECT_THROW(BaseApiStrategyUtils::create_keyset_cursor(sort.view(), array_document.view()),
+                 std::invalid_argument);
+}
+
+TEST(KeysetPaginationTest, DescendingSortUsesLessThan) {
+    auto sort = BaseApiStrategyUtils::add_keyset_tiebreaker(make_document(kvp("value", -1)));
+    auto last_document = make_document(kvp("_id", bsoncxx::oid()), kvp("value", 7));
+    auto cursor = BaseApiStrategyUtils::create_keyset_cursor(sort.view(), last_document.view());
+
+    auto filter = BaseApiStrategyUtils::parse_keyset_cursor_to_filter(cursor, sort.view());
+    auto first = (*filter.view()["$or"].get_array().value.begin()).get_document().value;
+    EXPECT_EQ(first["value"]["$lt"].get_int32().value, 7);
+}
+
+TEST(KeysetPaginationTest, RejectsInvalidOrMismatchedCursor) {
+    auto sort = BaseApiStrategyUtils::add_keyset_tiebreaker(make_document(kvp("value", 1)));
+    auto other_sort = BaseApiStrategyUtils::add_keyset_tiebreaker(make_document(kvp("date", 1)));
+    auto last_document = make_document(kvp("_id", bsoncxx::oid()), kvp("value", 7));
+    auto cursor = BaseApiStrategyUtils::create_keyset_cursor(sort.view(), last_document.view());
+
+    EXPECT_THROW(BaseApiStrategyUtils::parse_keyset_cursor_to_filter("not a cursor", sort.view()),
+                 std::invalid_argument);
+    EXPECT_THROW(BaseApiStrategyUtils::parse_keyset_cursor_to_filter(cursor, other_sort.view()),
+                 std::invalid_argument);
+}
+
+// ----- Tests for parse_request_json_to_projection -----
+
+TEST(ParseRequestJsonToProjectionTest, NoProjectionRequested) {
+    auto body = crow::json::load("{\"filter\": {}}");
+    EXPECT_FALSE(BaseApiStrategyUtils::parse_request_json_to_projection(body));
+    EXPECT_FALSE(BaseApiStrategyUtils::parse_request_json_to_projection(crow::json::load("")));
+}
+
+TEST(ParseRequestJsonToProjectionTest, IncludesFieldsAndRequiredFields) {
+    auto body = crow::json::load("{\"fields\": [\"title\", \"date\"]}");
+    auto projection = BaseApiStrategyUtils::parse_request_json_to_projection(body, {"sentiment"});
+    ASSERT_TRUE(projection);
+    EXPECT_EQ(projection->view()["title"].get_int32().value, 1);
+    EXPECT_EQ(projection->view()["date"].get_int32().value, 1);
+    EXPECT_EQ(projection->view()["sentiment"].get_int32().value, 1);
+    EXPECT_FALSE(projection->view()["_id"]);
+}
+
+TEST(ParseRequestJsonToProjectionTest, ExcludesFieldsExceptRequiredFields) {
+    auto body = crow::json::load("{\"exclude_fields\": [\"description\", \"date\"]}");
+    auto projection = BaseApiStrategyUtils::parse_request_json_to_projection(body, {"date"});
+    ASSERT_TRUE(projection);
+    EXPECT_EQ(projection->view()["description"].get_int32().value, 0);
+    EXPECT_FALSE(projection->view()["date"]);
+}
+
+TEST(ParseRequestJsonToProjectionTest, InclusionMayExcludeOnlyId) {
+    auto body = crow::json::load("{\"fields\": [\"title\"], \"exclude_fields\": [\"_id\"]}");
+    auto projection = BaseApiStrategyUtils::parse_request_json_to_projection(body);
+    ASSERT_TRUE(projection);
+    EXPECT_EQ(projection->view()["_id"].get_int32().value, 0);
+
+    auto mixed_body =
+        crow::json::load("{\"fields\": [\"title\"], \"exclude_fields\": [\"description\"]}");
+    EXPECT_THROW(BaseApiStrategyUtils::parse_request_json_to_projection(mixed_body),
+                 std::invalid_argument);
+}
+
+TEST(ParseRequestJsonToProjectionTest, RejectsInvalidFieldNames) {
+    EXPECT_THROW(
+        BaseApiStrategyUtils::parse_request_json_to_projection(crow::json::load("{\"fields\": 1}")),
+        std::invalid_argument);
+    EXPECT_THROW(BaseApiStrategyUtils::parse_request_json_to_projection(
+                     crow::json::load("{\"fields\": [\"$where\"]}")),
+                 std::invalid_argument);
+}
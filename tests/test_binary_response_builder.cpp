@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/document/view.hpp>
+#include <bsoncxx/types.hpp>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "binary_response_builder.hpp"
+#include "crow.h"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+// ----- Test that BSON bodies embed the documents unchanged -----
+TEST(BinaryResponseBuilderTest, BuildsBsonWithRawDocuments) {
+    bsoncxx::types::b_date date{std::chrono::milliseconds{1000}};
+    auto first = make_document(kvp("value", 1), kvp("date", date));
+    auto second = make_document(kvp("value", 2));
+
+    BinaryResponseBuilder builder(ResponseFormat::Bson, "documents");
+    builder.append_document(first.view());
+    builder.append_document(second.view());
+    EXPECT_EQ(builder.get_item_count(), 2u);
+
+    crow::json::wvalue fields;
+    fields["next_cursor"] = "abc";
+    auto body_bytes = builder.finish(fields);
+    bsoncxx::document::view body(reinterpret_cast<const std::uint8_t*>(body_bytes.data()),
+                                 body_bytes.size());
+
+    auto documents = body["documents"].get_array().value;
+    EXPECT_EQ(documents[0].get_document().value, first.view());
+    EXPECT_EQ(documents[1].get_document().value, second.view());
+    EXPECT_EQ(documents[0]["date"].type(), bsoncxx::type::k_date)
+        << "BSON callers should get dates as BSON dates.";
+    EXPECT_EQ(body["next_cursor"].get_string().value, "abc");
+}
+
+// ----- Test the MessagePack envelope -----
+TEST(BinaryResponseBuilderTest, BuildsMessagePack) {
+    BinaryResponseBuilder builder(ResponseFormat::MessagePack, "documents");
+    builder.append_document(make_document(kvp("a", 1)).view());
+
+    crow::json::wvalue fields;
+    fields["success"] = true;
+    EXPECT_EQ(builder.finish(fields), "\x82\xa9" "documents\x91\x81\xa1" "a\x01\xa7success\xc3");
+}
+
+// ----- Test that JSON is left to JsonResponseBuilder -----
+TEST(BinaryResponseBuilderTest, RejectsJson) {
+    EXPECT_THROW(BinaryResponseBuilder(ResponseFormat::Json, "documents"), std::invalid_argument);
+}
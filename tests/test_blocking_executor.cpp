@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "blocking_executor.hpp"
+
+// ----- Test that submitted tasks run on the executor's own threads -----
+TEST(BlockingExecutorTest, RunsSubmittedTasks) {
+    std::atomic<int> completed_tasks{0};
+    std::atomic<bool> ran_on_caller_thread{false};
+    auto caller_thread_id = std::this_thread::get_id();
+    {
+        BlockingExecutor executor(4, 100);
+        EXPECT_EQ(executor.get_num_threads(), 4);
+        for (int i = 0; i < 50; ++i) {
+            EXPECT_TRUE(executor.submit([&]() {
+                if (std::this_thread::get_id() == caller_thread_id) {
+                    ran_on_caller_thread = true;
+                }
+                completed_tasks++;
+            }));
+        }
+    }  // destructor drains the queue before joining
+
+    EXPECT_EQ(completed_tasks, 50);
+    EXPECT_FALSE(ran_on_caller_thread);
+}
+
+// ----- Test that the queue is bounded -----
+TEST(BlockingExecutorTest, RejectsWhenQueueIsFull) {
+    std::atomic<bool> release{false};
+    std::atomic<bool> started{false};
+    BlockingExecutor executor(1, 2);
+
+    EXPECT_TRUE(executor.submit([&]() {
+        started = true;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }));
+    while (!started) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_TRUE(executor.submit([]() {}));
+    EXPECT_TRUE(executor.submit([]() {}));
+    EXPECT_FALSE(executor.submit([]() {}));
+
+    release = true;
+}
+
+// ----- Test that a throwing task does not take down its worker -----
+TEST(BlockingExecutorTest, SurvivesThrowingTask) {
+    std::atomic<bool> ran_after_throw{false};
+    {
+        BlockingExecutor executor(1, 10);
+        executor.submit([]() { throw std::runtime_error("boom"); });
+        executor.submit([&]() { ran_after_throw = true; });
+    }
+    EXPECT_TRUE(ran_after_throw);
+}
+
+// ----- Test invalid thread count -----
+TEST(BlockingExecutorTest, InvalidThreadCount) {
+    EXPECT_THROW(BlockingExecutor(0, 10), std::invalid_argument);
+}
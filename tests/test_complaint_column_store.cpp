@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "complaint_column_store.hpp"
+#include "constants.hpp"
+#include "database_manager.hpp"
+#include "date_utils.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+static auto to_milliseconds(const std::string& datetime) -> int64_t {
+    return DateUtils::string_to_utc_unix_timestamp(datetime, Constants::DATETIME_FORMAT) * 1000;
+}
+
+static auto make_columns() -> ComplaintColumnStore::Columns {
+    ComplaintColumnStore::Columns columns;
+    columns.append(to_milliseconds("03-01-2024 10:00:00"), std::string("Housing"),
+                   std::string("Reddit"), 0.5);
+    columns.append(to_milliseconds("20-01-2024 10:00:00"), std::string("Housing"),
+                   std::string("Reddit"), -0.25);
+    columns.append(to_milliseconds("03-02-2024 10:00:00"), std::string("Transport"),
+                   std::string("Reddit"), 1.0);
+    columns.append(to_milliseconds("03-02-2024 10:00:00"), bsoncxx::stdx::nullopt,
+                   std::string("Reddit"), std::numeric_limits<double>::quiet_NaN());
+    columns.append(ComplaintColumnStore::MISSING_DATE, std::string("Housing"),
+                   std::string("Reddit"), 0.0);
+    return columns;
+}
+
+// ----- Test that complaints are dictionary encoded and months counted from 1970 -----
+TEST(ComplaintColumnStoreTest, EncodesComplaints) {
+    auto columns = make_columns();
+    ASSERT_EQ(columns.size(), 5u);
+    EXPECT_EQ(columns.category_dictionary, (std::vector<std::string>{"Housing", "Transport"}));
+    EXPECT_EQ(columns.categories[3], ComplaintColumnStore::MISSING_CATEGORY);
+    EXPECT_EQ(columns.months[4], ComplaintColumnStore::NO_MONTH);
+    EXPECT_EQ(columns.first_month, (2024 - 1970) * 12);
+    EXPECT_EQ(columns.last_month, (2024 - 1970) * 12 + 1);
+    EXPECT_EQ(ComplaintColumnStore::_get_month(to_milliseconds("31-12-1969 12:00:00")), -1);
+
+    ComplaintColumnStore::Columns from_document;
+    from_document.append(make_document(kvp("category", 1), kvp("sentiment", 1)).view());
+    EXPECT_EQ(from_document.dates[0], ComplaintColumnStore::MISSING_DATE);
+    EXPECT_EQ(from_document.categories[0], ComplaintColumnStore::MISSING_CATEGORY);
+    EXPECT_DOUBLE_EQ(from_document.sentiments[0], 1.0);
+}
+
+// ----- Test that the statistics match a $match and $group over the same complaints -----
+TEST(ComplaintColumnStoreTest, ComputesStatistics) {
+    auto columns = make_columns();
+
+    ComplaintColumnStore::Filter filter;
+    auto groups = ComplaintColumnStore::compute_statistics(columns, filter, false,
+                                                           ComplaintColumnStore::Dimension::None);
+    ASSERT_EQ(groups.size(), 1u);
+    EXPECT_EQ(groups[0].statistics.count, 5);
+    EXPECT_EQ(groups[0].statistics.sentiment_count, 4);
+    EXPECT_DOUBLE_EQ(groups[0].statistics.sentiment_sum, 1.25);
+    EXPECT_EQ(groups[0].statistics.sentiment_sketch.get_count(), 4);
+    EXPECT_DOUBLE_EQ(groups[0].statistics.sentiment_sketch.get_min(), -0.25);
+    EXPECT_DOUBLE_EQ(groups[0].statistics.sentiment_sketch.get_max(), 1.0);
+
+    // a date bound leaves out complaints without a date
+    filter.from_date = to_milliseconds("01-01-2024 00:00:00");
+    filter.category = columns.category_codes.at("Housing");
+    groups = ComplaintColumnStore::compute_statistics(columns, filter, false,
+                                                      ComplaintColumnStore::Dimension::None);
+    ASSERT_EQ(groups.size(), 1u);
+    EXPECT_EQ(groups[0].statistics.count, 2);
+
+    filter = ComplaintColumnStore::Filter();
+    filter.has_sentiment_range = true;
+    filter.from_sentiment = 0.0f;
+    groups = ComplaintColumnStore::compute_statistics(columns, filter, false,
+                                                      ComplaintColumnStore::Dimension::None);
+    ASSERT_EQ(groups.size(), 1u);
+    EXPECT_EQ(groups[0].statistics.count, 3);
+
+    filter.matches_nothing = true;
+    EXPECT_TRUE(ComplaintColumnStore::compute_statistics(columns, filter, false,
+                                                         ComplaintColumnStore::Dimension::None)
+                    .empty());
+}
+
+// ----- Test grouping by month and category -----
+TEST(ComplaintColumnStoreTest, GroupsByMonthAndCategory) {
+    auto columns = make_columns();
+    ComplaintColumnStore::Filter filter;
+    filter.from_date = to_milliseconds("01-01-2024 00:00:00");
+    filter.to_date = to_milliseconds("31-12-2024 23:59:59");
+
+    auto groups = ComplaintColumnStore::compute_statistics(
+        columns, filter, true, ComplaintColumnStore::Dimension::Category);
+    ASSERT_EQ(groups.size(), 3u);
+    auto january = (2024 - 1970) * 12;
+    EXPECT_EQ(groups[0].month, january);
+    EXPECT_EQ(groups[0].value, columns.category_codes.at("Housing"));
+    EXPECT_EQ(groups[0].statistics.count, 2);
+    EXPECT_EQ(groups[1].month, january + 1);
+    EXPECT_EQ(groups[1].value, columns.category_codes.at("Transport"));
+    // a complaint without a category is grouped as missing, like null in $group
+    EXPECT_EQ(groups[2].month, january + 1);
+    EXPECT_EQ(groups[2].value, ComplaintColumnStore::MISSING_CATEGORY);
+    EXPECT_EQ(groups[2].statistics.sentiment_count, 0);
+    EXPECT_EQ(groups[0].statistics.sentiment_sketch.get_count(), 2);
+    EXPECT_EQ(groups[2].statistics.sentiment_sketch.get_count(), 0);
+
+    filter.to_date = to_milliseconds("31-01-2024 23:59:59");
+    groups = ComplaintColumnStore::compute_statistics(columns, filter, true,
+                                                      ComplaintColumnStore::Dimension::None);
+    ASSERT_EQ(groups.size(), 1u);
+    EXPECT_EQ(groups[0].value, ComplaintColumnStore::ANY_VALUE);
+    EXPECT_EQ(groups[0].statistics.count, 2);
+}
+
+// ----- Test sentiment buckets and the default bucket -----
+TEST(ComplaintColumnStoreTest, CountsSentimentBuckets) {
+    auto columns = make_columns();
+    ComplaintColumnStore::Filter filter;
+    auto counts =
+        ComplaintColumnStore::count_sentiment_buckets(columns, filter, {-1.0, 0.0, 1.0, 1.01});
+    // [-1, 0), [0, 1), [1, 1.01) and outside every bucket
+    EXPECT_EQ(counts, (std::vector<long long int>{1, 2, 1, 1}));
+
+    // a sentiment on a boundary left by adding 0.1 up from -1 is in the bucket it starts, as
+    // with $bucket, instead of moving below it as it would when rounded to a float
+    ComplaintColumnStore::Columns on_boundary;
+    on_boundary.append(ComplaintColumnStore::MISSING_DATE, bsoncxx::stdx::nullopt,
+                       bsoncxx::stdx::nullopt, -0.30000000000000016);
+    counts = ComplaintColumnStore::count_sentiment_buckets(on_boundary, filter,
+                                                           {-1.0, -0.30000000000000016, 1.01});
+    EXPECT_EQ(counts, (std::vector<long long int>{0, 1, 0}));
+}
+
+// ----- Test that the store loads complaints from the database -----
+TEST(ComplaintColumnStoreTest, LoadsComplaints) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    db_manager->delete_many(Constants::COLLECTION_COMPLAINTS, make_document().view());
+    db_manager->insert_one(
+        Constants::COLLECTION_COMPLAINTS,
+        make_document(kvp("category", "Housing"), kvp("source", "Reddit"), kvp("sentiment", 0.5))
+            .view());
+
+    ComplaintColumnStore complaint_column_store(db_manager, 0);
+    complaint_column_store.refresh();
+    // opening the change stream counts as a change, so wait for the reload it triggers
+    auto columns = complaint_column_store.get_columns();
+    for (int i = 0; i < 500 && !columns; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        columns = complaint_column_store.get_columns();
+    }
+    ASSERT_NE(columns, nullptr);
+    EXPECT_EQ(columns->size(), 1u);
+    EXPECT_EQ(columns->category_dictionary, std::vector<std::string>{"Housing"});
+
+    // a reported change is loaded even without a change stream
+    db_manager->insert_one(Constants::COLLECTION_COMPLAINTS,
+                           make_document(kvp("category", "Transport")).view());
+    complaint_column_store.mark_changed();
+    columns = complaint_column_store.get_columns();
+    for (int i = 0; i < 500 && (!columns || columns->size() != 2); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        columns = complaint_column_store.get_columns();
+    }
+    ASSERT_NE(columns, nullptr);
+    EXPECT_EQ(columns->size(), 2u);
+
+    db_manager->delete_many(Constants::COLLECTION_COMPLAINTS, make_document().view());
+}
+
+// ----- Test that the previous columns are served while a change loads, but only for a while -----
+TEST(ComplaintColumnStoreTest, ServesPreviousColumnsWithinStaleness) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    db_manager->delete_many(Constants::COLLECTION_COMPLAINTS, make_document().view());
+    db_manager->insert_one(Constants::COLLECTION_COMPLAINTS,
+                           make_document(kvp("category", "Housing")).view());
+
+    ComplaintColumnStore stale_store(db_manager, 0, 60000);
+    stale_store.refresh();
+    int refresh_count = 0;
+    stale_store.set_on_refresh([&refresh_count]() { refresh_count++; });
+    stale_store.mark_changed();
+    auto columns = stale_store.get_columns();
+    ASSERT_NE(columns, nullptr);
+    EXPECT_EQ(columns->size(), 1u);
+    stale_store.refresh();
+    EXPECT_GE(refresh_count, 1);
+
+    ComplaintColumnStore current_store(db_manager, 0, 0);
+    current_store.refresh();
+    auto loaded_columns = current_store.get_columns();
+    current_store.mark_changed();
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    // a reload may already have caught up, but the columns that miss the change are not served
+    auto current_columns = current_store.get_columns();
+    EXPECT_TRUE(current_columns == nullptr || current_columns != loaded_columns);
+
+    db_manager->delete_many(Constants::COLLECTION_COMPLAINTS, make_document().view());
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "complaint_rollup_manager.hpp"
+#include "constants.hpp"
+#include "database_manager.hpp"
+#include "date_utils.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+static auto make_date(const std::string& datetime) -> bsoncxx::types::b_date {
+    return bsoncxx::types::b_date{std::chrono::seconds(
+        DateUtils::string_to_utc_unix_timestamp(datetime, Constants::DATETIME_FORMAT))};
+}
+
+static auto make_complaint(const bsoncxx::oid& oid, const std::string& datetime,
+                           const std::string& category, const double& sentiment)
+    -> bsoncxx::document::value {
+    return make_document(kvp("_id", oid), kvp("date", make_date(datetime)),
+                         kvp("category", category), kvp("source", "Reddit"),
+                         kvp("sentiment", sentiment));
+}
+
+static auto find_rollup(std::shared_ptr<DatabaseManager> db_manager, const std::string& month,
+                        const std::string& category)
+    -> bsoncxx::stdx::optional<bsoncxx::document::value> {
+    return db_manager->find_one(
+        Constants::COLLECTION_COMPLAINT_ROLLUPS,
+        make_document(kvp("date", make_date(month)), kvp("category", category),
+                      kvp("source", "Reddit"))
+            .view());
+}
+
+static auto get_count(const bsoncxx::document::view& rollup) -> long long int {
+    auto count = rollup["count"];
+    return count.type() == bsoncxx::type::k_int32 ? count.get_int32().value
+                                                  : count.get_int64().value;
+}
+
+static auto get_bin_count(const bsoncxx::document::view& rollup, const std::string& bin)
+    -> long long int {
+    auto count = rollup["sentiment_histogram"][bin];
+    if (!count) {
+        return 0;
+    }
+    return count.type() == bsoncxx::type::k_int32 ? count.get_int32().value
+                                                  : count.get_int64().value;
+}
+
+static void clear_collections(std::shared_ptr<DatabaseManager> db_manager) {
+    db_manager->delete_many(Constants::COLLECTION_COMPLAINTS, make_document().view());
+    db_manager->delete_many(Constants::COLLECTION_COMPLAINT_ROLLUPS, make_document().view());
+}
+
+// ----- Test that a complaint is keyed by the first instant of its month -----
+TEST(ComplaintRollupManagerTest, KeysComplaintsByMonth) {
+    auto key = ComplaintRollupManager::_make_key(
+        make_complaint(bsoncxx::oid(), "29-02-2024 23:59:59", "Housing", 0.5).view());
+    ASSERT_TRUE(key.has_value());
+    EXPECT_EQ(key->view()["date"].get_date(), make_date("01-02-2024 00:00:00"));
+    EXPECT_EQ(key->view()["category"].get_string().value, "Housing");
+    EXPECT_EQ(key->view()["source"].get_string().value, "Reddit");
+
+    EXPECT_EQ(ComplaintRollupManager::_get_month_start(make_date("31-12-1969 12:00:00")),
+              make_date("01-12-1969 00:00:00"));
+    EXPECT_FALSE(ComplaintRollupManager::_make_key(make_document(kvp("category", "Housing")).view())
+                     .has_value());
+}
+
+// ----- Test that inserted complaints are summed per month and category -----
+TEST(ComplaintRollupManagerTest, AppliesInserts) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    clear_collections(db_manager);
+    ComplaintRollupManager complaint_rollup_manager(db_manager);
+
+    auto first = make_complaint(bsoncxx::oid(), "03-01-2024 10:00:00", "Housing", 0.5);
+    auto second = make_complaint(bsoncxx::oid(), "20-01-2024 10:00:00", "Housing", -0.25);
+    auto third = make_complaint(bsoncxx::oid(), "03-02-2024 10:00:00", "Housing", 1.0);
+    complaint_rollup_manager.apply_inserts({first.view(), second.view(), third.view()});
+
+    auto january = find_rollup(db_manager, "01-01-2024 00:00:00", "Housing");
+    ASSERT_TRUE(january.has_value());
+    EXPECT_EQ(get_count(january->view()), 2);
+    EXPECT_DOUBLE_EQ(january->view()["sentiment_sum"].get_double().value, 0.25);
+    EXPECT_DOUBLE_EQ(january->view()["sentiment_sum_of_squares"].get_double().value, 0.3125);
+    // 0.5 and -0.25 fall in bins 150 and 75
+    EXPECT_EQ(get_bin_count(january->view(), "150"), 1);
+    EXPECT_EQ(get_bin_count(january->view(), "75"), 1);
+
+    auto february = find_rollup(db_manager, "01-02-2024 00:00:00", "Housing");
+    ASSERT_TRUE(february.has_value());
+    EXPECT_EQ(get_count(february->view()), 1);
+
+    clear_collections(db_manager);
+}
+
+// ----- Test that updates and deletes move contributions between rollups -----
+TEST(ComplaintRollupManagerTest, TracksUpdatesAndDeletes) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    clear_collections(db_manager);
+    ComplaintRollupManager complaint_rollup_manager(db_manager);
+
+    bsoncxx::oid oid;
+    auto complaint = make_complaint(oid, "03-01-2024 10:00:00", "Housing", 0.5);
+    db_manager->insert_one(Constants::COLLECTION_COMPLAINTS, complaint.view());
+    complaint_rollup_manager.apply_inserts({complaint.view()});
+
+    auto filter = make_document(kvp("_id", oid));
+    auto result = complaint_rollup_manager.update_one(
+        filter.view(),
+        make_document(kvp("$set", make_document(kvp("category", "Transport")))).view());
+    EXPECT_EQ(result.matched_count, 1);
+    EXPECT_EQ(result.modified_count, 1);
+    EXPECT_EQ(get_count(find_rollup(db_manager, "01-01-2024 00:00:00", "Housing")->view()), 0);
+    EXPECT_EQ(get_count(find_rollup(db_manager, "01-01-2024 00:00:00", "Transport")->view()), 1);
+
+    // an update that changes nothing leaves the rollups alone
+    result = complaint_rollup_manager.update_one(
+        filter.view(),
+        make_document(kvp("$set", make_document(kvp("category", "Transport")))).view());
+    EXPECT_EQ(result.modified_count, 0);
+    EXPECT_EQ(get_count(find_rollup(db_manager, "01-01-2024 00:00:00", "Transport")->view()), 1);
+
+    // the range shrinks back to the sentiments left once the lowest one is deleted
+    bsoncxx::oid other_oid;
+    auto other = make_complaint(other_oid, "20-01-2024 10:00:00", "Transport", 0.75);
+    db_manager->insert_one(Constants::COLLECTION_COMPLAINTS, other.view());
+    complaint_rollup_manager.apply_inserts({other.view()});
+    auto transport = find_rollup(db_manager, "01-01-2024 00:00:00", "Transport");
+    EXPECT_DOUBLE_EQ(transport->view()["sentiment_min"].get_double().value, 0.5);
+    EXPECT_DOUBLE_EQ(transport->view()["sentiment_max"].get_double().value, 0.75);
+
+    EXPECT_EQ(complaint_rollup_manager.delete_many(filter.view()), 1);
+    transport = find_rollup(db_manager, "01-01-2024 00:00:00", "Transport");
+    EXPECT_EQ(get_count(transport->view()), 1);
+    EXPECT_DOUBLE_EQ(transport->view()["sentiment_min"].get_double().value, 0.75);
+    EXPECT_EQ(complaint_rollup_manager.delete_many(make_document(kvp("_id", other_oid)).view()), 1);
+    EXPECT_FALSE(find_rollup(db_manager, "01-01-2024 00:00:00", "Transport")
+                     ->view()["sentiment_min"]);
+
+    // writes that match nothing leave the rollups alone
+    EXPECT_EQ(complaint_rollup_manager.delete_many(filter.view()), 0);
+    EXPECT_EQ(complaint_rollup_manager
+                  .update_one(filter.view(),
+                              make_document(kvp("$set", make_document(kvp("sentiment", 0.0))))
+                                  .view())
+                  .matched_count,
+              0);
+    EXPECT_EQ(get_count(find_rollup(db_manager, "01-01-2024 00:00:00", "Transport")->view()), 0);
+
+    clear_collections(db_manager);
+}
+
+// ----- Test that rebuild matches the incrementally kept rollups -----
+TEST(ComplaintRollupManagerTest, RebuildMatchesIncrementalRollups) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    clear_collections(db_manager);
+    ComplaintRollupManager complaint_rollup_manager(db_manager);
+
+    std::vector<bsoncxx::document::value> complaints = {
+        make_complaint(bsoncxx::oid(), "03-01-2024 10:00:00", "Housing", 0.5),
+        make_complaint(bsoncxx::oid(), "20-01-2024 10:00:00", "Housing", -0.25),
+        make_complaint(bsoncxx::oid(), "03-01-2024 10:00:00", "Transport", 1.0)};
+    db_manager->insert_many(Constants::COLLECTION_COMPLAINTS, complaints);
+
+    EXPECT_EQ(complaint_rollup_manager.rebuild(), 2);
+    auto housing = find_rollup(db_manager, "01-01-2024 00:00:00", "Housing");
+    ASSERT_TRUE(housing.has_value());
+    EXPECT_EQ(get_count(housing->view()), 2);
+    EXPECT_EQ(get_count(housing->view()), housing->view()["sentiment_count"].get_int32().value);
+    EXPECT_DOUBLE_EQ(housing->view()["sentiment_sum"].get_double().value, 0.25);
+    EXPECT_DOUBLE_EQ(housing->view()["sentiment_min"].get_double().value, -0.25);
+    EXPECT_DOUBLE_EQ(housing->view()["sentiment_max"].get_double().value, 0.5);
+    EXPECT_EQ(get_bin_count(housing->view(), "150"), 1);
+    EXPECT_EQ(get_bin_count(housing->view(), "75"), 1);
+
+    // in sync, so nothing is rebuilt and incremental updates keep adding up
+    complaint_rollup_manager.rebuild_if_out_of_sync();
+    complaint_rollup_manager.apply_inserts({complaints[0].view()});
+    auto incremented = find_rollup(db_manager, "01-01-2024 00:00:00", "Housing");
+    EXPECT_EQ(get_count(incremented->view()), 3);
+    EXPECT_EQ(get_bin_count(incremented->view(), "150"), 2);
+    complaint_rollup_manager.rebuild_if_out_of_sync();
+    EXPECT_EQ(get_count(find_rollup(db_manager, "01-01-2024 00:00:00", "Housing")->view()), 2);
+
+    clear_collections(db_manager);
+}
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "blocking_executor.hpp"
+#include "concurrency_manager.hpp"
+#include "constants.hpp"
+#include "crow.h"
+
+// Handler that blocks until the test releases it, so slots stay occupied.
+static auto make_blocking_handler(std::atomic<bool>& release, std::atomic<int>& running)
+    -> std::function<crow::response(const crow::request&)> {
+    return [&release, &running](const crow::request& req) {
+        running++;
+        while (!release) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        running--;
+        return crow::response(200);
+    };
+}
+
+static void wait_until_running(std::atomic<int>& running, int expected) {
+    while (running < expected) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// Serves a request whose handler responds before returning.
+static auto serve(const deferred_handler_func_type& handler, const crow::request& req)
+    -> crow::response {
+    crow::response result(0);
+    handler(req, [&result](crow::response res) { result = std::move(res); });
+    return result;
+}
+
+// ----- Test that requests within the concurrency limit pass through -----
+TEST(ConcurrencyManagerTest, AdmitsWithinLimit) {
+    ConcurrencyManager manager;
+    auto handler = manager.concurrency_protection_decorator(
+        [](const crow::request& req) { return crow::response(200); }, {2, 0, 100});
+
+    crow::request req;
+    EXPECT_EQ(serve(handler, req).code, 200);
+    EXPECT_EQ(serve(handler, req).code, 200);
+}
+
+// ----- Test that a full route with no queue rejects immediately with Retry-After -----
+TEST(ConcurrencyManagerTest, RejectsWhenQueueIsFull) {
+    ConcurrencyManager manager(7);
+    std::atomic<bool> release{false};
+    std::atomic<int> running{0};
+    auto handler = manager.concurrency_protection_decorator(
+        make_blocking_handler(release, running), {1, 0, 1000});
+
+    std::thread holder([&handler]() {
+        crow::request req;
+        serve(handler, req);
+    });
+    wait_until_running(running, 1);
+
+    crow::request req;
+    auto start = std::chrono::steady_clock::now();
+    auto res = serve(handler, req);
+    auto waited = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(res.code, 503);
+    EXPECT_EQ(res.get_header_value("Retry-After"), "7");
+    EXPECT_LT(waited, std::chrono::milliseconds(500)) << "A full queue should fail fast.";
+
+    release = true;
+    holder.join();
+}
+
+// ----- Test that a queued request does not block its caller and gives up after its deadline -----
+TEST(ConcurrencyManagerTest, RejectsAfterWaitDeadline) {
+    ConcurrencyManager manager;
+    std::atomic<bool> release{false};
+    std::atomic<int> running{0};
+    auto handler = manager.concurrency_protection_decorator(
+        make_blocking_handler(release, running), {1, 4, 50});
+
+    std::thread holder([&handler]() {
+        crow::request req;
+        serve(handler, req);
+    });
+    wait_until_running(running, 1);
+
+    crow::request req;
+    std::atomic<int> code{0};
+    auto start = std::chrono::steady_clock::now();
+    handler(req, [&code](crow::response res) { code = res.code; });
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(50))
+        << "A queued request should not block the calling thread.";
+    while (code == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto waited = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(code, 503);
+    EXPECT_GE(waited, std::chrono::milliseconds(50));
+
+    release = true;
+    holder.join();
+}
+
+// ----- Test that a queued request is admitted once a slot frees up -----
+TEST(ConcurrencyManagerTest, QueuedRequestRunsAfterRelease) {
+    ConcurrencyManager manager;
+    std::atomic<bool> release{false};
+    std::atomic<int> running{0};
+    auto handler = manager.concurrency_protection_decorator(
+        make_blocking_handler(release, running), {1, 4, 5000});
+
+    std::thread holder([&handler]() {
+        crow::request req;
+        serve(handler, req);
+    });
+    wait_until_running(running, 1);
+
+    crow::request req;
+    std::atomic<int> code{0};
+    handler(req, [&code](crow::response res) { code = res.code; });
+    EXPECT_EQ(code, 0);
+
+    // without an executor, the request that frees the slot starts the queued one on its thread
+    release = true;
+    holder.join();
+    EXPECT_EQ(code, 200);
+}
+
+// ----- Test that routes decorated separately do not share slots -----
+TEST(ConcurrencyManagerTest, RoutesHaveIndependentSlots) {
+    ConcurrencyManager manager;
+    std::atomic<bool> release{false};
+    std::atomic<int> running{0};
+    auto heavy_handler = manager.concurrency_protection_decorator(
+        make_blocking_handler(release, running), {1, 0, 1000});
+    auto light_handler = manager.concurrency_protection_decorator(
+        [](const crow::request& req) { return crow::response(200); }, {1, 0, 1000});
+
+    std::thread holder([&heavy_handler]() {
+        crow::request req;
+        serve(heavy_handler, req);
+    });
+    wait_until_running(running, 1);
+
+    crow::request req;
+    EXPECT_EQ(serve(light_handler, req).code, 200);
+    EXPECT_EQ(serve(heavy_handler, req).code, 503);
+
+    release = true;
+    holder.join();
+}
+
+// ----- Test that a deferred handler keeps its slot until it responds -----
+TEST(ConcurrencyManagerTest, DeferredHandlerHoldsSlotUntilResponse) {
+    ConcurrencyManager manager;
+    respond_func_type pending_respond;
+    auto handler = manager.concurrency_protection_decorator(
+        deferred_handler_func_type(
+            [&pending_respond](const crow::request& req, const respond_func_type& respond) {
+                pending_respond = respond;
+            }),
+        {1, 0, 100});
+
+    crow::request req;
+    int first_code = 0;
+    handler(req, [&first_code](crow::response res) { first_code = res.code; });
+    EXPECT_EQ(first_code, 0) << "The first request should still be waiting.";
+
+    int second_code = 0;
+    handler(req, [&second_code](crow::response res) { second_code = res.code; });
+    EXPECT_EQ(second_code, 503);
+
+    pending_respond(crow::response(200));
+    EXPECT_EQ(first_code, 200);
+
+    int third_code = 0;
+    handler(req, [&third_code](crow::response res) { third_code = res.code; });
+    pending_respond(crow::response(201));
+    EXPECT_EQ(third_code, 201);
+}
+
+// ----- Test that a queued request is started on the executor once a slot frees up -----
+TEST(ConcurrencyManagerTest, QueuedRequestRunsOnExecutor) {
+    auto executor = std::make_shared<BlockingExecutor>(1, 4);
+    ConcurrencyManager manager(Constants::ADMISSION_RETRY_AFTER_SECONDS, executor);
+    respond_func_type pending_respond;
+    std::atomic<int> started{0};
+    auto handler = manager.concurrency_protection_decorator(
+        deferred_handler_func_type([&pending_respond, &started](const crow::request& req,
+                                                                const respond_func_type& respond) {
+            if (started++ == 0) {
+                pending_respond = respond;
+                return;
+            }
+            respond(crow::response(201));
+        }),
+        {1, 4, 5000});
+
+    crow::request req;
+    std::atomic<int> first_code{0};
+    handler(req, [&first_code](crow::response res) { first_code = res.code; });
+    std::atomic<int> second_code{0};
+    handler(req, [&second_code](crow::response res) { second_code = res.code; });
+    EXPECT_EQ(started, 1);
+
+    pending_respond(crow::response(200));
+    while (second_code == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(first_code, 200);
+    EXPECT_EQ(second_code, 201);
+}
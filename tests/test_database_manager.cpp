@@ -5,6 +5,7 @@
 #include <cstdlib>
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
+#include <thread>
 #include <vector>
 
 #include "constants.hpp"
@@ -240,4 +241,106 @@ TEST(DatabaseManagerTest, CreateFromEnv) {
     // Clean up environment variables.
     unsetenv("MONGO_URI");
     unsetenv("DB_NAME");
-}
\ No newline at end of file
+}
+// ----- Test for concurrent use of the client pool -----
+TEST(DatabaseManagerTest, ConcurrentAccessThroughPool) {
+    // A pool smaller than the number of threads forces callers to wait for a free client.
+    DatabaseManager dbManager("mongodb://localhost:27017", "test_db", 2, 5000);
+    std::string collection_name = "test_concurrent_access";
+    cleanup_collection(dbManager, collection_name);
+
+    const int thread_count = 8;
+    const int inserts_per_thread = 25;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; ++i) {
+        threads.emplace_back([&dbManager, &collection_name, i]() {
+            for (int j = 0; j < inserts_per_thread; ++j) {
+                dbManager.insert_one(collection_name,
+                                     make_document(kvp("thread", i), kvp("item", j)).view());
+                auto cursor = dbManager.find(collection_name, make_document(kvp("thread", i)));
+                for (auto&& doc : cursor) {
+                    (void)doc;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    long long count = dbManager.count_documents(collection_name, make_document().view());
+    EXPECT_EQ(count, thread_count * inserts_per_thread);
+
+    cleanup_collection(dbManager, collection_name);
+}
+
+// ----- Test for bulk_write with mixed operations -----
+TEST(DatabaseManagerTest, BulkWriteMixedOperations) {
+    DatabaseManager dbManager("mongodb://localhost:27017", "test_db");
+    std::string collection_name = "test_bulk_write";
+    cleanup_collection(dbManager, collection_name);
+    dbManager.insert_one(collection_name, make_document(kvp("name", "Bob")).view());
+
+    std::vector<BulkWriteOperation> operations;
+    operations.push_back(BulkWriteOperation::insert_one(make_document(kvp("name", "Alice"))));
+    operations.push_back(BulkWriteOperation::update_one(
+        make_document(kvp("name", "Bob")),
+        make_document(kvp("$set", make_document(kvp("age", 30))))));
+    operations.push_back(BulkWriteOperation::update_one(
+        make_document(kvp("name", "Carol")),
+        make_document(kvp("$set", make_document(kvp("age", 40)))), true));
+    operations.push_back(BulkWriteOperation::delete_one(make_document(kvp("name", "Alice"))));
+
+    // a chunk size of 3 forces two round trips
+    auto result = dbManager.bulk_write(collection_name, operations, 3);
+
+    ASSERT_EQ(result.item_results.size(), operations.size());
+    EXPECT_EQ(result.count(BulkWriteItemStatus::Succeeded), 4);
+    EXPECT_EQ(result.inserted_count, 1);
+    EXPECT_EQ(result.modified_count, 1);
+    EXPECT_EQ(result.upserted_count, 1);
+    EXPECT_EQ(result.deleted_count, 1);
+    EXPECT_EQ(dbManager.count_documents(collection_name, make_document().view()), 2);
+
+    cleanup_collection(dbManager, collection_name);
+}
+
+// ----- Test that bulk_write classifies duplicate keys per item and keeps going -----
+TEST(DatabaseManagerTest, BulkWriteDuplicateKeys) {
+    DatabaseManager dbManager("mongodb://localhost:27017", "test_db");
+    std::string collection_name = "test_bulk_write_duplicates";
+    cleanup_collection(dbManager, collection_name);
+
+    std::vector<BulkWriteOperation> operations;
+    operations.push_back(BulkWriteOperation::insert_one(make_document(kvp("_id", 1))));
+    operations.push_back(BulkWriteOperation::insert_one(make_document(kvp("_id", 1))));
+    operations.push_back(BulkWriteOperation::insert_one(make_document(kvp("_id", 2))));
+    operations.push_back(BulkWriteOperation::insert_one(make_document(kvp("_id", 2))));
+    operations.push_back(BulkWriteOperation::insert_one(make_document(kvp("_id", 3))));
+
+    auto result = dbManager.bulk_write(collection_name, operations, 2);
+
+    ASSERT_EQ(result.item_results.size(), operations.size());
+    EXPECT_EQ(result.item_results[0].status, BulkWriteItemStatus::Succeeded);
+    EXPECT_EQ(result.item_results[1].status, BulkWriteItemStatus::DuplicateKey);
+    EXPECT_EQ(result.item_results[1].error_code, Constants::MONGO_DUPLICATE_KEY_ERROR_CODE);
+    EXPECT_EQ(result.item_results[2].status, BulkWriteItemStatus::Succeeded);
+    EXPECT_EQ(result.item_results[3].status, BulkWriteItemStatus::DuplicateKey);
+    EXPECT_EQ(result.item_results[4].status, BulkWriteItemStatus::Succeeded);
+    EXPECT_EQ(result.inserted_count, 3);
+    EXPECT_EQ(dbManager.count_documents(collection_name, make_document().view()), 3);
+
+    cleanup_collection(dbManager, collection_name);
+}
+
+// ----- Test bulk_write edge cases -----
+TEST(DatabaseManagerTest, BulkWriteEmptyAndInvalidChunkSize) {
+    DatabaseManager dbManager("mongodb://localhost:27017", "test_db");
+    auto result = dbManager.bulk_write("test_bulk_write_empty", {});
+    EXPECT_TRUE(result.item_results.empty());
+
+    std::vector<BulkWriteOperation> operations;
+    operations.push_back(BulkWriteOperation::insert_one(make_document(kvp("name", "Alice"))));
+    EXPECT_THROW(dbManager.bulk_write("test_bulk_write_empty", operations, 0),
+                 std::invalid_argument);
+}
@@ -4,6 +4,7 @@
 #include <ctime>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "date_utils.hpp"
 
@@ -85,3 +86,62 @@ TEST(DateUtilsTest, StringToUtcUnixTimestampInvalidThrows) {
         << "string_to_utc_unix_timestamp should throw a runtime_error for an improperly formatted "
            "date string.";
 }
+
+// ----- Test that the fixed-format codec agrees with the iostream path -----
+TEST(DateUtilsTest, FixedFormatCodecMatchesIostreamPath) {
+    // "%T" is equivalent to "%H:%M:%S" but is not DATETIME_FORMAT, so it takes the old path.
+    const std::string iostream_format = "%d-%m-%Y %T";
+    for (long long int timestamp : {0LL, 1LL, 86399LL, 951782400LL, 1709164800LL, 1740787199LL,
+                                    4102444800LL, -1LL, -86400LL, -2208988800LL}) {
+        auto datetime = DateUtils::utc_unix_timestamp_to_string(timestamp, "%d-%m-%Y %H:%M:%S");
+        EXPECT_EQ(datetime, DateUtils::utc_unix_timestamp_to_string(timestamp, iostream_format))
+            << "Formatting should not depend on which path is taken for " << timestamp << ".";
+        EXPECT_EQ(DateUtils::string_to_utc_unix_timestamp(datetime, "%d-%m-%Y %H:%M:%S"), timestamp)
+            << "Parsing should invert formatting for " << datetime << ".";
+    }
+}
+
+// ----- Test that the fixed-format parser handles leap days and rolls days over like timegm -----
+TEST(DateUtilsTest, FixedFormatParseCalendarEdges) {
+    EXPECT_EQ(DateUtils::string_to_utc_unix_timestamp("29-02-2024 00:00:00", "%d-%m-%Y %H:%M:%S"),
+              1709164800LL);
+    EXPECT_EQ(DateUtils::string_to_utc_unix_timestamp("31-12-1969 23:59:59", "%d-%m-%Y %H:%M:%S"),
+              -1LL);
+    EXPECT_EQ(DateUtils::string_to_utc_unix_timestamp("31-02-2023 00:00:00", "%d-%m-%Y %H:%M:%S"),
+              DateUtils::string_to_utc_unix_timestamp("03-03-2023 00:00:00", "%d-%m-%Y %H:%M:%S"))
+        << "Days past the end of the month should roll into the next month.";
+}
+
+// ----- Test that the fixed-format codec rejects what it cannot represent -----
+TEST(DateUtilsTest, FixedFormatCodecRejectsMalformedInput) {
+    long long int timestamp;
+    for (const std::string datetime : {"1-01-1970 00:00:00", "01/01/1970 00:00:00",
+                                       "01-13-1970 00:00:00", "00-01-1970 00:00:00",
+                                       "01-01-1970 24:00:00", "01-01-1970 00:00:0x",
+                                       "01-01-1970 00:00:00Z"}) {
+        EXPECT_FALSE(DateUtils::parse_datetime(datetime.data(), datetime.size(), timestamp))
+            << datetime << " should not be accepted by the fixed-format parser.";
+    }
+    EXPECT_THROW(
+        DateUtils::string_to_utc_unix_timestamp("01-13-1970 00:00:00", "%d-%m-%Y %H:%M:%S"),
+        std::runtime_error);
+
+    char datetime[DateUtils::DATETIME_LENGTH];
+    EXPECT_FALSE(DateUtils::format_datetime(253402300800LL, datetime))
+        << "Years past 9999 do not fit the fixed layout.";
+}
+
+// ----- Test for the batch conversions -----
+TEST(DateUtilsTest, BatchConversions) {
+    std::vector<long long int> timestamps = {0, 1709164800LL, -1};
+    auto datetimes = DateUtils::utc_unix_timestamps_to_strings(timestamps, "%d-%m-%Y %H:%M:%S");
+    ASSERT_EQ(datetimes.size(), 3u);
+    EXPECT_EQ(datetimes[0], "01-01-1970 00:00:00");
+    EXPECT_EQ(datetimes[1], "29-02-2024 00:00:00");
+    EXPECT_EQ(datetimes[2], "31-12-1969 23:59:59");
+    EXPECT_EQ(DateUtils::strings_to_utc_unix_timestamps(datetimes, "%d-%m-%Y %H:%M:%S"),
+              timestamps);
+
+    EXPECT_EQ(DateUtils::utc_unix_timestamps_to_strings({0}, "%Y")[0], "1970")
+        << "Other formats should still go through the iostream path.";
+}
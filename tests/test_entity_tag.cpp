@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "crow.h"
+#include "entity_tag.hpp"
+
+// ----- Test that a body hashed in chunks gets the same ETag as in one piece -----
+TEST(EntityTagTest, HashesChunksLikeWholeBody) {
+    EntityTagHasher hasher;
+    hasher.update("{\"documents\":[");
+    hasher.update("1,2,3");
+    hasher.update("]}");
+
+    EXPECT_EQ(hasher.get_etag(), EntityTagUtils::compute_etag("{\"documents\":[1,2,3]}"));
+    EXPECT_NE(hasher.get_etag(), EntityTagUtils::compute_etag("{\"documents\":[1,2,4]}"));
+    EXPECT_EQ(hasher.get_etag().front(), '"');
+    EXPECT_EQ(hasher.get_etag().back(), '"');
+}
+
+// ----- Test If-None-Match lists, wildcards, weak tags and encoding suffixes -----
+TEST(EntityTagTest, MatchesIfNoneMatch) {
+    auto etag = EntityTagUtils::compute_etag("body");
+    auto gzip_etag = EntityTagUtils::add_encoding_to_etag(etag, "gzip");
+
+    EXPECT_NE(gzip_etag, etag);
+    EXPECT_TRUE(EntityTagUtils::matches_if_none_match(etag, etag));
+    EXPECT_TRUE(EntityTagUtils::matches_if_none_match("\"other\", " + etag, etag));
+    EXPECT_TRUE(EntityTagUtils::matches_if_none_match("W/" + etag, etag));
+    EXPECT_TRUE(EntityTagUtils::matches_if_none_match(gzip_etag, etag));
+    EXPECT_TRUE(EntityTagUtils::matches_if_none_match(etag, gzip_etag));
+    EXPECT_TRUE(EntityTagUtils::matches_if_none_match("*", etag));
+    EXPECT_FALSE(EntityTagUtils::matches_if_none_match("", etag));
+    EXPECT_FALSE(EntityTagUtils::matches_if_none_match("\"other\"", etag));
+}
+
+// ----- Test that only successful responses are tagged, and existing tags are kept -----
+TEST(EntityTagTest, TagsSuccessfulResponses) {
+    auto tagged = EntityTagUtils::tag_response(crow::response(200, "body"));
+    EXPECT_EQ(tagged.get_header_value("ETag"), EntityTagUtils::compute_etag("body"));
+
+    auto failed = EntityTagUtils::tag_response(crow::response(500, "body"));
+    EXPECT_EQ(failed.get_header_value("ETag"), "");
+
+    crow::response already_tagged(200, "body");
+    already_tagged.set_header("ETag", "\"version-7\"");
+    auto kept = EntityTagUtils::tag_response(std::move(already_tagged));
+    EXPECT_EQ(kept.get_header_value("ETag"), "\"version-7\"");
+}
+
+// ----- Test that a matching If-None-Match gets a body-less 304 -----
+TEST(EntityTagTest, AnswersMatchingRequestWithNotModified) {
+    auto etag = EntityTagUtils::compute_etag("body");
+
+    crow::request req;
+    req.add_header("If-None-Match", etag);
+    auto res = EntityTagUtils::make_conditional_response(
+        req, EntityTagUtils::tag_response(crow::response(200, "body")));
+    EXPECT_EQ(res.code, 304);
+    EXPECT_EQ(res.body, "");
+    EXPECT_EQ(res.get_header_value("ETag"), etag);
+
+    crow::request stale_req;
+    stale_req.add_header("If-None-Match", "\"stale\"");
+    auto full_res = EntityTagUtils::make_conditional_response(
+        stale_req, EntityTagUtils::tag_response(crow::response(200, "body")));
+    EXPECT_EQ(full_res.code, 200);
+    EXPECT_EQ(full_res.body, "body");
+}
+
+// ----- Test that untagged responses are never turned into a 304 -----
+TEST(EntityTagTest, LeavesUntaggedResponsesAlone) {
+    crow::request req;
+    req.add_header("If-None-Match", "*");
+
+    auto res = EntityTagUtils::make_conditional_response(req, crow::response(200, "body"));
+    EXPECT_EQ(res.code, 200);
+    EXPECT_EQ(res.body, "body");
+}
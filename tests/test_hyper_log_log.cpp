@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/json.hpp>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "hyper_log_log.hpp"
+
+// ----- Test that a hash is split into its low bits and the rank of the rest -----
+TEST(HyperLogLogTest, SplitsHashes) {
+    HyperLogLog sketch;
+    sketch.add_hash(0);
+    EXPECT_EQ(sketch.get_register(0), HyperLogLog::MAX_RANK);
+    // the low bits of a negative hash in two's complement, like $mod made non-negative
+    sketch.add_hash(-1);
+    EXPECT_EQ(sketch.get_register(HyperLogLog::REGISTER_COUNT - 1), HyperLogLog::MAX_RANK);
+    sketch.add_hash(std::numeric_limits<int64_t>::max());
+    EXPECT_EQ(sketch.get_register(HyperLogLog::REGISTER_COUNT - 1), HyperLogLog::MAX_RANK);
+    // the largest rest has no leading zeros
+    HyperLogLog largest;
+    largest.add_hash(std::numeric_limits<int64_t>::max());
+    EXPECT_EQ(largest.get_register(HyperLogLog::REGISTER_COUNT - 1), 1);
+
+    auto rank = bsoncxx::to_json(HyperLogLog::make_rank_expression("$author").view());
+    EXPECT_NE(rank.find("\"$toHashedIndexKey\" : \"$author\""), std::string::npos);
+}
+
+// ----- Test that estimates are close to the number of distinct hashes -----
+TEST(HyperLogLogTest, EstimatesDistinctCounts) {
+    std::mt19937_64 random(3203);
+    for (auto distinct_count : {10, 1000, 100000}) {
+        HyperLogLog sketch;
+        for (int i = 0; i < distinct_count; ++i) {
+            auto hash = static_cast<int64_t>(random());
+            // repeated values do not count
+            sketch.add_hash(hash);
+            sketch.add_hash(hash);
+        }
+        EXPECT_NEAR(sketch.estimate(), distinct_count, distinct_count * 0.05 + 1);
+    }
+    EXPECT_EQ(HyperLogLog().estimate(), 0);
+}
+
+// ----- Test that merged sketches estimate the union -----
+TEST(HyperLogLogTest, MergesSketches) {
+    std::mt19937_64 random(3203);
+    HyperLogLog january;
+    HyperLogLog february;
+    HyperLogLog both;
+    for (int i = 0; i < 20000; ++i) {
+        auto hash = static_cast<int64_t>(random());
+        // half of the values appear in both months
+        if (i % 4 != 3) {
+            january.add_hash(hash);
+        }
+        if (i % 4 != 0) {
+            february.add_hash(hash);
+        }
+        both.add_hash(hash);
+    }
+    january.merge(february);
+    for (int index = 0; index < HyperLogLog::REGISTER_COUNT; ++index) {
+        ASSERT_EQ(january.get_register(index), both.get_register(index));
+    }
+    EXPECT_NEAR(january.estimate(), 20000, 1000);
+
+    // registers keep the largest rank and ignore indexes out of range
+    HyperLogLog registers;
+    registers.add_register(7, 3);
+    registers.add_register(7, 2);
+    registers.add_register(HyperLogLog::REGISTER_COUNT, 5);
+    EXPECT_EQ(registers.get_register(7), 3);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <mongocxx/exception/exception.hpp>
+
+#include "database_manager.hpp"
+#include "index_manager.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+static auto contains(const std::vector<std::string>& names, const std::string& name) -> bool {
+    return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+// ----- Test that index names match the ones mongod generates -----
+TEST(IndexManagerTest, GetIndexName) {
+    EXPECT_EQ(IndexManager::get_index_name({"complaints", {{"date", 1}}, false, false}),
+              "date_1");
+    EXPECT_EQ(IndexManager::get_index_name(
+                  {"complaints", {{"category", 1}, {"date", -1}}, false, false}),
+              "category_1_date_-1");
+    EXPECT_EQ(IndexManager::get_index_name(
+                  {"complaints", {{"title", 1}, {"description", 1}}, false, true}),
+              "title_text_description_text");
+}
+
+// ----- Test creating, verifying and reporting indexes -----
+TEST(IndexManagerTest, EnsureIndexes) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    std::string collection_name = "test_index_manager";
+    db_manager->delete_many(collection_name, make_document().view());
+    db_manager->create_index(collection_name, make_document(kvp("legacy", 1)).view());
+
+    std::vector<IndexSpec> index_specs = {
+        {collection_name, {{"email", 1}}, true, false},
+        {collection_name, {{"category", 1}, {"date", 1}}, false, false},
+        {collection_name, {{"external_id", 1}}, true, false, true},
+        {"another_collection", {{"name", 1}}, true, false},
+    };
+
+    IndexManager index_manager(db_manager);
+    auto first_report = index_manager.ensure_indexes({collection_name}, index_specs);
+    auto second_report = index_manager.ensure_indexes({collection_name}, index_specs);
+
+    EXPECT_TRUE(contains(first_report.created, collection_name + ".email_1") ||
+                contains(first_report.existing, collection_name + ".email_1"));
+    EXPECT_TRUE(contains(second_report.existing, collection_name + ".email_1"));
+    EXPECT_TRUE(contains(second_report.existing, collection_name + ".category_1_date_1"));
+    EXPECT_TRUE(second_report.created.empty());
+    EXPECT_TRUE(second_report.missing.empty());
+    EXPECT_TRUE(contains(second_report.unregistered, collection_name + ".legacy_1"));
+    EXPECT_FALSE(contains(second_report.unregistered, collection_name + "._id_"));
+    EXPECT_FALSE(contains(second_report.existing, "another_collection.name_1"));
+
+    db_manager->insert_one(collection_name, make_document(kvp("email", "a@b.com")).view());
+    EXPECT_THROW(
+        db_manager->insert_one(collection_name, make_document(kvp("email", "a@b.com")).view()),
+        mongocxx::exception);
+
+    // documents without the key of a partial unique index do not collide
+    db_manager->insert_one(collection_name, make_document(kvp("email", "c@d.com")).view());
+    EXPECT_NO_THROW(
+        db_manager->insert_one(collection_name, make_document(kvp("email", "e@f.com")).view()));
+    db_manager->insert_one(collection_name,
+                           make_document(kvp("email", "g@h.com"), kvp("external_id", 1)).view());
+    EXPECT_THROW(db_manager->insert_one(
+                     collection_name,
+                     make_document(kvp("email", "i@j.com"), kvp("external_id", 1)).view()),
+                 mongocxx::exception);
+
+    db_manager->delete_many(collection_name, make_document().view());
+}
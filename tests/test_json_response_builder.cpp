@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "crow.h"
+#include "json_response_builder.hpp"
+
+// ----- Test that the appended pieces form the expected JSON object -----
+TEST(JsonResponseBuilderTest, BuildsArrayAndFields) {
+    std::string body;
+    JsonResponseBuilder builder([&body](const std::string& piece) { body += piece; });
+
+    builder.begin_array("documents");
+    builder.append_array_item("{\"a\":1}");
+    builder.append_array_item("{\"a\":2}");
+    crow::json::wvalue fields;
+    fields["success"] = true;
+    builder.finish(fields);
+
+    auto json = crow::json::load(body);
+    ASSERT_TRUE(json);
+    ASSERT_EQ(json["documents"].size(), 2);
+    EXPECT_EQ(json["documents"][1]["a"].i(), 2);
+    EXPECT_TRUE(json["success"].b());
+    EXPECT_EQ(builder.get_item_count(), 2);
+}
+
+// ----- Test that an empty array and no extra fields are still valid JSON -----
+TEST(JsonResponseBuilderTest, BuildsEmptyArray) {
+    std::string body;
+    JsonResponseBuilder builder([&body](const std::string& piece) { body += piece; });
+
+    builder.begin_array("documents");
+    builder.finish(crow::json::wvalue());
+
+    EXPECT_EQ(body, "{\"documents\":[]}");
+}
+
+// ----- Test that every item is handed on as soon as it is appended -----
+TEST(JsonResponseBuilderTest, AppendsItemsWithoutBuffering) {
+    std::vector<std::string> pieces;
+    JsonResponseBuilder builder([&pieces](const std::string& piece) { pieces.push_back(piece); });
+
+    builder.begin_array("documents");
+    builder.append_array_item("1");
+    EXPECT_EQ(pieces.back(), "1");
+    builder.append_array_item("2");
+    EXPECT_EQ(pieces.back(), "2");
+    builder.finish(crow::json::wvalue());
+
+    std::string body;
+    for (const auto& piece : pieces) {
+        body += piece;
+    }
+    EXPECT_EQ(body, "{\"documents\":[1,2]}");
+}
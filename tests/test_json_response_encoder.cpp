@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/json.hpp>
+#include <bsoncxx/oid.hpp>
+#include <bsoncxx/types.hpp>
+#include <chrono>
+#include <string>
+
+#include "base_api_strategy_utils.hpp"
+#include "crow.h"
+#include "json_response_encoder.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
+using bsoncxx::builder::basic::make_document;
+
+// The response JSON the to_json + crow::json::load + wvalue path produces.
+static auto encode_with_wvalue(const bsoncxx::document::view& doc) -> std::string {
+    auto doc_rval = crow::json::load(bsoncxx::to_json(doc));
+    return BaseApiStrategyUtils::parse_database_json_to_response_json(doc_rval).dump();
+}
+
+// Compares two JSON values regardless of object key order.
+static void expect_same_json(const crow::json::rvalue& actual, const crow::json::rvalue& expected) {
+    ASSERT_EQ(actual.t(), expected.t());
+    if (expected.t() == crow::json::type::Object) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (const auto& field : expected) {
+            ASSERT_TRUE(actual.has(field.key())) << field.key();
+            expect_same_json(actual[field.key()], field);
+        }
+    } else if (expected.t() == crow::json::type::List) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            expect_same_json(actual[i], expected[i]);
+        }
+    } else if (expected.t() == crow::json::type::Number) {
+        EXPECT_DOUBLE_EQ(actual.d(), expected.d());
+    } else {
+        EXPECT_EQ(crow::json::wvalue(actual).dump(), crow::json::wvalue(expected).dump());
+    }
+}
+
+// February 1, 2020 00:00:00 UTC
+static const bsoncxx::types::b_date TEST_DATE{std::chrono::milliseconds{1580515200000}};
+
+// ----- Test that dates in documents are formatted and ObjectIds stay extended JSON -----
+TEST(JsonResponseEncoderTest, RewritesDatesAndKeepsOids) {
+    bsoncxx::oid oid;
+    auto doc = make_document(kvp("_id", oid), kvp("date", TEST_DATE),
+                             kvp("nested", make_document(kvp("date_closed", TEST_DATE))));
+
+    auto json = crow::json::load(JsonResponseEncoder::encode_document(doc.view()));
+    ASSERT_TRUE(json);
+    EXPECT_EQ(std::string(json["_id"]["$oid"].s()), oid.to_string());
+    EXPECT_EQ(std::string(json["date"].s()), "01-02-2020 00:00:00");
+    EXPECT_EQ(std::string(json["nested"]["date_closed"].s()), "01-02-2020 00:00:00");
+}
+
+// ----- Test that arrays are left as extended JSON, like the wvalue path does -----
+TEST(JsonResponseEncoderTest, LeavesArraysAsExtendedJson) {
+    auto doc = make_document(kvp("dates", make_array(TEST_DATE)));
+
+    auto json = crow::json::load(JsonResponseEncoder::encode_document(doc.view()));
+    ASSERT_TRUE(json);
+    EXPECT_EQ(json["dates"][0]["$date"].i(), 1580515200000);
+}
+
+// ----- Test that strings are escaped -----
+TEST(JsonResponseEncoderTest, EscapesStrings) {
+    auto doc = make_document(kvp("text", "quote \" backslash \\ newline \n tab \t bell \a"));
+
+    auto json = crow::json::load(JsonResponseEncoder::encode_document(doc.view()));
+    ASSERT_TRUE(json);
+    EXPECT_EQ(std::string(json["text"].s()), "quote \" backslash \\ newline \n tab \t bell \a");
+}
+
+// ----- Test that numbers keep their values -----
+TEST(JsonResponseEncoderTest, EncodesNumbers) {
+    auto doc = make_document(kvp("int32", 7), kvp("int64", int64_t{9007199254740993}),
+                             kvp("double", 0.1), kvp("negative", -2.5), kvp("whole", 3.0));
+
+    auto json = crow::json::load(JsonResponseEncoder::encode_document(doc.view()));
+    ASSERT_TRUE(json);
+    EXPECT_EQ(json["int32"].i(), 7);
+    EXPECT_EQ(json["int64"].i(), 9007199254740993);
+    EXPECT_DOUBLE_EQ(json["double"].d(), 0.1);
+    EXPECT_DOUBLE_EQ(json["negative"].d(), -2.5);
+    EXPECT_DOUBLE_EQ(json["whole"].d(), 3.0);
+}
+
+// ----- Test that the encoder gives the same JSON values as the wvalue path -----
+TEST(JsonResponseEncoderTest, MatchesWvaluePath) {
+    auto doc = make_document(
+        kvp("_id", bsoncxx::oid()), kvp("title", "Flooding at \"Block 5\""),
+        kvp("date", TEST_DATE), kvp("sentiment", -0.25), kvp("is_resolved", false),
+        kvp("tags", make_array("drainage", "rain")),
+        kvp("meta", make_document(kvp("source", "Reddit"), kvp("score", 12),
+                                  kvp("missing", bsoncxx::types::b_null{}))));
+
+    auto encoded = crow::json::load(JsonResponseEncoder::encode_document(doc.view()));
+    auto expected = crow::json::load(encode_with_wvalue(doc.view()));
+    ASSERT_TRUE(encoded);
+    ASSERT_TRUE(expected);
+    expect_same_json(encoded, expected);
+}
+
+// ----- Test that encoding appends to the given buffer -----
+TEST(JsonResponseEncoderTest, AppendsToBuffer) {
+    std::string buffer = "[";
+    JsonResponseEncoder::encode_document(make_document(kvp("a", 1)).view(), buffer);
+    buffer += ",";
+    JsonResponseEncoder::encode_document(make_document(kvp("a", 2)).view(), buffer);
+    buffer += "]";
+
+    EXPECT_EQ(buffer, "[{\"a\":1},{\"a\":2}]");
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "jwt_manager.hpp"
+
+// ----- Test that a generated token yields its claims -----
+TEST(JwtManagerTest, GetClaimsOfGeneratedToken) {
+    JwtManager jwt_manager("test_secret", 3600, 16);
+    auto token = jwt_manager.generate_token("abc", "Admin");
+
+    auto claims = jwt_manager.get_claims(token);
+
+    EXPECT_EQ(claims.oid, "abc");
+    EXPECT_EQ(claims.role, "Admin");
+    EXPECT_GT(claims.expires_at, std::chrono::system_clock::now());
+}
+
+// ----- Test that repeat verifications of a token share one cache entry -----
+TEST(JwtManagerTest, CachesVerifiedClaims) {
+    JwtManager jwt_manager("test_secret", 3600, 16);
+    auto token = jwt_manager.generate_token("abc", "Citizen");
+
+    jwt_manager.get_claims(token);
+    auto claims = jwt_manager.get_claims(token);
+
+    EXPECT_EQ(claims.role, "Citizen");
+    EXPECT_EQ(jwt_manager.get_claims_cache_size(), 1);
+}
+
+// ----- Test that tokens signed with another secret or altered are rejected -----
+TEST(JwtManagerTest, RejectsInvalidTokens) {
+    JwtManager jwt_manager("test_secret", 3600, 16);
+    JwtManager other_jwt_manager("other_secret", 3600, 16);
+    auto token = jwt_manager.generate_token("abc", "Citizen");
+
+    EXPECT_THROW(other_jwt_manager.get_claims(token), std::runtime_error);
+    jwt_manager.get_claims(token);
+    // the first character of the signature carries no padding bits
+    auto altered_token = token;
+    auto& signature_char = altered_token[token.rfind('.') + 1];
+    signature_char = signature_char == 'A' ? 'B' : 'A';
+    EXPECT_THROW(jwt_manager.get_claims(altered_token), std::runtime_error);
+    EXPECT_EQ(jwt_manager.get_claims_cache_size(), 1);
+}
+
+// ----- Test that expired tokens are rejected and not cached -----
+TEST(JwtManagerTest, RejectsExpiredTokens) {
+    JwtManager jwt_manager("test_secret", -1, 16);
+    auto token = jwt_manager.generate_token("abc", "Admin");
+
+    EXPECT_THROW(jwt_manager.get_claims(token), std::runtime_error);
+    EXPECT_EQ(jwt_manager.get_claims_cache_size(), 0);
+}
+
+// ----- Test that a full cache drops its least recently used token -----
+TEST(JwtManagerTest, EvictsLeastRecentlyUsedClaims) {
+    JwtManager jwt_manager("test_secret", 3600, 2);
+    auto first = jwt_manager.generate_token("first", "Citizen");
+    auto second = jwt_manager.generate_token("second", "Citizen");
+    auto third = jwt_manager.generate_token("third", "Citizen");
+
+    jwt_manager.get_claims(first);
+    jwt_manager.get_claims(second);
+    jwt_manager.get_claims(first);
+    jwt_manager.get_claims(third);
+
+    EXPECT_EQ(jwt_manager.get_claims_cache_size(), 2);
+    EXPECT_EQ(jwt_manager.get_claims(first).oid, "first");
+}
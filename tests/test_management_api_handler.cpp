@@ -122,6 +122,102 @@ TEST(ManagementApiHandlerTest, GetMany) {
     auto response = handler.get_many(req, db_ptr, collection);
     EXPECT_EQ(response.code, 200);
     EXPECT_NE(response.body.find("\"documents\""), std::string::npos);
+    EXPECT_EQ(response.body.find("\"next_cursor\""), std::string::npos)
+        << "Pages by page_number should not have a cursor.";
+
+    cleanup_collection(*db_ptr, collection);
+}
+
+// -------- Test for get_many with field projection --------
+TEST(ManagementApiHandlerTest, GetManyWithFields) {
+    auto db_ptr = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    ManagementApiHandler handler;
+    std::string collection = "test_management_get_many_fields";
+    cleanup_collection(*db_ptr, collection);
+
+    db_ptr->insert_one(collection, make_document(kvp("title", "Noise"),
+                                                 kvp("description", "Very long text"),
+                                                 kvp("value", 1))
+                                       .view());
+
+    crow::request req;
+    req.body =
+        "{\"filter\": {}, \"page_size\": 10, \"page_number\": 1, \"fields\": [\"title\"], "
+        "\"sort\": {\"value\": 1}}";
+    auto response = handler.get_many(req, db_ptr, collection);
+    EXPECT_EQ(response.code, 200);
+    EXPECT_NE(response.body.find("Noise"), std::string::npos);
+    EXPECT_EQ(response.body.find("Very long text"), std::string::npos);
+
+    cleanup_collection(*db_ptr, collection);
+}
+
+// -------- Test for get_many with keyset pagination --------
+TEST(ManagementApiHandlerTest, GetManyWithAfterCursor) {
+    auto db_ptr = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    ManagementApiHandler handler;
+    std::string collection = "test_management_get_many_after";
+    cleanup_collection(*db_ptr, collection);
+
+    for (int value = 1; value <= 5; ++value) {
+        db_ptr->insert_one(collection, make_document(kvp("value", value)).view());
+    }
+
+    std::vector<int> seen_values;
+    std::string after = "";
+    for (int page = 0; page < 5; ++page) {
+        crow::request req;
+        req.body = "{\"filter\": {}, \"page_size\": 2, \"after\": \"" + after +
+                   "\", \"sort\": {\"value\": -1}}";
+        auto response = handler.get_many(req, db_ptr, collection);
+        ASSERT_EQ(response.code, 200);
+
+        auto body = crow::json::load(response.body);
+        for (const auto& document : body["documents"].lo()) {
+            seen_values.push_back(document["value"].i());
+        }
+        if (body["next_cursor"].t() == crow::json::type::Null) {
+            break;
+        }
+        after = body["next_cursor"].s();
+    }
+
+    EXPECT_EQ(seen_values, std::vector<int>({5, 4, 3, 2, 1}));
+
+    cleanup_collection(*db_ptr, collection);
+}
+
+// -------- Test for get_many with keyset pagination over missing and mixed-type keys --------
+TEST(ManagementApiHandlerTest, GetManyWithAfterCursorAcrossTypes) {
+    auto db_ptr = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    ManagementApiHandler handler;
+    std::string collection = "test_management_get_many_after_types";
+    cleanup_collection(*db_ptr, collection);
+
+    db_ptr->insert_one(collection, make_document(kvp("value", 2)).view());
+    db_ptr->insert_one(collection, make_document(kvp("value", "b")).view());
+    db_ptr->insert_one(collection, make_document(kvp("other", true)).view());
+    db_ptr->insert_one(collection, make_document(kvp("value", 1)).view());
+
+    for (const auto& direction : {"1", "-1"}) {
+        int seen_count = 0;
+        std::string after = "";
+        for (int page = 0; page < 10; ++page) {
+            crow::request req;
+            req.body = "{\"filter\": {}, \"page_size\": 1, \"after\": \"" + after +
+                       "\", \"sort\": {\"value\": " + direction + "}}";
+            auto response = handler.get_many(req, db_ptr, collection);
+            ASSERT_EQ(response.code, 200);
+
+            auto body = crow::json::load(response.body);
+            seen_count += body["documents"].size();
+            if (body["next_cursor"].t() == crow::json::type::Null) {
+                break;
+            }
+            after = body["next_cursor"].s();
+        }
+        EXPECT_EQ(seen_count, 4) << "Every document should be paged with direction " << direction;
+    }
 
     cleanup_collection(*db_ptr, collection);
 }
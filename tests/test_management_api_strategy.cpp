@@ -8,6 +8,7 @@
 #include <tuple>
 #include <vector>
 
+#include "base_api_strategy_utils.hpp"
 #include "crow.h"
 #include "gtest/gtest.h"
 #include "management_api_strategy.hpp"
@@ -57,6 +58,46 @@ TEST(ManagementApiStrategyTest, ProcessRequestGetMany) {
     // Verify that the sort document contains the expected sort field.
     EXPECT_NE(sort_json.find("value"), std::string::npos);
     EXPECT_NE(sort_json.find("1"), std::string::npos);
+    // page_number requests keep the sort as given.
+    EXPECT_FALSE(sort.view()["_id"]) << "Only keyset pages get an _id tie-breaker.";
+}
+
+// -------- Test for process_request_func_get_many with an after cursor --------
+TEST(ManagementApiStrategyTest, ProcessRequestGetManyAfterCursor) {
+    crow::request first_page_req;
+    first_page_req.body =
+        "{\"filter\": {\"test\": true}, \"page_size\": 5, \"after\": \"\", \"sort\": "
+        "{\"value\": 1}}";
+    auto first_page = ManagementApiStrategy::process_request_func_get_many(first_page_req);
+    auto sort = std::get<2>(first_page);
+    EXPECT_FALSE(std::get<1>(first_page).skip()) << "Keyset pages must not skip.";
+    EXPECT_TRUE(sort.view()["_id"]) << "Sort should end with an _id tie-breaker.";
+
+    auto cursor = BaseApiStrategyUtils::create_keyset_cursor(
+        sort.view(), make_document(kvp("_id", bsoncxx::oid()), kvp("value", 3)).view());
+    crow::request next_page_req;
+    next_page_req.body =
+        "{\"filter\": {\"test\": true}, \"page_size\": 5, \"after\": \"" + cursor +
+        "\", \"sort\": {\"value\": 1}}";
+    auto next_page = ManagementApiStrategy::process_request_func_get_many(next_page_req);
+    std::string filter_json = to_json(std::get<0>(next_page).view());
+
+    EXPECT_NE(filter_json.find("$and"), std::string::npos);
+    EXPECT_NE(filter_json.find("$or"), std::string::npos);
+    EXPECT_NE(filter_json.find("test"), std::string::npos);
+}
+
+// -------- Test that get_many needs exactly one of page_number or after --------
+TEST(ManagementApiStrategyTest, ProcessRequestGetManyPagingModes) {
+    crow::request neither_req;
+    neither_req.body = "{\"filter\": {}, \"page_size\": 5}";
+    EXPECT_THROW(ManagementApiStrategy::process_request_func_get_many(neither_req),
+                 std::invalid_argument);
+
+    crow::request both_req;
+    both_req.body = "{\"filter\": {}, \"page_size\": 5, \"page_number\": 1, \"after\": \"\"}";
+    EXPECT_THROW(ManagementApiStrategy::process_request_func_get_many(both_req),
+                 std::invalid_argument);
 }
 
 // -------- Test for process_request_func_get_all --------
@@ -0,0 +1,43 @@
+#include <gtest/gtest.h>
+
+#include "metrics_manager.hpp"
+
+// ----- Test counters -----
+TEST(MetricsManagerTest, IncrementCounter) {
+    MetricsManager metrics_manager;
+    EXPECT_EQ(metrics_manager.get_counter("requests"), 0);
+
+    metrics_manager.increment_counter("requests");
+    metrics_manager.increment_counter("requests", 4);
+
+    EXPECT_EQ(metrics_manager.get_counter("requests"), 5);
+}
+
+// ----- Test summaries -----
+TEST(MetricsManagerTest, ObserveSummary) {
+    MetricsManager metrics_manager;
+    metrics_manager.observe("batch_size", 4);
+    metrics_manager.observe("batch_size", 1);
+    metrics_manager.observe("batch_size", 10);
+
+    auto summary = metrics_manager.get_summary("batch_size");
+    EXPECT_EQ(summary.count, 3);
+    EXPECT_DOUBLE_EQ(summary.sum, 15);
+    EXPECT_DOUBLE_EQ(summary.min, 1);
+    EXPECT_DOUBLE_EQ(summary.max, 10);
+    EXPECT_EQ(metrics_manager.get_summary("unknown").count, 0);
+}
+
+// ----- Test JSON export -----
+TEST(MetricsManagerTest, ToJson) {
+    MetricsManager metrics_manager;
+    metrics_manager.increment_counter("requests", 2);
+    metrics_manager.observe("latency_ms", 3);
+    metrics_manager.observe("latency_ms", 5);
+
+    auto json = crow::json::load(metrics_manager.to_json().dump());
+    ASSERT_TRUE(json);
+    EXPECT_EQ(json["counters"]["requests"].i(), 2);
+    EXPECT_EQ(json["summaries"]["latency_ms"]["count"].i(), 2);
+    EXPECT_DOUBLE_EQ(json["summaries"]["latency_ms"]["mean"].d(), 4);
+}
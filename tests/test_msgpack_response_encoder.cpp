@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/array.hpp>
+#include <bsoncxx/builder/basic/document.hpp>
+#include <bsoncxx/oid.hpp>
+#include <bsoncxx/types.hpp>
+#include <chrono>
+#include <string>
+
+#include "crow.h"
+#include "msgpack_response_encoder.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_array;
+using bsoncxx::builder::basic::make_document;
+
+static auto encode_int(const long long int& number) -> std::string {
+    std::string out;
+    MsgpackResponseEncoder::write_int64(number, out);
+    return out;
+}
+
+// ----- Test that integers use the smallest encoding -----
+TEST(MsgpackResponseEncoderTest, EncodesIntegers) {
+    EXPECT_EQ(encode_int(0), std::string(1, '\x00'));
+    EXPECT_EQ(encode_int(127), "\x7f");
+    EXPECT_EQ(encode_int(128), "\xcc\x80");
+    EXPECT_EQ(encode_int(65536), std::string("\xce\x00\x01\x00\x00", 5));
+    EXPECT_EQ(encode_int(-1), "\xff");
+    EXPECT_EQ(encode_int(-33), "\xd0\xdf");
+    EXPECT_EQ(encode_int(-129), "\xd1\xff\x7f");
+    EXPECT_EQ(encode_int(1LL << 40), std::string("\xcf\x00\x00\x01\x00\x00\x00\x00\x00", 9));
+}
+
+// ----- Test string and container headers at their size boundaries -----
+TEST(MsgpackResponseEncoderTest, EncodesHeaders) {
+    std::string out;
+    MsgpackResponseEncoder::write_string(std::string(31, 'a'), out);
+    EXPECT_EQ(out.substr(0, 1), "\xbf");
+    out.clear();
+    MsgpackResponseEncoder::write_string(std::string(32, 'a'), out);
+    EXPECT_EQ(out.substr(0, 2), "\xd9\x20");
+    out.clear();
+    MsgpackResponseEncoder::write_array_header(16, out);
+    EXPECT_EQ(out, std::string("\xdc\x00\x10", 3));
+    out.clear();
+    MsgpackResponseEncoder::write_map_header(15, out);
+    EXPECT_EQ(out, "\x8f");
+}
+
+// ----- Test that documents keep the JSON response shape -----
+TEST(MsgpackResponseEncoderTest, EncodesDocumentLikeJsonResponse) {
+    bsoncxx::types::b_date date{std::chrono::milliseconds{0}};
+    auto document = make_document(kvp("title", "hi"), kvp("score", 1.5), kvp("ok", true),
+                                  kvp("date", date), kvp("tags", make_array(date)));
+
+    std::string out;
+    MsgpackResponseEncoder::encode_document(document.view(), out);
+
+    std::string expected = "\x85";
+    expected += std::string("\xa5title\xa2hi");
+    expected += std::string("\xa5score\xcb\x3f\xf8\x00\x00\x00\x00\x00\x00", 15);
+    expected += "\xa2ok\xc3";
+    // dates of the document become strings, dates in arrays stay {"$date": ms}
+    expected += "\xa4" "date\xb3" "01-01-1970 00:00:00";
+    expected += std::string("\xa4tags\x91\x81\xa5$date\x00", 14);
+    EXPECT_EQ(out, expected);
+}
+
+// ----- Test that ObjectIds are written as {"$oid": "..."} -----
+TEST(MsgpackResponseEncoderTest, EncodesObjectId) {
+    bsoncxx::oid oid;
+    auto document = make_document(kvp("_id", oid));
+
+    std::string out;
+    MsgpackResponseEncoder::encode_document(document.view(), out);
+    EXPECT_EQ(out, "\x81\xa3_id\x81\xa4$oid\xb8" + oid.to_string());
+}
+
+// ----- Test that parsed JSON keeps its number types -----
+TEST(MsgpackResponseEncoderTest, EncodesJson) {
+    std::string out;
+    MsgpackResponseEncoder::encode_json(crow::json::load(R"([1, -2, 0.5, null, "x"])"), out);
+    EXPECT_EQ(out,
+              std::string("\x95\x01\xfe\xcb\x3f\xe0\x00\x00\x00\x00\x00\x00\xc0\xa1x", 15));
+}
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <memory>
+#include <string>
+#include <tuple>
+
+#include "base_api_handler.hpp"
+#include "crow.h"
+#include "database_manager.hpp"
+#include "entity_tag.hpp"
+#include "env_manager.hpp"
+#include "replicated_collection.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+static auto process_request_func_get_all(const crow::request& req)
+    -> std::tuple<bsoncxx::document::value, mongocxx::options::find, bsoncxx::document::value> {
+    return {make_document(), mongocxx::options::find{}, make_document()};
+}
+
+// ----- Test that documents are found by _id and by name without the database -----
+TEST(ReplicatedCollectionTest, FindsDocumentsByOidAndName) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    std::string collection_name = "test_replicated_collection_find";
+    db_manager->delete_many(collection_name, make_document().view());
+    bsoncxx::oid oid;
+    db_manager->insert_one(collection_name, make_document(kvp("_id", oid), kvp("name", "Housing"),
+                                                          kvp("color", "#FF0000"))
+                                                .view());
+
+    ReplicatedCollection replicated_collection(db_manager, collection_name, 0);
+    // once loaded, reads keep working after the documents are gone from the database
+    db_manager->delete_many(collection_name, make_document().view());
+
+    bsoncxx::stdx::optional<bsoncxx::document::value> by_oid;
+    ASSERT_TRUE(replicated_collection.find_one(make_document(kvp("_id", oid)).view(), by_oid));
+    ASSERT_TRUE(by_oid.has_value());
+    EXPECT_EQ(by_oid->view()["name"].get_string().value, "Housing");
+
+    bsoncxx::stdx::optional<bsoncxx::document::value> by_name;
+    ASSERT_TRUE(
+        replicated_collection.find_one(make_document(kvp("name", "Housing")).view(), by_name));
+    ASSERT_TRUE(by_name.has_value());
+    EXPECT_EQ(by_name->view()["_id"].get_oid().value, oid);
+
+    bsoncxx::stdx::optional<bsoncxx::document::value> missing;
+    ASSERT_TRUE(
+        replicated_collection.find_one(make_document(kvp("name", "Transport")).view(), missing));
+    EXPECT_FALSE(missing.has_value());
+}
+
+// ----- Test that filters other than a single _id or name equality are not answered -----
+TEST(ReplicatedCollectionTest, DeclinesOtherFilters) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    std::string collection_name = "test_replicated_collection_filters";
+    db_manager->delete_many(collection_name, make_document().view());
+    db_manager->insert_one(collection_name, make_document(kvp("name", "Housing")).view());
+
+    ReplicatedCollection replicated_collection(db_manager, collection_name, 0);
+    bsoncxx::stdx::optional<bsoncxx::document::value> result;
+    EXPECT_FALSE(replicated_collection.find_one(make_document().view(), result));
+    EXPECT_FALSE(
+        replicated_collection.find_one(make_document(kvp("color", "#FF0000")).view(), result));
+    EXPECT_FALSE(replicated_collection.find_one(
+        make_document(kvp("name", "Housing"), kvp("color", "#FF0000")).view(), result));
+    EXPECT_FALSE(replicated_collection.find_one(
+        make_document(kvp("name", make_document(kvp("$ne", "Housing")))).view(), result));
+    EXPECT_FALSE(result.has_value());
+
+    db_manager->delete_many(collection_name, make_document().view());
+}
+
+// ----- Test that the replica picks up writes once refreshed -----
+TEST(ReplicatedCollectionTest, RefreshPicksUpWrites) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    std::string collection_name = "test_replicated_collection_refresh";
+    db_manager->delete_many(collection_name, make_document().view());
+
+    ReplicatedCollection replicated_collection(db_manager, collection_name, 0);
+    db_manager->insert_one(collection_name, make_document(kvp("name", "Housing")).view());
+    replicated_collection.refresh();
+
+    bsoncxx::stdx::optional<bsoncxx::document::value> result;
+    ASSERT_TRUE(
+        replicated_collection.find_one(make_document(kvp("name", "Housing")).view(), result));
+    EXPECT_TRUE(result.has_value());
+    EXPECT_EQ(replicated_collection.get_snapshot()->documents.size(), 1);
+
+    db_manager->delete_many(collection_name, make_document().view());
+}
+
+// ----- Test that the cached body of the whole collection matches find_serialized's -----
+TEST(ReplicatedCollectionTest, ServesSameBodyAsFindSerialized) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    std::string collection_name = "test_replicated_collection_get_all";
+    db_manager->delete_many(collection_name, make_document().view());
+    for (int i = 0; i < 5; ++i) {
+        db_manager->insert_one(collection_name,
+                               make_document(kvp("name", "category " + std::to_string(i))).view());
+    }
+
+    auto replicated_collection = std::make_shared<ReplicatedCollection>(db_manager,
+                                                                        collection_name, 0);
+    BaseApiHandler handler;
+    crow::request req;
+    auto from_database =
+        handler.find_serialized(req, db_manager, collection_name, process_request_func_get_all);
+    crow::request replicated_req;
+    auto from_replica = handler.find_serialized(replicated_req, replicated_collection,
+                                                process_request_func_get_all);
+
+    EXPECT_EQ(from_replica.code, 200);
+    EXPECT_EQ(from_replica.body, from_database.body);
+    EXPECT_EQ(from_replica.get_header_value("ETag"), from_database.get_header_value("ETag"));
+    EXPECT_EQ(from_replica.get_header_value("ETag"),
+              EntityTagUtils::compute_etag(from_replica.body));
+
+    db_manager->delete_many(collection_name, make_document().view());
+}
+
+// ----- Test that only configured collections are replicated -----
+TEST(ReplicatedCollectionTest, CreatesOnlyConfiguredCollections) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    EnvManager env_manager;
+
+    EXPECT_NE(ReplicatedCollection::create_from_env(db_manager, "categories", env_manager),
+              nullptr);
+    EXPECT_EQ(ReplicatedCollection::create_from_env(db_manager, "complaints", env_manager),
+              nullptr);
+}
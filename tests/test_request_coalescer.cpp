@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "crow.h"
+#include "deferred_handler.hpp"
+#include "metrics_manager.hpp"
+#include "request_coalescer.hpp"
+
+// ----- Test that concurrent callers of one key share a single execution -----
+TEST(RequestCoalescerTest, SharesConcurrentExecution) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    RequestCoalescer request_coalescer("test", metrics_manager);
+    const int num_callers = 8;
+    int executions = 0;
+    // the execution stays open until its respond is called
+    respond_func_type leader_respond;
+    auto compute_func = [&](const respond_func_type& respond) {
+        executions++;
+        leader_respond = respond;
+    };
+
+    std::vector<crow::response> responses(num_callers);
+    std::vector<bool> is_responded(num_callers, false);
+    for (int i = 0; i < num_callers; ++i) {
+        request_coalescer.get_or_compute("key", compute_func, [&, i](crow::response res) {
+            responses[i] = std::move(res);
+            is_responded[i] = true;
+        });
+    }
+    // callers that arrive while the execution runs are parked, not blocked
+    EXPECT_EQ(executions, 1);
+    EXPECT_EQ(request_coalescer.get_in_flight_count(), 1);
+    for (int i = 0; i < num_callers; ++i) {
+        EXPECT_FALSE(is_responded[i]);
+    }
+
+    crow::response res(200, "{\"count\":3}");
+    res.set_header("ETag", "\"abc\"");
+    leader_respond(std::move(res));
+
+    for (int i = 0; i < num_callers; ++i) {
+        EXPECT_TRUE(is_responded[i]);
+        EXPECT_EQ(responses[i].code, 200);
+        EXPECT_EQ(responses[i].body, "{\"count\":3}");
+        EXPECT_EQ(responses[i].get_header_value("ETag"), "\"abc\"");
+    }
+    EXPECT_EQ(metrics_manager->get_counter("request_coalescer.test.executions"), 1);
+    EXPECT_EQ(metrics_manager->get_counter("request_coalescer.test.coalesced"), num_callers - 1);
+    EXPECT_EQ(request_coalescer.get_in_flight_count(), 0);
+}
+
+// ----- Test that finished executions and empty keys are not shared -----
+TEST(RequestCoalescerTest, RunsSequentialCallsAndEmptyKeysSeparately) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    RequestCoalescer request_coalescer("test", metrics_manager);
+    int executions = 0;
+    auto compute_func = [&executions](const respond_func_type& respond) {
+        executions++;
+        respond(crow::response(200));
+    };
+    int responses = 0;
+    auto respond = [&responses](crow::response res) { responses++; };
+
+    request_coalescer.get_or_compute("key", compute_func, respond);
+    request_coalescer.get_or_compute("key", compute_func, respond);
+    request_coalescer.get_or_compute("", compute_func, respond);
+
+    EXPECT_EQ(executions, 3);
+    EXPECT_EQ(responses, 3);
+    EXPECT_EQ(metrics_manager->get_counter("request_coalescer.test.coalesced"), 0);
+}
+
+// ----- Test that an exception reaches the caller, fails parked callers and clears the key -----
+TEST(RequestCoalescerTest, PropagatesExceptions) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    RequestCoalescer request_coalescer("test", metrics_manager);
+    int follower_code = 0;
+
+    EXPECT_THROW(request_coalescer.get_or_compute(
+                     "key",
+                     [&](const respond_func_type& respond) {
+                         // a caller arrives while the execution runs, then it fails
+                         request_coalescer.get_or_compute(
+                             "key", [](const respond_func_type& respond) {},
+                             [&follower_code](crow::response res) { follower_code = res.code; });
+                         throw std::runtime_error("failed");
+                     },
+                     [](crow::response res) {}),
+                 std::runtime_error);
+    EXPECT_EQ(follower_code, 500);
+    EXPECT_EQ(request_coalescer.get_in_flight_count(), 0);
+
+    int code = 0;
+    request_coalescer.get_or_compute(
+        "key", [](const respond_func_type& respond) { respond(crow::response(200)); },
+        [&code](crow::response res) { code = res.code; });
+    EXPECT_EQ(code, 200);
+}
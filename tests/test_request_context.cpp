@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "crow.h"
+#include "request_context.hpp"
+
+// ----- Test that the body is parsed once and reused -----
+TEST(RequestContextTest, ParsesBodyOnce) {
+    crow::request req;
+    req.body = "{\"name\":\"first\"}";
+    RequestContext context(req);
+
+    EXPECT_EQ(std::string(context.get_body()["name"].s()), "first");
+
+    // a second parse would see the new body
+    req.body = "{\"name\":\"second\"}";
+    EXPECT_EQ(std::string(context.get_body()["name"].s()), "first");
+}
+
+// ----- Test that an invalid body is falsy, like crow::json::load -----
+TEST(RequestContextTest, InvalidBodyIsFalsy) {
+    crow::request req;
+    req.body = "";
+    RequestContext context(req);
+
+    EXPECT_FALSE(context.get_body());
+}
+
+// ----- Test that get returns the scoped context only for its own request -----
+TEST(RequestContextTest, GetReturnsScopedContext) {
+    crow::request req;
+    crow::request other_req;
+    auto context = std::make_shared<RequestContext>(req);
+
+    {
+        RequestContext::Scope scope(context);
+        EXPECT_EQ(RequestContext::get(req), context);
+        EXPECT_NE(RequestContext::get(other_req), context);
+    }
+
+    EXPECT_NE(RequestContext::get(req), context);
+}
+
+// ----- Test that nested scopes restore the outer context -----
+TEST(RequestContextTest, NestedScopeRestoresPrevious) {
+    crow::request outer_req;
+    crow::request inner_req;
+    auto outer_context = std::make_shared<RequestContext>(outer_req);
+    auto inner_context = std::make_shared<RequestContext>(inner_req);
+
+    RequestContext::Scope outer_scope(outer_context);
+    {
+        RequestContext::Scope inner_scope(inner_context);
+        EXPECT_EQ(RequestContext::get(inner_req), inner_context);
+    }
+    EXPECT_EQ(RequestContext::get(outer_req), outer_context);
+}
+
+// ----- Test that JWT claims and stage timings are kept -----
+TEST(RequestContextTest, KeepsClaimsAndTimings) {
+    crow::request req;
+    RequestContext context(req);
+
+    EXPECT_FALSE(context.has_jwt_claims());
+    context.set_jwt_claims({{"oid", "abc"}, {"role", "Admin"}});
+    EXPECT_TRUE(context.has_jwt_claims());
+    EXPECT_EQ(context.get_jwt_claim("role"), "Admin");
+    EXPECT_EQ(context.get_jwt_claim("missing"), "");
+
+    context.record_stage("admitted");
+    context.record_stage("completed");
+    const auto& timings = context.get_stage_timings();
+    ASSERT_EQ(timings.size(), 2);
+    EXPECT_EQ(timings[0].first, "admitted");
+    EXPECT_LE(timings[0].second, timings[1].second);
+}
+
+// ----- Test that the response format follows the Accept header -----
+TEST(RequestContextTest, NegotiatesResponseFormat) {
+    crow::request req;
+    RequestContext json_context(req);
+    EXPECT_EQ(json_context.get_response_format(), ResponseFormat::Json);
+
+    req.add_header("Accept", "application/msgpack");
+    RequestContext msgpack_context(req);
+    EXPECT_EQ(msgpack_context.get_response_format(), ResponseFormat::MessagePack);
+    EXPECT_EQ(RequestContext::get_current(), nullptr)
+        << "No context should be current outside of a scope.";
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include <string>
+
+#include "crow.h"
+#include "response_compressor.hpp"
+
+static auto gunzip(const std::string& data) -> std::string {
+    z_stream stream = {};
+    inflateInit2(&stream, 15 + 16);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+
+    std::string out;
+    char buffer[4096];
+    int result;
+    do {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        result = inflate(&stream, Z_NO_FLUSH);
+        out.append(buffer, sizeof(buffer) - stream.avail_out);
+    } while (result == Z_OK);
+    inflateEnd(&stream);
+    EXPECT_EQ(result, Z_STREAM_END);
+    return out;
+}
+
+static auto unzstd(const std::string& data, const size_t& max_size) -> std::string {
+    std::string out(max_size, '\0');
+    auto size = ZSTD_decompress(&out[0], out.size(), data.data(), data.size());
+    EXPECT_FALSE(ZSTD_isError(size));
+    out.resize(ZSTD_isError(size) ? 0 : size);
+    return out;
+}
+
+static auto make_body() -> std::string {
+    std::string body = "{\"documents\":[";
+    for (int i = 0; i < 5000; ++i) {
+        body += "{\"title\":\"Complaint " + std::to_string(i) + "\",\"category\":\"Housing\"},";
+    }
+    body += "{}]}";
+    return body;
+}
+
+// ----- Test that both encodings round-trip -----
+TEST(ResponseCompressorTest, CompressRoundTrips) {
+    auto body = make_body();
+
+    auto gzip_body = StreamingCompressor::compress(body, ContentEncoding::Gzip, 5);
+    EXPECT_LT(gzip_body.size(), body.size());
+    EXPECT_EQ(gunzip(gzip_body), body);
+
+    auto zstd_body = StreamingCompressor::compress(body, ContentEncoding::Zstd, 3);
+    EXPECT_LT(zstd_body.size(), body.size());
+    EXPECT_EQ(unzstd(zstd_body, body.size()), body);
+}
+
+// ----- Test Accept-Encoding negotiation -----
+TEST(ResponseCompressorTest, NegotiatesEncoding) {
+    EXPECT_EQ(ResponseCompressor::negotiate_encoding(""), ContentEncoding::Identity);
+    EXPECT_EQ(ResponseCompressor::negotiate_encoding("identity, br"), ContentEncoding::Identity);
+    EXPECT_EQ(ResponseCompressor::negotiate_encoding("gzip, deflate"), ContentEncoding::Gzip);
+    EXPECT_EQ(ResponseCompressor::negotiate_encoding("gzip, deflate, br, zstd"),
+              ContentEncoding::Zstd)
+        << "zstd should win a tie.";
+    EXPECT_EQ(ResponseCompressor::negotiate_encoding("gzip;q=1.0, zstd;q=0.5"),
+              ContentEncoding::Gzip);
+    EXPECT_EQ(ResponseCompressor::negotiate_encoding("zstd;q=0"), ContentEncoding::Identity);
+}
+
+// ----- Test that a finished response is compressed only above the threshold -----
+TEST(ResponseCompressorTest, CompressResponseHonorsThreshold) {
+    ResponseCompressor compressor(true, 1024, 5, 3);
+    crow::request req;
+    req.add_header("Accept-Encoding", "gzip");
+
+    crow::response large_res(200);
+    large_res.body = make_body();
+    large_res.set_header("ETag", "\"tag\"");
+    compressor.compress_response(req, large_res);
+    EXPECT_EQ(large_res.get_header_value("Content-Encoding"), "gzip");
+    EXPECT_EQ(gunzip(large_res.body), make_body());
+    // the compressed representation gets its own strong ETag
+    EXPECT_EQ(large_res.get_header_value("ETag"), "\"tag-gzip\"");
+
+    crow::response small_res(200);
+    small_res.body = "{\"success\":true}";
+    compressor.compress_response(req, small_res);
+    EXPECT_EQ(small_res.get_header_value("Content-Encoding"), "");
+    EXPECT_EQ(small_res.body, "{\"success\":true}");
+}
+
+// ----- Test that a disabled compressor leaves responses alone -----
+TEST(ResponseCompressorTest, DisabledCompressorDoesNothing) {
+    ResponseCompressor compressor(false);
+    crow::request req;
+    req.add_header("Accept-Encoding", "zstd");
+
+    crow::response res(200);
+    res.body = make_body();
+    compressor.compress_response(req, res);
+    EXPECT_EQ(res.get_header_value("Content-Encoding"), "");
+    EXPECT_EQ(compressor.make_body_compressor(req, res), nullptr);
+}
+
+// ----- Test that a body written in chunks is compressed incrementally -----
+TEST(ResponseCompressorTest, BodyCompressorStreamsChunks) {
+    auto body = make_body();
+    crow::response res(200);
+    ResponseBodyCompressor body_compressor(res, ContentEncoding::Zstd, 3, 1024);
+
+    for (size_t i = 0; i < body.size(); i += 700) {
+        body_compressor.write(body.substr(i, 700));
+        // once past the threshold the body only grows by compressed output
+        if (i > 2048) {
+            EXPECT_LT(res.body.size(), i);
+        }
+    }
+    body_compressor.finish();
+
+    EXPECT_EQ(res.get_header_value("Content-Encoding"), "zstd");
+    EXPECT_EQ(unzstd(res.body, body.size()), body);
+}
+
+// ----- Test that a short body written in chunks stays uncompressed -----
+TEST(ResponseCompressorTest, BodyCompressorSkipsSmallBodies) {
+    crow::response res(200);
+    ResponseBodyCompressor body_compressor(res, ContentEncoding::Gzip, 5, 1024);
+    body_compressor.write("{\"documents\":[");
+    body_compressor.write("]}");
+    body_compressor.finish();
+
+    EXPECT_EQ(res.get_header_value("Content-Encoding"), "");
+    EXPECT_EQ(res.body, "{\"documents\":[]}");
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/document/view.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "base_api_strategy_utils.hpp"
+#include "crow.h"
+#include "request_context.hpp"
+#include "response_format.hpp"
+
+// ----- Test that JSON stays the default -----
+TEST(ResponseFormatTest, DefaultsToJson) {
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format(""), ResponseFormat::Json);
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format("*/*"), ResponseFormat::Json);
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format("text/html, application/xml"),
+              ResponseFormat::Json);
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format("application/json"),
+              ResponseFormat::Json);
+}
+
+// ----- Test that the supported binary media types are recognised -----
+TEST(ResponseFormatTest, NegotiatesBinaryFormats) {
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format("application/bson"),
+              ResponseFormat::Bson);
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format("Application/MsgPack"),
+              ResponseFormat::MessagePack);
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format("application/x-msgpack"),
+              ResponseFormat::MessagePack);
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format("text/html, application/bson"),
+              ResponseFormat::Bson);
+}
+
+// ----- Test that q-values decide between several supported types -----
+TEST(ResponseFormatTest, HonorsQualityValues) {
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format(
+                  "application/json;q=0.5, application/msgpack;q=0.9"),
+              ResponseFormat::MessagePack);
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format(
+                  "application/bson; q=0.2, application/json"),
+              ResponseFormat::Json);
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format("application/bson;q=0"),
+              ResponseFormat::Json)
+        << "q=0 means the type is not acceptable.";
+    EXPECT_EQ(ResponseFormatUtils::negotiate_response_format("application/bson, application/json"),
+              ResponseFormat::Bson)
+        << "The earlier type should win a tie.";
+}
+
+// ----- Test that make_success_response encodes for the request being served -----
+TEST(ResponseFormatTest, MakeSuccessResponseHonorsAccept) {
+    crow::request req;
+    req.add_header("Accept", "application/bson");
+    RequestContext::Scope scope(std::make_shared<RequestContext>(req));
+
+    crow::json::wvalue data;
+    data["count"] = 3;
+    auto res = BaseApiStrategyUtils::make_success_response(200, std::move(data), "ok");
+    EXPECT_EQ(res.code, 200);
+    EXPECT_EQ(res.get_header_value("Content-Type"), "application/bson");
+
+    bsoncxx::document::view body(reinterpret_cast<const std::uint8_t*>(res.body.data()),
+                                 res.body.size());
+    EXPECT_TRUE(body["success"].get_bool().value);
+    EXPECT_EQ(body["message"].get_string().value, "ok");
+}
+
+// ----- Test that errors are encoded the same way -----
+TEST(ResponseFormatTest, MakeErrorResponseHonorsAccept) {
+    crow::request req;
+    req.add_header("Accept", "application/msgpack");
+    RequestContext::Scope scope(std::make_shared<RequestContext>(req));
+
+    auto res = BaseApiStrategyUtils::make_error_response(400, "bad");
+    EXPECT_EQ(res.code, 400);
+    EXPECT_EQ(res.get_header_value("Content-Type"), "application/msgpack");
+    // {"success": false, "message": "bad"} in either key order
+    std::string success_field = "\xa7success\xc2";
+    std::string message_field = std::string("\xa7message\xa3") + "bad";
+    EXPECT_TRUE(res.body == "\x82" + success_field + message_field ||
+                res.body == "\x82" + message_field + success_field);
+}
+
+// ----- Test that responses outside of a request stay JSON -----
+TEST(ResponseFormatTest, NoContextGivesJson) {
+    auto res = BaseApiStrategyUtils::make_success_response(200, {}, "ok");
+    auto body = crow::json::load(res.body);
+    ASSERT_TRUE(body);
+    EXPECT_TRUE(body["success"].b());
+}
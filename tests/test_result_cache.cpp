@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "crow.h"
+#include "entity_tag.hpp"
+#include "metrics_manager.hpp"
+#include "result_cache.hpp"
+
+// ----- Test that a repeated request is served from the cache -----
+TEST(ResultCacheTest, ServesRepeatedRequestFromCache) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    ResultCache result_cache("test", metrics_manager);
+    int computations = 0;
+    auto compute_func = [&computations]() {
+        computations++;
+        crow::response res(200, "{\"count\":3}");
+        res.set_header("Content-Type", "application/json");
+        return res;
+    };
+
+    crow::request req;
+    req.body = "{\"filter\":{\"category\":\"Housing\"}}";
+    auto first = result_cache.get_or_compute("route", req, compute_func);
+    auto second = result_cache.get_or_compute("route", req, compute_func);
+
+    EXPECT_EQ(computations, 1);
+    EXPECT_EQ(second.code, 200);
+    EXPECT_EQ(second.body, first.body);
+    EXPECT_EQ(second.get_header_value("Content-Type"), "application/json");
+    EXPECT_EQ(metrics_manager->get_counter("result_cache.test.hits"), 1);
+    EXPECT_EQ(metrics_manager->get_counter("result_cache.test.misses"), 1);
+}
+
+// ----- Test that keys ignore object key order but not values or routes -----
+TEST(ResultCacheTest, KeysAreCanonical) {
+    crow::request req;
+    req.body = "{\"filter\":{\"a\":1,\"b\":[1,2]},\"bucket_size\":0.5}";
+    crow::request reordered_req;
+    reordered_req.body = "{\"bucket_size\":0.5,\"filter\":{\"b\":[1,2],\"a\":1}}";
+    crow::request other_req;
+    other_req.body = "{\"filter\":{\"a\":1,\"b\":[2,1]},\"bucket_size\":0.5}";
+
+    EXPECT_EQ(ResultCache::make_key("route", req), ResultCache::make_key("route", reordered_req));
+    EXPECT_NE(ResultCache::make_key("route", req), ResultCache::make_key("route", other_req));
+    EXPECT_NE(ResultCache::make_key("route", req), ResultCache::make_key("other_route", req));
+}
+
+// ----- Test that the response format is part of the key -----
+TEST(ResultCacheTest, KeysDependOnResponseFormat) {
+    crow::request req;
+    req.body = "{}";
+    crow::request msgpack_req;
+    msgpack_req.body = "{}";
+    msgpack_req.add_header("Accept", "application/msgpack");
+
+    EXPECT_NE(ResultCache::make_key("route", req), ResultCache::make_key("route", msgpack_req));
+}
+
+// ----- Test that failed responses and invalid bodies are not cached -----
+TEST(ResultCacheTest, DoesNotCacheFailures) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    ResultCache result_cache("test", metrics_manager);
+    int computations = 0;
+    auto compute_func = [&computations]() {
+        computations++;
+        return crow::response(500);
+    };
+
+    crow::request req;
+    req.body = "{}";
+    result_cache.get_or_compute("route", req, compute_func);
+    result_cache.get_or_compute("route", req, compute_func);
+    EXPECT_EQ(computations, 2);
+
+    crow::request invalid_req;
+    invalid_req.body = "not json";
+    EXPECT_TRUE(ResultCache::make_key("route", invalid_req).empty());
+    EXPECT_EQ(result_cache.size(), 0);
+}
+
+// ----- Test that invalidate drops every entry -----
+TEST(ResultCacheTest, InvalidateDropsEntries) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    ResultCache result_cache("test", metrics_manager);
+    int computations = 0;
+    auto compute_func = [&computations]() {
+        computations++;
+        return crow::response(200);
+    };
+
+    crow::request req;
+    req.body = "{}";
+    result_cache.get_or_compute("route", req, compute_func);
+    result_cache.invalidate();
+    result_cache.get_or_compute("route", req, compute_func);
+
+    EXPECT_EQ(computations, 2);
+    EXPECT_EQ(metrics_manager->get_counter("result_cache.test.invalidations"), 1);
+}
+
+// ----- Test that a result computed across an invalidation is not stored -----
+TEST(ResultCacheTest, DoesNotStoreResultComputedBeforeInvalidation) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    ResultCache result_cache("test", metrics_manager);
+    crow::request req;
+    req.body = "{}";
+
+    result_cache.get_or_compute("route", req, [&result_cache]() {
+        // a write lands while the aggregation is running
+        result_cache.invalidate();
+        return crow::response(200);
+    });
+
+    EXPECT_EQ(result_cache.size(), 0);
+}
+
+// ----- Test that entries expire after the TTL -----
+TEST(ResultCacheTest, ExpiresAfterTtl) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    ResultCache result_cache("test", metrics_manager, true, 20);
+    int computations = 0;
+    auto compute_func = [&computations]() {
+        computations++;
+        return crow::response(200);
+    };
+
+    crow::request req;
+    req.body = "{}";
+    result_cache.get_or_compute("route", req, compute_func);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    result_cache.get_or_compute("route", req, compute_func);
+
+    EXPECT_EQ(computations, 2);
+}
+
+// ----- Test that a full cache drops its oldest entry -----
+TEST(ResultCacheTest, EvictsOldestEntryWhenFull) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    ResultCache result_cache("test", metrics_manager, true, 60000, 2);
+    auto compute_func = []() { return crow::response(200); };
+
+    for (int i = 0; i < 3; ++i) {
+        crow::request req;
+        req.body = "{\"page\":" + std::to_string(i) + "}";
+        result_cache.get_or_compute("route", req, compute_func);
+    }
+
+    EXPECT_EQ(result_cache.size(), 2);
+    EXPECT_EQ(metrics_manager->get_counter("result_cache.test.evictions"), 1);
+}
+
+// ----- Test that a disabled cache always computes -----
+TEST(ResultCacheTest, DisabledCacheAlwaysComputes) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    ResultCache result_cache("test", metrics_manager, false);
+    int computations = 0;
+    auto compute_func = [&computations]() {
+        computations++;
+        return crow::response(200);
+    };
+
+    crow::request req;
+    req.body = "{}";
+    result_cache.get_or_compute("route", req, compute_func);
+    result_cache.get_or_compute("route", req, compute_func);
+
+    EXPECT_EQ(computations, 2);
+    EXPECT_EQ(result_cache.size(), 0);
+}
+
+// ----- Test that a hit whose ETag the client already holds is answered with a 304 -----
+TEST(ResultCacheTest, AnswersMatchingHitWithNotModified) {
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    ResultCache result_cache("test", metrics_manager);
+    auto compute_func = []() {
+        return EntityTagUtils::tag_response(crow::response(200, "{\"count\":3}"));
+    };
+
+    crow::request req;
+    req.body = "{}";
+    auto first = result_cache.get_or_compute("route", req, compute_func);
+
+    crow::request conditional_req;
+    conditional_req.body = "{}";
+    conditional_req.add_header("If-None-Match", first.get_header_value("ETag"));
+    auto second = result_cache.get_or_compute("route", conditional_req, compute_func);
+
+    EXPECT_EQ(second.code, 304);
+    EXPECT_EQ(second.body, "");
+    EXPECT_EQ(metrics_manager->get_counter("result_cache.test.hits"), 1);
+}
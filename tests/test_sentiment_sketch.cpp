@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <bsoncxx/json.hpp>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "sentiment_sketch.hpp"
+
+// ----- Test that sentiments fall in fixed-width bins, clamped to the edge bins -----
+TEST(SentimentSketchTest, BinsSentiments) {
+    EXPECT_EQ(SentimentSketch::get_bin(-1.0), 0);
+    EXPECT_EQ(SentimentSketch::get_bin(-0.995), 0);
+    EXPECT_EQ(SentimentSketch::get_bin(0.0), 100);
+    EXPECT_EQ(SentimentSketch::get_bin(0.5), 150);
+    EXPECT_EQ(SentimentSketch::get_bin(1.0), SentimentSketch::BIN_COUNT - 1);
+    EXPECT_EQ(SentimentSketch::get_bin(-3.0), 0);
+    EXPECT_EQ(SentimentSketch::get_bin(3.0), SentimentSketch::BIN_COUNT - 1);
+
+    auto expression = bsoncxx::to_json(SentimentSketch::make_bin_expression("$sentiment").view());
+    EXPECT_NE(expression.find("\"$isNumber\" : \"$sentiment\""), std::string::npos);
+    EXPECT_NE(expression.find("\"$toInt\""), std::string::npos);
+}
+
+// ----- Test that quantiles are within half a bin width of the exact ones -----
+TEST(SentimentSketchTest, EstimatesQuantiles) {
+    std::vector<double> sentiments;
+    SentimentSketch sketch;
+    for (int i = 0; i < 1000; ++i) {
+        // skewed towards negative sentiments
+        auto sentiment = std::pow(i / 999.0, 2) * 2 - 1;
+        sentiments.push_back(sentiment);
+        sketch.add(sentiment);
+    }
+    std::sort(sentiments.begin(), sentiments.end());
+
+    EXPECT_EQ(sketch.get_count(), 1000);
+    EXPECT_DOUBLE_EQ(sketch.get_min(), -1.0);
+    EXPECT_DOUBLE_EQ(sketch.get_max(), 1.0);
+    for (auto q : {0.5, 0.9, 0.99}) {
+        auto exact = sentiments[static_cast<size_t>(q * sentiments.size()) - 1];
+        EXPECT_NEAR(sketch.get_quantile(q), exact, 0.5 / SentimentSketch::BINS_PER_UNIT + 1e-9);
+    }
+}
+
+// ----- Test that merged and removed sentiments add up like the sketch of the remaining ones -----
+TEST(SentimentSketchTest, MergesAndRemoves) {
+    SentimentSketch first;
+    first.add(-0.5);
+    first.add(0.25);
+    SentimentSketch second;
+    second.add(0.75, 3);
+    first.merge(second);
+    EXPECT_EQ(first.get_count(), 5);
+    EXPECT_EQ(first.get_bin_count(SentimentSketch::get_bin(0.75)), 3);
+    EXPECT_DOUBLE_EQ(first.get_max(), 0.75);
+
+    // bins alone, as kept in rollups, bound the range by the bin edges
+    SentimentSketch bins;
+    bins.add_bin(SentimentSketch::get_bin(0.25), 1);
+    bins.add_bin(SentimentSketch::get_bin(0.75), 2);
+    bins.add_bin(SentimentSketch::get_bin(0.75), -2);
+    bins.add_bin(SentimentSketch::BIN_COUNT, 1);
+    EXPECT_EQ(bins.get_count(), 1);
+    EXPECT_NEAR(bins.get_min(), 0.25, 1e-9);
+    EXPECT_NEAR(bins.get_max(), 0.26, 1e-9);
+    EXPECT_NEAR(bins.get_quantile(0.5), 0.255, 1e-9);
+
+    SentimentSketch empty;
+    EXPECT_EQ(empty.get_quantile(0.5), 0);
+    EXPECT_EQ(empty.get_min(), 0);
+}
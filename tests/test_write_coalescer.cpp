@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <bsoncxx/builder/basic/document.hpp>
+#include <chrono>
+#include <future>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "database_manager.hpp"
+#include "metrics_manager.hpp"
+#include "write_coalescer.hpp"
+
+using bsoncxx::builder::basic::kvp;
+using bsoncxx::builder::basic::make_document;
+
+// ----- Test that concurrent inserts are batched and each caller gets its own oid -----
+TEST(WriteCoalescerTest, CoalescesConcurrentInserts) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    std::string collection_name = "test_write_coalescer";
+    db_manager->delete_many(collection_name, make_document().view());
+
+    const int num_inserts = 40;
+    std::vector<std::string> oids(num_inserts);
+    {
+        WriteCoalescer write_coalescer(db_manager, collection_name, metrics_manager, 50, 10, 1000);
+        std::vector<std::thread> callers;
+        for (int i = 0; i < num_inserts; ++i) {
+            callers.emplace_back([&, i]() {
+                auto result = write_coalescer.insert_one(make_document(kvp("value", i)).view());
+                EXPECT_EQ(result.item_result.status, BulkWriteItemStatus::Succeeded);
+                oids[i] = result.oid.to_string();
+            });
+        }
+        for (auto& caller : callers) {
+            caller.join();
+        }
+    }
+
+    EXPECT_EQ(std::set<std::string>(oids.begin(), oids.end()).size(), num_inserts);
+    EXPECT_EQ(db_manager->count_documents(collection_name, make_document().view()), num_inserts);
+
+    auto batch_size = metrics_manager->get_summary("write_coalescer." + collection_name +
+                                                   ".batch_size");
+    EXPECT_LT(batch_size.count, num_inserts) << "Inserts should share batches.";
+    EXPECT_LE(batch_size.max, 10);
+
+    db_manager->delete_many(collection_name, make_document().view());
+}
+
+// ----- Test that a duplicate key only fails its own caller -----
+TEST(WriteCoalescerTest, ReportsDuplicateKeyPerCaller) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    std::string collection_name = "test_write_coalescer_duplicates";
+    db_manager->delete_many(collection_name, make_document().view());
+
+    WriteCoalescer write_coalescer(db_manager, collection_name, metrics_manager, 0, 10, 100);
+    bsoncxx::oid oid;
+    auto first = write_coalescer.insert_one(make_document(kvp("_id", oid)).view());
+    auto second = write_coalescer.insert_one(make_document(kvp("_id", oid)).view());
+
+    EXPECT_EQ(first.item_result.status, BulkWriteItemStatus::Succeeded);
+    EXPECT_EQ(first.oid, oid);
+    EXPECT_EQ(second.item_result.status, BulkWriteItemStatus::DuplicateKey);
+
+    db_manager->delete_many(collection_name, make_document().view());
+}
+
+// ----- Test that a callback insert returns before its batch is written -----
+TEST(WriteCoalescerTest, CallsBackOnceWritten) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    std::string collection_name = "test_write_coalescer_callbacks";
+    db_manager->delete_many(collection_name, make_document().view());
+
+    std::promise<CoalescedInsertResult> written;
+    {
+        WriteCoalescer write_coalescer(db_manager, collection_name, metrics_manager, 50, 10, 1000);
+        write_coalescer.insert_one(
+            make_document(kvp("value", 1)).view(),
+            [&written](const CoalescedInsertResult& result) { written.set_value(result); });
+        auto future = written.get_future();
+        EXPECT_EQ(future.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout)
+            << "The insert should wait for the batch window.";
+
+        auto result = future.get();
+        EXPECT_EQ(result.item_result.status, BulkWriteItemStatus::Succeeded);
+        EXPECT_EQ(db_manager->count_documents(collection_name,
+                                              make_document(kvp("_id", result.oid)).view()),
+                  1);
+    }
+
+    db_manager->delete_many(collection_name, make_document().view());
+}
+
+// ----- Test invalid configuration -----
+TEST(WriteCoalescerTest, InvalidConfiguration) {
+    auto db_manager = std::make_shared<DatabaseManager>("mongodb://localhost:27017", "test_db");
+    auto metrics_manager = std::make_shared<MetricsManager>();
+    EXPECT_THROW(WriteCoalescer(db_manager, "test", metrics_manager, 10, 0, 100),
+                 std::invalid_argument);
+    EXPECT_THROW(WriteCoalescer(db_manager, "test", metrics_manager, 10, 10, 5),
+                 std::invalid_argument);
+}